@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_benchmark.dir/benchmark/cache_benchmark.cpp.o"
+  "CMakeFiles/cache_benchmark.dir/benchmark/cache_benchmark.cpp.o.d"
+  "cache_benchmark"
+  "cache_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
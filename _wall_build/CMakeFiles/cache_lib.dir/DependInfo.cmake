@@ -0,0 +1,36 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/arc_cache.cpp" "CMakeFiles/cache_lib.dir/src/arc_cache.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/arc_cache.cpp.o.d"
+  "/root/repo/src/cache_server.cpp" "CMakeFiles/cache_lib.dir/src/cache_server.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/cache_server.cpp.o.d"
+  "/root/repo/src/cluster_client.cpp" "CMakeFiles/cache_lib.dir/src/cluster_client.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/cluster_client.cpp.o.d"
+  "/root/repo/src/io_engine.cpp" "CMakeFiles/cache_lib.dir/src/io_engine.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/io_engine.cpp.o.d"
+  "/root/repo/src/latency_histogram.cpp" "CMakeFiles/cache_lib.dir/src/latency_histogram.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/latency_histogram.cpp.o.d"
+  "/root/repo/src/lfu_cache.cpp" "CMakeFiles/cache_lib.dir/src/lfu_cache.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/lfu_cache.cpp.o.d"
+  "/root/repo/src/lru_cache.cpp" "CMakeFiles/cache_lib.dir/src/lru_cache.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/lru_cache.cpp.o.d"
+  "/root/repo/src/lz4_codec.cpp" "CMakeFiles/cache_lib.dir/src/lz4_codec.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/lz4_codec.cpp.o.d"
+  "/root/repo/src/memcached_protocol.cpp" "CMakeFiles/cache_lib.dir/src/memcached_protocol.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/memcached_protocol.cpp.o.d"
+  "/root/repo/src/memory_allocator.cpp" "CMakeFiles/cache_lib.dir/src/memory_allocator.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/memory_allocator.cpp.o.d"
+  "/root/repo/src/metrics.cpp" "CMakeFiles/cache_lib.dir/src/metrics.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/metrics.cpp.o.d"
+  "/root/repo/src/metrics_http_server.cpp" "CMakeFiles/cache_lib.dir/src/metrics_http_server.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/metrics_http_server.cpp.o.d"
+  "/root/repo/src/metrics_registry.cpp" "CMakeFiles/cache_lib.dir/src/metrics_registry.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/metrics_registry.cpp.o.d"
+  "/root/repo/src/miss_ratio_curve.cpp" "CMakeFiles/cache_lib.dir/src/miss_ratio_curve.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/miss_ratio_curve.cpp.o.d"
+  "/root/repo/src/replication.cpp" "CMakeFiles/cache_lib.dir/src/replication.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/replication.cpp.o.d"
+  "/root/repo/src/resp_protocol.cpp" "CMakeFiles/cache_lib.dir/src/resp_protocol.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/resp_protocol.cpp.o.d"
+  "/root/repo/src/timing.cpp" "CMakeFiles/cache_lib.dir/src/timing.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/timing.cpp.o.d"
+  "/root/repo/src/write_ahead_log.cpp" "CMakeFiles/cache_lib.dir/src/write_ahead_log.cpp.o" "gcc" "CMakeFiles/cache_lib.dir/src/write_ahead_log.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
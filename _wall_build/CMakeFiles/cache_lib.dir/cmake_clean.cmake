@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_lib.dir/src/arc_cache.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/arc_cache.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/cache_server.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/cache_server.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/cluster_client.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/cluster_client.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/io_engine.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/io_engine.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/latency_histogram.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/latency_histogram.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/lfu_cache.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/lfu_cache.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/lru_cache.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/lru_cache.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/lz4_codec.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/lz4_codec.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/memcached_protocol.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/memcached_protocol.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/memory_allocator.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/memory_allocator.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/metrics.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/metrics.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/metrics_http_server.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/metrics_http_server.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/metrics_registry.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/metrics_registry.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/miss_ratio_curve.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/miss_ratio_curve.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/replication.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/replication.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/resp_protocol.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/resp_protocol.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/timing.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/timing.cpp.o.d"
+  "CMakeFiles/cache_lib.dir/src/write_ahead_log.cpp.o"
+  "CMakeFiles/cache_lib.dir/src/write_ahead_log.cpp.o.d"
+  "libcache_lib.a"
+  "libcache_lib.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_lib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
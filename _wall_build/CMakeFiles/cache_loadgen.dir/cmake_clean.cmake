@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_loadgen.dir/tools/cache_loadgen.cpp.o"
+  "CMakeFiles/cache_loadgen.dir/tools/cache_loadgen.cpp.o.d"
+  "cache_loadgen"
+  "cache_loadgen.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_loadgen.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_memory_benchmark.dir/benchmark/memory_footprint.cpp.o"
+  "CMakeFiles/cache_memory_benchmark.dir/benchmark/memory_footprint.cpp.o.d"
+  "cache_memory_benchmark"
+  "cache_memory_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_memory_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
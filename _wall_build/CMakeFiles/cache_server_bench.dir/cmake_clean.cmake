@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_server_bench.dir/tools/cache_server_bench.cpp.o"
+  "CMakeFiles/cache_server_bench.dir/tools/cache_server_bench.cpp.o.d"
+  "cache_server_bench"
+  "cache_server_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_server_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,45 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/test_adaptive.cpp" "CMakeFiles/cache_tests.dir/test/test_adaptive.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_adaptive.cpp.o.d"
+  "/root/repo/test/test_arc.cpp" "CMakeFiles/cache_tests.dir/test/test_arc.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_arc.cpp.o.d"
+  "/root/repo/test/test_cache_server.cpp" "CMakeFiles/cache_tests.dir/test/test_cache_server.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_cache_server.cpp.o.d"
+  "/root/repo/test/test_cluster_client.cpp" "CMakeFiles/cache_tests.dir/test/test_cluster_client.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_cluster_client.cpp.o.d"
+  "/root/repo/test/test_compression.cpp" "CMakeFiles/cache_tests.dir/test/test_compression.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_compression.cpp.o.d"
+  "/root/repo/test/test_concurrency.cpp" "CMakeFiles/cache_tests.dir/test/test_concurrency.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_concurrency.cpp.o.d"
+  "/root/repo/test/test_durable_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_durable_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_durable_cache.cpp.o.d"
+  "/root/repo/test/test_hot_key_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_hot_key_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_hot_key_cache.cpp.o.d"
+  "/root/repo/test/test_incremental_hash_map.cpp" "CMakeFiles/cache_tests.dir/test/test_incremental_hash_map.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_incremental_hash_map.cpp.o.d"
+  "/root/repo/test/test_io_engine.cpp" "CMakeFiles/cache_tests.dir/test/test_io_engine.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_io_engine.cpp.o.d"
+  "/root/repo/test/test_latency_histogram.cpp" "CMakeFiles/cache_tests.dir/test/test_latency_histogram.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_latency_histogram.cpp.o.d"
+  "/root/repo/test/test_lfu.cpp" "CMakeFiles/cache_tests.dir/test/test_lfu.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_lfu.cpp.o.d"
+  "/root/repo/test/test_loading_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_loading_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_loading_cache.cpp.o.d"
+  "/root/repo/test/test_lru.cpp" "CMakeFiles/cache_tests.dir/test/test_lru.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_lru.cpp.o.d"
+  "/root/repo/test/test_maintenance_scheduler.cpp" "CMakeFiles/cache_tests.dir/test/test_maintenance_scheduler.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_maintenance_scheduler.cpp.o.d"
+  "/root/repo/test/test_metrics_exporter.cpp" "CMakeFiles/cache_tests.dir/test/test_metrics_exporter.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_metrics_exporter.cpp.o.d"
+  "/root/repo/test/test_miss_ratio_curve.cpp" "CMakeFiles/cache_tests.dir/test/test_miss_ratio_curve.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_miss_ratio_curve.cpp.o.d"
+  "/root/repo/test/test_near_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_near_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_near_cache.cpp.o.d"
+  "/root/repo/test/test_replication.cpp" "CMakeFiles/cache_tests.dir/test/test_replication.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_replication.cpp.o.d"
+  "/root/repo/test/test_resp_protocol.cpp" "CMakeFiles/cache_tests.dir/test/test_resp_protocol.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_resp_protocol.cpp.o.d"
+  "/root/repo/test/test_shadow_simulator.cpp" "CMakeFiles/cache_tests.dir/test/test_shadow_simulator.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_shadow_simulator.cpp.o.d"
+  "/root/repo/test/test_sharded_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_sharded_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_sharded_cache.cpp.o.d"
+  "/root/repo/test/test_shared_memory_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_shared_memory_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_shared_memory_cache.cpp.o.d"
+  "/root/repo/test/test_snapshot.cpp" "CMakeFiles/cache_tests.dir/test/test_snapshot.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_snapshot.cpp.o.d"
+  "/root/repo/test/test_tiered_cache.cpp" "CMakeFiles/cache_tests.dir/test/test_tiered_cache.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_tiered_cache.cpp.o.d"
+  "/root/repo/test/test_timing.cpp" "CMakeFiles/cache_tests.dir/test/test_timing.cpp.o" "gcc" "CMakeFiles/cache_tests.dir/test/test_timing.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_wall_build/CMakeFiles/cache_lib.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,61 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cache_tests.dir/test/test_adaptive.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_adaptive.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_arc.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_arc.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_cache_server.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_cache_server.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_cluster_client.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_cluster_client.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_compression.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_compression.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_concurrency.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_concurrency.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_durable_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_durable_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_hot_key_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_hot_key_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_incremental_hash_map.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_incremental_hash_map.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_io_engine.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_io_engine.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_latency_histogram.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_latency_histogram.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_lfu.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_lfu.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_loading_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_loading_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_lru.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_lru.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_maintenance_scheduler.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_maintenance_scheduler.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_metrics_exporter.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_metrics_exporter.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_miss_ratio_curve.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_miss_ratio_curve.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_near_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_near_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_replication.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_replication.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_resp_protocol.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_resp_protocol.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_shadow_simulator.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_shadow_simulator.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_sharded_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_sharded_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_shared_memory_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_shared_memory_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_snapshot.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_snapshot.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_tiered_cache.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_tiered_cache.cpp.o.d"
+  "CMakeFiles/cache_tests.dir/test/test_timing.cpp.o"
+  "CMakeFiles/cache_tests.dir/test/test_timing.cpp.o.d"
+  "cache_tests"
+  "cache_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cache_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
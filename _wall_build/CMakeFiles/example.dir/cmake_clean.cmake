@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example.dir/examples/example_usage.cpp.o"
+  "CMakeFiles/example.dir/examples/example_usage.cpp.o.d"
+  "example"
+  "example.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example_arc.dir/examples/example_arc.cpp.o"
+  "CMakeFiles/example_arc.dir/examples/example_arc.cpp.o.d"
+  "example_arc"
+  "example_arc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_arc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
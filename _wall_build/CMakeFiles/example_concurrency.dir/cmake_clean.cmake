@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example_concurrency.dir/examples/example_concurrency.cpp.o"
+  "CMakeFiles/example_concurrency.dir/examples/example_concurrency.cpp.o.d"
+  "example_concurrency"
+  "example_concurrency.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_concurrency.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example_lfu.dir/examples/example_lfu.cpp.o"
+  "CMakeFiles/example_lfu.dir/examples/example_lfu.cpp.o.d"
+  "example_lfu"
+  "example_lfu.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_lfu.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example_lru.dir/examples/example_lru.cpp.o"
+  "CMakeFiles/example_lru.dir/examples/example_lru.cpp.o.d"
+  "example_lru"
+  "example_lru.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_lru.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example_mixed.dir/examples/example_mixed.cpp.o"
+  "CMakeFiles/example_mixed.dir/examples/example_mixed.cpp.o.d"
+  "example_mixed"
+  "example_mixed.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_mixed.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_wall_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(CacheTests "/root/repo/_wall_build/cache_tests")
+set_tests_properties(CacheTests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;110;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(MemoryFootprint "/root/repo/_wall_build/cache_memory_benchmark" "--entries" "100000" "--baseline" "/root/repo/benchmark/memory_baseline.txt" "--threshold" "0.10")
+set_tests_properties(MemoryFootprint PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;114;add_test;/root/repo/CMakeLists.txt;0;")
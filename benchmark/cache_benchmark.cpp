@@ -1,6 +1,20 @@
+#include "../include/cache/adaptive_cache.hpp"
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/durable_cache.hpp"
+#include "../include/cache/hot_key_cache.hpp"
+#include "../include/cache/lfu_cache.hpp"
 #include "../include/cache/lru_cache.hpp"
+#include "../include/cache/maintenance_scheduler.hpp"
+#include "../include/cache/miss_ratio_curve.hpp"
+#include "../include/cache/near_cache.hpp"
+#include "../include/cache/sharded_cache.hpp"
 #include "workload_patterns.hpp"
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
 #include <vector>
 
 static void BM_LRU_PutGet(benchmark::State& state) {
@@ -18,5 +32,246 @@ static void BM_LRU_PutGet(benchmark::State& state) {
 
 BENCHMARK(BM_LRU_PutGet)->Arg(1024)->Arg(8192)->Arg(65536);
 
+// Shared-cache scalability: every thread hammers one cache instance.
+// Args: {distribution, read percent}. Reads are plain gets and writes are
+// puts, after a single-threaded demand-fill warmup over the trace prefix.
+enum Distribution { kUniform, kZipf, kScanMix, kHotKey };
+
+constexpr int kMTCapacity = 1 << 16;
+constexpr int kMTKeySpace = 1 << 20;
+constexpr size_t kMTTraceLen = 1 << 21;
+
+static const std::vector<int>& mt_trace(int distribution) {
+  static const std::vector<int> traces[] = {
+      bench::uniform_keys(kMTTraceLen, kMTKeySpace),
+      bench::zipf_keys(kMTTraceLen, kMTKeySpace, 0.99),
+      bench::scan_mix_keys(kMTTraceLen, kMTKeySpace),
+      bench::hot_key_keys(kMTTraceLen, kMTKeySpace),
+  };
+  return traces[distribution];
+}
+
+template <typename Cache>
+static std::unique_ptr<Cache> make_mt_cache() {
+  return std::make_unique<Cache>(kMTCapacity, "bench_mt");
+}
+
+template <>
+std::unique_ptr<cache::NearCache<int, int>> make_mt_cache() {
+  return std::make_unique<cache::NearCache<int, int>>(kMTCapacity, cache::NearCacheOptions(), "bench_mt");
+}
+
+template <typename Cache>
+static void BM_MT(benchmark::State& state) {
+  static std::unique_ptr<Cache> shared;
+  const auto& keys = mt_trace(static_cast<int>(state.range(0)));
+  const uint64_t read_pct = static_cast<uint64_t>(state.range(1));
+  if (state.thread_index() == 0) {
+    shared = make_mt_cache<Cache>();
+    for (size_t i = 0; i < 4 * kMTCapacity; ++i) {
+      if (!shared->get(keys[i])) shared->put(keys[i], keys[i]);
+    }
+  }
+  // The start of the loop is a barrier, so `shared` is ready here.
+  size_t idx = (static_cast<size_t>(state.thread_index()) * 7919 * 1021) % keys.size();
+  uint64_t rng = 0x9E3779B97F4A7C15ull * (state.thread_index() + 1);
+  uint64_t reads = 0;
+  uint64_t hits = 0;
+  for (auto _ : state) {
+    int k = keys[idx];
+    if (++idx == keys.size()) idx = 0;
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    if (rng % 100 < read_pct) {
+      ++reads;
+      if (shared->get(k)) ++hits;
+    } else {
+      shared->put(k, k);
+    }
+  }
+  state.counters["ops"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                             benchmark::Counter::kIsRate);
+  state.counters["hit_rate"] = benchmark::Counter(
+      reads ? static_cast<double>(hits) / reads : 0.0, benchmark::Counter::kAvgThreads);
+  if (state.thread_index() == 0) {
+    // Sampled by the cache's own timing policy, outside its lock.
+    state.counters["p99_get_ns"] = static_cast<double>(
+        shared->metrics().latency_percentile(cache::LatencyOp::Get, 0.99));
+    state.counters["p99_put_ns"] = static_cast<double>(
+        shared->metrics().latency_percentile(cache::LatencyOp::Put, 0.99));
+    shared.reset();
+  }
+}
+
+static void MTArgs(benchmark::internal::Benchmark* b) {
+  for (int dist : {kUniform, kZipf, kScanMix, kHotKey}) {
+    for (int read_pct : {100, 95, 50}) b->Args({dist, read_pct});
+  }
+  b->ArgNames({"dist", "read_pct"})->ThreadRange(1, 64)->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(BM_MT, cache::LRUCache<int, int>)->Apply(MTArgs);
+BENCHMARK_TEMPLATE(BM_MT, cache::LFUCache<int, int>)->Apply(MTArgs);
+BENCHMARK_TEMPLATE(BM_MT, cache::ARCCache<int, int>)->Apply(MTArgs);
+BENCHMARK_TEMPLATE(BM_MT, cache::AdaptiveCache<int, int>)->Apply(MTArgs);
+// Per-thread L1 in front of an LRU; compare with BM_MT<LRUCache> on dist 3 (hot keys).
+BENCHMARK_TEMPLATE(BM_MT, cache::NearCache<int, int>)->Apply(MTArgs);
+
+// Sharded reads where half the traffic goes to 16 keys (dist 3 above),
+// plain and with the hot-key table in front of the shards.
+template <typename Cache>
+static std::unique_ptr<Cache> make_sharded_cache() {
+  return std::make_unique<Cache>(kMTCapacity, 16, cache::HotKeyOptions(), "bench_hot");
+}
+
+template <>
+std::unique_ptr<cache::ShardedCache<int, int>> make_sharded_cache() {
+  return std::make_unique<cache::ShardedCache<int, int>>(kMTCapacity, 16, "bench_hot");
+}
+
+template <typename Cache>
+static void BM_ShardedHotKeys(benchmark::State& state) {
+  static std::unique_ptr<Cache> shared;
+  const auto& keys = mt_trace(kHotKey);
+  if (state.thread_index() == 0) {
+    shared = make_sharded_cache<Cache>();
+    for (size_t i = 0; i < 4 * kMTCapacity; ++i) {
+      if (!shared->get(keys[i])) shared->put(keys[i], keys[i]);
+    }
+  }
+  size_t idx = (static_cast<size_t>(state.thread_index()) * 7919 * 1021) % keys.size();
+  uint64_t hits = 0;
+  for (auto _ : state) {
+    if (shared->get(keys[idx])) ++hits;
+    if (++idx == keys.size()) idx = 0;
+  }
+  state.counters["ops"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                             benchmark::Counter::kIsRate);
+  state.counters["hit_rate"] = benchmark::Counter(
+      static_cast<double>(hits) / state.iterations(), benchmark::Counter::kAvgThreads);
+  if (state.thread_index() == 0) shared.reset();
+}
+
+BENCHMARK_TEMPLATE(BM_ShardedHotKeys, cache::ShardedCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ShardedHotKeys, cache::HotKeyCache<int, int>)->ThreadRange(1, 64)->UseRealTime();
+
+// Cost of latency measurement on a cache hit: compiled out, sampled, full.
+template <typename Timing>
+static void BM_LRU_GetTiming(benchmark::State& state) {
+  cache::LRUCache<int, int, Timing> c(1024);
+  for (int i = 0; i < 1024; ++i) c.put(i, i);
+  int k = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(c.get(k));
+    k = (k + 1) & 1023;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_LRU_GetTiming, cache::NoTiming);
+BENCHMARK_TEMPLATE(BM_LRU_GetTiming, cache::SampledTiming);
+BENCHMARK_TEMPLATE(BM_LRU_GetTiming, cache::FullTiming);
+
+// Hit path with and without a SHARDS miss-ratio-curve hook at 0.1% sampling.
+static void BM_LRU_GetMissRatioCurve(benchmark::State& state) {
+  cache::LRUCache<int, int> c(1024);
+  cache::MissRatioCurve mrc(0.001);
+  cache::MissRatioCurveObserver<int> hook(mrc);
+  if (state.range(0)) c.set_observer(&hook);
+  for (int i = 0; i < 1024; ++i) c.put(i, i);
+  int k = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(c.get(k));
+    k = (k + 1) & 1023;
+  }
+  c.set_observer(nullptr);
+}
+
+BENCHMARK(BM_LRU_GetMissRatioCurve)->Arg(0)->Arg(1);
+
+// Fills an empty cache so the index grows many times and reports the
+// worst single put; with incremental rehashing the tail stays flat.
+static void BM_LRU_GrowthTail(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  std::vector<int64_t> lat(n);
+  for (auto _ : state) {
+    cache::LRUCache<int, int> c(n);
+    for (size_t i = 0; i < n; ++i) {
+      auto t0 = std::chrono::steady_clock::now();
+      c.put(static_cast<int>(i), static_cast<int>(i));
+      auto t1 = std::chrono::steady_clock::now();
+      lat[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+  }
+  std::sort(lat.begin(), lat.end());
+  state.counters["p9999_ns"] = static_cast<double>(lat[n * 9999 / 10000]);
+  state.counters["max_ns"] = static_cast<double>(lat.back());
+}
+
+// Put throughput in memory (Arg 0) and with the write-ahead log (Arg 1);
+// group commit should keep the logged path within ~20% of plain puts.
+static void BM_LRU_PutDurable(benchmark::State& state) {
+  const std::string dir = std::filesystem::temp_directory_path() / "hpc_bench_wal";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  auto keys = bench::uniform_keys(1 << 20, 1 << 20);
+  size_t idx = 0;
+  auto run = [&](cache::CacheInterface<int, int>& c) {
+    for (auto _ : state) {
+      int k = keys[idx++ & (keys.size() - 1)];
+      c.put(k, k);
+    }
+  };
+  if (state.range(0)) {
+    cache::DurableCache<int, int> c(65536, dir + "/cache", cache::WalOptions(), "bench_durable");
+    run(c);
+    c.sync();
+    state.counters["group_commits"] = static_cast<double>(c.wal().group_commits());
+  } else {
+    cache::LRUCache<int, int> c(65536, "bench_put");
+    run(c);
+  }
+  state.SetItemsProcessed(state.iterations());
+  std::filesystem::remove_all(dir);
+}
+
+BENCHMARK(BM_LRU_PutDurable)->Arg(0)->Arg(1)->ArgName("wal");
+
+// Puts of 1 KiB values into a full cache, so nearly every put evicts.
+// Arg 1 defers eviction and freeing to a MaintenanceScheduler; the tail
+// counters show what that takes off the put path.
+static void BM_LRU_PutEvicting(benchmark::State& state) {
+  cache::MaintenanceScheduler scheduler(1);
+  cache::LRUCache<int, std::string> c(65536, "bench_evicting");
+  if (state.range(0)) c.set_maintenance(&scheduler);
+  auto keys = bench::uniform_keys(1 << 20, 1 << 20);
+  const std::string value(1024, 'v');
+  for (int i = 0; i < 65536; ++i) c.put(-i - 1, value);
+  std::vector<int64_t> lat;
+  lat.reserve(1 << 20);
+  size_t idx = 0;
+  for (auto _ : state) {
+    int k = keys[idx++ & (keys.size() - 1)];
+    auto t0 = std::chrono::steady_clock::now();
+    c.put(k, value);
+    auto t1 = std::chrono::steady_clock::now();
+    if (lat.size() < lat.capacity()) {
+      lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    }
+  }
+  c.set_maintenance(nullptr);
+  std::sort(lat.begin(), lat.end());
+  if (!lat.empty()) {
+    state.counters["p50_ns"] = static_cast<double>(lat[lat.size() / 2]);
+    state.counters["p99_ns"] = static_cast<double>(lat[lat.size() * 99 / 100]);
+    state.counters["p999_ns"] = static_cast<double>(lat[lat.size() * 999 / 1000]);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LRU_PutEvicting)->Arg(0)->Arg(1)->ArgName("deferred");
+
+BENCHMARK(BM_LRU_GrowthTail)->Arg(1 << 20)->Arg(1 << 22)->Iterations(1)->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
 
@@ -0,0 +1,44 @@
+# Checks that cache_memory_benchmark's baseline comparison can fail: a
+# baseline far below the real footprint must exit 1, and one with a
+# missing case or a line that does not parse must exit 2.
+#
+#   cmake -DBENCHMARK=<cache_memory_benchmark> -DBASELINE=<memory_baseline.txt>
+#         -DWORK_DIR=<scratch dir> -P check_baseline.cmake
+
+file(STRINGS "${BASELINE}" lines)
+set(shrunk "")
+set(missing "")
+set(garbled "")
+set(first TRUE)
+foreach(line IN LISTS lines)
+  if(line MATCHES "^([^# \t][^ \t]*)[ \t]")
+    string(APPEND shrunk "${CMAKE_MATCH_1} 1\n")
+    if(first)
+      string(APPEND garbled "${CMAKE_MATCH_1} lots\n")
+      set(first FALSE)
+    else()
+      string(APPEND missing "${line}\n")
+      string(APPEND garbled "${line}\n")
+    endif()
+  else()
+    string(APPEND shrunk "${line}\n")
+    string(APPEND missing "${line}\n")
+    string(APPEND garbled "${line}\n")
+  endif()
+endforeach()
+
+function(expect_exit name contents status pattern)
+  set(path "${WORK_DIR}/memory_baseline_${name}.txt")
+  file(WRITE "${path}" "${contents}")
+  execute_process(COMMAND "${BENCHMARK}" --entries 10000 --baseline "${path}"
+                  RESULT_VARIABLE rc OUTPUT_VARIABLE out ERROR_VARIABLE err)
+  file(REMOVE "${path}")
+  if(NOT rc EQUAL status OR NOT "${out}${err}" MATCHES "${pattern}")
+    message(FATAL_ERROR "${name} baseline: expected exit ${status} and '${pattern}', "
+                        "got exit ${rc}\n${out}${err}")
+  endif()
+endfunction()
+
+expect_exit(shrunk "${shrunk}" 1 "REGRESSION lru/u64_u64")
+expect_exit(missing "${missing}" 2 "has no entry for")
+expect_exit(garbled "${garbled}" 2 "expected \"<case> <bytes>\"")
@@ -0,0 +1,231 @@
+// Memory footprint benchmark: fills each policy to capacity and reports
+// allocated bytes per resident entry, including ghost lists and shadow
+// state. Allocation is measured three ways:
+//   new_bytes  - live usable bytes through a counting global operator new/delete
+//   heap_bytes - glibc mallinfo2() in-use bytes (also sees malloc/calloc,
+//                e.g. IncrementalHashMap bucket arrays, and malloc headers)
+//   rss_bytes  - resident set growth from /proc/self/statm
+//
+//   cache_memory_benchmark [--entries N] [--baseline FILE [--threshold 0.10]]
+//                          [--write-baseline FILE]
+//
+// With --baseline the run fails (exit 1) when any case's heap bytes per
+// entry exceeds its recorded value by more than the threshold, and exits 2
+// when the baseline cannot be read, has a line that does not parse or
+// lacks a case.
+#include "../include/cache/adaptive_cache.hpp"
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/lfu_cache.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <malloc.h>
+
+namespace {
+
+std::atomic<int64_t> g_live_bytes{0};
+
+void* counted_alloc(size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    g_live_bytes.fetch_add(static_cast<int64_t>(malloc_usable_size(p)), std::memory_order_relaxed);
+    return p;
+}
+
+void counted_free(void* p) noexcept {
+    if (!p) return;
+    g_live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(p)), std::memory_order_relaxed);
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(size_t n) { return counted_alloc(n); }
+void* operator new[](size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+
+namespace {
+
+struct Usage {
+    int64_t new_bytes = 0;
+    int64_t heap_bytes = 0;
+    int64_t rss_bytes = 0;
+};
+
+Usage usage() {
+    Usage u;
+    u.new_bytes = g_live_bytes.load();
+    struct mallinfo2 mi = mallinfo2();
+    u.heap_bytes = static_cast<int64_t>(mi.uordblks + mi.hblkhd);
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    u.rss_bytes = static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+    return u;
+}
+
+template<typename T> T make_value(uint64_t i);
+template<> uint64_t make_value<uint64_t>(uint64_t i) { return i; }
+template<> int make_value<int>(uint64_t i) { return static_cast<int>(i); }
+template<> std::string make_value<std::string>(uint64_t i) {
+    std::string s = "key:" + std::to_string(i);
+    s.resize(32, 'x'); // past the small-string buffer, like a real id
+    return s;
+}
+
+struct Result {
+    std::string name;
+    size_t entries = 0;
+    double new_per_entry = 0, heap_per_entry = 0, rss_per_entry = 0, payload = 0;
+};
+
+// Fills to capacity, re-reads the first half so it counts as frequent,
+// then inserts another capacity of new keys. Every policy ends full and
+// ARC's ghost lists (and the adaptive shadow) are populated.
+template<typename Cache, typename Key, typename Value>
+Result measure(const std::string& name, size_t capacity) {
+    malloc_trim(0);
+    Usage before = usage();
+    Result r;
+    r.name = name;
+    {
+        Cache c(capacity, "mem_" + name);
+        for (uint64_t i = 0; i < capacity; ++i) c.put(make_value<Key>(i), make_value<Value>(i));
+        for (uint64_t i = 0; i < capacity / 2; ++i) (void)c.get(make_value<Key>(i));
+        for (uint64_t i = capacity; i < 2 * capacity; ++i) {
+            c.put(make_value<Key>(i), make_value<Value>(i));
+        }
+        Usage after = usage();
+        r.entries = c.size();
+        double n = static_cast<double>(r.entries);
+        r.new_per_entry = (after.new_bytes - before.new_bytes) / n;
+        r.heap_per_entry = (after.heap_bytes - before.heap_bytes) / n;
+        r.rss_per_entry = (after.rss_bytes - before.rss_bytes) / n;
+        r.payload = static_cast<double>(sizeof(Key) + sizeof(Value));
+    }
+    return r;
+}
+
+template<template<class, class, class> class Policy, typename Key, typename Value>
+Result measure_policy(const std::string& name, size_t capacity) {
+    return measure<Policy<Key, Value, cache::NoTiming>, Key, Value>(name, capacity);
+}
+
+#define FOR_EACH_POLICY(K, V, label)                                                     \
+    results.push_back(measure_policy<cache::LRUCache, K, V>("lru/" label, entries));      \
+    results.push_back(measure_policy<cache::LFUCache, K, V>("lfu/" label, entries));      \
+    results.push_back(measure_policy<cache::ARCCache, K, V>("arc/" label, entries));      \
+    results.push_back(measure_policy<cache::AdaptiveCache, K, V>("adaptive/" label, entries))
+
+// "<case> <heap bytes per entry>" per line; blank lines and lines
+// starting with '#' are skipped. On failure, says why in `error`.
+bool read_baseline(const std::string& path, std::map<std::string, double>& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); ++line_no) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        std::istringstream fields(line);
+        std::string name, rest;
+        double value;
+        if (!(fields >> name >> value) || (fields >> rest) || !(value > 0)) {
+            error = path + ":" + std::to_string(line_no) + ": expected \"<case> <bytes>\", got \"" + line + "\"";
+            return false;
+        }
+        out[name] = value;
+    }
+    return true;
+}
+
+int usage_error() {
+    std::cerr << "usage: cache_memory_benchmark [--entries N] [--baseline FILE] "
+                 "[--threshold F] [--write-baseline FILE]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t entries = 1000000;
+    std::string baseline_path;
+    std::string write_path;
+    double threshold = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return usage_error();
+        std::string value = argv[++i];
+        if (arg == "--entries") entries = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--baseline") baseline_path = value;
+        else if (arg == "--threshold") threshold = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--write-baseline") write_path = value;
+        else return usage_error();
+    }
+
+    std::vector<Result> results;
+    FOR_EACH_POLICY(uint64_t, uint64_t, "u64_u64");
+    FOR_EACH_POLICY(int, int, "i32_i32");
+    FOR_EACH_POLICY(uint64_t, std::string, "u64_str32");
+    FOR_EACH_POLICY(std::string, std::string, "str32_str32");
+
+    std::printf("%-22s %10s %12s %12s %12s %10s %12s\n", "case", "entries", "new_B/entry",
+                "heap_B/entry", "rss_B/entry", "payload_B", "overhead_B");
+    for (const auto& r : results) {
+        std::printf("%-22s %10zu %12.1f %12.1f %12.1f %10.0f %12.1f\n", r.name.c_str(), r.entries,
+                    r.new_per_entry, r.heap_per_entry, r.rss_per_entry, r.payload,
+                    r.heap_per_entry - r.payload);
+    }
+
+    if (!write_path.empty()) {
+        std::ofstream out(write_path);
+        out << "# case heap_bytes_per_entry (entries=" << entries << ")\n";
+        for (const auto& r : results) out << r.name << " " << r.heap_per_entry << "\n";
+    }
+
+    int status = 0;
+    if (!baseline_path.empty()) {
+        std::map<std::string, double> baseline;
+        std::string error;
+        if (!read_baseline(baseline_path, baseline, error)) {
+            std::fprintf(stderr, "bad baseline: %s\n", error.c_str());
+            return 2;
+        }
+        for (const auto& r : results) {
+            if (!baseline.count(r.name)) {
+                std::fprintf(stderr, "bad baseline: %s has no entry for %s\n", baseline_path.c_str(),
+                             r.name.c_str());
+                return 2;
+            }
+        }
+        for (const auto& r : results) {
+            auto it = baseline.find(r.name);
+            double limit = it->second * (1.0 + threshold);
+            if (r.heap_per_entry > limit) {
+                std::printf("REGRESSION %s: %.1f B/entry > %.1f (baseline %.1f + %.0f%%)\n",
+                            r.name.c_str(), r.heap_per_entry, limit, it->second, threshold * 100);
+                status = 1;
+            }
+        }
+        if (status == 0) std::printf("memory footprint within %.0f%% of baseline\n", threshold * 100);
+    }
+    return status;
+}
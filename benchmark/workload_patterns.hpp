@@ -1,6 +1,9 @@
 #pragma once
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <random>
+#include <vector>
 
 namespace bench {
 
@@ -10,20 +13,60 @@ inline std::vector<int> sequential_keys(size_t n) {
     return keys;
 }
 
-inline std::vector<int> zipf_keys(size_t n, int max_key, double skew = 1.2) {
+inline std::vector<int> uniform_keys(size_t n, int max_key, uint32_t seed = 42) {
+    std::vector<int> out(n);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, max_key - 1);
+    for (auto& k : out) k = dist(rng);
+    return out;
+}
+
+// Zipf over [0, max_key): key k is drawn with probability proportional to
+// 1 / (k + 1)^skew. Samples by binary search over the exact CDF, so any
+// skew (including skew <= 1) is handled correctly.
+inline std::vector<int> zipf_keys(size_t n, int max_key, double skew = 1.2, uint32_t seed = 42) {
+    std::vector<double> cdf(static_cast<size_t>(max_key));
+    double sum = 0.0;
+    for (int k = 0; k < max_key; ++k) {
+        sum += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+        cdf[static_cast<size_t>(k)] = sum;
+    }
     std::vector<int> out;
     out.reserve(n);
-    std::mt19937 rng(42);
-    std::uniform_real_distribution<> uni(0.0, 1.0);
-    // Simple inverse CDF approximation
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<> uni(0.0, sum);
     for (size_t i = 0; i < n; ++i) {
-        double u = uni(rng);
-        int k = static_cast<int>(max_key * std::pow(u, -1.0 / skew)) % max_key;
-        if (k < 0) k = -k;
-        out.push_back(k);
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), uni(rng));
+        if (it == cdf.end()) --it;
+        out.push_back(static_cast<int>(it - cdf.begin()));
     }
     return out;
 }
 
-} // namespace bench
+// Zipf traffic over [0, max_key) interrupted by one-pass scans of
+// never-repeating keys above max_key; `scan_share` of every period is scan.
+inline std::vector<int> scan_mix_keys(size_t n, int max_key, double scan_share = 0.2,
+                                      size_t period = 10000, uint32_t seed = 42) {
+    std::vector<int> out = zipf_keys(n, max_key, 0.99, seed);
+    size_t scan_len = static_cast<size_t>(static_cast<double>(period) * scan_share);
+    int next_cold = max_key;
+    for (size_t start = 0; start < n; start += period) {
+        size_t end = std::min(n, start + scan_len);
+        for (size_t i = start; i < end; ++i) out[i] = next_cold++;
+    }
+    return out;
+}
+
+// `hot_share` of accesses go to `hot_count` keys; the rest are uniform.
+inline std::vector<int> hot_key_keys(size_t n, int max_key, int hot_count = 16,
+                                     double hot_share = 0.5, uint32_t seed = 42) {
+    std::vector<int> out(n);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<> uni(0.0, 1.0);
+    std::uniform_int_distribution<int> hot(0, hot_count - 1);
+    std::uniform_int_distribution<int> cold(0, max_key - 1);
+    for (auto& k : out) k = uni(rng) < hot_share ? hot(rng) : cold(rng);
+    return out;
+}
 
+} // namespace bench
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+
+namespace cache {
+
+// Hook invoked by the caches after every get()/put(), outside the cache
+// lock. Attach with set_observer(); the observer must outlive the
+// attachment and be safe to call from multiple threads.
+template<typename Key>
+class AccessObserver {
+public:
+    virtual ~AccessObserver() = default;
+    virtual void on_get(const Key& key, bool hit) = 0;
+    virtual void on_put(const Key& key) = 0;
+};
+
+// Fans one hook slot out to several observers. Populate it before
+// attaching; the list itself is not synchronised.
+template<typename Key>
+class ObserverList : public AccessObserver<Key> {
+public:
+    void add(AccessObserver<Key>* observer) { observers_.push_back(observer); }
+
+    void on_get(const Key& key, bool hit) override {
+        for (auto* o : observers_) o->on_get(key, hit);
+    }
+
+    void on_put(const Key& key) override {
+        for (auto* o : observers_) o->on_put(key);
+    }
+
+private:
+    std::vector<AccessObserver<Key>*> observers_;
+};
+
+} // namespace cache
@@ -0,0 +1,270 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "shadow_simulator.hpp"
+#include "timing.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace cache {
+
+struct AdaptiveOptions {
+    ShadowPolicy initial_policy = ShadowPolicy::ARC;
+    double sampling_rate = 0.05;   // key sample fed to the ghost simulators
+    size_t window = 10000;         // operations per evaluation window
+    double switch_margin = 0.02;   // hit-rate lead a challenger needs
+    size_t windows_to_switch = 3;  // consecutive winning windows before switching
+    size_t migrate_per_op = 8;     // entries moved out of the old policy per operation (at least 1)
+};
+
+// Cache that picks its eviction policy at runtime. An inline
+// ShadowSimulator runs sampled key-only LRU, LFU and ARC ghosts beside
+// the live data, outside the cache lock. At the end of
+// every window the policy with the best windowed hit rate becomes a
+// candidate, and it replaces the live policy only after leading by
+// switch_margin for windows_to_switch consecutive windows (hysteresis).
+//
+// A switch does not stop the world. The old cache becomes a draining
+// source. Each operation moves its migrate_per_op hottest entries into the
+// new cache, behind everything used since the switch (put_cold()), and a
+// hit on a not-yet-migrated key promotes it immediately. Together the two
+// caches never hold more than capacity() entries; when full, the coldest
+// unmigrated entry goes first.
+template<typename Key, typename Value, typename Timing = DefaultTiming>
+class AdaptiveCache : public CacheInterface<Key, Value> {
+private:
+    using Policy = CacheInterface<Key, Value>;
+
+    // Small caches sample every key so the ghost caches are not degenerate.
+    static constexpr double kMinGhostEntries = 1000.0;
+
+public:
+    explicit AdaptiveCache(size_t capacity, const std::string& name = "adaptive_cache",
+                           const AdaptiveOptions& options = AdaptiveOptions())
+        : capacity_(capacity)
+        , name_(name)
+        , options_(options)
+        , policy_(options.initial_policy)
+        , active_(make_policy(options.initial_policy))
+        , shadow_(capacity, ghost_rate(capacity, options.sampling_rate), name, ShadowMode::Inline)
+        , metrics_(name) {}
+
+    bool put(const Key& key, const Value& value) override {
+        auto sample = timing_.begin();
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            if (draining_) {
+                draining_->remove(key);
+            }
+            insert_active(key, value);
+            after_operation();
+            metrics_.set_size(size_locked());
+        }
+        timing_.end(sample, metrics_, LatencyOp::Put);
+        shadow_.on_put(key);
+        return true;
+    }
+
+    std::optional<Value> get(const Key& key) override {
+        auto sample = timing_.begin();
+        std::optional<Value> result;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            result = active_->get(key);
+            if (!result && draining_) {
+                // Promote straight into the new policy instead of waiting
+                // for the migration cursor to reach it.
+                result = draining_->get(key);
+                if (result) {
+                    draining_->remove(key);
+                    insert_active(key, *result);
+                }
+            }
+            if (result) {
+                metrics_.record_hit();
+            } else {
+                metrics_.record_miss();
+            }
+            after_operation();
+        }
+        timing_.end(sample, metrics_, LatencyOp::Get);
+        shadow_.on_get(key, result.has_value());
+        return result;
+    }
+
+    bool remove(const Key& key) override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        bool removed = active_->remove(key);
+        if (draining_) {
+            removed = draining_->remove(key) || removed;
+        }
+        metrics_.set_size(size_locked());
+        return removed;
+    }
+
+    void clear() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        active_->clear();
+        draining_.reset();
+        metrics_.set_size(0);
+    }
+
+    std::optional<std::pair<Key, Value>> take_victim() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (draining_) {
+            if (auto victim = draining_->take_victim()) return victim;
+        }
+        return active_->take_victim();
+    }
+
+    size_t size() const override {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return size_locked();
+    }
+
+    size_t capacity() const override { return capacity_; }
+    size_t hit_count() const override { return metrics_.hits(); }
+    size_t miss_count() const override { return metrics_.misses(); }
+    size_t eviction_count() const override { return metrics_.evictions(); }
+    double hit_rate() const override { return metrics_.hit_rate(); }
+
+    const Metrics& metrics() const { return metrics_; }
+    Timing& timing() { return timing_; }
+    const ShadowSimulator<Key>& shadow() const { return shadow_; }
+
+    ShadowPolicy current_policy() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return policy_;
+    }
+
+    size_t policy_switches() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return switches_;
+    }
+
+    bool migrating() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return draining_ != nullptr;
+    }
+
+private:
+    static double ghost_rate(size_t capacity, double requested) {
+        double floor = capacity > 0 ? kMinGhostEntries / static_cast<double>(capacity) : 1.0;
+        return std::min(1.0, std::max(requested, floor));
+    }
+
+    std::unique_ptr<Policy> make_policy(ShadowPolicy policy) const {
+        switch (policy) {
+            case ShadowPolicy::LFU:
+                return std::make_unique<LFUCache<Key, Value, NoTiming>>(capacity_, name_ + "_live_lfu");
+            case ShadowPolicy::ARC:
+                return std::make_unique<ARCCache<Key, Value, NoTiming>>(capacity_, name_ + "_live_arc");
+            default:
+                return std::make_unique<LRUCache<Key, Value, NoTiming>>(capacity_, name_ + "_live_lru");
+        }
+    }
+
+    size_t size_locked() const {
+        return active_->size() + (draining_ ? draining_->size() : 0);
+    }
+
+    void insert_active(const Key& key, const Value& value) {
+        // Keep active + draining within capacity by dropping the coldest
+        // unmigrated entry; once draining is gone the active policy evicts.
+        if (draining_ && active_->size() + draining_->size() >= capacity_) {
+            if (draining_->take_victim()) {
+                metrics_.record_eviction();
+            }
+        }
+        size_t before = active_->eviction_count();
+        active_->put(key, value);
+        size_t evicted = active_->eviction_count() - before;
+        for (size_t i = 0; i < evicted; ++i) {
+            metrics_.record_eviction();
+        }
+    }
+
+    void migrate_step(size_t budget) {
+        for (size_t i = 0; draining_ && i < budget; ++i) {
+            auto entry = draining_->take_hottest();
+            if (!entry) {
+                draining_.reset();
+                break;
+            }
+            // Hottest first, each behind the last, so the migrated entries
+            // keep their order below the keys used since the switch.
+            active_->put_cold(entry->key, entry->value, entry->references);
+        }
+    }
+
+    void after_operation() {
+        migrate_step(std::max<size_t>(1, options_.migrate_per_op));
+        if (++ops_ % options_.window == 0) {
+            evaluate_window();
+        }
+    }
+
+    void evaluate_window() {
+        static const ShadowPolicy kPolicies[] = {ShadowPolicy::LRU, ShadowPolicy::LFU, ShadowPolicy::ARC};
+        double rates[3];
+        for (int i = 0; i < 3; ++i) {
+            const Metrics& m = shadow_.metrics(kPolicies[i]);
+            uint64_t hits = m.hits();
+            uint64_t misses = m.misses();
+            uint64_t dh = hits - last_hits_[i];
+            uint64_t dm = misses - last_misses_[i];
+            last_hits_[i] = hits;
+            last_misses_[i] = misses;
+            rates[i] = (dh + dm) > 0 ? static_cast<double>(dh) / (dh + dm) : -1.0;
+        }
+        int best = 0;
+        for (int i = 1; i < 3; ++i) {
+            if (rates[i] > rates[best]) best = i;
+        }
+        int current = static_cast<int>(policy_);
+        if (kPolicies[best] != policy_ && rates[current] >= 0.0 &&
+            rates[best] >= rates[current] + options_.switch_margin) {
+            streak_ = (candidate_ == kPolicies[best]) ? streak_ + 1 : 1;
+            candidate_ = kPolicies[best];
+        } else {
+            streak_ = 0;
+        }
+        // A switch waits for the previous migration to finish, so at most
+        // two policies hold data and no operation drains more than
+        // migrate_per_op entries. The streak carries over until then.
+        if (streak_ >= options_.windows_to_switch && !draining_) {
+            switch_to(candidate_);
+        }
+    }
+
+    void switch_to(ShadowPolicy policy) {
+        draining_ = std::move(active_);
+        active_ = make_policy(policy);
+        policy_ = policy;
+        streak_ = 0;
+        ++switches_;
+    }
+
+    const size_t capacity_;
+    const std::string name_;
+    const AdaptiveOptions options_;
+    ShadowPolicy policy_;
+    std::unique_ptr<Policy> active_;
+    std::unique_ptr<Policy> draining_;
+    ShadowSimulator<Key> shadow_;
+
+    size_t ops_ = 0;
+    size_t switches_ = 0;
+    size_t streak_ = 0;
+    ShadowPolicy candidate_ = ShadowPolicy::LRU;
+    uint64_t last_hits_[3] = {0, 0, 0};
+    uint64_t last_misses_[3] = {0, 0, 0};
+
+    mutable std::shared_mutex mutex_;
+    Metrics metrics_;
+    Timing timing_;
+};
+
+} // namespace cache
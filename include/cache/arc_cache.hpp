@@ -1,27 +1,34 @@
 #pragma once
 #include "cache_interface.hpp"
+#include "access_observer.hpp"
+#include "eviction_listener.hpp"
 #include "memory_allocator.hpp"
 #include "metrics.hpp"
+#include "snapshot.hpp"
+#include "timing.hpp"
+#include "value_compression.hpp"
 #include <unordered_map>
 #include <list>
 #include <shared_mutex>
-#include <chrono>
 
 namespace cache {
 
 // Adaptive Replacement Cache (ARC)
 // Balances between recency (LRU) and frequency (LFU)
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Timing = DefaultTiming>
 class ARCCache : public CacheInterface<Key, Value> {
 private:
     struct Node {
         Key key;
         Value value;
+        uint32_t raw_size = 0; // non-zero while value holds compressed bytes
+        bool cold = false;     // examined by the cold-entry compressor (T1 only)
     };
     
     using NodeList = std::list<Node>;
     
     enum class ListType { T1, T2, B1, B2 };
+    using Evicted = std::optional<std::pair<Key, Value>>;
     
     struct MapValue {
         typename NodeList::iterator it;
@@ -29,17 +36,293 @@ private:
     };
     
 public:
-    explicit ARCCache(size_t capacity) 
+    explicit ARCCache(size_t capacity, const std::string& name = "arc_cache")
         : capacity_(capacity)
         , p_(0)
         , t1_list_()
         , t2_list_()
         , b1_list_()
         , b2_list_()
-        , metrics_("arc_cache") {}
+        , t1_cold_(t1_list_)
+        , metrics_(name) {}
     
     bool put(const Key& key, const Value& value) override {
-        auto start = std::chrono::high_resolution_clock::now();
+        auto sample = timing_.begin();
+        Evicted evicted;
+        bool inserted = put_locked(key, value, evicted);
+        timing_.end(sample, metrics_, LatencyOp::Put);
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_put(key);
+        }
+        if (evicted) {
+            if (auto* listener = eviction_listener_.load(std::memory_order_acquire)) {
+                listener->on_evict(evicted->first, std::move(evicted->second));
+            }
+        }
+        return inserted;
+    }
+    
+    std::optional<Value> get(const Key& key) override {
+        auto sample = timing_.begin();
+        auto result = get_locked(key);
+        timing_.end(sample, metrics_, LatencyOp::Get);
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_get(key, result.has_value());
+        }
+        return result;
+    }
+    
+    // Reads key and refreshes its place in the policy as get() does, but
+    // records no hit, miss or latency and is not shown to the observer.
+    // For the library's own reads, such as HotKeyCache::refresh().
+    std::optional<Value> get_uncounted(const Key& key) { return get_locked(key, false); }
+    
+    bool remove(const Key& key) override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        
+        auto map_it = map_.find(key);
+        if (map_it == map_.end()) {
+            return false;
+        }
+        
+        switch (map_it->second.list_type) {
+            case ListType::T1:
+                t1_cold_.on_unlink(map_it->second.it);
+                t1_list_.erase(map_it->second.it);
+                break;
+            case ListType::T2: t2_list_.erase(map_it->second.it); break;
+            case ListType::B1: b1_list_.erase(map_it->second.it); break;
+            case ListType::B2: b2_list_.erase(map_it->second.it); break;
+        }
+        
+        map_.erase(map_it);
+        metrics_.set_size(t1_list_.size() + t2_list_.size());
+        
+        return true;
+    }
+    
+    void clear() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_.clear();
+        t1_list_.clear();
+        t2_list_.clear();
+        b1_list_.clear();
+        b2_list_.clear();
+        t1_cold_.reset();
+        p_ = 0;
+        metrics_.set_size(0);
+    }
+    
+    std::optional<std::pair<Key, Value>> take_victim() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        while (!t1_list_.empty() || !t2_list_.empty()) {
+            // Same choice as replace(): T1 while it exceeds its target p_
+            bool from_t1 = !t1_list_.empty() && (t1_list_.size() > p_ || t2_list_.empty());
+            NodeList& list = from_t1 ? t1_list_ : t2_list_;
+            auto last = std::prev(list.end());
+            map_.erase(last->key);
+            if (from_t1) {
+                t1_cold_.on_unlink(last);
+                if (last->raw_size && !inflate(*last)) {
+                    list.pop_back();
+                    continue;
+                }
+            }
+            std::pair<Key, Value> victim(std::move(last->key), std::move(last->value));
+            list.pop_back();
+            metrics_.set_size(t1_list_.size() + t2_list_.size());
+            return victim;
+        }
+        metrics_.set_size(0);
+        return std::nullopt;
+    }
+    
+    // T2 before T1, each from its MRU end. T2 entries have been referenced
+    // at least twice.
+    std::optional<MigratedEntry<Key, Value>> take_hottest() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        while (!t1_list_.empty() || !t2_list_.empty()) {
+            bool from_t2 = !t2_list_.empty();
+            NodeList& list = from_t2 ? t2_list_ : t1_list_;
+            auto first = list.begin();
+            map_.erase(first->key);
+            if (!from_t2) {
+                t1_cold_.on_unlink(first);
+                if (first->raw_size && !inflate(*first)) {
+                    list.pop_front();
+                    continue;
+                }
+            }
+            MigratedEntry<Key, Value> entry{std::move(first->key), std::move(first->value), from_t2 ? 2u : 1u};
+            list.pop_front();
+            metrics_.set_size(t1_list_.size() + t2_list_.size());
+            return entry;
+        }
+        metrics_.set_size(0);
+        return std::nullopt;
+    }
+    
+    // Goes in at the LRU end of T2 if referenced more than once, else of
+    // T1. A ghost of the key is dropped; an existing entry keeps its place.
+    bool put_cold(const Key& key, const Value& value, uint64_t references) override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto map_it = map_.find(key);
+        if (map_it != map_.end()) {
+            switch (map_it->second.list_type) {
+                case ListType::T1:
+                case ListType::T2:
+                    map_it->second.it->value = value;
+                    map_it->second.it->raw_size = 0;
+                    return true;
+                case ListType::B1: b1_list_.erase(map_it->second.it); break;
+                case ListType::B2: b2_list_.erase(map_it->second.it); break;
+            }
+            map_.erase(map_it);
+        }
+        if (t1_list_.size() + t2_list_.size() >= capacity_) return false;
+        
+        // Keep |T1| + |B1| <= c and the directory within 2c, as a miss would.
+        bool to_t2 = references > 1;
+        if (!to_t2 && t1_list_.size() + b1_list_.size() >= capacity_) {
+            map_.erase(b1_list_.back().key);
+            b1_list_.pop_back();
+        }
+        if (map_.size() >= 2 * capacity_) {
+            NodeList& ghosts = b2_list_.empty() ? b1_list_ : b2_list_;
+            map_.erase(ghosts.back().key);
+            ghosts.pop_back();
+        }
+        NodeList& list = to_t2 ? t2_list_ : t1_list_;
+        list.push_back({key, value});
+        map_[key] = {std::prev(list.end()), to_t2 ? ListType::T2 : ListType::T1};
+        metrics_.set_size(t1_list_.size() + t2_list_.size());
+        return true;
+    }
+    
+    size_t size() const override {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return t1_list_.size() + t2_list_.size();
+    }
+    
+    // Whether key is resident (in T1 or T2; ghosts do not count), without
+    // counting a lookup or moving it.
+    bool contains(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = map_.find(key);
+        return it != map_.end() &&
+               (it->second.list_type == ListType::T1 || it->second.list_type == ListType::T2);
+    }
+    
+    size_t capacity() const override { return capacity_; }
+    size_t hit_count() const override { return metrics_.hits(); }
+    size_t miss_count() const override { return metrics_.misses(); }
+    size_t eviction_count() const override { return metrics_.evictions(); }
+    double hit_rate() const override { return metrics_.hit_rate(); }
+    
+    const Metrics& metrics() const { return metrics_; }
+    Timing& timing() { return timing_; }
+    
+    // Attach an access hook (e.g. a MissRatioCurveObserver); nullptr detaches.
+    void set_observer(AccessObserver<Key>* observer) {
+        observer_.store(observer, std::memory_order_release);
+    }
+    
+    // Hand evicted entries to `listener` (e.g. a FlashStore spill tier)
+    // instead of dropping them; nullptr detaches.
+    void set_eviction_listener(EvictionListener<Key, Value>* listener) {
+        eviction_listener_.store(listener, std::memory_order_release);
+    }
+    
+    // Opt in to compressing values that age toward the LRU end of T1.
+    // Only value types with a ValueCompressor specialization are affected.
+    void set_compression(const CompressionOptions& options) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        compression_ = options;
+    }
+    
+    // Background step: compresses up to max_entries T1 values that have
+    // fallen into its cold region since the last call. Returns entries examined.
+    size_t compress_cold(size_t max_entries) {
+        if constexpr (!ValueCompressor<Value>::supported) {
+            (void)max_entries;
+            return 0;
+        } else {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            if (!compression_.enabled) return 0;
+            size_t n = t1_list_.size();
+            size_t hot = static_cast<size_t>(n * compression_.hot_fraction + 0.5);
+            return t1_cold_.advance(n > hot ? n - hot : 0, max_entries, [this](Node& node) {
+                if (node.raw_size) return;
+                size_t raw = node.value.size();
+                node.raw_size = ValueCompressor<Value>::compress(node.value, compression_.min_value_size);
+                if (node.raw_size) {
+                    metrics_.record_compression(raw, node.value.size());
+                }
+            });
+        }
+    }
+    
+    // Copies T2, T1 and the B1/B2 ghost keys (each MRU to LRU) and the
+    // adaptation target p_ under the lock, then encodes and writes them on
+    // a background thread.
+    std::future<bool> save_snapshot(const std::string& path) const {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        uint64_t p = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            records.reserve(map_.size());
+            auto copy = [&records](const NodeList& list, ListType type) {
+                for (const auto& node : list) {
+                    records.push_back({node.key, node.value, static_cast<uint64_t>(type), node.raw_size});
+                }
+            };
+            copy(t2_list_, ListType::T2);
+            copy(t1_list_, ListType::T1);
+            copy(b1_list_, ListType::B1);
+            copy(b2_list_, ListType::B2);
+            p = p_;
+        }
+        return write_snapshot_async(path, SnapshotPolicy::ARC, p, std::move(records));
+    }
+    
+    // Replaces the contents (including ghosts and p_) with a snapshot. A
+    // smaller cache keeps T2 before T1, and at most capacity() ghosts.
+    bool load_snapshot(const std::string& path) {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        uint64_t p = 0;
+        if (!read_snapshot(path, SnapshotPolicy::ARC, p, records)) return false;
+        
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_.clear();
+        t1_list_.clear();
+        t2_list_.clear();
+        b1_list_.clear();
+        b2_list_.clear();
+        t1_cold_.reset();
+        map_.reserve(std::min<size_t>(records.size(), 2 * capacity_));
+        size_t resident = 0;
+        size_t ghosts = 0;
+        for (auto& r : records) {
+            ListType type = static_cast<ListType>(r.meta);
+            bool ghost = type == ListType::B1 || type == ListType::B2;
+            if (r.meta > static_cast<uint64_t>(ListType::B2) || map_.count(r.key) ||
+                (ghost ? ghosts >= capacity_ : resident >= capacity_)) {
+                continue;
+            }
+            NodeList& list = type == ListType::T1 ? t1_list_
+                           : type == ListType::T2 ? t2_list_
+                           : type == ListType::B1 ? b1_list_ : b2_list_;
+            list.push_back({r.key, ghost ? Value{} : std::move(r.value)});
+            map_[r.key] = {std::prev(list.end()), type};
+            ++(ghost ? ghosts : resident);
+        }
+        p_ = std::min<size_t>(static_cast<size_t>(p), capacity_);
+        metrics_.set_size(t1_list_.size() + t2_list_.size());
+        return true;
+    }
+    
+private:
+    bool put_locked(const Key& key, const Value& value, Evicted& evicted) {
         std::unique_lock<std::shared_mutex> lock(mutex_);
         
         auto map_it = map_.find(key);
@@ -51,6 +334,7 @@ public:
             
             // Move to MRU of T2
             if (map_it->second.list_type == ListType::T1) {
+                t1_cold_.on_unlink(map_it->second.it);
                 t1_list_.erase(map_it->second.it);
             } else {
                 t2_list_.erase(map_it->second.it);
@@ -58,11 +342,6 @@ public:
             
             t2_list_.push_front({key, value});
             map_[key] = {t2_list_.begin(), ListType::T2};
-            
-            auto end = std::chrono::high_resolution_clock::now();
-            metrics_.record_latency_ns(
-                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-            );
             return true;
         }
         
@@ -74,16 +353,11 @@ public:
             size_t delta = b2_size >= b1_size ? 1 : b2_size / b1_size + 1;
             p_ = std::min(capacity_, p_ + delta);
             
-            replace(key, ListType::B1);
+            replace(key, ListType::B1, evicted);
             b1_list_.erase(map_it->second.it);
             
             t2_list_.push_front({key, value});
             map_[key] = {t2_list_.begin(), ListType::T2};
-            
-            auto end = std::chrono::high_resolution_clock::now();
-            metrics_.record_latency_ns(
-                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-            );
             return true;
         }
         
@@ -95,16 +369,11 @@ public:
             size_t delta = b1_size >= b2_size ? 1 : b1_size / b2_size + 1;
             p_ = (p_ >= delta) ? p_ - delta : 0;
             
-            replace(key, ListType::B2);
+            replace(key, ListType::B2, evicted);
             b2_list_.erase(map_it->second.it);
             
             t2_list_.push_front({key, value});
             map_[key] = {t2_list_.begin(), ListType::T2};
-            
-            auto end = std::chrono::high_resolution_clock::now();
-            metrics_.record_latency_ns(
-                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-            );
             return true;
         }
         
@@ -117,10 +386,12 @@ public:
                 auto& lru = b1_list_.back();
                 map_.erase(lru.key);
                 b1_list_.pop_back();
-                replace(key, ListType::B1);
+                replace(key, ListType::B1, evicted);
             } else {
+                t1_cold_.on_unlink(std::prev(t1_list_.end()));
                 auto& lru = t1_list_.back();
                 map_.erase(lru.key);
+                capture(lru, evicted);
                 t1_list_.pop_back();
                 metrics_.record_eviction();
             }
@@ -130,30 +401,24 @@ public:
                 map_.erase(lru.key);
                 b2_list_.pop_back();
             }
-            replace(key, ListType::B1);
+            replace(key, ListType::B1, evicted);
         }
         
         t1_list_.push_front({key, value});
         map_[key] = {t1_list_.begin(), ListType::T1};
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
         metrics_.set_size(t1_list_.size() + t2_list_.size());
         
         return true;
     }
     
-    std::optional<Value> get(const Key& key) override {
-        auto start = std::chrono::high_resolution_clock::now();
+    std::optional<Value> get_locked(const Key& key, bool count = true) {
         std::unique_lock<std::shared_mutex> lock(mutex_);
         
         auto map_it = map_.find(key);
         if (map_it == map_.end() || 
             map_it->second.list_type == ListType::B1 || 
             map_it->second.list_type == ListType::B2) {
-            metrics_.record_miss();
+            if (count) metrics_.record_miss();
             return std::nullopt;
         }
         
@@ -161,75 +426,57 @@ public:
         
         // Move to MRU of T2
         if (map_it->second.list_type == ListType::T1) {
+            t1_cold_.on_unlink(map_it->second.it);
             Node node = *map_it->second.it;
             t1_list_.erase(map_it->second.it);
+            if (node.raw_size) {
+                // A value that no longer decompresses is dropped and reads as a miss.
+                if (!inflate(node)) {
+                    map_.erase(map_it);
+                    metrics_.set_size(t1_list_.size() + t2_list_.size());
+                    if (count) metrics_.record_miss();
+                    return std::nullopt;
+                }
+                val = node.value;
+            }
             t2_list_.push_front(node);
             map_[key] = {t2_list_.begin(), ListType::T2};
         } else {
             t2_list_.splice(t2_list_.begin(), t2_list_, map_it->second.it);
         }
         
-        metrics_.record_hit();
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
+        if (count) metrics_.record_hit();
         
         return val;
     }
     
-    bool remove(const Key& key) override {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto map_it = map_.find(key);
-        if (map_it == map_.end()) {
+    // False, and counted, when the stored bytes do not decode.
+    bool inflate(Node& node) {
+        if (!ValueCompressor<Value>::decompress(node.value, node.raw_size)) {
+            metrics_.record_decompression_failure();
             return false;
         }
-        
-        switch (map_it->second.list_type) {
-            case ListType::T1: t1_list_.erase(map_it->second.it); break;
-            case ListType::T2: t2_list_.erase(map_it->second.it); break;
-            case ListType::B1: b1_list_.erase(map_it->second.it); break;
-            case ListType::B2: b2_list_.erase(map_it->second.it); break;
-        }
-        
-        map_.erase(map_it);
-        metrics_.set_size(t1_list_.size() + t2_list_.size());
-        
+        node.raw_size = 0;
+        metrics_.record_decompression();
         return true;
     }
     
-    void clear() override {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        map_.clear();
-        t1_list_.clear();
-        t2_list_.clear();
-        b1_list_.clear();
-        b2_list_.clear();
-        p_ = 0;
-        metrics_.set_size(0);
-    }
-    
-    size_t size() const override {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        return t1_list_.size() + t2_list_.size();
+    // Keeps the victim only when someone is listening for it.
+    void capture(Node& node, Evicted& evicted) {
+        if (!eviction_listener_.load(std::memory_order_relaxed)) return;
+        if (node.raw_size && !inflate(node)) return;
+        evicted.emplace(std::move(node.key), std::move(node.value));
     }
     
-    size_t capacity() const override { return capacity_; }
-    size_t hit_count() const override { return metrics_.hits(); }
-    size_t miss_count() const override { return metrics_.misses(); }
-    size_t eviction_count() const override { return metrics_.evictions(); }
-    double hit_rate() const override { return metrics_.hit_rate(); }
-    
-private:
-    void replace(const Key& key, ListType ghost_type) {
+    void replace(const Key& key, ListType ghost_type, Evicted& evicted) {
         if (!t1_list_.empty() && 
             ((t1_list_.size() > p_) || 
              (ghost_type == ListType::B2 && t1_list_.size() == p_))) {
             
+            t1_cold_.on_unlink(std::prev(t1_list_.end()));
             auto& lru = t1_list_.back();
             Key old_key = lru.key;
+            capture(lru, evicted);
             t1_list_.pop_back();
             
             b1_list_.push_front({old_key, Value{}});
@@ -238,6 +485,7 @@ private:
         } else if (!t2_list_.empty()) {
             auto& lru = t2_list_.back();
             Key old_key = lru.key;
+            capture(lru, evicted);
             t2_list_.pop_back();
             
             b2_list_.push_front({old_key, Value{}});
@@ -253,10 +501,15 @@ private:
     NodeList t2_list_; // Recently accessed multiple times
     NodeList b1_list_; // Ghost entries evicted from T1
     NodeList b2_list_; // Ghost entries evicted from T2
+    ColdRegion<NodeList> t1_cold_;
+    CompressionOptions compression_;
     
     std::unordered_map<Key, MapValue> map_;
     mutable std::shared_mutex mutex_;
     Metrics metrics_;
+    Timing timing_;
+    std::atomic<AccessObserver<Key>*> observer_{nullptr};
+    std::atomic<EvictionListener<Key, Value>*> eviction_listener_{nullptr};
 };
 
 } // namespace cache
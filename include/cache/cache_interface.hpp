@@ -1,10 +1,22 @@
 #pragma once
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace cache {
 
+// An entry moving between caches, with the references the source policy
+// has seen for it (1 where the policy does not count them).
+template<typename Key, typename Value>
+struct MigratedEntry {
+    Key key;
+    Value value;
+    uint64_t references = 1;
+};
+
 template<typename Key, typename Value>
 class CacheInterface {
 public:
@@ -17,6 +29,32 @@ public:
     virtual size_t size() const = 0;
     virtual size_t capacity() const = 0;
     
+    // Removes and returns the entry the policy would evict next, without
+    // counting an eviction. Lets entries migrate between caches.
+    virtual std::optional<std::pair<Key, Value>> take_victim() { return std::nullopt; }
+    
+    // The other end: removes and returns the entry the policy would evict
+    // last. Draining a cache this way and handing each entry to another's
+    // put_cold() moves it hottest first without reordering it.
+    virtual std::optional<MigratedEntry<Key, Value>> take_hottest() { return std::nullopt; }
+    
+    // Inserts a migrated entry behind every resident entry of its rank, so
+    // it is evicted before keys used since; policies that count references
+    // start it at `references`. A full cache drops it and returns false.
+    virtual bool put_cold(const Key& key, const Value& value, uint64_t references = 1) {
+        (void)references;
+        return put(key, value);
+    }
+    
+    // Looks up a batch of keys; results are in the order of `keys`.
+    // Policies override this to serve the whole batch under one lock.
+    virtual std::vector<std::optional<Value>> get_many(const std::vector<Key>& keys) {
+        std::vector<std::optional<Value>> results;
+        results.reserve(keys.size());
+        for (const auto& key : keys) results.push_back(get(key));
+        return results;
+    }
+    
     // Metrics
     virtual size_t hit_count() const = 0;
     virtual size_t miss_count() const = 0;
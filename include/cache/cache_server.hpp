@@ -0,0 +1,89 @@
+#pragma once
+#include "io_engine.hpp"
+#include "protocol_handler.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cache {
+
+enum class ServerProtocol { Memcached, Resp };
+
+struct ServerOptions {
+    ServerProtocol protocol = ServerProtocol::Memcached;
+    std::string bind_address = "127.0.0.1";
+    uint16_t port = 11211;           // 0 picks an ephemeral port
+    size_t threads = 0;              // event loops; 0 = one per hardware thread
+    bool pin_threads = false;        // pin event loop i to CPU i
+    size_t max_item_bytes = 1 << 20; // largest value a set may store
+    IoBackend io_backend = IoBackend::Auto;
+    IoEngineOptions io;
+};
+
+struct ServerStats {
+    std::atomic<uint64_t> connections{0}; // accepted so far
+    std::atomic<uint64_t> commands{0};
+    std::atomic<uint64_t> bytes_read{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> syscalls{0};    // made by the event loops' I/O engines
+};
+
+// Network front-end for an ItemCache speaking the memcached text protocol
+// or RESP (see ServerOptions::protocol). To serve both, run two servers
+// over the same cache.
+//
+// Thread per core: each event loop owns an IoEngine (io_uring where
+// available, epoll otherwise) and its own SO_REUSEPORT listening socket,
+// so the kernel spreads new connections across loops and a connection
+// never changes threads. Every connection keeps a multishot receive armed.
+// A loop runs every complete request it has received (pipelining) and
+// sends all replies with one gathered send, written straight from the
+// cache's shared value buffers. While a send is in flight, newly received
+// requests wait for it to finish.
+class CacheServer {
+public:
+    CacheServer(ItemCache& cache, const ServerOptions& options = ServerOptions());
+    ~CacheServer();
+
+    CacheServer(const CacheServer&) = delete;
+    CacheServer& operator=(const CacheServer&) = delete;
+
+    // Throws std::system_error if the sockets or I/O engines cannot be set up.
+    void start();
+    void stop();
+
+    uint16_t port() const { return port_; }
+    bool running() const { return running_.load(std::memory_order_acquire); }
+    const ServerStats& stats() const { return stats_; }
+    // "io_uring" or "epoll" once started.
+    const char* io_engine() const { return io_engine_; }
+
+private:
+    struct Connection;
+    struct Loop;
+
+    void run(Loop& loop);
+    void on_accept(Loop& loop, const IoCompletion& c);
+    void on_received(Loop& loop, Connection& conn, const IoCompletion& c);
+    void on_sent(Loop& loop, Connection& conn, int32_t result);
+    std::unique_ptr<ProtocolHandler> make_handler() const;
+    // Runs buffered requests and starts sending their replies; closes the
+    // connection if it is done.
+    void process(Loop& loop, Connection& conn);
+    void close_connection(Loop& loop, Connection& conn);
+    // Frees the connection once it is closing and nothing is in flight.
+    void reap(Loop& loop, Connection& conn);
+
+    ItemCache& cache_;
+    const ServerOptions options_;
+    uint16_t port_;
+    const char* io_engine_ = "";
+    std::atomic<bool> running_{false};
+    std::vector<std::unique_ptr<Loop>> loops_;
+    ServerStats stats_;
+};
+
+} // namespace cache
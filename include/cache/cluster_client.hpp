@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// Rendezvous (highest-random-weight) hashing over named nodes: a key goes
+// to the node whose mix of (node, key) hashes scores highest. Adding a
+// node moves only the keys it now wins, about 1/N of them, and removing one
+// moves only its own keys. Jump hashing is cheaper per lookup but can only
+// remove the last bucket, which does not fit arbitrary node failures.
+// Names and keys are hashed with FNV-1a rather than std::hash, so clients
+// built with different standard libraries place keys on the same nodes.
+class RendezvousHash {
+public:
+    void add(const std::string& node);
+    void remove(const std::string& node);
+
+    // Index into nodes(); -1 when there are none.
+    int pick(const std::string& key) const;
+
+    const std::vector<std::string>& nodes() const { return nodes_; }
+
+private:
+    std::vector<std::string> nodes_;
+    std::vector<uint64_t> seeds_; // hash of each node name
+};
+
+struct ClusterOptions {
+    size_t idle_connections_per_node = 4; // kept open between requests
+    std::chrono::milliseconds timeout{1000};      // connect, send and receive
+    size_t keys_per_get = 100;                    // per pipelined get command
+};
+
+// Client for a set of memcached-protocol nodes (cache_server, or memcached
+// itself) addressed as "host:port", with keys placed by RendezvousHash.
+//
+// get_many() groups keys by node and fans out: it writes every node's
+// requests before reading any reply, so nodes work in parallel and the
+// call takes about as long as the slowest one. Within a node, requests
+// are pipelined: one write carries every get (set_many: every set), and
+// the replies are read back in order. Each node has a pool of idle
+// connections. A request borrows one and opens a new one if none is
+// idle, so callers never wait for each other.
+//
+// A node that cannot be reached reads as misses and failed writes, and
+// errors() counts these failures. So does a key memcached cannot carry
+// (empty, over 250 bytes, or containing spaces or control characters);
+// it is never sent. Thread-safe.
+class ClusterClient {
+public:
+    explicit ClusterClient(const std::vector<std::string>& endpoints,
+                           const ClusterOptions& options = ClusterOptions());
+    ~ClusterClient();
+
+    ClusterClient(const ClusterClient&) = delete;
+    ClusterClient& operator=(const ClusterClient&) = delete;
+
+    void add_node(const std::string& endpoint);
+    void remove_node(const std::string& endpoint);
+    std::vector<std::string> nodes() const;
+    std::string node_for(const std::string& key) const;
+
+    std::optional<std::string> get(const std::string& key);
+    std::vector<std::optional<std::string>> get_many(const std::vector<std::string>& keys);
+    // ttl_seconds == 0 never expires. TTLs over 30 days are sent as an
+    // absolute time, which is how memcached reads such values.
+    bool set(const std::string& key, const std::string& value, uint32_t ttl_seconds = 0);
+    // Returns how many were stored.
+    size_t set_many(const std::vector<std::pair<std::string, std::string>>& items,
+                    uint32_t ttl_seconds = 0);
+    bool remove(const std::string& key);
+
+    uint64_t errors() const { return errors_.load(std::memory_order_relaxed); }
+
+private:
+    class Connection;
+    struct Node;
+
+    // Groups item indexes by owning node; skips everything if there is
+    // none. Invalid keys are left out and counted as errors.
+    template <typename KeyOf>
+    std::vector<std::pair<std::shared_ptr<Node>, std::vector<size_t>>>
+    group_by_node(size_t count, KeyOf key_of);
+    std::unique_ptr<Connection> acquire(Node& node);
+    void release(Node& node, std::unique_ptr<Connection> conn);
+    void fail() { errors_.fetch_add(1, std::memory_order_relaxed); }
+
+    const ClusterOptions options_;
+    mutable std::shared_mutex mutex_; // ring_ and nodes_
+    RendezvousHash ring_;
+    std::vector<std::shared_ptr<Node>> nodes_; // parallel to ring_.nodes()
+    std::atomic<uint64_t> errors_{0};
+};
+
+} // namespace cache
@@ -0,0 +1,163 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "lru_cache.hpp"
+#include "mutation_codec.hpp"
+#include "write_ahead_log.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cache {
+
+// Crash-consistent wrapper: every put(), remove() and clear() is appended
+// to a WriteAheadLog before it is applied, and checkpoint() folds the log
+// into a snapshot of the underlying cache (LRUCache, LFUCache or ARCCache).
+//
+// On disk, for a base path P:
+//   P.snap.<g>  snapshot holding the effect of every segment below g
+//   P.wal.<g>   log segments
+// The constructor loads the newest snapshot, replays the segments from its
+// generation on, and starts a fresh segment. Evictions are not logged;
+// replay simply lets the policy evict again.
+//
+// Durability is bounded by WalOptions::fsync_interval; call sync() to wait
+// for everything written so far. Once the log fails to write, mutations,
+// sync() and checkpoint() throw std::system_error and the cache is left
+// as the log last recorded it.
+template<typename Key, typename Value, typename Cache = LRUCache<Key, Value>>
+class DurableCache : public CacheInterface<Key, Value> {
+    using Codec = MutationCodec<Key, Value>;
+
+public:
+    DurableCache(size_t capacity, const std::string& base_path,
+                 const WalOptions& options = WalOptions(),
+                 const std::string& name = "durable_cache")
+        : base_path_(base_path)
+        , cache_(capacity, name) {
+        uint64_t next = recover();
+        wal_ = std::make_unique<WriteAheadLog>(base_path_, next, options);
+    }
+
+    bool put(const Key& key, const Value& value) override {
+        const std::string& record = Codec::put(key, value);
+        // Log order must match apply order, so both happen under one lock.
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        wal_->append(record.data(), record.size());
+        return cache_.put(key, value);
+    }
+
+    std::optional<Value> get(const Key& key) override { return cache_.get(key); }
+
+    bool remove(const Key& key) override {
+        const std::string& record = Codec::remove(key);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        wal_->append(record.data(), record.size());
+        return cache_.remove(key);
+    }
+
+    void clear() override {
+        const std::string& record = Codec::clear();
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        wal_->append(record.data(), record.size());
+        cache_.clear();
+    }
+
+    // Waits until every mutation made so far is on stable storage.
+    void sync() { wal_->sync(); }
+
+    // Starts a new log segment, snapshots the cache, and deletes the
+    // snapshot and segments it supersedes. Writers are only blocked for the
+    // rotation; the snapshot is written in the background and waited on.
+    // Returns false if the snapshot could not be saved; throws
+    // std::system_error if the log segment could not be sealed.
+    bool checkpoint() {
+        std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            generation = wal_->rotate();
+        }
+        // Mutations racing with the snapshot are both in it and in the new
+        // segment; replaying them again is harmless (last write wins).
+        if (!cache_.save_snapshot(snapshot_path(generation)).get()) return false;
+        for (const auto& file : list_files()) {
+            if (file.generation < generation) std::filesystem::remove(file.path);
+        }
+        return true;
+    }
+
+    size_t size() const override { return cache_.size(); }
+    size_t capacity() const override { return cache_.capacity(); }
+    size_t hit_count() const override { return cache_.hit_count(); }
+    size_t miss_count() const override { return cache_.miss_count(); }
+    size_t eviction_count() const override { return cache_.eviction_count(); }
+    double hit_rate() const override { return cache_.hit_rate(); }
+
+    Cache& cache() { return cache_; }
+    const WriteAheadLog& wal() const { return *wal_; }
+    size_t replayed_records() const { return replayed_; }
+
+private:
+    struct File {
+        std::string path;
+        uint64_t generation;
+        bool snapshot;
+    };
+
+    std::string snapshot_path(uint64_t generation) const {
+        return base_path_ + ".snap." + std::to_string(generation);
+    }
+
+    std::vector<File> list_files() const {
+        std::vector<File> files;
+        std::filesystem::path base(base_path_);
+        std::filesystem::path dir = base.has_parent_path() ? base.parent_path() : ".";
+        std::string prefix = base.filename().string();
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            std::string name = entry.path().filename().string();
+            for (const char* kind : {".snap.", ".wal."}) {
+                std::string stem = prefix + kind;
+                if (name.size() <= stem.size() || name.compare(0, stem.size(), stem) != 0) continue;
+                std::string suffix = name.substr(stem.size());
+                if (suffix.find_first_not_of("0123456789") != std::string::npos) continue;
+                files.push_back({entry.path().string(), std::stoull(suffix), kind[1] == 's'});
+            }
+        }
+        std::sort(files.begin(), files.end(),
+                  [](const File& a, const File& b) { return a.generation < b.generation; });
+        return files;
+    }
+
+    // Returns the generation for the next log segment.
+    uint64_t recover() {
+        auto files = list_files();
+        uint64_t base_generation = 0;
+        for (const auto& f : files) {
+            if (f.snapshot && f.generation >= base_generation && cache_.load_snapshot(f.path)) {
+                base_generation = f.generation;
+            }
+        }
+        uint64_t next = base_generation;
+        for (const auto& f : files) {
+            next = std::max(next, f.generation + 1);
+            if (f.snapshot || f.generation < base_generation) continue;
+            replayed_ += WriteAheadLog::replay(f.path, [this](const char* p, size_t len) {
+                Codec::apply(cache_, p, p + len);
+            });
+        }
+        return next;
+    }
+
+    const std::string base_path_;
+    Cache cache_;
+    std::unique_ptr<WriteAheadLog> wal_;
+    std::mutex write_mutex_;
+    std::mutex checkpoint_mutex_;
+    size_t replayed_ = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace cache {
+
+// Receives entries as a cache evicts them, e.g. to spill them into a
+// slower tier instead of dropping them. Called after the cache lock has
+// been released, on the thread whose put() caused the eviction. Entries
+// removed explicitly (remove(), clear(), take_victim()) are not reported.
+template<typename Key, typename Value>
+class EvictionListener {
+public:
+    virtual ~EvictionListener() = default;
+    virtual void on_evict(const Key& key, Value&& value) = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,566 @@
+#pragma once
+#include "eviction_listener.hpp"
+#include "io_engine.hpp"
+#include "metrics.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sys/uio.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace cache {
+
+struct FlashOptions {
+    size_t file_bytes = size_t(1) << 30;  // size of the on-disk log
+    size_t block_bytes = size_t(1) << 20; // unit of sequential writes (4 KiB multiple)
+    IoBackend read_backend = IoBackend::Auto; // get_async(): io_uring if available, else the pread pool
+    size_t read_threads = 4;              // pread workers behind get_async() without io_uring
+    size_t max_queued_reads = 1024;       // beyond this get_async() reads inline
+    size_t max_pending_blocks = 4;        // sealed blocks awaiting write before puts are dropped
+    bool direct_io = true;                // O_DIRECT when the filesystem supports it
+};
+
+// Log-structured second-tier store on a local file, usually fed by a DRAM
+// cache's eviction listener.
+//
+// Records (u32 length | key | value, encoded with SnapshotCodec) are
+// appended to an aligned in-memory block. Full blocks are written by a
+// background thread with one large pwrite each, so the device only sees
+// sequential block-sized writes. The file is a ring of blocks: opening
+// block n drops the index entries still pointing into block n - ring size
+// (FIFO eviction). The index keeps only key -> (log position, length).
+//
+// get() reads on the calling thread. get_async() hands reads to one
+// thread driving an io_uring IoEngine, which keeps up to kReadDepth of
+// them in the kernel at once; small reads land in buffers registered with
+// the ring. Without io_uring (or with read_backend = Epoll, where each
+// read would still be a blocking pread) get_async() uses a pread thread
+// pool instead. Records still in memory are served from their block buffer.
+template<typename Key, typename Value>
+class FlashStore : public EvictionListener<Key, Value> {
+private:
+    static_assert(SnapshotCodec<Key>::supported && SnapshotCodec<Value>::supported,
+                  "FlashStore supports trivially copyable and std::string keys/values");
+
+    static constexpr size_t kAlign = 4096;
+    static constexpr unsigned kReadDepth = 128;        // io_uring reads in flight
+    static constexpr unsigned kReadSlots = 64;         // registered read buffers
+    static constexpr size_t kReadSlotBytes = 16 * 1024;
+
+    struct Location {
+        uint64_t pos; // absolute log position: block number * block_bytes + offset
+        uint32_t len;
+    };
+
+    struct Block {
+        uint64_t number = 0;
+        size_t used = 0;
+        char* data = nullptr;
+    };
+
+    // The aligned file range that covers a record.
+    struct Span {
+        uint64_t start;
+        size_t len;
+        size_t offset; // of the record within the range
+    };
+
+    // A get_async() read on the I/O engine.
+    struct AsyncRead {
+        Key key;
+        Location loc;
+        Span span;
+        size_t done = 0;
+        char* buf = nullptr;
+        int slot = -1; // registered slot holding buf, or -1 if buf is owned
+        std::promise<std::optional<Value>> promise;
+    };
+
+public:
+    // Creates (or truncates) the log file at path. Throws std::runtime_error
+    // if it cannot be opened or sized, and std::system_error if
+    // read_backend is IoUring and io_uring is unavailable.
+    explicit FlashStore(const std::string& path, const FlashOptions& options = FlashOptions(),
+                        const std::string& name = "flash_store")
+        : options_(normalize(options))
+        , ring_blocks_(options_.file_bytes / options_.block_bytes)
+        , block_keys_(ring_blocks_)
+        , metrics_(name) {
+        open_read_engine();
+        open_file(path);
+        active_.number = 0;
+        active_.data = acquire_buffer();
+        writer_ = std::thread([this] { write_loop(); });
+        if (engine_) {
+            reader_ = std::thread([this] { read_loop(); });
+        } else {
+            pool_ = std::make_unique<ThreadPool>(options_.read_threads, options_.max_queued_reads);
+        }
+    }
+
+    ~FlashStore() {
+        if (reader_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(read_mutex_);
+                read_stopping_ = true;
+            }
+            engine_->wake();
+            reader_.join();
+        }
+        engine_.reset();
+        pool_.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        writer_cv_.notify_all();
+        writer_.join();
+        ::close(fd_);
+        std::free(active_.data);
+        for (char* buf : free_buffers_) std::free(buf);
+    }
+
+    FlashStore(const FlashStore&) = delete;
+    FlashStore& operator=(const FlashStore&) = delete;
+
+    // Appends key -> value to the log. Returns false (and forgets any older
+    // copy of key) if the record exceeds a block or the writer is backed up.
+    bool put(const Key& key, const Value& value) {
+        std::string record(sizeof(uint32_t), '\0');
+        SnapshotCodec<Key>::write(record, key);
+        SnapshotCodec<Value>::write(record, value);
+        uint32_t len = static_cast<uint32_t>(record.size());
+        std::memcpy(&record[0], &len, sizeof(len));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (record.size() > options_.block_bytes ||
+            (active_.used + record.size() > options_.block_bytes &&
+             pending_.size() >= options_.max_pending_blocks)) {
+            index_.erase(key);
+            ++dropped_writes_;
+            metrics_.set_size(index_.size());
+            return false;
+        }
+        if (active_.used + record.size() > options_.block_bytes) {
+            seal_locked();
+        }
+        std::memcpy(active_.data + active_.used, record.data(), record.size());
+        index_[key] = {active_.number * options_.block_bytes + active_.used, len};
+        block_keys_[active_.number % ring_blocks_].push_back(key);
+        active_.used += record.size();
+        bytes_appended_ += record.size();
+        metrics_.set_size(index_.size());
+        return true;
+    }
+
+    std::optional<Value> get(const Key& key) {
+        Location loc;
+        std::optional<Value> value;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (find_locked(key, loc, value)) return value;
+        }
+        value = read_from_file(key, loc);
+        record_lookup(value.has_value());
+        return value;
+    }
+
+    // Looks key up on the I/O engine or the read pool. Falls back to
+    // reading inline when max_queued_reads are already waiting.
+    std::future<std::optional<Value>> get_async(const Key& key) {
+        if (engine_) return read_async(key);
+        auto promise = std::make_shared<std::promise<std::optional<Value>>>();
+        auto future = promise->get_future();
+        if (!pool_->submit([this, key, promise] { promise->set_value(get(key)); })) {
+            promise->set_value(get(key));
+        }
+        return future;
+    }
+
+    bool remove(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool removed = index_.erase(key) > 0;
+        metrics_.set_size(index_.size());
+        return removed;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.clear();
+        for (auto& keys : block_keys_) keys.clear();
+        metrics_.set_size(0);
+    }
+
+    // Seals the partially filled block and waits until every sealed block
+    // has reached the file.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (active_.used > 0) seal_locked();
+        flushed_cv_.wait(lock, [this] { return pending_.empty(); });
+    }
+
+    void on_evict(const Key& key, Value&& value) override { put(key, value); }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    const Metrics& metrics() const { return metrics_; }
+    uint64_t bytes_appended() const { return bytes_appended_.load(std::memory_order_relaxed); }
+    uint64_t blocks_written() const { return blocks_written_.load(std::memory_order_relaxed); }
+    uint64_t dropped_writes() const { return dropped_writes_.load(std::memory_order_relaxed); }
+    uint64_t write_errors() const { return write_errors_.load(std::memory_order_relaxed); }
+    bool direct_io() const { return direct_io_; }
+    // "io_uring" or "thread_pool": what serves get_async() reads.
+    const char* read_backend() const { return engine_ ? engine_->name() : "thread_pool"; }
+
+private:
+    static FlashOptions normalize(FlashOptions o) {
+        o.block_bytes = std::max(kAlign, (o.block_bytes + kAlign - 1) / kAlign * kAlign);
+        o.file_bytes = std::max(2 * o.block_bytes, o.file_bytes / o.block_bytes * o.block_bytes);
+        o.max_pending_blocks = std::max<size_t>(1, o.max_pending_blocks);
+        return o;
+    }
+
+    // Only io_uring is worth a reader thread: an epoll engine would run
+    // every pread on that one thread, which the pool does better.
+    void open_read_engine() {
+        if (options_.read_backend == IoBackend::Epoll) return;
+        IoEngineOptions io;
+        io.queue_depth = kReadDepth;
+        io.buffer_count = 1; // receive buffers go unused here
+        io.buffer_size = 64;
+        auto engine = make_io_engine(options_.read_backend, io);
+        if (std::strcmp(engine->name(), "io_uring") != 0) return;
+        void* p = nullptr;
+        if (::posix_memalign(&p, kAlign, kReadSlots * kReadSlotBytes) != 0) throw std::bad_alloc();
+        slot_memory_.reset(static_cast<char*>(p));
+        std::vector<iovec> slots(kReadSlots);
+        for (unsigned i = 0; i < kReadSlots; ++i) {
+            slots[i] = {slot_memory_.get() + i * kReadSlotBytes, kReadSlotBytes};
+            free_slots_.push_back(static_cast<int>(i));
+        }
+        slots_registered_ = engine->register_buffers(slots.data(), kReadSlots);
+        engine_ = std::move(engine);
+    }
+
+    void open_file(const std::string& path) {
+        int flags = O_RDWR | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (options_.direct_io) {
+            fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct_io_ = fd_ >= 0;
+        }
+#endif
+        if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0) throw std::runtime_error("FlashStore: cannot open " + path);
+        if (::ftruncate(fd_, static_cast<off_t>(options_.file_bytes)) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("FlashStore: cannot size " + path);
+        }
+    }
+
+    char* acquire_buffer() {
+        if (!free_buffers_.empty()) {
+            char* buf = free_buffers_.back();
+            free_buffers_.pop_back();
+            return buf;
+        }
+        void* p = nullptr;
+        if (::posix_memalign(&p, kAlign, options_.block_bytes) != 0) throw std::bad_alloc();
+        return static_cast<char*>(p);
+    }
+
+    // Queues the active block for writing and opens the next one, dropping
+    // index entries for the block it will overwrite in the ring.
+    void seal_locked() {
+        std::memset(active_.data + active_.used, 0, options_.block_bytes - active_.used);
+        pending_.push_back(active_);
+        writer_cv_.notify_one();
+
+        uint64_t number = active_.number + 1;
+        active_ = Block{number, 0, acquire_buffer()};
+        auto& keys = block_keys_[number % ring_blocks_];
+        if (number >= ring_blocks_) {
+            uint64_t overwritten = number - ring_blocks_;
+            for (const Key& k : keys) {
+                auto it = index_.find(k);
+                if (it != index_.end() && it->second.pos / options_.block_bytes == overwritten) {
+                    index_.erase(it);
+                    metrics_.record_eviction();
+                }
+            }
+        }
+        keys.clear();
+    }
+
+    // Answers key from the index and the in-memory blocks if it can. Returns
+    // false, with loc set, when the record has to be read from the file.
+    bool find_locked(const Key& key, Location& loc, std::optional<Value>& value) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            metrics_.record_miss();
+            return true;
+        }
+        loc = it->second;
+        if (const char* block = buffered_locked(loc.pos / options_.block_bytes)) {
+            value = decode(block + loc.pos % options_.block_bytes, loc.len, key);
+            record_lookup(value.has_value());
+            return true;
+        }
+        return false;
+    }
+
+    const char* buffered_locked(uint64_t number) const {
+        if (number == active_.number) return active_.data;
+        for (const auto& block : pending_) {
+            if (block.number == number) return block.data;
+        }
+        return nullptr;
+    }
+
+    void write_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            writer_cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) return;
+            Block block = pending_.front(); // stays readable from memory until written
+            lock.unlock();
+            off_t offset = static_cast<off_t>((block.number % ring_blocks_) * options_.block_bytes);
+            bool ok = write_all(block.data, options_.block_bytes, offset);
+            lock.lock();
+            if (ok) {
+                blocks_written_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                write_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+            free_buffers_.push_back(block.data);
+            pending_.pop_front();
+            flushed_cv_.notify_all();
+        }
+    }
+
+    bool write_all(const char* data, size_t len, off_t offset) {
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd_, data, len, offset);
+            if (n <= 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+    Span span_of(const Location& loc) const {
+        uint64_t file_off = (loc.pos / options_.block_bytes % ring_blocks_) * options_.block_bytes +
+                            loc.pos % options_.block_bytes;
+        uint64_t start = file_off & ~static_cast<uint64_t>(kAlign - 1);
+        uint64_t end = (file_off + loc.len + kAlign - 1) & ~static_cast<uint64_t>(kAlign - 1);
+        return {start, static_cast<size_t>(end - start), static_cast<size_t>(file_off - start)};
+    }
+
+    std::optional<Value> read_from_file(const Key& key, const Location& loc) {
+        Span span = span_of(loc);
+        void* buf = nullptr;
+        if (::posix_memalign(&buf, kAlign, span.len) != 0) return std::nullopt;
+        std::unique_ptr<char, decltype(&std::free)> holder(static_cast<char*>(buf), &std::free);
+        size_t done = 0;
+        while (done < span.len) {
+            ssize_t n = ::pread(fd_, holder.get() + done, span.len - done, static_cast<off_t>(span.start + done));
+            if (n <= 0) return std::nullopt;
+            done += static_cast<size_t>(n);
+        }
+        return validate_read(key, loc, holder.get() + span.offset);
+    }
+
+    std::optional<Value> validate_read(const Key& key, const Location& loc, const char* record) {
+        auto value = decode(record, loc.len, key);
+        // The ring may have reused this block while we were reading. Its
+        // index entries are dropped before it is rewritten, so an entry
+        // that is still present means the bytes we read were intact.
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end() || it->second.pos != loc.pos) return std::nullopt;
+        return value;
+    }
+
+    std::future<std::optional<Value>> read_async(const Key& key) {
+        auto read = std::make_unique<AsyncRead>();
+        auto future = read->promise.get_future();
+        if (reads_outstanding_.load(std::memory_order_relaxed) >= options_.max_queued_reads) {
+            read->promise.set_value(get(key));
+            return future;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::optional<Value> value;
+            if (find_locked(key, read->loc, value)) {
+                read->promise.set_value(std::move(value));
+                return future;
+            }
+        }
+        read->key = key;
+        reads_outstanding_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(read_mutex_);
+            read_queue_.push_back(std::move(read));
+        }
+        engine_->wake();
+        return future;
+    }
+
+    // Runs on reader_, the only thread that drives engine_. Each wait()
+    // submits the reads queued since the last one and reaps completions.
+    void read_loop() {
+        std::unordered_map<uint64_t, std::unique_ptr<AsyncRead>> in_flight;
+        std::deque<std::unique_ptr<AsyncRead>> waiting;
+        std::vector<IoCompletion> completions;
+        uint64_t next_tag = 0;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(read_mutex_);
+                for (auto& read : read_queue_) waiting.push_back(std::move(read));
+                read_queue_.clear();
+                if (read_stopping_ && waiting.empty() && in_flight.empty()) return;
+            }
+            while (!waiting.empty() && in_flight.size() < kReadDepth) {
+                std::unique_ptr<AsyncRead> read = std::move(waiting.front());
+                waiting.pop_front();
+                if (!start_read(*read)) {
+                    complete_read(*read, false);
+                    continue;
+                }
+                submit_read(*read, next_tag);
+                in_flight.emplace(next_tag++, std::move(read));
+            }
+            completions.clear();
+            engine_->wait(completions, -1);
+            for (const auto& c : completions) {
+                auto it = in_flight.find(c.tag);
+                if (it == in_flight.end()) continue;
+                AsyncRead& read = *it->second;
+                if (c.result > 0) {
+                    read.done += static_cast<size_t>(c.result);
+                    if (read.done < read.span.len) {
+                        submit_read(read, c.tag); // short read: ask for the rest
+                        continue;
+                    }
+                }
+                complete_read(read, c.result > 0);
+                in_flight.erase(it);
+            }
+        }
+    }
+
+    // Picks a registered slot for small reads, else allocates.
+    bool start_read(AsyncRead& read) {
+        read.span = span_of(read.loc);
+        if (read.span.len <= kReadSlotBytes && !free_slots_.empty()) {
+            read.slot = free_slots_.back();
+            free_slots_.pop_back();
+            read.buf = slot_memory_.get() + static_cast<size_t>(read.slot) * kReadSlotBytes;
+            return true;
+        }
+        void* buf = nullptr;
+        if (::posix_memalign(&buf, kAlign, read.span.len) != 0) return false;
+        read.buf = static_cast<char*>(buf);
+        return true;
+    }
+
+    void submit_read(AsyncRead& read, uint64_t tag) {
+        engine_->read(fd_, read.buf + read.done, read.span.len - read.done, read.span.start + read.done,
+                      tag, read.slot >= 0 && slots_registered_ ? read.slot : -1);
+    }
+
+    void complete_read(AsyncRead& read, bool ok) {
+        std::optional<Value> value;
+        if (ok) value = validate_read(read.key, read.loc, read.buf + read.span.offset);
+        if (read.slot >= 0) {
+            free_slots_.push_back(read.slot);
+        } else {
+            std::free(read.buf);
+        }
+        record_lookup(value.has_value());
+        reads_outstanding_.fetch_sub(1, std::memory_order_relaxed);
+        read.promise.set_value(std::move(value));
+    }
+
+    static std::optional<Value> decode(const char* p, uint32_t len, const Key& expected) {
+        const char* end = p + len;
+        uint32_t stored;
+        std::memcpy(&stored, p, sizeof(stored));
+        if (stored != len) return std::nullopt;
+        p += sizeof(stored);
+        Key key;
+        Value value;
+        if (!SnapshotCodec<Key>::read(p, end, key) || !(key == expected) ||
+            !SnapshotCodec<Value>::read(p, end, value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    void record_lookup(bool hit) {
+        if (hit) {
+            metrics_.record_hit();
+        } else {
+            metrics_.record_miss();
+        }
+    }
+
+    const FlashOptions options_;
+    const uint64_t ring_blocks_;
+    int fd_ = -1;
+    bool direct_io_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable writer_cv_;
+    std::condition_variable flushed_cv_;
+    std::unordered_map<Key, Location> index_;
+    std::vector<std::vector<Key>> block_keys_; // keys appended to each ring slot
+    Block active_;
+    std::deque<Block> pending_;
+    std::vector<char*> free_buffers_;
+    bool stopping_ = false;
+
+    std::atomic<uint64_t> bytes_appended_{0};
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> dropped_writes_{0};
+    std::atomic<uint64_t> write_errors_{0};
+    Metrics metrics_;
+
+    std::thread writer_;
+
+    // get_async() with io_uring: read_queue_ is handed to reader_, which
+    // alone uses engine_ and the read slots.
+    std::unique_ptr<char, decltype(&std::free)> slot_memory_{nullptr, &std::free};
+    std::vector<int> free_slots_;
+    bool slots_registered_ = false;
+    std::unique_ptr<IoEngine> engine_; // after slot_memory_: unregisters it on close
+    std::mutex read_mutex_;
+    std::deque<std::unique_ptr<AsyncRead>> read_queue_;
+    bool read_stopping_ = false;
+    std::atomic<size_t> reads_outstanding_{0};
+    std::thread reader_;
+
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+} // namespace cache
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace cache {
+
+// splitmix64 finaliser: turns std::hash output (often the identity for
+// integers) into well-spread 64 bits suitable for sampling decisions.
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+template<typename Key, typename Hash = std::hash<Key>>
+inline uint64_t hash_key(const Key& key) {
+    return mix64(static_cast<uint64_t>(Hash{}(key)));
+}
+
+// 64-bit FNV-1a. Unlike std::hash, its output is fixed by definition, so
+// anything that must agree across builds and processes (key placement
+// between clients) hashes with it.
+inline uint64_t fnv1a(std::string_view bytes) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+} // namespace cache
@@ -0,0 +1,147 @@
+#pragma once
+#include "access_observer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cache {
+
+template<typename Key>
+struct HeavyHitter {
+    Key key;
+    uint64_t count; // estimate; never below the true count
+    uint64_t error; // count - error is a lower bound
+};
+
+// Space-Saving top-K over the reads seen by a cache. Tracks `capacity`
+// keys in a min-heap; an untracked key replaces the current minimum and
+// inherits its count as error, so any key whose frequency is above
+// total / capacity is guaranteed to be tracked.
+//
+// offer() samples 1 in sample_rate calls per thread and drops the sample
+// if another thread holds the lock, so the detector never becomes the
+// contention point it is looking for. decay() halves every count so keys
+// that cool off sink and are eventually displaced.
+template<typename Key, typename Hash = std::hash<Key>>
+class HeavyHitters : public AccessObserver<Key> {
+public:
+    explicit HeavyHitters(size_t capacity, uint32_t sample_rate = 1)
+        : capacity_(std::max<size_t>(capacity, 1))
+        , sample_rate_(std::max<uint32_t>(sample_rate, 1)) {
+        heap_.reserve(capacity_);
+        index_.reserve(capacity_ * 2);
+    }
+
+    void on_get(const Key& key, bool) override { offer(key); }
+    void on_put(const Key&) override {}
+
+    void offer(const Key& key) {
+        thread_local uint32_t tick = 0;
+        if (++tick % sample_rate_ != 0) return;
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (lock.owns_lock()) add_locked(key, 1);
+    }
+
+    // Unsampled and never dropped.
+    void add(const Key& key, uint64_t count = 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        add_locked(key, count);
+    }
+
+    // The k most frequent keys, highest count first.
+    std::vector<HeavyHitter<Key>> top(size_t k) const {
+        std::vector<HeavyHitter<Key>> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result = heap_;
+        }
+        std::sort(result.begin(), result.end(),
+                  [](const HeavyHitter<Key>& a, const HeavyHitter<Key>& b) { return a.count > b.count; });
+        if (result.size() > k) result.resize(k);
+        return result;
+    }
+
+    // Counted samples, decayed along with the counts.
+    uint64_t total() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_;
+    }
+
+    void decay() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        total_ /= 2;
+        size_t kept = 0;
+        for (size_t i = 0; i < heap_.size(); ++i) {
+            heap_[i].count /= 2;
+            heap_[i].error /= 2;
+            if (heap_[i].count == 0) continue;
+            if (kept != i) heap_[kept] = std::move(heap_[i]);
+            ++kept;
+        }
+        heap_.resize(kept);
+        index_.clear();
+        for (size_t i = 0; i < heap_.size(); ++i) index_[heap_[i].key] = i;
+        for (size_t i = heap_.size() / 2; i-- > 0;) sift_down(i);
+    }
+
+    uint32_t sample_rate() const { return sample_rate_; }
+
+private:
+    void add_locked(const Key& key, uint64_t count) {
+        total_ += count;
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            heap_[it->second].count += count;
+            sift_down(it->second);
+        } else if (heap_.size() < capacity_) {
+            heap_.push_back({key, count, 0});
+            index_[key] = heap_.size() - 1;
+            sift_up(heap_.size() - 1);
+        } else {
+            HeavyHitter<Key>& min = heap_[0];
+            index_.erase(min.key);
+            min = {key, min.count + count, min.count};
+            index_[key] = 0;
+            sift_down(0);
+        }
+    }
+
+    void swap_entries(size_t a, size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        index_[heap_[a].key] = a;
+        index_[heap_[b].key] = b;
+    }
+
+    void sift_up(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (heap_[parent].count <= heap_[i].count) break;
+            swap_entries(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(size_t i) {
+        for (;;) {
+            size_t smallest = i;
+            for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap_.size(); ++child) {
+                if (heap_[child].count < heap_[smallest].count) smallest = child;
+            }
+            if (smallest == i) break;
+            swap_entries(i, smallest);
+            i = smallest;
+        }
+    }
+
+    const size_t capacity_;
+    const uint32_t sample_rate_;
+    mutable std::mutex mutex_;
+    std::vector<HeavyHitter<Key>> heap_; // min-heap by count
+    std::unordered_map<Key, size_t, Hash> index_;
+    uint64_t total_ = 0;
+};
+
+} // namespace cache
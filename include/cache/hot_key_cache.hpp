@@ -0,0 +1,241 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "hash_util.hpp"
+#include "heavy_hitters.hpp"
+#include "lru_cache.hpp"
+#include "per_thread.hpp"
+#include "periodic_task.hpp"
+#include "sharded_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cache {
+
+struct HotKeyOptions {
+    size_t tracked_keys = 256;     // Space-Saving counters
+    size_t hot_slots = 32;         // most keys promoted at once
+    uint32_t sample_rate = 16;     // the detector sees 1 in N reads per thread
+    double min_share = 0.01;       // of sampled reads, needed to be (or stay) hot
+    std::chrono::milliseconds refresh_interval{100}; // 0: call refresh() yourself
+    size_t version_stripes = 1024; // rounded up to a power of two
+};
+
+// ShardedCache with a hot-key bypass. A HeavyHitters detector watches the
+// reads. refresh() copies the keys that hold at least min_share of the
+// sampled reads into an immutable hot table, which is published under a
+// generation number. Each thread keeps its own reference to the current
+// table and checks it before hashing to a shard, so a viral key is served
+// without touching its shard's lock.
+//
+// Writes go to the shard and then bump the key's version stripe, as in
+// NearCache. A hot entry is used only while its stripe still has the
+// version it was copied at, so a written key falls through to the shard
+// until the next refresh copies it again. Each refresh also decays the
+// counts: a key that cools off drops below min_share and is demoted, and
+// the shard read that refreshes a key keeps it recent for its policy. That
+// read is not counted as a hit, so hit_count() covers callers' reads only.
+template<typename Key, typename Value, typename Shard = LRUCache<Key, Value>>
+class HotKeyCache : public CacheInterface<Key, Value> {
+public:
+    HotKeyCache(size_t capacity, size_t shard_count = 0,
+                const HotKeyOptions& options = HotKeyOptions(),
+                const std::string& name = "hot_key_cache")
+        : inner_(capacity, shard_count, name)
+        , detector_(options.tracked_keys, options.sample_rate)
+        , options_(options)
+        , versions_(options.version_stripes) {
+        if (options.refresh_interval.count() > 0) {
+            refresher_ = std::make_unique<PeriodicTask>(options.refresh_interval, [this] { refresh(); });
+        }
+    }
+
+    bool put(const Key& key, const Value& value) override {
+        bool stored = inner_.put(key, value);
+        versions_.invalidate(hash_key(key));
+        return stored;
+    }
+
+    std::optional<Value> get(const Key& key) override {
+        detector_.offer(key);
+        auto& local = current();
+        if (const HotEntry* e = find_hot(local.state, key, hash_key(key))) {
+            local.add_hits(1);
+            return e->value;
+        }
+        return inner_.get(key);
+    }
+
+    std::vector<std::optional<Value>> get_many(const std::vector<Key>& keys) override {
+        auto& local = current();
+        std::vector<std::optional<Value>> results(keys.size());
+        std::vector<size_t> rest;
+        std::vector<Key> rest_keys;
+        uint64_t hits = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            detector_.offer(keys[i]);
+            if (const HotEntry* e = find_hot(local.state, keys[i], hash_key(keys[i]))) {
+                results[i] = e->value;
+                ++hits;
+            } else {
+                rest.push_back(i);
+                rest_keys.push_back(keys[i]);
+            }
+        }
+        local.add_hits(hits);
+        if (!rest.empty()) {
+            auto found = inner_.get_many(rest_keys);
+            for (size_t j = 0; j < rest.size(); ++j) results[rest[j]] = std::move(found[j]);
+        }
+        return results;
+    }
+
+    bool remove(const Key& key) override {
+        bool removed = inner_.remove(key);
+        versions_.invalidate(hash_key(key));
+        return removed;
+    }
+
+    void clear() override {
+        inner_.clear();
+        versions_.invalidate_all();
+    }
+
+    // Promotes the current heavy hitters, demotes keys that cooled off and
+    // decays the counts. Runs every refresh_interval when that is set.
+    void refresh() {
+        std::lock_guard<std::mutex> refresh_lock(refresh_mutex_);
+        uint64_t threshold = std::max<uint64_t>(
+            2, static_cast<uint64_t>(std::ceil(options_.min_share * detector_.total())));
+        auto next = std::make_shared<HotSet>();
+        for (auto& hitter : detector_.top(options_.hot_slots)) {
+            if (hitter.count - hitter.error < threshold) continue;
+            uint64_t h = hash_key(hitter.key);
+            // Read before the value: a write in between leaves it stale-marked.
+            uint64_t version = versions_.version(h);
+            auto value = inner_.get_uncounted(hitter.key);
+            if (!value) continue;
+            next->entries.push_back({std::move(hitter.key), std::move(*value), h, version});
+        }
+        next->build_index();
+        {
+            std::lock_guard<std::mutex> lock(publish_mutex_);
+            hot_ = std::move(next);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+        detector_.decay();
+    }
+
+    // Keys currently served from the hot table.
+    std::vector<Key> hot_keys() const {
+        std::lock_guard<std::mutex> lock(publish_mutex_);
+        std::vector<Key> keys;
+        if (hot_) {
+            for (const auto& e : hot_->entries) keys.push_back(e.key);
+        }
+        return keys;
+    }
+
+    // The detector's current top-k, for operators.
+    std::vector<HeavyHitter<Key>> top_keys(size_t k) const { return detector_.top(k); }
+
+    // Reads served from the hot table, over all threads.
+    size_t hot_hits() const { return static_cast<size_t>(locals_.hits()); }
+
+    size_t size() const override { return inner_.size(); }
+    size_t capacity() const override { return inner_.capacity(); }
+    size_t hit_count() const override { return inner_.hit_count() + hot_hits(); }
+    size_t miss_count() const override { return inner_.miss_count(); }
+    size_t eviction_count() const override { return inner_.eviction_count(); }
+    double hit_rate() const override {
+        size_t hits = hit_count();
+        size_t total = hits + miss_count();
+        return total > 0 ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    ShardedCache<Key, Value, Shard>& sharded() { return inner_; }
+
+private:
+    struct HotEntry {
+        Key key;
+        Value value;
+        uint64_t hash;
+        uint64_t version;
+    };
+
+    // Immutable once published; open addressing over entry indexes.
+    struct HotSet {
+        std::vector<HotEntry> entries;
+        std::vector<int32_t> index;
+
+        void build_index() {
+            size_t slots = 1;
+            while (slots < entries.size() * 2) slots <<= 1;
+            index.assign(slots, -1);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                size_t at = entries[i].hash & (slots - 1);
+                while (index[at] >= 0) at = (at + 1) & (slots - 1);
+                index[at] = static_cast<int32_t>(i);
+            }
+        }
+
+        const HotEntry* find(const Key& key, uint64_t h) const {
+            if (entries.empty()) return nullptr;
+            size_t mask = index.size() - 1;
+            for (size_t at = h & mask; index[at] >= 0; at = (at + 1) & mask) {
+                const HotEntry& e = entries[static_cast<size_t>(index[at])];
+                if (e.hash == h && e.key == key) return &e;
+            }
+            return nullptr;
+        }
+    };
+
+    // A thread's reference to the published table.
+    struct HotRef {
+        std::shared_ptr<const HotSet> set;
+        uint64_t generation = 0;
+    };
+
+    const HotEntry* find_hot(const HotRef& ref, const Key& key, uint64_t h) const {
+        if (!ref.set) return nullptr;
+        const HotEntry* e = ref.set->find(key, h);
+        if (e && e->version == versions_.version(h)) return e;
+        return nullptr;
+    }
+
+    // The calling thread's HotRef, brought up to date; only a new
+    // generation takes the publish lock.
+    typename PerThread<HotRef>::Local& current() {
+        auto& local = locals_.get();
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (local.state.generation != generation) {
+            std::lock_guard<std::mutex> lock(publish_mutex_);
+            local.state.set = hot_;
+            local.state.generation = generation;
+        }
+        return local;
+    }
+
+    ShardedCache<Key, Value, Shard> inner_;
+    HeavyHitters<Key> detector_;
+    const HotKeyOptions options_;
+    VersionStripes versions_;
+
+    mutable std::mutex publish_mutex_;
+    std::shared_ptr<const HotSet> hot_;
+    std::atomic<uint64_t> generation_{0};
+    std::mutex refresh_mutex_;
+
+    PerThread<HotRef> locals_;
+
+    std::unique_ptr<PeriodicTask> refresher_; // last: stopped before the rest goes
+};
+
+} // namespace cache
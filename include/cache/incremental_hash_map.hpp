@@ -0,0 +1,200 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+
+namespace cache {
+
+// Chained hash index that grows without a stop-the-world rehash.
+// When the load factor is crossed a table of twice the size is allocated
+// and every subsequent mutation migrates a bounded number of buckets from
+// the old table, so no single operation pays for moving every entry.
+template<typename Key, typename T, typename Hash = std::hash<Key>>
+class IncrementalHashMap {
+private:
+    struct Entry {
+        Key key;
+        T value;
+        Entry* next;
+    };
+
+    // calloc() hands back lazily zeroed pages for large tables, so growing
+    // does not memset the whole bucket array up front.
+    struct Table {
+        Entry** buckets = nullptr;
+        size_t mask = 0;
+        unsigned shift = 64;
+
+        size_t bucket_count() const { return buckets ? mask + 1 : 0; }
+
+        void allocate(size_t count) {
+            buckets = static_cast<Entry**>(std::calloc(count, sizeof(Entry*)));
+            if (!buckets) throw std::bad_alloc();
+            mask = count - 1;
+            shift = 64;
+            while (count > 1) { count >>= 1; --shift; }
+        }
+
+        void release() {
+            std::free(buckets);
+            buckets = nullptr;
+            mask = 0;
+            shift = 64;
+        }
+
+        size_t index(size_t hash) const {
+            // Fibonacci mixing so identity hashes still spread over the high bits
+            return shift >= 64 ? 0
+                : static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+    };
+
+public:
+    static constexpr size_t kMinBuckets = 16;
+    static constexpr size_t kMigrateBucketsPerOp = 8;
+
+    explicit IncrementalHashMap(size_t expected_size = 0) {
+        size_t count = kMinBuckets;
+        while (count < expected_size) count <<= 1;
+        active_.allocate(count);
+    }
+
+    ~IncrementalHashMap() {
+        clear();
+        active_.release();
+    }
+
+    IncrementalHashMap(const IncrementalHashMap&) = delete;
+    IncrementalHashMap& operator=(const IncrementalHashMap&) = delete;
+
+    T* find(const Key& key) {
+        migrate_step();
+        return lookup(key);
+    }
+
+    const T* find(const Key& key) const { return lookup(key); }
+
+    // Inserts key -> value unless the key is already present.
+    // Returns the stored value and whether an insertion happened.
+    std::pair<T*, bool> insert(const Key& key, T value) {
+        migrate_step();
+        if (T* existing = lookup(key)) {
+            return {existing, false};
+        }
+        if (size_ + 1 > active_.bucket_count()) {
+            grow();
+        }
+        size_t h = hasher_(key);
+        Entry*& head = active_.buckets[active_.index(h)];
+        head = new Entry{key, std::move(value), head};
+        ++size_;
+        return {&head->value, true};
+    }
+
+    bool erase(const Key& key) {
+        migrate_step();
+        size_t h = hasher_(key);
+        if (unlink(active_, h, key)) return true;
+        return draining_.buckets && unlink(draining_, h, key);
+    }
+
+    void clear() {
+        free_chains(active_);
+        free_chains(draining_);
+        draining_.release();
+        migrate_pos_ = 0;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool rehashing() const { return draining_.buckets != nullptr; }
+    size_t bucket_count() const { return active_.bucket_count(); }
+
+private:
+    T* lookup(const Key& key) const {
+        size_t h = hasher_(key);
+        if (Entry* e = find_in(active_, h, key)) return &e->value;
+        if (draining_.buckets) {
+            if (Entry* e = find_in(draining_, h, key)) return &e->value;
+        }
+        return nullptr;
+    }
+
+    Entry* find_in(const Table& table, size_t h, const Key& key) const {
+        for (Entry* e = table.buckets[table.index(h)]; e; e = e->next) {
+            if (e->key == key) return e;
+        }
+        return nullptr;
+    }
+
+    bool unlink(Table& table, size_t h, const Key& key) {
+        Entry** link = &table.buckets[table.index(h)];
+        while (*link) {
+            Entry* e = *link;
+            if (e->key == key) {
+                *link = e->next;
+                delete e;
+                --size_;
+                return true;
+            }
+            link = &e->next;
+        }
+        return false;
+    }
+
+    void grow() {
+        // The previous migration normally finishes long before the next
+        // growth; if it has not, finish it so at most two tables exist.
+        while (draining_.buckets) migrate_step();
+        draining_ = active_;
+        active_ = Table{};
+        active_.allocate(draining_.bucket_count() * 2);
+        migrate_pos_ = 0;
+    }
+
+    void migrate_step() {
+        if (!draining_.buckets) return;
+        size_t end = migrate_pos_ + kMigrateBucketsPerOp;
+        size_t count = draining_.bucket_count();
+        if (end > count) end = count;
+        for (; migrate_pos_ < end; ++migrate_pos_) {
+            Entry* e = draining_.buckets[migrate_pos_];
+            while (e) {
+                Entry* next = e->next;
+                Entry*& head = active_.buckets[active_.index(hasher_(e->key))];
+                e->next = head;
+                head = e;
+                e = next;
+            }
+            draining_.buckets[migrate_pos_] = nullptr;
+        }
+        if (migrate_pos_ == count) {
+            draining_.release();
+            migrate_pos_ = 0;
+        }
+    }
+
+    static void free_chains(Table& table) {
+        for (size_t i = 0; i < table.bucket_count(); ++i) {
+            Entry* e = table.buckets[i];
+            while (e) {
+                Entry* next = e->next;
+                delete e;
+                e = next;
+            }
+            table.buckets[i] = nullptr;
+        }
+    }
+
+    Table active_;
+    Table draining_;
+    size_t migrate_pos_ = 0;
+    size_t size_ = 0;
+    Hash hasher_;
+};
+
+} // namespace cache
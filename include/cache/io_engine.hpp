@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/uio.h>
+#include <vector>
+
+namespace cache {
+
+enum class IoBackend { Auto, Epoll, IoUring };
+
+struct IoEngineOptions {
+    unsigned queue_depth = 512;     // io_uring submission queue entries
+    unsigned buffer_count = 256;    // receive buffers; a power of two <= 32768
+    size_t buffer_size = 16 * 1024;
+};
+
+struct IoCompletion {
+    uint64_t tag = 0;
+    int32_t result = 0;          // bytes, an accepted fd, 0 at EOF, or -errno
+    bool more = false;           // a multishot operation is still armed
+    const char* data = nullptr;  // received bytes, valid until release(buffer)
+    uint16_t buffer = 0;
+};
+
+// Completion-based I/O shared by the network event loops and positional
+// disk reads. Operations are queued and handed to the kernel together by
+// the next wait(), which then returns every completion that is ready; the
+// caller's tag identifies each one.
+//
+// The io_uring backend submits a whole batch with one io_uring_enter(),
+// keeps one multishot accept and one multishot recv armed per socket, and
+// receives into a ring of provided buffers registered with the kernel, so
+// a busy loop makes one syscall per wait() rather than one per socket
+// operation. Disk reads may target buffers pinned with register_buffers().
+// The epoll backend implements the same contract with level-triggered
+// readiness and plain syscalls, for kernels without io_uring (or where it
+// is disabled).
+//
+// An engine is driven by a single thread; only wake() may be called from
+// others.
+class IoEngine {
+public:
+    virtual ~IoEngine() = default;
+
+    // Multishot: one completion per accepted socket (non-blocking,
+    // close-on-exec) until one arrives with more == false.
+    virtual void accept(int listen_fd, uint64_t tag) = 0;
+
+    // Multishot: one completion per chunk received into an engine buffer,
+    // which the caller hands back with release(). Ends with more == false
+    // at EOF, on error, or with -ENOBUFS when every buffer is in use; in
+    // the last case release buffers and call recv() again.
+    virtual void recv(int fd, uint64_t tag) = 0;
+
+    // One gathered send with MSG_NOSIGNAL; the result may be short. The
+    // iovec array is copied, but the bytes must stay untouched until the
+    // completion arrives.
+    virtual void send(int fd, const iovec* iov, int count, uint64_t tag) = 0;
+
+    // Reads up to len bytes at offset. buffer_index >= 0 names the
+    // register_buffers() entry that contains buf.
+    virtual void read(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag,
+                      int buffer_index = -1) = 0;
+
+    // Pins buffers for read(). Returns false if the kernel refused them.
+    virtual bool register_buffers(const iovec* iov, unsigned count) = 0;
+
+    virtual void release(uint16_t buffer) = 0;
+
+    // Submits everything queued, waits up to timeout_ms (-1: forever) for
+    // at least one completion and appends all ready ones to `out`. Returns
+    // the number appended, which is 0 after a timeout or wake().
+    virtual size_t wait(std::vector<IoCompletion>& out, int timeout_ms) = 0;
+
+    virtual void wake() = 0;
+
+    virtual const char* name() const = 0;
+
+    // System calls made so far on the driving thread.
+    uint64_t syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+protected:
+    void count_syscalls(uint64_t n = 1) {
+        syscalls_.store(syscalls_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> syscalls_{0};
+};
+
+// Auto picks io_uring when it was compiled in (HAS_IO_URING) and a probe
+// shows the kernel supports multishot recv with provided buffer rings
+// (6.0+), and epoll otherwise. Asking for IoUring explicitly throws std::system_error
+// when it is unavailable.
+std::unique_ptr<IoEngine> make_io_engine(IoBackend backend = IoBackend::Auto,
+                                         const IoEngineOptions& options = IoEngineOptions());
+
+bool io_uring_available();
+
+} // namespace cache
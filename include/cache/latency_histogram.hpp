@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cache {
+
+// HDR-style log-linear histogram of nanosecond latencies.
+// Each power of two is split into kSubBuckets linear buckets, giving about
+// 3% relative error. Writers record into a lazily allocated per-thread
+// stripe so the hot path never shares a cache line with other threads;
+// readers merge all stripes when asked for a percentile.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    static constexpr unsigned kMaxMagnitude = 40; // values clamp at ~18 minutes
+    static constexpr size_t kBucketCount = (kMaxMagnitude - kSubBucketBits + 1) * kSubBuckets;
+    static constexpr size_t kMaxStripes = 64;
+
+    LatencyHistogram() = default;
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value_ns) {
+        stripe().counts[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Value at quantile p in [0, 1], e.g. 0.99 for p99. Returns 0 when empty.
+    uint64_t percentile(double p) const;
+    uint64_t count() const;
+    void reset();
+
+    // Merged bucket counts across all stripes.
+    std::vector<uint64_t> snapshot() const;
+
+    // percentile() over bucket counts from snapshot(), which may be summed
+    // across histograms first.
+    static uint64_t percentile(const std::vector<uint64_t>& counts, double p);
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        unsigned magnitude = 63 - static_cast<unsigned>(__builtin_clzll(v));
+        if (magnitude >= kMaxMagnitude) return kBucketCount - 1;
+        unsigned shift = magnitude - kSubBucketBits;
+        return static_cast<size_t>((shift + 1) * kSubBuckets + ((v >> shift) - kSubBuckets));
+    }
+
+    // Representative (midpoint) value of a bucket.
+    static uint64_t bucket_value(size_t index) {
+        if (index < kSubBuckets) return index;
+        unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+        uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+        return lower + ((1ull << shift) >> 1);
+    }
+
+private:
+    struct Stripe {
+        std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+    };
+
+    Stripe& stripe() {
+        auto& slot = stripes_[thread_slot()];
+        Stripe* s = slot.load(std::memory_order_acquire);
+        return s ? *s : allocate_stripe(slot);
+    }
+
+    static size_t thread_slot();
+    static Stripe& allocate_stripe(std::atomic<Stripe*>& slot);
+
+    std::array<std::atomic<Stripe*>, kMaxStripes> stripes_{};
+};
+
+} // namespace cache
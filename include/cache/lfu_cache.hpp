@@ -1,16 +1,18 @@
 #pragma once
 #include "cache_interface.hpp"
+#include "access_observer.hpp"
 #include "memory_allocator.hpp"
 #include "metrics.hpp"
+#include "snapshot.hpp"
+#include "timing.hpp"
 #include <unordered_map>
 #include <map>
 #include <list>
 #include <shared_mutex>
-#include <chrono>
 
 namespace cache {
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Timing = DefaultTiming>
 class LFUCache : public CacheInterface<Key, Value> {
 private:
     struct Node {
@@ -22,64 +24,36 @@ private:
     using NodeList = std::list<Node>;
     
 public:
-    explicit LFUCache(size_t capacity) 
+    explicit LFUCache(size_t capacity, const std::string& name = "lfu_cache")
         : capacity_(capacity)
         , min_freq_(0)
-        , metrics_("lfu_cache") {}
+        , metrics_(name) {}
     
     bool put(const Key& key, const Value& value) override {
-        auto start = std::chrono::high_resolution_clock::now();
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        if (capacity_ == 0) return false;
-        
-        auto map_it = map_.find(key);
-        if (map_it != map_.end()) {
-            // Update existing
-            map_it->second.it->value = value;
-            touch(key);
-        } else {
-            // Insert new
-            if (map_.size() >= capacity_) {
-                evict();
-            }
-            
-            freq_map_[1].push_front({key, value, 1});
-            map_[key] = {freq_map_[1].begin(), 1};
-            min_freq_ = 1;
+        auto sample = timing_.begin();
+        bool inserted = put_locked(key, value);
+        timing_.end(sample, metrics_, LatencyOp::Put);
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_put(key);
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
-        metrics_.set_size(map_.size());
-        
-        return true;
+        return inserted;
     }
     
     std::optional<Value> get(const Key& key) override {
-        auto start = std::chrono::high_resolution_clock::now();
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto map_it = map_.find(key);
-        if (map_it == map_.end()) {
-            metrics_.record_miss();
-            return std::nullopt;
+        auto sample = timing_.begin();
+        auto result = get_locked(key);
+        timing_.end(sample, metrics_, LatencyOp::Get);
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_get(key, result.has_value());
         }
-        
-        Value val = map_it->second.it->value;
-        touch(key);
-        metrics_.record_hit();
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
-        
-        return val;
+        return result;
     }
     
+    // Reads key and refreshes its place in the policy as get() does, but
+    // records no hit, miss or latency and is not shown to the observer.
+    // For the library's own reads, such as HotKeyCache::refresh().
+    std::optional<Value> get_uncounted(const Key& key) { return get_locked(key, false); }
+    
     bool remove(const Key& key) override {
         std::unique_lock<std::shared_mutex> lock(mutex_);
         
@@ -107,18 +81,166 @@ public:
         metrics_.set_size(0);
     }
     
+    std::optional<std::pair<Key, Value>> take_victim() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (freq_map_.empty()) return std::nullopt;
+        
+        auto min_it = freq_map_.begin();
+        auto& back = min_it->second.back();
+        std::pair<Key, Value> victim(back.key, std::move(back.value));
+        map_.erase(back.key);
+        min_it->second.pop_back();
+        if (min_it->second.empty()) {
+            freq_map_.erase(min_it);
+        }
+        metrics_.set_size(map_.size());
+        return victim;
+    }
+    
+    std::optional<MigratedEntry<Key, Value>> take_hottest() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (freq_map_.empty()) return std::nullopt;
+        
+        auto max_it = std::prev(freq_map_.end());
+        auto& front = max_it->second.front();
+        MigratedEntry<Key, Value> entry{front.key, std::move(front.value), front.freq};
+        map_.erase(front.key);
+        max_it->second.pop_front();
+        if (max_it->second.empty()) {
+            freq_map_.erase(max_it);
+        }
+        min_freq_ = freq_map_.empty() ? 0 : freq_map_.begin()->first;
+        metrics_.set_size(map_.size());
+        return entry;
+    }
+    
+    // Goes in at the least recent end of the `references` bucket, keeping
+    // the frequency the source counted. An existing key keeps its place.
+    bool put_cold(const Key& key, const Value& value, uint64_t references) override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto map_it = map_.find(key);
+        if (map_it != map_.end()) {
+            map_it->second.it->value = value;
+            return true;
+        }
+        if (map_.size() >= capacity_) return false;
+        size_t freq = std::max<size_t>(1, static_cast<size_t>(references));
+        auto& list = freq_map_[freq];
+        list.push_back({key, value, freq});
+        map_[key] = {std::prev(list.end()), freq};
+        min_freq_ = freq_map_.begin()->first;
+        metrics_.set_size(map_.size());
+        return true;
+    }
+    
     size_t size() const override {
         std::shared_lock<std::shared_mutex> lock(mutex_);
         return map_.size();
     }
     
+    // Whether key is resident, without counting a lookup or its frequency.
+    bool contains(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return map_.count(key) != 0;
+    }
+    
     size_t capacity() const override { return capacity_; }
     size_t hit_count() const override { return metrics_.hits(); }
     size_t miss_count() const override { return metrics_.misses(); }
     size_t eviction_count() const override { return metrics_.evictions(); }
     double hit_rate() const override { return metrics_.hit_rate(); }
     
+    const Metrics& metrics() const { return metrics_; }
+    Timing& timing() { return timing_; }
+    
+    // Attach an access hook (e.g. a MissRatioCurveObserver); nullptr detaches.
+    void set_observer(AccessObserver<Key>* observer) {
+        observer_.store(observer, std::memory_order_release);
+    }
+    
+    // Copies entries with their frequencies, most frequent first, under the
+    // lock, then encodes and writes them on a background thread.
+    std::future<bool> save_snapshot(const std::string& path) const {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            records.reserve(map_.size());
+            for (auto f = freq_map_.rbegin(); f != freq_map_.rend(); ++f) {
+                for (const auto& node : f->second) {
+                    records.push_back({node.key, node.value, node.freq, 0});
+                }
+            }
+        }
+        return write_snapshot_async(path, SnapshotPolicy::LFU, 0, std::move(records));
+    }
+    
+    // Replaces the contents with a snapshot, restoring each entry's
+    // frequency. If it holds more than capacity() entries the most
+    // frequent are kept.
+    bool load_snapshot(const std::string& path) {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        uint64_t extra = 0;
+        if (!read_snapshot(path, SnapshotPolicy::LFU, extra, records)) return false;
+        
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_.clear();
+        freq_map_.clear();
+        map_.reserve(std::min<size_t>(records.size(), capacity_));
+        for (auto& r : records) {
+            if (map_.size() >= capacity_) break;
+            if (map_.count(r.key)) continue;
+            size_t freq = std::max<size_t>(1, static_cast<size_t>(r.meta));
+            auto& list = freq_map_[freq];
+            list.push_back({r.key, std::move(r.value), freq});
+            map_[r.key] = {std::prev(list.end()), freq};
+        }
+        min_freq_ = freq_map_.empty() ? 0 : freq_map_.begin()->first;
+        metrics_.set_size(map_.size());
+        return true;
+    }
+    
 private:
+    bool put_locked(const Key& key, const Value& value) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        
+        if (capacity_ == 0) return false;
+        
+        auto map_it = map_.find(key);
+        if (map_it != map_.end()) {
+            // Update existing
+            map_it->second.it->value = value;
+            touch(key);
+        } else {
+            // Insert new
+            if (map_.size() >= capacity_) {
+                evict();
+            }
+            
+            freq_map_[1].push_front({key, value, 1});
+            map_[key] = {freq_map_[1].begin(), 1};
+            min_freq_ = 1;
+        }
+        metrics_.set_size(map_.size());
+        
+        return true;
+    }
+    
+    std::optional<Value> get_locked(const Key& key, bool count = true) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        
+        auto map_it = map_.find(key);
+        if (map_it == map_.end()) {
+            if (count) metrics_.record_miss();
+            return std::nullopt;
+        }
+        
+        Value val = map_it->second.it->value;
+        touch(key);
+        if (count) metrics_.record_hit();
+        
+        return val;
+    }
+    
     void touch(const Key& key) {
         auto& item = map_[key];
         size_t freq = item.freq;
@@ -140,13 +262,16 @@ private:
     void evict() {
         if (freq_map_.empty()) return;
         
-        auto& min_list = freq_map_[min_freq_];
+        // The map is ordered by frequency, so begin() is the minimum even
+        // when remove() has left min_freq_ pointing at an emptied bucket.
+        auto min_it = freq_map_.begin();
+        auto& min_list = min_it->second;
         auto& back = min_list.back();
         map_.erase(back.key);
         min_list.pop_back();
         
         if (min_list.empty()) {
-            freq_map_.erase(min_freq_);
+            freq_map_.erase(min_it);
         }
         
         metrics_.record_eviction();
@@ -163,6 +288,8 @@ private:
     std::map<size_t, NodeList> freq_map_;
     mutable std::shared_mutex mutex_;
     Metrics metrics_;
+    Timing timing_;
+    std::atomic<AccessObserver<Key>*> observer_{nullptr};
 };
 
 } // namespace cache
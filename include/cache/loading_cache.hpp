@@ -0,0 +1,303 @@
+#pragma once
+#include "hash_util.hpp"
+#include "lru_cache.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cache {
+
+struct LoadingOptions {
+    std::chrono::milliseconds ttl{60000};
+    double refresh_ahead = 0.8;             // of ttl; later reads reload in the background; 0 disables
+    std::chrono::milliseconds stale_grace{0}; // past ttl, still served while a reload runs
+    double xfetch_beta = 1.0;               // early-expiry aggressiveness; 0 disables
+    size_t refresh_threads = 2;
+    size_t max_queued_refreshes = 1024;     // further refreshes are dropped, not queued
+};
+
+// What LoadingCache stores in its policy cache. Times are Clock ticks in
+// nanoseconds.
+template<typename Value>
+struct LoadedValue {
+    Value value;
+    int64_t loaded_ns = 0;
+    int64_t expires_ns = 0;
+    int64_t load_cost_ns = 0; // how long the loader took
+};
+
+// Read-through cache over a loader with per-entry TTLs. A miss, or an
+// entry past ttl + stale_grace, loads synchronously. Concurrent misses on
+// one key share a single load.
+//
+// Hits are not just returned until the entry expires. A hit schedules a
+// background reload on a bounded ThreadPool when any of these hold:
+//   - refresh-ahead: the entry is older than refresh_ahead * ttl;
+//   - stale-while-revalidate: it has expired but is within stale_grace
+//     (the stale value is returned);
+//   - XFetch: now - load_cost * xfetch_beta * ln(rand()) >= expiry. Entries
+//     that are slow to load are refreshed earlier, and the randomness
+//     spreads the refreshes of keys loaded together.
+// Each key has at most one refresh in flight, and a full queue drops the
+// refresh rather than blocking the reader. A refresh whose loader throws
+// keeps the old value; one whose loader returns nullopt removes the key.
+// A put(), remove() or clear() during a load wins: keys with a load in
+// flight carry a generation that those bump, together with their write,
+// and a loader result whose generation has moved on is not stored. A get()
+// that missed before a put() landed returns the put value instead of
+// loading.
+//
+// Clock is a steady clock type; tests substitute their own.
+template<typename Key, typename Value,
+         typename Cache = LRUCache<Key, LoadedValue<Value>>,
+         typename Clock = std::chrono::steady_clock>
+class LoadingCache {
+public:
+    using Loader = std::function<std::optional<Value>(const Key&)>;
+
+    LoadingCache(size_t capacity, Loader loader,
+                 const LoadingOptions& options = LoadingOptions(),
+                 const std::string& name = "loading_cache")
+        : cache_(capacity, name)
+        , loader_(std::move(loader))
+        , options_(options)
+        , pool_(std::make_unique<ThreadPool>(options.refresh_threads, options.max_queued_refreshes)) {}
+
+    // Drains queued refreshes before anything they use goes away.
+    ~LoadingCache() { pool_.reset(); }
+
+    LoadingCache(const LoadingCache&) = delete;
+    LoadingCache& operator=(const LoadingCache&) = delete;
+
+    // Throws whatever the loader throws on a synchronous load.
+    std::optional<Value> get(const Key& key) {
+        int64_t now = now_ns();
+        uint64_t writes = writes_.load(std::memory_order_acquire);
+        if (auto entry = cache_.get(key)) {
+            if (now < entry->expires_ns) {
+                if (should_refresh(*entry, now)) refresh(key);
+                return std::move(entry->value);
+            }
+            if (now < entry->expires_ns + ns(options_.stale_grace)) {
+                stale_hits_.fetch_add(1, std::memory_order_relaxed);
+                refresh(key);
+                return std::move(entry->value);
+            }
+        }
+        return load(key, writes);
+    }
+
+    bool put(const Key& key, const Value& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        supersede(key);
+        int64_t now = now_ns();
+        bool stored = cache_.put(key, LoadedValue<Value>{value, now, now + ns(options_.ttl), 0});
+        writes_.fetch_add(1, std::memory_order_release);
+        return stored;
+    }
+
+    bool remove(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        supersede(key);
+        return cache_.remove(key);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& f : in_flight_) ++f.second.generation;
+        cache_.clear();
+    }
+
+    // Queues a background reload unless one is already in flight.
+    void refresh(const Key& key) {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!refreshing_.insert(key).second) return;
+            generation = begin_load(key);
+        }
+        bool queued = pool_->submit([this, key, generation] {
+            bool refreshed = false;
+            std::optional<Value> value;
+            int64_t start = now_ns(), end = start;
+            try {
+                value = loader_(key);
+                end = now_ns();
+                refreshed = true;
+            } catch (...) {
+                refresh_failures_.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (end_load(key, generation) && refreshed) {
+                if (value) {
+                    cache_.put(key, LoadedValue<Value>{std::move(*value), end, end + ns(options_.ttl), end - start});
+                } else {
+                    cache_.remove(key);
+                }
+            }
+            if (refreshed) refreshes_.fetch_add(1, std::memory_order_relaxed);
+            refreshing_.erase(key);
+        });
+        if (!queued) {
+            refreshes_dropped_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex_);
+            end_load(key, generation);
+            refreshing_.erase(key);
+        }
+    }
+
+    size_t size() const { return cache_.size(); }
+    size_t capacity() const { return cache_.capacity(); }
+
+    uint64_t loads() const { return loads_.load(std::memory_order_relaxed); }
+    uint64_t refreshes() const { return refreshes_.load(std::memory_order_relaxed); }
+    uint64_t stale_hits() const { return stale_hits_.load(std::memory_order_relaxed); }
+    uint64_t refresh_failures() const { return refresh_failures_.load(std::memory_order_relaxed); }
+    uint64_t refreshes_dropped() const { return refreshes_dropped_.load(std::memory_order_relaxed); }
+    size_t refreshes_in_flight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return refreshing_.size();
+    }
+
+    Cache& cache() { return cache_; }
+
+private:
+    static int64_t ns(std::chrono::nanoseconds d) { return d.count(); }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    // Uniform in (0, 1].
+    static double uniform() {
+        thread_local uint64_t state = mix64(reinterpret_cast<uintptr_t>(&state) ^
+                                            static_cast<uint64_t>(now_ns()));
+        state = mix64(state + 0x9E3779B97F4A7C15ull);
+        return static_cast<double>((state >> 11) + 1) * (1.0 / 9007199254740992.0);
+    }
+
+    bool should_refresh(const LoadedValue<Value>& entry, int64_t now) const {
+        int64_t ttl = entry.expires_ns - entry.loaded_ns;
+        if (options_.refresh_ahead > 0 &&
+            now >= entry.loaded_ns + static_cast<int64_t>(options_.refresh_ahead * ttl)) {
+            return true;
+        }
+        if (options_.xfetch_beta > 0 && entry.load_cost_ns > 0) {
+            double early = -static_cast<double>(entry.load_cost_ns) * options_.xfetch_beta * std::log(uniform());
+            return static_cast<double>(now) + early >= static_cast<double>(entry.expires_ns);
+        }
+        return false;
+    }
+
+    // Synchronous load; concurrent callers for the same key wait for the
+    // first one's result instead of calling the loader again. `writes` is
+    // writes_ as get() saw it before its lookup missed.
+    std::optional<Value> load(const Key& key, uint64_t writes) {
+        std::promise<std::optional<Value>> promise;
+        std::shared_future<std::optional<Value>> pending;
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = loading_.find(key);
+            if (it != loading_.end()) {
+                pending = it->second;
+            } else {
+                // A put since the miss may have stored this key; it wins
+                // over a load that would start after it. Rare enough that
+                // the extra lookup is not worth keeping out of the stats.
+                if (writes_.load(std::memory_order_relaxed) != writes) {
+                    auto entry = cache_.get(key);
+                    if (entry && now_ns() < entry->expires_ns) return std::move(entry->value);
+                }
+                loading_.emplace(key, promise.get_future().share());
+                generation = begin_load(key);
+            }
+        }
+        if (pending.valid()) return pending.get();
+
+        std::optional<Value> value;
+        int64_t start = now_ns(), end;
+        try {
+            value = loader_(key);
+            end = now_ns();
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                end_load(key, generation);
+                loading_.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        loads_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (end_load(key, generation) && value) {
+                cache_.put(key, LoadedValue<Value>{*value, end, end + ns(options_.ttl), end - start});
+            }
+            loading_.erase(key);
+        }
+        promise.set_value(value);
+        return value;
+    }
+
+    // The three below are called with mutex_ held. A load registers the
+    // key's current generation before calling the loader, and stores its
+    // result only if end_load() says no put(), remove() or clear() came
+    // in between; storing under mutex_ keeps that answer true until the
+    // write lands.
+    uint64_t begin_load(const Key& key) {
+        InFlight& f = in_flight_[key];
+        ++f.loads;
+        return f.generation;
+    }
+
+    bool end_load(const Key& key, uint64_t generation) {
+        auto it = in_flight_.find(key);
+        bool current = it->second.generation == generation;
+        if (--it->second.loads == 0) in_flight_.erase(it);
+        return current;
+    }
+
+    // put() and remove() bump and write under mutex_, so a load that
+    // checks after them drops its result and one that stored before them
+    // is overwritten.
+    void supersede(const Key& key) {
+        auto it = in_flight_.find(key);
+        if (it != in_flight_.end()) ++it->second.generation;
+    }
+
+    Cache cache_;
+    const Loader loader_;
+    const LoadingOptions options_;
+    struct InFlight {
+        uint64_t generation = 0;
+        unsigned loads = 0; // a refresh and a synchronous load may overlap
+    };
+
+    // refreshing_, loading_ and in_flight_; also held across put(),
+    // remove() and clear() so a write and its generation bump land together
+    mutable std::mutex mutex_;
+    std::unordered_set<Key> refreshing_;
+    std::unordered_map<Key, InFlight> in_flight_;
+    std::unordered_map<Key, std::shared_future<std::optional<Value>>> loading_;
+    std::atomic<uint64_t> writes_{0}; // put()s so far, bumped under mutex_
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> refreshes_{0};
+    std::atomic<uint64_t> stale_hits_{0};
+    std::atomic<uint64_t> refresh_failures_{0};
+    std::atomic<uint64_t> refreshes_dropped_{0};
+    std::unique_ptr<ThreadPool> pool_; // last: its tasks use everything above
+};
+
+} // namespace cache
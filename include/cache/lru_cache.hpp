@@ -1,102 +1,193 @@
 #pragma once
 #include "cache_interface.hpp"
+#include "access_observer.hpp"
+#include "eviction_listener.hpp"
 #include "memory_allocator.hpp"
 #include "metrics.hpp"
-#include <unordered_map>
+#include "timing.hpp"
+#include "incremental_hash_map.hpp"
+#include "maintenance_scheduler.hpp"
+#include "snapshot.hpp"
+#include "value_compression.hpp"
+#include <algorithm>
 #include <list>
 #include <shared_mutex>
-#include <chrono>
 
 namespace cache {
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Timing = DefaultTiming>
 class LRUCache : public CacheInterface<Key, Value> {
 private:
     struct Node {
         Key key;
         Value value;
         typename std::list<Node>::iterator list_it;
+        uint32_t raw_size = 0; // non-zero while value holds compressed bytes
+        bool cold = false;     // examined by the cold-entry compressor
     };
     
     using NodeList = std::list<Node>;
-    using MapType = std::unordered_map<Key, typename NodeList::iterator>;
+    using MapType = IncrementalHashMap<Key, typename NodeList::iterator>;
+    using Evicted = std::optional<std::pair<Key, Value>>;
+    
+    // Index buckets allocated up front; larger caches grow incrementally.
+    static constexpr size_t kInitialIndexSize = 1 << 16;
     
 public:
-    explicit LRUCache(size_t capacity) 
+    explicit LRUCache(size_t capacity, const std::string& name = "lru_cache")
         : capacity_(capacity)
         , node_list_()
-        , metrics_("lru_cache") {}
+        , map_(std::min(capacity, kInitialIndexSize))
+        , cold_(node_list_)
+        , metrics_(name)
+        , limit_(capacity) {}
+    
+    ~LRUCache() override {
+        if (scheduler_) scheduler_->cancel(maintenance_);
+    }
     
     bool put(const Key& key, const Value& value) override {
-        auto start = std::chrono::high_resolution_clock::now();
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto map_it = map_.find(key);
-        if (map_it != map_.end()) {
-            // Update existing
-            node_list_.splice(node_list_.begin(), node_list_, map_it->second);
-            map_it->second->value = value;
-        } else {
-            // Insert new
-            if (map_.size() >= capacity_) {
-                evict();
+        auto sample = timing_.begin();
+        Evicted evicted;
+        bool inserted = put_locked(key, value, evicted);
+        timing_.end(sample, metrics_, LatencyOp::Put);
+        if (scheduler_ && metrics_.size() > capacity_) {
+            scheduler_->schedule(maintenance_);
+        }
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_put(key);
+        }
+        if (evicted) {
+            if (auto* listener = eviction_listener_.load(std::memory_order_acquire)) {
+                listener->on_evict(evicted->first, std::move(evicted->second));
             }
-            node_list_.push_front({key, value, {}});
-            node_list_.front().list_it = node_list_.begin();
-            map_[key] = node_list_.begin();
         }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
-        metrics_.set_size(map_.size());
-        
-        return true;
+        return inserted;
     }
     
     std::optional<Value> get(const Key& key) override {
-        auto start = std::chrono::high_resolution_clock::now();
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto map_it = map_.find(key);
-        if (map_it == map_.end()) {
-            metrics_.record_miss();
-            return std::nullopt;
+        auto sample = timing_.begin();
+        auto result = get_locked(key);
+        timing_.end(sample, metrics_, LatencyOp::Get);
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            observer->on_get(key, result.has_value());
         }
-        
-        // Move to front (most recently used)
-        node_list_.splice(node_list_.begin(), node_list_, map_it->second);
-        metrics_.record_hit();
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        metrics_.record_latency_ns(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-        );
-        
-        return map_it->second->value;
+        return result;
+    }
+    
+    // Reads key and refreshes its place in the policy as get() does, but
+    // records no hit, miss or latency and is not shown to the observer.
+    // For the library's own reads, such as HotKeyCache::refresh().
+    std::optional<Value> get_uncounted(const Key& key) { return get_locked(key, false); }
+    
+    std::vector<std::optional<Value>> get_many(const std::vector<Key>& keys) override {
+        std::vector<std::optional<Value>> results;
+        results.reserve(keys.size());
+        {
+            // Not timed: one batch is not comparable with single gets.
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            for (const auto& key : keys) {
+                results.push_back(lookup(key));
+            }
+        }
+        if (auto* observer = observer_.load(std::memory_order_acquire)) {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                observer->on_get(keys[i], results[i].has_value());
+            }
+        }
+        return results;
     }
     
     bool remove(const Key& key) override {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto map_it = map_.find(key);
-        if (map_it == map_.end()) {
-            return false;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            
+            auto* it = map_.find(key);
+            if (!it) {
+                return false;
+            }
+            
+            cold_.on_unlink(*it);
+            if (scheduler_) {
+                retired_.splice(retired_.end(), node_list_, *it);
+            } else {
+                node_list_.erase(*it);
+            }
+            map_.erase(key);
+            metrics_.set_size(map_.size());
         }
-        
-        node_list_.erase(map_it->second);
-        map_.erase(map_it);
-        metrics_.set_size(map_.size());
-        
+        if (scheduler_) scheduler_->schedule(maintenance_);
         return true;
     }
     
     void clear() override {
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            map_.clear();
+            if (scheduler_) {
+                retired_.splice(retired_.end(), node_list_);
+            } else {
+                node_list_.clear();
+            }
+            cold_.reset();
+            metrics_.set_size(0);
+        }
+        if (scheduler_) scheduler_->schedule(maintenance_);
+    }
+    
+    std::optional<std::pair<Key, Value>> take_victim() override {
         std::unique_lock<std::shared_mutex> lock(mutex_);
-        map_.clear();
-        node_list_.clear();
+        while (!node_list_.empty()) {
+            auto last = std::prev(node_list_.end());
+            cold_.on_unlink(last);
+            map_.erase(last->key);
+            if (last->raw_size && !inflate(*last)) {
+                node_list_.pop_back();
+                continue;
+            }
+            std::pair<Key, Value> victim(std::move(last->key), std::move(last->value));
+            node_list_.pop_back();
+            metrics_.set_size(map_.size());
+            return victim;
+        }
         metrics_.set_size(0);
+        return std::nullopt;
+    }
+    
+    std::optional<MigratedEntry<Key, Value>> take_hottest() override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        while (!node_list_.empty()) {
+            auto first = node_list_.begin();
+            cold_.on_unlink(first);
+            map_.erase(first->key);
+            if (first->raw_size && !inflate(*first)) {
+                node_list_.pop_front();
+                continue;
+            }
+            MigratedEntry<Key, Value> entry{std::move(first->key), std::move(first->value), 1};
+            node_list_.pop_front();
+            metrics_.set_size(map_.size());
+            return entry;
+        }
+        metrics_.set_size(0);
+        return std::nullopt;
+    }
+    
+    // Goes in at the LRU end. An existing key keeps its place.
+    bool put_cold(const Key& key, const Value& value, uint64_t) override {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (auto* it = map_.find(key)) {
+            (*it)->value = value;
+            (*it)->raw_size = 0;
+            return true;
+        }
+        if (map_.size() >= capacity_) return false;
+        node_list_.push_back({key, value, {}});
+        auto last = std::prev(node_list_.end());
+        last->list_it = last;
+        map_.insert(key, last);
+        metrics_.set_size(map_.size());
+        return true;
     }
     
     size_t size() const override {
@@ -104,27 +195,267 @@ public:
         return map_.size();
     }
     
+    // Whether key is resident, without counting a lookup or touching recency.
+    bool contains(const Key& key) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return map_.find(key) != nullptr;
+    }
+    
     size_t capacity() const override { return capacity_; }
     size_t hit_count() const override { return metrics_.hits(); }
     size_t miss_count() const override { return metrics_.misses(); }
     size_t eviction_count() const override { return metrics_.evictions(); }
     double hit_rate() const override { return metrics_.hit_rate(); }
     
+    const Metrics& metrics() const { return metrics_; }
+    Timing& timing() { return timing_; }
+    
+    // Attach an access hook (e.g. a MissRatioCurveObserver); nullptr detaches.
+    void set_observer(AccessObserver<Key>* observer) {
+        observer_.store(observer, std::memory_order_release);
+    }
+    
+    // Hand evicted entries to `listener` (e.g. a FlashStore spill tier)
+    // instead of dropping them; nullptr detaches.
+    void set_eviction_listener(EvictionListener<Key, Value>* listener) {
+        eviction_listener_.store(listener, std::memory_order_release);
+    }
+    
+    // Moves eviction off the put path. A put only evicts inline once the
+    // cache is `overshoot` past capacity; going past capacity queues a
+    // pass on `scheduler` that evicts in batches down to `low_water` and
+    // frees the victims, and removed or cleared entries, outside the lock.
+    // The size therefore floats between low_water and capacity + overshoot.
+    // nullptr detaches and trims back to capacity inline. Call while no
+    // other thread is using the cache.
+    void set_maintenance(MaintenanceScheduler* scheduler, const MaintenanceOptions& options = MaintenanceOptions()) {
+        if (scheduler_) scheduler_->cancel(maintenance_);
+        scheduler_ = scheduler;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            limit_ = capacity_;
+            low_water_ = capacity_;
+            if (scheduler) {
+                limit_ += std::max<size_t>(1, static_cast<size_t>(capacity_ * options.overshoot));
+                low_water_ = std::min(capacity_, static_cast<size_t>(capacity_ * options.low_water));
+            }
+            batch_ = std::max<size_t>(1, options.batch);
+        }
+        if (!scheduler) trim(capacity_);
+    }
+    
+    // Opt in to compressing values that age out of the hot MRU region.
+    // Only value types with a ValueCompressor specialization are affected.
+    void set_compression(const CompressionOptions& options) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        compression_ = options;
+    }
+    
+    // Background step: compresses up to max_entries values that have fallen
+    // into the cold region since the last call. Returns entries examined.
+    size_t compress_cold(size_t max_entries) {
+        if constexpr (!ValueCompressor<Value>::supported) {
+            (void)max_entries;
+            return 0;
+        } else {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            if (!compression_.enabled) return 0;
+            size_t n = node_list_.size();
+            size_t hot = static_cast<size_t>(n * compression_.hot_fraction + 0.5);
+            return cold_.advance(n > hot ? n - hot : 0, max_entries, [this](Node& node) {
+                if (node.raw_size) return;
+                size_t raw = node.value.size();
+                node.raw_size = ValueCompressor<Value>::compress(node.value, compression_.min_value_size);
+                if (node.raw_size) {
+                    metrics_.record_compression(raw, node.value.size());
+                }
+            });
+        }
+    }
+    
+    // Copies the entries in MRU-to-LRU order under the lock, then encodes
+    // and writes them on a background thread. Resolves to false on I/O error.
+    std::future<bool> save_snapshot(const std::string& path) const {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            records.reserve(node_list_.size());
+            for (const auto& node : node_list_) {
+                records.push_back({node.key, node.value, 0, node.raw_size});
+            }
+        }
+        return write_snapshot_async(path, SnapshotPolicy::LRU, 0, std::move(records));
+    }
+    
+    // Replaces the contents with a snapshot, keeping recency order. If the
+    // snapshot holds more than capacity() entries the most recent are kept.
+    bool load_snapshot(const std::string& path) {
+        std::vector<SnapshotRecord<Key, Value>> records;
+        uint64_t extra = 0;
+        if (!read_snapshot(path, SnapshotPolicy::LRU, extra, records)) return false;
+        
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_.clear();
+        node_list_.clear();
+        cold_.reset();
+        for (auto& r : records) {
+            if (node_list_.size() >= capacity_) break;
+            if (map_.find(r.key)) continue;
+            node_list_.push_back({std::move(r.key), std::move(r.value), {}});
+            auto it = std::prev(node_list_.end());
+            it->list_it = it;
+            map_.insert(it->key, it);
+        }
+        metrics_.set_size(map_.size());
+        return true;
+    }
+    
 private:
-    void evict() {
+    bool put_locked(const Key& key, const Value& value, Evicted& evicted) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        
+        auto* it = map_.find(key);
+        if (it) {
+            // Update existing
+            cold_.on_unlink(*it);
+            node_list_.splice(node_list_.begin(), node_list_, *it);
+            (*it)->value = value;
+            (*it)->raw_size = 0;
+        } else {
+            // Insert new
+            if (map_.size() >= limit_) {
+                evict(evicted);
+            }
+            node_list_.push_front({key, value, {}});
+            node_list_.front().list_it = node_list_.begin();
+            map_.insert(key, node_list_.begin());
+        }
+        metrics_.set_size(map_.size());
+        
+        return true;
+    }
+    
+    std::optional<Value> get_locked(const Key& key, bool count = true) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return lookup(key, count);
+    }
+    
+    // Caller holds mutex_ exclusively.
+    std::optional<Value> lookup(const Key& key, bool count = true) {
+        auto* it = map_.find(key);
+        if (!it) {
+            if (count) metrics_.record_miss();
+            return std::nullopt;
+        }
+        
+        // A value that no longer decompresses is dropped and reads as a miss.
+        if ((*it)->raw_size && !inflate(**it)) {
+            auto node = *it;
+            cold_.on_unlink(node);
+            map_.erase(key);
+            node_list_.erase(node);
+            metrics_.set_size(map_.size());
+            if (count) metrics_.record_miss();
+            return std::nullopt;
+        }
+        
+        // Move to front (most recently used)
+        cold_.on_unlink(*it);
+        node_list_.splice(node_list_.begin(), node_list_, *it);
+        if (count) metrics_.record_hit();
+        
+        return (*it)->value;
+    }
+    
+    // False, and counted, when the stored bytes do not decode.
+    bool inflate(Node& node) {
+        if (!ValueCompressor<Value>::decompress(node.value, node.raw_size)) {
+            metrics_.record_decompression_failure();
+            return false;
+        }
+        node.raw_size = 0;
+        metrics_.record_decompression();
+        return true;
+    }
+    
+    void evict(Evicted& evicted) {
         if (node_list_.empty()) return;
         
+        cold_.on_unlink(std::prev(node_list_.end()));
         auto& back = node_list_.back();
         map_.erase(back.key);
+        capture(back, evicted);
         node_list_.pop_back();
         metrics_.record_eviction();
     }
     
+    // The maintenance pass: evicts down to target, releasing the lock
+    // between batches, and destroys or hands off the victims unlocked.
+    void trim(size_t target) {
+        for (;;) {
+            NodeList dead;
+            std::vector<std::pair<Key, Value>> evicted;
+            auto* listener = eviction_listener_.load(std::memory_order_acquire);
+            bool more;
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                dead.splice(dead.end(), retired_);
+                for (size_t n = 0; n < batch_ && map_.size() > target; ++n) {
+                    auto last = std::prev(node_list_.end());
+                    cold_.on_unlink(last);
+                    map_.erase(last->key);
+                    if (listener) {
+                        if (!last->raw_size || inflate(*last)) {
+                            evicted.emplace_back(std::move(last->key), std::move(last->value));
+                        }
+                        node_list_.pop_back();
+                    } else {
+                        dead.splice(dead.end(), node_list_, last);
+                    }
+                    metrics_.record_eviction();
+                }
+                metrics_.set_size(map_.size());
+                more = map_.size() > target;
+            }
+            for (auto& e : evicted) {
+                listener->on_evict(e.first, std::move(e.second));
+            }
+            if (!more) return;
+        }
+    }
+    
+    struct Maintenance : MaintenanceTask {
+        explicit Maintenance(LRUCache& c) : cache(c) {}
+        void run() override { cache.trim(cache.low_water_); }
+        LRUCache& cache;
+    };
+    
+    // Keeps the victim only when someone is listening for it.
+    void capture(Node& node, Evicted& evicted) {
+        if (!eviction_listener_.load(std::memory_order_relaxed)) return;
+        if (node.raw_size && !inflate(node)) return;
+        evicted.emplace(std::move(node.key), std::move(node.value));
+    }
+    
     const size_t capacity_;
     NodeList node_list_;
     MapType map_;
+    ColdRegion<NodeList> cold_;
+    CompressionOptions compression_;
     mutable std::shared_mutex mutex_;
     Metrics metrics_;
+    Timing timing_;
+    std::atomic<AccessObserver<Key>*> observer_{nullptr};
+    std::atomic<EvictionListener<Key, Value>*> eviction_listener_{nullptr};
+    
+    // Deferred maintenance; limit_, low_water_, batch_ and retired_ are
+    // guarded by mutex_.
+    MaintenanceScheduler* scheduler_ = nullptr;
+    size_t limit_;       // size at which a put evicts inline
+    size_t low_water_ = 0;
+    size_t batch_ = 1;
+    NodeList retired_;   // unlinked nodes waiting to be freed off the request path
+    Maintenance maintenance_{*this};
 };
 
 } // namespace cache
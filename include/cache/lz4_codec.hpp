@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace cache {
+namespace lz4 {
+
+// Minimal LZ4 block-format codec (no frame header, no checksums).
+// The caller keeps the uncompressed size alongside the compressed bytes.
+
+// Upper bound on compressed output for an input of `size` bytes.
+inline size_t compress_bound(size_t size) { return size + size / 255 + 16; }
+
+// Compresses src into dst (which must hold compress_bound(size) bytes).
+// Returns the number of bytes written.
+size_t compress(const char* src, size_t size, char* dst);
+
+// Decompresses exactly raw_size bytes into dst.
+// Returns false if the input is malformed.
+bool decompress(const char* src, size_t size, char* dst, size_t raw_size);
+
+} // namespace lz4
+} // namespace cache
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cache {
+
+// How a cache attached to a MaintenanceScheduler defers its upkeep.
+struct MaintenanceOptions {
+    double low_water = 0.95; // of capacity; a maintenance pass evicts down to this
+    double overshoot = 0.05; // of capacity (at least 1 entry) a put may add before evicting inline
+    size_t batch = 32;       // evictions per lock hold
+};
+
+// Deferred upkeep owned by a cache. A task is queued at most once: while
+// it is waiting, schedule() is a single atomic exchange. It may be queued
+// again while running, so run() must be safe to call concurrently.
+class MaintenanceTask {
+public:
+    virtual ~MaintenanceTask() = default;
+    virtual void run() = 0;
+
+private:
+    friend class MaintenanceScheduler;
+    std::atomic<bool> queued_{false};
+    unsigned running_ = 0; // guarded by the scheduler's mutex
+};
+
+// A few worker threads that run the caches' maintenance tasks, such as
+// batched eviction and freeing evicted values, so request threads only
+// enqueue. Meant to be shared: one scheduler serves any number of caches
+// or shards, and shared() is a process-wide instance.
+class MaintenanceScheduler {
+public:
+    explicit MaintenanceScheduler(size_t threads = 1) {
+        threads = std::max<size_t>(threads, 1);
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    // Queued tasks are dropped; detach every cache first.
+    ~MaintenanceScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    // Never destroyed, so caches with static storage can still detach
+    // from it at exit.
+    static MaintenanceScheduler& shared() {
+        static MaintenanceScheduler* instance = new MaintenanceScheduler(1);
+        return *instance;
+    }
+
+    void schedule(MaintenanceTask& task) {
+        if (task.queued_.exchange(true, std::memory_order_acq_rel)) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                task.queued_.store(false, std::memory_order_release);
+                return;
+            }
+            queue_.push_back(&task);
+        }
+        cv_.notify_one();
+    }
+
+    // Unqueues the task and waits for any run in progress. Called by a
+    // cache detaching or being destroyed; it must not schedule the task
+    // again afterwards.
+    void cancel(MaintenanceTask& task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), &task), queue_.end());
+        task.queued_.store(false, std::memory_order_release);
+        idle_cv_.wait(lock, [&] { return task.running_ == 0; });
+    }
+
+    // Blocks until nothing is queued or running.
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return queue_.empty() && active_ == 0; });
+    }
+
+    size_t thread_count() const { return workers_.size(); }
+
+    uint64_t runs() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return runs_;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+            MaintenanceTask* task = queue_.front();
+            queue_.pop_front();
+            ++task->running_;
+            ++active_;
+            // Cleared before running: work that arrives meanwhile queues it again.
+            task->queued_.store(false, std::memory_order_release);
+            lock.unlock();
+            task->run();
+            lock.lock();
+            --task->running_;
+            --active_;
+            ++runs_;
+            idle_cv_.notify_all();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<MaintenanceTask*> queue_;
+    size_t active_ = 0;
+    uint64_t runs_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace cache
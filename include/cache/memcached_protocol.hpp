@@ -0,0 +1,36 @@
+#pragma once
+#include "protocol_handler.hpp"
+#include <string_view>
+#include <vector>
+
+namespace cache {
+
+// memcached text protocol: get, gets (multi-key), set, delete, version and
+// quit, with optional noreply. Lines may end in "\r\n" or "\n". Multi-key
+// gets go through ItemCache::get_many; expired items are dropped when read.
+class MemcachedHandler : public ProtocolHandler {
+public:
+    static constexpr size_t kMaxKeyBytes = 250;
+    static constexpr size_t kMaxLineBytes = 64 * 1024;
+
+    MemcachedHandler(ItemCache& cache, size_t max_item_bytes);
+
+    ProcessResult process(const char* data, size_t len, ReplyBuilder& out) override;
+
+private:
+    // Handles the request starting at p; returns bytes consumed, or 0 if
+    // the request is not complete yet.
+    size_t handle(const char* p, const char* end, ReplyBuilder& out, bool& close);
+    void handle_get(bool with_cas, ReplyBuilder& out);
+    size_t handle_set(const char* body, const char* end, ReplyBuilder& out);
+    void handle_delete(ReplyBuilder& out);
+
+    ItemCache& cache_;
+    const size_t max_item_bytes_;
+    size_t swallow_ = 0; // data bytes of a rejected set still to skip
+    int64_t now_ = 0;
+    std::vector<std::string_view> tokens_;
+    std::vector<std::string> keys_;
+};
+
+} // namespace cache
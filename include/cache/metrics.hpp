@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include "latency_histogram.hpp"
 
 #ifdef HAS_PROMETHEUS
 #include <prometheus/counter.h>
@@ -13,20 +14,43 @@
 
 namespace cache {
 
+enum class LatencyOp { Get, Put };
+
 class Metrics {
 public:
     Metrics(const std::string& cache_name = "default");
-    ~Metrics() = default;
+    ~Metrics();
+    
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
     
     void record_hit();
     void record_miss();
     void record_eviction();
-    void record_latency_ns(uint64_t latency_ns);
+    void record_latency_ns(LatencyOp op, uint64_t latency_ns);
     void set_size(size_t size);
+    void record_compression(size_t raw_bytes, size_t compressed_bytes);
+    void record_decompression();
+    void record_decompression_failure();
+    // Mutation records (and their bytes) shipped by a replication primary
+    // or applied by a replica, and how far behind the primary it is
+    void record_replication(uint64_t records, uint64_t bytes);
+    void set_replication_lag(uint64_t bytes);
     
     uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
     uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
     uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+    uint64_t size() const { return size_.load(std::memory_order_relaxed); }
+    const std::string& name() const { return name_; }
+    
+    uint64_t compressions() const { return compressions_.load(std::memory_order_relaxed); }
+    uint64_t decompressions() const { return decompressions_.load(std::memory_order_relaxed); }
+    // Compressed values that failed to decode and were dropped
+    uint64_t decompression_failures() const { return decompression_failures_.load(std::memory_order_relaxed); }
+    
+    uint64_t replicated_records() const { return replicated_records_.load(std::memory_order_relaxed); }
+    uint64_t replicated_bytes() const { return replicated_bytes_.load(std::memory_order_relaxed); }
+    uint64_t replication_lag() const { return replication_lag_.load(std::memory_order_relaxed); }
     
     double hit_rate() const {
         uint64_t h = hits();
@@ -34,10 +58,40 @@ public:
         return (h + m) > 0 ? static_cast<double>(h) / (h + m) : 0.0;
     }
     
+    // Latency at quantile p in [0, 1] (e.g. 0.999) for the given operation
+    uint64_t latency_percentile(LatencyOp op, double p) const {
+        return histogram(op).percentile(p);
+    }
+    
+    const LatencyHistogram& histogram(LatencyOp op) const {
+        return op == LatencyOp::Get ? get_latency_ : put_latency_;
+    }
+    
+    // Raw bytes per compressed byte over every value compressed so far
+    double compression_ratio() const {
+        uint64_t in = compressed_in_bytes();
+        uint64_t out = compressed_out_bytes();
+        return out > 0 ? static_cast<double>(in) / out : 0.0;
+    }
+    uint64_t compressed_in_bytes() const { return compressed_in_bytes_.load(std::memory_order_relaxed); }
+    uint64_t compressed_out_bytes() const { return compressed_out_bytes_.load(std::memory_order_relaxed); }
+    
 private:
+    std::string name_;
     std::atomic<uint64_t> hits_{0};
     std::atomic<uint64_t> misses_{0};
     std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> size_{0};
+    std::atomic<uint64_t> compressions_{0};
+    std::atomic<uint64_t> decompressions_{0};
+    std::atomic<uint64_t> decompression_failures_{0};
+    std::atomic<uint64_t> compressed_in_bytes_{0};
+    std::atomic<uint64_t> compressed_out_bytes_{0};
+    std::atomic<uint64_t> replicated_records_{0};
+    std::atomic<uint64_t> replicated_bytes_{0};
+    std::atomic<uint64_t> replication_lag_{0};
+    LatencyHistogram get_latency_;
+    LatencyHistogram put_latency_;
     
 #ifdef HAS_PROMETHEUS
     std::shared_ptr<prometheus::Registry> registry_;
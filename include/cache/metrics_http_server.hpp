@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace cache {
+
+// Minimal HTTP/1.0 listener serving MetricsRegistry::render_prometheus()
+// at /metrics from a background thread. Binds to localhost only; port 0
+// picks an ephemeral port (see port()). Not a general-purpose web server.
+class MetricsHttpServer {
+public:
+    explicit MetricsHttpServer(uint16_t port = 9464, const std::string& bind_address = "127.0.0.1");
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    // Throws std::system_error if the socket cannot be bound.
+    void start();
+    void stop();
+
+    uint16_t port() const { return port_; }
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+private:
+    void serve();
+    void handle(int client_fd);
+
+    uint16_t port_;
+    std::string bind_address_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace cache
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+class Metrics;
+
+// Process-wide list of live Metrics instances. Every Metrics registers
+// itself on construction, so any cache can be scraped without wiring.
+// The registry lock only guards membership; rendering reads the atomic
+// counters and never touches a cache lock.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    void add(const Metrics* metrics);
+    void remove(const Metrics* metrics);
+    size_t size() const;
+
+    // Sets the instance="<label>" of a registered Metrics; "" clears it.
+    void set_instance(const Metrics& metrics, const std::string& label);
+
+    // The instance label a registered Metrics is exported with.
+    std::string instance_of(const Metrics& metrics) const;
+
+    // Prometheus text exposition format (version 0.0.4) for every live
+    // cache, labelled cache="<name>" and, if not empty, instance="<label>",
+    // sorted by label. Each live Metrics is its own series: one whose
+    // labels are taken by another live Metrics, on add() or
+    // set_instance(), gets "<label>-<n>" (or "<n>") instead, with n never
+    // reused for that name and label. Counters therefore only rise for as
+    // long as a series exists, and values are never summed across caches.
+    std::string render_prometheus() const;
+
+private:
+    MetricsRegistry() = default;
+
+    struct Entry {
+        const Metrics* metrics;
+        std::string instance;
+    };
+
+    // `label`, or the next free "<label>-<n>" if another live Metrics
+    // than `self` has this name and label. Caller holds mutex_.
+    std::string unique_instance(const Metrics* self, const std::string& label);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> metrics_;
+    std::map<std::pair<std::string, std::string>, uint64_t> suffixes_; // last n per name and label
+};
+
+} // namespace cache
@@ -0,0 +1,84 @@
+#pragma once
+#include "access_observer.hpp"
+#include "hash_util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// Online LRU miss-ratio curve estimated with SHARDS spatial sampling
+// (Waldspurger et al., FAST '15). A key is tracked only when its hash falls
+// below a fixed threshold, so roughly sampling_rate of all distinct keys
+// are followed with every one of their references. Reuse (stack) distances
+// of sampled keys come from a Fenwick tree over access timestamps and are
+// scaled by 1 / sampling_rate to estimate distances in the full stream.
+class MissRatioCurve {
+public:
+    explicit MissRatioCurve(double sampling_rate = 0.001);
+
+    MissRatioCurve(const MissRatioCurve&) = delete;
+    MissRatioCurve& operator=(const MissRatioCurve&) = delete;
+
+    // Call for every reference; unsampled keys return after one compare.
+    void record(uint64_t key_hash) {
+        if ((key_hash & kSampleMask) < threshold_) record_sampled(key_hash);
+    }
+
+    template<typename Key>
+    void access(const Key& key) { record(hash_key(key)); }
+
+    // Estimated hit ratio of an LRU cache holding `capacity` entries.
+    double hit_ratio(size_t capacity) const;
+    double miss_ratio(size_t capacity) const { return 1.0 - hit_ratio(capacity); }
+
+    // (capacity, miss ratio) pairs at `points` evenly spaced capacities.
+    std::vector<std::pair<size_t, double>> curve(size_t max_capacity, size_t points) const;
+
+    double sampling_rate() const { return rate_; }
+    uint64_t sampled_references() const;
+    void reset();
+
+private:
+    static constexpr uint64_t kSampleBits = 24;
+    static constexpr uint64_t kSampleMask = (1ull << kSampleBits) - 1;
+
+    void record_sampled(uint64_t key_hash);
+    void fenwick_add(size_t pos, int64_t delta);
+    int64_t fenwick_prefix(size_t pos) const; // sum of [0, pos)
+    void compact();
+
+    double rate_;
+    uint64_t threshold_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, size_t> last_access_; // key hash -> timestamp
+    std::vector<int64_t> fenwick_;                     // 1 at each key's latest timestamp
+    size_t clock_ = 0;
+    std::vector<uint64_t> distance_counts_; // index = sampled stack distance - 1
+    uint64_t cold_misses_ = 0;
+    uint64_t references_ = 0;
+};
+
+// Adapts a MissRatioCurve to the caches' access hook. Lookups count as
+// references; puts only when count_puts is set (write-through workloads).
+template<typename Key>
+class MissRatioCurveObserver : public AccessObserver<Key> {
+public:
+    explicit MissRatioCurveObserver(MissRatioCurve& curve, bool count_puts = false)
+        : curve_(curve), count_puts_(count_puts) {}
+
+    void on_get(const Key& key, bool) override { curve_.access(key); }
+    void on_put(const Key& key) override {
+        if (count_puts_) curve_.access(key);
+    }
+
+private:
+    MissRatioCurve& curve_;
+    bool count_puts_;
+};
+
+} // namespace cache
@@ -0,0 +1,58 @@
+#pragma once
+#include "snapshot.hpp"
+#include <cstdint>
+#include <string>
+
+namespace cache {
+
+// Encoding of one cache mutation, shared by the write-ahead log and the
+// replication stream: an op byte followed by the key and, for puts, the
+// value, both in SnapshotCodec format.
+template<typename Key, typename Value>
+struct MutationCodec {
+    enum class Op : uint8_t { Put = 1, Remove = 2, Clear = 3 };
+
+    // Encoders return a per-thread buffer, so logging a mutation does not
+    // allocate. It stays valid until the thread's next encode.
+    static const std::string& put(const Key& key, const Value& value) {
+        std::string& record = scratch(Op::Put);
+        SnapshotCodec<Key>::write(record, key);
+        SnapshotCodec<Value>::write(record, value);
+        return record;
+    }
+
+    static const std::string& remove(const Key& key) {
+        std::string& record = scratch(Op::Remove);
+        SnapshotCodec<Key>::write(record, key);
+        return record;
+    }
+
+    static const std::string& clear() { return scratch(Op::Clear); }
+
+    // Applies one record to `cache`; malformed records are ignored.
+    template<typename Cache>
+    static void apply(Cache& cache, const char* p, const char* end) {
+        if (p == end) return;
+        Op op = static_cast<Op>(*p++);
+        Key key;
+        if (op == Op::Clear) {
+            cache.clear();
+        } else if (SnapshotCodec<Key>::read(p, end, key)) {
+            Value value;
+            if (op == Op::Remove) {
+                cache.remove(key);
+            } else if (op == Op::Put && SnapshotCodec<Value>::read(p, end, value)) {
+                cache.put(key, value);
+            }
+        }
+    }
+
+private:
+    static std::string& scratch(Op op) {
+        thread_local std::string record;
+        record.assign(1, static_cast<char>(op));
+        return record;
+    }
+};
+
+} // namespace cache
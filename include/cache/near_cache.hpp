@@ -0,0 +1,131 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "hash_util.hpp"
+#include "lru_cache.hpp"
+#include "per_thread.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cache {
+
+struct NearCacheOptions {
+    size_t l1_slots = 256;           // per thread, rounded up to a power of two
+    size_t version_stripes = 1024;   // rounded up to a power of two
+    uint32_t l2_touch_interval = 64; // every Nth L1 hit on a slot also reads L2
+};
+
+// Two-level cache: a shared L2 (LRUCache or ARCCache holding
+// shared_ptr<const Value>) behind a small direct-mapped L1 per thread.
+//
+// An L1 slot holds the key, a reference to the L2 entry's value and the
+// version of the key's stripe when it was filled. Every put(), remove()
+// and clear() bumps the affected stripe versions after changing L2, so a
+// slot is valid exactly while its version still matches; no thread ever
+// has to visit another thread's L1. An L1 hit reads the stripe version
+// and the immutable value and writes only thread-local memory, so hot keys
+// stop contending on the L2 lock and on its list links.
+//
+// L1 hits do not reach L2, so its policy would see hot keys as idle and
+// evict them. Every l2_touch_interval-th hit on a slot therefore goes
+// through L2 instead, which refreshes the key's recency there.
+//
+// Each thread's L1 lives until the thread exits (or, after the cache is
+// destroyed, until the thread next touches another NearCache of the same
+// type) and keeps the values it references alive that long. The cache
+// itself only tracks the L1s of live threads, for l1_hits(); an exiting
+// thread folds its hit count in and frees its L1.
+template<typename Key, typename Value, typename Cache = LRUCache<Key, std::shared_ptr<const Value>>>
+class NearCache : public CacheInterface<Key, Value> {
+    using Ref = std::shared_ptr<const Value>;
+
+public:
+    NearCache(size_t capacity, const NearCacheOptions& options = NearCacheOptions(),
+              const std::string& name = "near_cache")
+        : l2_(capacity, name)
+        , l1_slots_(round_up_pow2(options.l1_slots))
+        , touch_interval_(std::max<uint32_t>(options.l2_touch_interval, 1))
+        , versions_(options.version_stripes) {}
+
+    bool put(const Key& key, const Value& value) override {
+        bool stored = l2_.put(key, std::make_shared<const Value>(value));
+        versions_.invalidate(hash_key(key));
+        return stored;
+    }
+
+    std::optional<Value> get(const Key& key) override {
+        uint64_t h = hash_key(key);
+        auto& l1 = l1s_.get(l1_slots_);
+        Slot& slot = l1.state[h & (l1_slots_ - 1)];
+        // Loaded before L2 is read: a write racing with the fill bumps the
+        // version after changing L2, so the slot can only be stale-marked.
+        uint64_t version = versions_.version(h);
+        if (slot.value && slot.version == version && slot.key == key) {
+            if (++slot.hits % touch_interval_ != 0) {
+                l1.add_hits(1);
+                return *slot.value;
+            }
+        }
+        auto ref = l2_.get(key);
+        if (!ref || !*ref) {
+            if (slot.value && slot.key == key) slot.value.reset();
+            return std::nullopt;
+        }
+        if (!(slot.value && slot.key == key)) {
+            slot.key = key;
+            slot.hits = 0;
+        }
+        slot.value = std::move(*ref);
+        slot.version = version;
+        return *slot.value;
+    }
+
+    bool remove(const Key& key) override {
+        bool removed = l2_.remove(key);
+        versions_.invalidate(hash_key(key));
+        return removed;
+    }
+
+    void clear() override {
+        l2_.clear();
+        versions_.invalidate_all();
+    }
+
+    size_t size() const override { return l2_.size(); }
+    size_t capacity() const override { return l2_.capacity(); }
+    size_t hit_count() const override { return l2_.hit_count() + l1_hits(); }
+    size_t miss_count() const override { return l2_.miss_count(); }
+    size_t eviction_count() const override { return l2_.eviction_count(); }
+    double hit_rate() const override {
+        size_t hits = hit_count();
+        size_t total = hits + miss_count();
+        return total > 0 ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    // Hits served from a thread's L1 without touching L2, over all threads.
+    size_t l1_hits() const { return static_cast<size_t>(l1s_.hits()); }
+
+    // L2's metrics; L1 hits are only counted by l1_hits().
+    const Metrics& metrics() const { return l2_.metrics(); }
+    Cache& cache() { return l2_; }
+
+private:
+    struct Slot {
+        Key key{};
+        Ref value; // null when empty
+        uint64_t version = 0;
+        uint32_t hits = 0;
+    };
+
+    Cache l2_;
+    const size_t l1_slots_;
+    const uint32_t touch_interval_;
+    VersionStripes versions_;
+    PerThread<std::vector<Slot>> l1s_;
+};
+
+} // namespace cache
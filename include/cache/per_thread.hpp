@@ -0,0 +1,178 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+inline size_t round_up_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Versions for copies of cache entries kept outside the cache (NearCache's
+// per-thread L1, HotKeyCache's hot table). Keys hash onto a power-of-two
+// number of counters. A writer changes the cache first and then bumps the
+// key's stripe, so a copy taken at an older version is known to be stale
+// and a copy taken while a write was in flight can only be stale-marked.
+class VersionStripes {
+public:
+    explicit VersionStripes(size_t count)
+        : mask_(round_up_pow2(count) - 1)
+        , stripes_(new Stripe[mask_ + 1]) {}
+
+    // Read before the cache when taking a copy.
+    uint64_t version(uint64_t hash) const {
+        return stripe(hash).load(std::memory_order_acquire);
+    }
+
+    void invalidate(uint64_t hash) { stripe(hash).fetch_add(1, std::memory_order_release); }
+
+    void invalidate_all() {
+        for (size_t i = 0; i <= mask_; ++i) stripes_[i].version.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    // Own cache line each, so bumping one stripe does not invalidate the
+    // line other threads read for their keys.
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> version{0};
+    };
+
+    std::atomic<uint64_t>& stripe(uint64_t hash) const {
+        return stripes_[(hash >> 32) & mask_].version;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Stripe[]> stripes_;
+};
+
+// One T per thread for an owning object, plus a hit counter per thread
+// that the owner can total without a shared atomic on the read path.
+//
+// A thread finds its state through a thread_local list, with the last
+// owner it used cached in front. The state belongs to the thread: it is
+// freed when the thread exits, which first folds its hits into the
+// owner's total, or once the owner is gone and the thread next looks up
+// another owner of the same type. The owner only lists live threads'
+// states, to read their counters.
+template<typename T>
+class PerThread {
+public:
+    struct Local {
+        template<typename... Args>
+        explicit Local(Args&&... args) : state(std::forward<Args>(args)...) {}
+
+        // Owner thread only: a plain increment, no locked RMW.
+        void add_hits(uint64_t n) {
+            hits.store(hits.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        T state;
+        std::atomic<uint64_t> hits{0};
+    };
+
+    PerThread() : id_(next_id()) {}
+
+    PerThread(const PerThread&) = delete;
+    PerThread& operator=(const PerThread&) = delete;
+
+    // The calling thread's Local, constructing its T from args on first use.
+    template<typename... Args>
+    Local& get(Args&&... args) {
+        Tables& tables = this_thread();
+        if (tables.last_owner == id_) return *tables.last;
+        return attach(tables, std::forward<Args>(args)...);
+    }
+
+    // Hits over all threads, including ones that have exited.
+    uint64_t hits() const {
+        std::lock_guard<std::mutex> lock(registry_->mutex);
+        uint64_t hits = registry_->retired_hits;
+        for (const Local* local : registry_->live) hits += local->hits.load(std::memory_order_relaxed);
+        return hits;
+    }
+
+private:
+    // Shared with the threads' entries, so an exiting thread can tell
+    // whether the owner is still there to take its hits.
+    struct Registry {
+        std::mutex mutex;
+        std::vector<const Local*> live;
+        uint64_t retired_hits = 0;
+
+        void retire(const Local* local) {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired_hits += local->hits.load(std::memory_order_relaxed);
+            live.erase(std::find(live.begin(), live.end(), local));
+        }
+    };
+
+    // A thread's states, one per live owner of this type it has used.
+    struct Tables {
+        struct Entry {
+            uint64_t owner;
+            std::weak_ptr<Registry> registry; // expired once the owner is gone
+            std::unique_ptr<Local> local;
+        };
+        uint64_t last_owner = 0;
+        Local* last = nullptr;
+        std::vector<Entry> entries;
+
+        ~Tables() {
+            for (auto& e : entries) {
+                if (auto registry = e.registry.lock()) registry->retire(e.local.get());
+            }
+        }
+    };
+
+    // Outside get() so that every Args shares the one list.
+    static Tables& this_thread() {
+        thread_local Tables tables;
+        return tables;
+    }
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Slow path: find this owner's state for the calling thread, creating
+    // it on first use, and drop states whose owner has been destroyed.
+    template<typename... Args>
+    Local& attach(Tables& tables, Args&&... args) {
+        auto& entries = tables.entries;
+        Local* found = nullptr;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->registry.expired()) {
+                it = entries.erase(it);
+                continue;
+            }
+            if (it->owner == id_) found = it->local.get();
+            ++it;
+        }
+        if (!found) {
+            auto local = std::make_unique<Local>(std::forward<Args>(args)...);
+            found = local.get();
+            {
+                std::lock_guard<std::mutex> lock(registry_->mutex);
+                registry_->live.push_back(found);
+            }
+            entries.push_back({id_, registry_, std::move(local)});
+        }
+        tables.last_owner = id_;
+        tables.last = found;
+        return *found;
+    }
+
+    const uint64_t id_;
+    std::shared_ptr<Registry> registry_ = std::make_shared<Registry>();
+};
+
+} // namespace cache
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace cache {
+
+// Runs a callable on a dedicated thread at a fixed interval until destroyed.
+// Used to drive background maintenance steps such as compress_cold().
+class PeriodicTask {
+public:
+    PeriodicTask(std::chrono::milliseconds interval, std::function<void()> fn)
+        : interval_(interval)
+        , fn_(std::move(fn))
+        , thread_([this] { run(); }) {}
+
+    ~PeriodicTask() { stop(); }
+
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (cv_.wait_for(lock, interval_, [this] { return stopping_; })) break;
+            lock.unlock();
+            fn_();
+            lock.lock();
+        }
+    }
+
+    std::chrono::milliseconds interval_;
+    std::function<void()> fn_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace cache
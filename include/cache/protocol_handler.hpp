@@ -0,0 +1,126 @@
+#pragma once
+#include "sharded_cache.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <vector>
+
+namespace cache {
+
+// What the network front-ends store per key. The value bytes are immutable
+// and shared, so a reply can point at them while a concurrent set replaces
+// the entry.
+struct CacheItem {
+    std::shared_ptr<const std::string> data;
+    uint32_t flags = 0;
+    uint64_t cas = 0;
+    int64_t expires = 0; // unix seconds; 0 never expires
+
+    bool expired(int64_t now) const { return expires != 0 && expires <= now; }
+};
+
+using ItemCache = ShardedCache<std::string, CacheItem>;
+
+// Accumulates a connection's replies as a list of segments for one
+// gathered write. Small protocol text is copied into an internal buffer
+// (adjacent copies merge into one segment). Values are referenced in
+// place and pinned until written, so they are never copied.
+class ReplyBuilder {
+public:
+    void append(const char* data, size_t len) {
+        if (len == 0) return;
+        if (!segments_.empty() && !segments_.back().ptr &&
+            segments_.back().offset + segments_.back().len == buffer_.size()) {
+            segments_.back().len += len;
+        } else {
+            segments_.push_back({nullptr, buffer_.size(), len});
+        }
+        buffer_.append(data, len);
+    }
+
+    void append(std::string_view text) { append(text.data(), text.size()); }
+
+    // The value stays alive until the bytes referencing it are written.
+    void append_value(std::shared_ptr<const std::string> value) {
+        if (value->empty()) return;
+        segments_.push_back({value->data(), 0, value->size()});
+        pins_.push_back(std::move(value));
+    }
+
+    bool empty() const { return next_ == segments_.size(); }
+
+    size_t pending_bytes() const {
+        size_t total = 0;
+        for (size_t i = next_; i < segments_.size(); ++i) total += segments_[i].len;
+        return total - written_;
+    }
+
+    // Describes up to `max` unwritten segments; returns the count used.
+    int fill(iovec* iov, int max) const {
+        int n = 0;
+        for (size_t i = next_; i < segments_.size() && n < max; ++i, ++n) {
+            const Segment& s = segments_[i];
+            const char* base = s.ptr ? s.ptr : buffer_.data() + s.offset;
+            size_t skip = i == next_ ? written_ : 0;
+            iov[n].iov_base = const_cast<char*>(base + skip);
+            iov[n].iov_len = s.len - skip;
+        }
+        return n;
+    }
+
+    // Marks `bytes` as written; once everything is, storage is recycled.
+    void consume(size_t bytes) {
+        while (bytes > 0 && next_ < segments_.size()) {
+            size_t left = segments_[next_].len - written_;
+            if (bytes < left) {
+                written_ += bytes;
+                return;
+            }
+            bytes -= left;
+            written_ = 0;
+            ++next_;
+        }
+        if (next_ == segments_.size()) clear();
+    }
+
+    void clear() {
+        segments_.clear();
+        pins_.clear();
+        buffer_.clear();
+        next_ = 0;
+        written_ = 0;
+    }
+
+private:
+    struct Segment {
+        const char* ptr; // nullptr: bytes live in buffer_ at offset
+        size_t offset;
+        size_t len;
+    };
+
+    std::vector<Segment> segments_;
+    std::vector<std::shared_ptr<const std::string>> pins_;
+    std::string buffer_;
+    size_t next_ = 0;    // first unwritten segment
+    size_t written_ = 0; // bytes of segments_[next_] already written
+};
+
+struct ProcessResult {
+    size_t consumed = 0; // input bytes fully handled
+    size_t commands = 0;
+    bool close = false;  // close once the replies are flushed
+};
+
+// One instance per connection; parses and executes every complete request
+// at the front of the receive buffer and appends the replies to `out`.
+// Incomplete trailing input is left unconsumed for the next call.
+class ProtocolHandler {
+public:
+    virtual ~ProtocolHandler() = default;
+    virtual ProcessResult process(const char* data, size_t len, ReplyBuilder& out) = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,314 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "lru_cache.hpp"
+#include "metrics.hpp"
+#include "mutation_codec.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cache {
+
+// Asynchronous primary -> replica replication.
+//
+// The primary appends every mutation (MutationCodec records, each framed
+// as u32 length + bytes) to a ReplicationLog, a bounded in-memory backlog
+// addressed by byte offset since the log was created. Each connected
+// replica has a sender thread that ships whatever has accumulated since its
+// last position as one Batch frame, so a burst of writes costs one send per
+// replica rather than one per mutation. Writers never wait for replicas.
+//
+// A replica connects with the log id and offset it has applied up to. If
+// that range is still in the backlog the primary streams from there
+// (partial resync); otherwise it sends a snapshot taken at a known offset
+// and streams from that offset (full sync). Replicas ack the offset they
+// have applied, and the primary reports the slowest replica's lag.
+//
+// Wire format (native endianness, like snapshots):
+//   replica -> primary  "HPCREPL1" | u64 log id | u64 offset (~0: none)
+//                       then a u64 applied offset after every frame
+//   primary -> replica  u8 type | u64 payload length | payload
+//     Snapshot   u64 log id | u64 offset | snapshot file
+//     Batch      u64 start offset | u64 primary offset | records
+//     Heartbeat  u64 primary offset, sent when idle
+struct ReplicationOptions {
+    std::string bind_address = "127.0.0.1";          // primary
+    uint16_t port = 0;                               // primary; 0 picks one
+    size_t backlog_bytes = size_t(16) << 20;         // kept for partial resyncs
+    size_t max_batch_bytes = 256 * 1024;             // per Batch frame
+    std::chrono::milliseconds heartbeat{100};        // when there is nothing to send
+    std::chrono::milliseconds timeout{2000};         // replica drops a silent primary
+    std::chrono::milliseconds reconnect_delay{100};  // replica, doubled up to 32x
+    // Full-sync staging files go in a fresh 0700 directory made under this
+    // one by start(); "" means $TMPDIR, or /tmp.
+    std::string snapshot_dir;
+};
+
+constexpr uint64_t kNoReplicationOffset = ~uint64_t(0);
+
+// Ring buffer of framed records. Offsets keep counting across wrap-around;
+// the oldest ones are overwritten once backlog_bytes is exceeded.
+// Thread-safe.
+class ReplicationLog {
+public:
+    explicit ReplicationLog(size_t capacity);
+
+    // Random per log, so a restarted primary is never mistaken for the old one.
+    uint64_t id() const { return id_; }
+
+    // Appends one record; returns the offset just past it.
+    uint64_t append(const char* data, size_t len);
+    uint64_t head() const;
+
+    // Appends whole records from offset `from` to `out`: at most max_bytes,
+    // but always at least one record. Waits up to `wait` while there is
+    // nothing new. Returns false if `from` has been overwritten or is past
+    // the head, meaning the reader needs a full sync.
+    bool read(uint64_t from, size_t max_bytes, std::string& out, size_t& records,
+              std::chrono::milliseconds wait) const;
+
+private:
+    void copy_in(uint64_t offset, const char* src, size_t len);
+    void copy_out(uint64_t offset, char* dst, size_t len) const;
+
+    const uint64_t id_;
+    std::vector<char> ring_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable appended_;
+    uint64_t head_ = 0;
+    uint64_t tail_ = 0; // oldest offset still held
+};
+
+// Primary side: accepts replicas and runs one sender thread for each.
+// `snapshot` writes the cache to a path and returns the log offset it
+// reflects, or kNoReplicationOffset on failure.
+class ReplicationServer {
+public:
+    using SnapshotFn = std::function<uint64_t(const std::string& path)>;
+
+    ReplicationServer(const ReplicationLog& log, SnapshotFn snapshot,
+                      const ReplicationOptions& options, const std::string& name);
+    ~ReplicationServer();
+
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+    // Throws std::system_error if the port cannot be bound or the staging
+    // directory cannot be created.
+    void start();
+    void stop();
+    uint16_t port() const { return port_; }
+
+    size_t replicas() const;
+    uint64_t full_syncs() const { return full_syncs_.load(std::memory_order_relaxed); }
+    // Records and bytes shipped (summed over replicas), and log bytes the
+    // slowest replica has not acked.
+    const Metrics& metrics() const { return metrics_; }
+
+private:
+    struct Replica;
+
+    void accept_loop();
+    void serve(Replica& replica);
+    bool send_snapshot(int fd, uint64_t& offset);
+    bool read_acks(Replica& replica);
+    void update_lag();
+
+    const ReplicationLog& log_;
+    const SnapshotFn snapshot_;
+    const ReplicationOptions options_;
+    const std::string name_;
+    Metrics metrics_;
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread acceptor_;
+    mutable std::mutex replicas_mutex_;
+    std::list<std::unique_ptr<Replica>> replicas_;
+    std::atomic<uint64_t> full_syncs_{0};
+    std::atomic<uint64_t> snapshot_seq_{0};
+    std::string staging_dir_;
+};
+
+// Replica side: keeps a connection to the primary, reconnecting with
+// backoff, and hands snapshots and records to `Handler`, which is only
+// ever called from the client's thread.
+class ReplicationClient {
+public:
+    struct Handler {
+        std::function<bool(const std::string& path)> load_snapshot;
+        std::function<void(const char* record, size_t len)> apply;
+    };
+
+    // `primary` is "host:port"; throws std::invalid_argument if it does
+    // not resolve.
+    ReplicationClient(const std::string& primary, Handler handler,
+                      const ReplicationOptions& options, const std::string& name);
+    ~ReplicationClient();
+
+    ReplicationClient(const ReplicationClient&) = delete;
+    ReplicationClient& operator=(const ReplicationClient&) = delete;
+
+    // Throws std::system_error if the staging directory cannot be created.
+    void start();
+    void stop();
+
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+    // Offsets in the primary's current log; kNoReplicationOffset until the
+    // first sync.
+    uint64_t applied_offset() const { return applied_.load(std::memory_order_acquire); }
+    uint64_t primary_offset() const { return primary_.load(std::memory_order_relaxed); }
+    uint64_t full_syncs() const { return full_syncs_.load(std::memory_order_relaxed); }
+    uint64_t reconnects() const { return reconnects_.load(std::memory_order_relaxed); }
+
+    // Waits until everything up to `offset` has been applied.
+    bool wait_for(uint64_t offset, std::chrono::milliseconds timeout) const;
+
+    // Records and bytes applied, and bytes behind the primary.
+    const Metrics& metrics() const { return metrics_; }
+
+private:
+    void run();
+    void session(int fd);
+    bool receive_snapshot(int fd, uint64_t length);
+    bool receive_batch(int fd, uint64_t length);
+    bool ack(int fd);
+    void set_applied(uint64_t offset);
+
+    struct Address;
+    std::unique_ptr<Address> address_;
+    const Handler handler_;
+    const ReplicationOptions options_;
+    const std::string name_;
+    Metrics metrics_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::mutex fd_mutex_;
+    int fd_ = -1; // current session, shut down by stop()
+    std::atomic<bool> connected_{false};
+    uint64_t log_id_ = 0;
+    std::atomic<uint64_t> applied_{kNoReplicationOffset};
+    std::atomic<uint64_t> primary_{0};
+    std::atomic<uint64_t> full_syncs_{0};
+    std::atomic<uint64_t> reconnects_{0};
+    std::string batch_;
+    std::string staging_dir_;
+    mutable std::mutex wait_mutex_;
+    mutable std::condition_variable applied_cv_;
+};
+
+// Primary: a cache (LRUCache, LFUCache or ARCCache) whose put(), remove()
+// and clear() are logged for replicas in apply order. Evictions are not
+// logged; a replica of the same capacity and policy evicts on its own.
+// Serves replicas on options.port from construction on.
+template<typename Key, typename Value, typename Cache = LRUCache<Key, Value>>
+class ReplicatedCache : public CacheInterface<Key, Value> {
+    using Codec = MutationCodec<Key, Value>;
+
+public:
+    ReplicatedCache(size_t capacity, const ReplicationOptions& options = ReplicationOptions(),
+                    const std::string& name = "replicated_cache")
+        : cache_(capacity, name)
+        , log_(options.backlog_bytes)
+        , server_(log_, [this](const std::string& path) { return snapshot(path); }, options,
+                  name + "_replication") {
+        server_.start();
+    }
+
+    bool put(const Key& key, const Value& value) override {
+        const std::string& record = Codec::put(key, value);
+        // Log order must match apply order, so both happen under one lock.
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        log_.append(record.data(), record.size());
+        return cache_.put(key, value);
+    }
+
+    std::optional<Value> get(const Key& key) override { return cache_.get(key); }
+
+    bool remove(const Key& key) override {
+        const std::string& record = Codec::remove(key);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        log_.append(record.data(), record.size());
+        return cache_.remove(key);
+    }
+
+    void clear() override {
+        const std::string& record = Codec::clear();
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        log_.append(record.data(), record.size());
+        cache_.clear();
+    }
+
+    size_t size() const override { return cache_.size(); }
+    size_t capacity() const override { return cache_.capacity(); }
+    size_t hit_count() const override { return cache_.hit_count(); }
+    size_t miss_count() const override { return cache_.miss_count(); }
+    size_t eviction_count() const override { return cache_.eviction_count(); }
+    double hit_rate() const override { return cache_.hit_rate(); }
+
+    // Log offset of the latest mutation; replicas that reach it are current.
+    uint64_t offset() const { return log_.head(); }
+    uint16_t port() const { return server_.port(); }
+    Cache& cache() { return cache_; }
+    ReplicationServer& replication() { return server_; }
+
+private:
+    // save_snapshot() copies the records before returning, so holding the
+    // write lock across it pins the snapshot to exactly `offset`.
+    uint64_t snapshot(const std::string& path) {
+        std::future<bool> saved;
+        uint64_t offset;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            offset = log_.head();
+            saved = cache_.save_snapshot(path);
+        }
+        return saved.get() ? offset : kNoReplicationOffset;
+    }
+
+    Cache cache_;
+    ReplicationLog log_;
+    std::mutex write_mutex_;
+    ReplicationServer server_; // last: its threads use everything above
+};
+
+// Replica: a read-only copy of a ReplicatedCache, kept up to date in the
+// background. Reads see the primary's writes after the replication lag.
+template<typename Key, typename Value, typename Cache = LRUCache<Key, Value>>
+class CacheReplica {
+    using Codec = MutationCodec<Key, Value>;
+
+public:
+    CacheReplica(size_t capacity, const std::string& primary,
+                 const ReplicationOptions& options = ReplicationOptions(),
+                 const std::string& name = "cache_replica")
+        : cache_(capacity, name)
+        , client_(primary,
+                  {[this](const std::string& path) { return cache_.load_snapshot(path); },
+                   [this](const char* p, size_t len) { Codec::apply(cache_, p, p + len); }},
+                  options, name + "_replication") {
+        client_.start();
+    }
+
+    std::optional<Value> get(const Key& key) { return cache_.get(key); }
+    size_t size() const { return cache_.size(); }
+
+    Cache& cache() { return cache_; }
+    ReplicationClient& replication() { return client_; }
+
+private:
+    Cache cache_;
+    ReplicationClient client_; // last: its thread writes to cache_
+};
+
+} // namespace cache
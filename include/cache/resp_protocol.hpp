@@ -0,0 +1,63 @@
+#pragma once
+#include "protocol_handler.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cache {
+
+// Redis protocol (RESP2, and RESP3 after HELLO 3) over the same ItemCache
+// as the memcached front-end. Supports GET, SET [EX s | PX ms], DEL, MGET,
+// EXPIRE, PING, HELLO, COMMAND and QUIT, as multi-bulk or inline commands.
+//
+// process() parses every complete command in the buffer before running
+// any. Consecutive GET/MGET commands in a pipeline are then served by one
+// ItemCache::get_many, so each shard is locked once per run of reads.
+// Bulk replies reference the stored value buffers instead of copying them.
+// Expiry has one-second resolution; PX is rounded up.
+class RespHandler : public ProtocolHandler {
+public:
+    static constexpr size_t kMaxArgs = 1024 * 1024;
+    static constexpr size_t kMaxInlineBytes = 64 * 1024;
+
+    RespHandler(ItemCache& cache, size_t max_item_bytes);
+
+    ProcessResult process(const char* data, size_t len, ReplyBuilder& out) override;
+
+    int protocol_version() const { return version_; }
+
+private:
+    struct Command {
+        size_t first_arg;
+        size_t argc;
+    };
+
+    // Parses one command at p into args_/commands_. Returns bytes consumed,
+    // 0 if incomplete, and sets error_ on malformed input.
+    size_t parse(const char* p, const char* end);
+    size_t parse_multibulk(const char* p, const char* end);
+    size_t parse_inline(const char* p, const char* end);
+
+    bool is_batched_read(const Command& c) const;
+    // Serves commands_[first, last), all GET/MGET, with one get_many.
+    void run_reads(size_t first, size_t last, ReplyBuilder& out);
+    bool run(const Command& c, ReplyBuilder& out); // false: close after reply
+
+    void reply_value(const std::optional<CacheItem>& item, ReplyBuilder& out);
+    void reply_null(ReplyBuilder& out);
+    void reply_int(int64_t value, ReplyBuilder& out);
+    void reply_error(const std::string& message, ReplyBuilder& out);
+
+    std::string_view arg(const Command& c, size_t i) const { return args_[c.first_arg + i]; }
+
+    ItemCache& cache_;
+    const size_t max_item_bytes_;
+    int version_ = 2;
+    int64_t now_ = 0;
+    std::string error_;
+    std::vector<std::string_view> args_;
+    std::vector<Command> commands_;
+    std::vector<std::string> keys_;
+};
+
+} // namespace cache
@@ -0,0 +1,159 @@
+#pragma once
+#include "access_observer.hpp"
+#include "arc_cache.hpp"
+#include "hash_util.hpp"
+#include "lfu_cache.hpp"
+#include "lru_cache.hpp"
+#include "../lockfree/bounded_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace cache {
+
+enum class ShadowPolicy { LRU, LFU, ARC };
+
+// Background hands samples to a worker thread and may drop them under
+// load; Inline replays them on the calling thread, which is deterministic
+// and suits owners that act on the projections (see AdaptiveCache).
+enum class ShadowMode { Background, Inline };
+
+// "What-if" simulators that run beside a live cache. Attached as the
+// cache's AccessObserver, it spatially samples keys by hash (as in
+// MissRatioCurve) and hands the sampled key hashes, never values, to a
+// background thread through a lock-free queue. That thread replays each
+// lookup as a demand fill (get, then put on a miss), and each put of a key
+// the ghost does not hold as an insert, into miniature LRU, LFU and ARC
+// caches scaled down by the sampling rate
+// (Waldspurger et al., "Cache Modeling and Optimization using Miniature
+// Simulations", ATC '17). Each miniature cache registers its own Metrics,
+// named "<name>_shadow_<policy>", so projected hit rates are exported
+// like any other cache. If the queue is full, samples are dropped and
+// counted rather than blocking the request thread.
+template<typename Key>
+class ShadowSimulator : public AccessObserver<Key> {
+public:
+    static constexpr size_t kQueueCapacity = 1 << 16;
+
+    ShadowSimulator(size_t live_capacity, double sampling_rate = 0.01,
+                    const std::string& name = "cache", ShadowMode mode = ShadowMode::Background)
+        : mode_(mode)
+        , rate_(std::min(1.0, std::max(sampling_rate, 1.0 / (kSampleMask + 1))))
+        , threshold_(static_cast<uint64_t>(std::ceil(rate_ * (kSampleMask + 1))))
+        , queue_(kQueueCapacity)
+        , lru_(scaled(live_capacity), name + "_shadow_lru")
+        , lfu_(scaled(live_capacity), name + "_shadow_lfu")
+        , arc_(scaled(live_capacity), name + "_shadow_arc") {
+        if (mode_ == ShadowMode::Background) {
+            worker_ = std::thread([this] { run(); });
+        }
+    }
+
+    ~ShadowSimulator() override {
+        stopping_.store(true, std::memory_order_release);
+        if (worker_.joinable()) worker_.join();
+    }
+
+    ShadowSimulator(const ShadowSimulator&) = delete;
+    ShadowSimulator& operator=(const ShadowSimulator&) = delete;
+
+    void on_get(const Key& key, bool) override { offer(key, true); }
+    // Ghosts fill themselves on a miss, so the put that follows a live
+    // miss must not count as a second reference (it would promote ARC
+    // entries to T2 and bump LFU frequencies). A put of a key the ghost
+    // does not hold, as in write-first traffic, still inserts it.
+    void on_put(const Key& key) override { offer(key, false); }
+
+    // Hit rate the live cache would see under `policy`, from sampled keys.
+    double projected_hit_rate(ShadowPolicy policy) const { return metrics(policy).hit_rate(); }
+
+    const Metrics& metrics(ShadowPolicy policy) const {
+        switch (policy) {
+            case ShadowPolicy::LFU: return lfu_.metrics();
+            case ShadowPolicy::ARC: return arc_.metrics();
+            default: return lru_.metrics();
+        }
+    }
+
+    double sampling_rate() const { return rate_; }
+    uint64_t dropped_samples() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t replayed_samples() const { return replayed_.load(std::memory_order_relaxed); }
+
+    // Blocks until every sample queued so far has been replayed.
+    void drain() {
+        while (queued_.load(std::memory_order_acquire) != replayed_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr uint64_t kSampleMask = (1ull << 24) - 1;
+    static constexpr auto kIdleSleep = std::chrono::microseconds(200);
+
+    struct Sample {
+        uint64_t key_hash;
+        bool is_get;
+    };
+
+    size_t scaled(size_t live_capacity) const {
+        return std::max<size_t>(1, static_cast<size_t>(std::llround(live_capacity * rate_)));
+    }
+
+    void offer(const Key& key, bool is_get) {
+        uint64_t h = hash_key(key);
+        if ((h & kSampleMask) >= threshold_) return;
+        if (mode_ == ShadowMode::Inline) {
+            queued_.fetch_add(1, std::memory_order_relaxed);
+            replay({h, is_get});
+        } else if (queue_.try_push({h, is_get})) {
+            queued_.fetch_add(1, std::memory_order_release);
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void run() {
+        Sample s;
+        while (true) {
+            if (!queue_.try_pop(s)) {
+                if (stopping_.load(std::memory_order_acquire)) return;
+                std::this_thread::sleep_for(kIdleSleep);
+                continue;
+            }
+            replay(s);
+        }
+    }
+
+    void replay(const Sample& s) {
+        replay(lru_, s);
+        replay(lfu_, s);
+        replay(arc_, s);
+        replayed_.fetch_add(1, std::memory_order_release);
+    }
+
+    template<typename Ghost>
+    static void replay(Ghost& ghost, const Sample& s) {
+        if (s.is_get ? !ghost.get(s.key_hash) : !ghost.contains(s.key_hash)) {
+            ghost.put(s.key_hash, 1);
+        }
+    }
+
+    ShadowMode mode_;
+    double rate_;
+    uint64_t threshold_;
+    BoundedQueue<Sample> queue_;
+    LRUCache<uint64_t, uint8_t, NoTiming> lru_;
+    LFUCache<uint64_t, uint8_t, NoTiming> lfu_;
+    ARCCache<uint64_t, uint8_t, NoTiming> arc_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> queued_{0};
+    std::atomic<uint64_t> replayed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread worker_;
+};
+
+} // namespace cache
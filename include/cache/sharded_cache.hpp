@@ -0,0 +1,120 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "hash_util.hpp"
+#include "lru_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cache {
+
+// Splits a cache into independently locked shards so threads touching
+// different keys do not convoy on one mutex. Keys are routed by the high
+// bits of a mixed hash; each shard is a full policy cache holding
+// ceil(capacity / shards) entries, so eviction is per shard (approximate
+// global policy), and capacity() reports the rounded-up total. Shards
+// register their own Metrics as name_<i>.
+template<typename Key, typename Value, typename Shard = LRUCache<Key, Value>>
+class ShardedCache : public CacheInterface<Key, Value> {
+public:
+    // shard_count is rounded up to a power of two; 0 picks one shard per
+    // hardware thread.
+    explicit ShardedCache(size_t capacity, size_t shard_count = 0,
+                          const std::string& name = "sharded_cache") {
+        if (shard_count == 0) shard_count = std::max(1u, std::thread::hardware_concurrency());
+        size_t count = 1;
+        while (count < shard_count) {
+            count <<= 1;
+            ++bits_;
+        }
+        size_t per_shard = (capacity + count - 1) / count;
+        capacity_ = per_shard * count;
+        shards_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            shards_.push_back(std::make_unique<Shard>(per_shard, name + "_" + std::to_string(i)));
+        }
+    }
+
+    bool put(const Key& key, const Value& value) override { return shard_for(key).put(key, value); }
+    std::optional<Value> get(const Key& key) override { return shard_for(key).get(key); }
+    std::optional<Value> get_uncounted(const Key& key) { return shard_for(key).get_uncounted(key); }
+    bool remove(const Key& key) override { return shard_for(key).remove(key); }
+
+    // Groups the batch by shard so each shard serves its keys in one call.
+    std::vector<std::optional<Value>> get_many(const std::vector<Key>& keys) override {
+        if (shards_.size() == 1) return shards_[0]->get_many(keys);
+        std::vector<std::vector<size_t>> groups(shards_.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            groups[shard_index(keys[i])].push_back(i);
+        }
+        std::vector<std::optional<Value>> results(keys.size());
+        std::vector<Key> batch;
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            if (groups[s].empty()) continue;
+            batch.clear();
+            for (size_t i : groups[s]) batch.push_back(keys[i]);
+            auto found = shards_[s]->get_many(batch);
+            for (size_t j = 0; j < found.size(); ++j) {
+                results[groups[s][j]] = std::move(found[j]);
+            }
+        }
+        return results;
+    }
+
+    void clear() override {
+        for (auto& s : shards_) s->clear();
+    }
+
+    // Round-robins over shards so migration drains them evenly.
+    std::optional<std::pair<Key, Value>> take_victim() override {
+        size_t start = victim_cursor_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            if (auto victim = shards_[(start + i) & (shards_.size() - 1)]->take_victim()) {
+                return victim;
+            }
+        }
+        return std::nullopt;
+    }
+
+    size_t size() const override { return sum([](const Shard& s) { return s.size(); }); }
+    size_t capacity() const override { return capacity_; }
+    size_t hit_count() const override { return sum([](const Shard& s) { return s.hit_count(); }); }
+    size_t miss_count() const override { return sum([](const Shard& s) { return s.miss_count(); }); }
+    size_t eviction_count() const override {
+        return sum([](const Shard& s) { return s.eviction_count(); });
+    }
+
+    double hit_rate() const override {
+        size_t hits = hit_count();
+        size_t total = hits + miss_count();
+        return total > 0 ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    size_t shard_count() const { return shards_.size(); }
+    Shard& shard(size_t i) { return *shards_[i]; }
+    const Shard& shard(size_t i) const { return *shards_[i]; }
+
+    size_t shard_index(const Key& key) const {
+        return bits_ == 0 ? 0 : static_cast<size_t>(hash_key(key) >> (64 - bits_));
+    }
+
+    Shard& shard_for(const Key& key) { return *shards_[shard_index(key)]; }
+
+private:
+    template<typename Fn>
+    size_t sum(Fn fn) const {
+        size_t total = 0;
+        for (const auto& s : shards_) total += fn(*s);
+        return total;
+    }
+
+    size_t capacity_ = 0;
+    unsigned bits_ = 0;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> victim_cursor_{0};
+};
+
+} // namespace cache
@@ -0,0 +1,391 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "hash_util.hpp"
+#include "metrics.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+
+namespace cache {
+
+// LRU cache whose entire state lives in one shared memory region, so all
+// processes on a host that attach to the same region share a single cache.
+//
+// The region holds a header, a bucket array and a fixed slab of `capacity`
+// slots. Hash chains and the recency list link slots by 32-bit index rather
+// than by pointer, so each process may map the region at a different
+// address. Every operation takes one process-shared robust mutex. If a
+// process dies while holding it, the next locker cannot trust the links, so
+// it clears the cache and carries on (counted in recoveries()).
+//
+// `region` is a POSIX shared memory name ("/sessions"), or a file path to
+// mmap if it contains another '/' (e.g. a file on tmpfs or hugetlbfs). The
+// first process creates and initialises the region. Later processes,
+// including a restarted worker, attach to the live contents as they are.
+// The region outlives every process until remove_region() is called.
+//
+// Keys and values are copied into the slab, so both must be trivially
+// copyable, and every attacher must use the same Key, Value and capacity.
+template<typename Key, typename Value>
+class SharedMemoryCache : public CacheInterface<Key, Value> {
+private:
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "SharedMemoryCache stores keys and values by value in shared memory");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "the ready flag must be address-free to live in shared memory");
+
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr uint64_t kMagic = 0x313048534D435048ull; // "HPCSMH01"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr auto kAttachTimeout = std::chrono::seconds(5);
+
+    struct Header {
+        std::atomic<uint64_t> magic; // stored last by the creating process
+        uint32_t version;
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t capacity;
+        uint32_t bucket_count;
+        pthread_mutex_t mutex;
+        uint32_t head;      // most recently used
+        uint32_t tail;      // least recently used
+        uint32_t free_head;
+        uint32_t size;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t recoveries;
+    };
+
+    struct Slot {
+        Key key;
+        Value value;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t chain; // next slot in the same bucket
+    };
+
+public:
+    SharedMemoryCache(const std::string& region, size_t capacity,
+                      const std::string& name = "shm_cache")
+        : region_(region)
+        , metrics_(name) {
+        if (capacity == 0 || capacity >= kNil) {
+            throw std::invalid_argument("SharedMemoryCache: capacity out of range");
+        }
+        capacity_ = static_cast<uint32_t>(capacity);
+        bucket_count_ = 1;
+        while (bucket_count_ < capacity_) bucket_count_ <<= 1;
+        bytes_ = slots_offset() + sizeof(Slot) * capacity_;
+        attach();
+        metrics_.set_size(size());
+    }
+
+    ~SharedMemoryCache() override {
+        ::munmap(base_, bytes_);
+    }
+
+    SharedMemoryCache(const SharedMemoryCache&) = delete;
+    SharedMemoryCache& operator=(const SharedMemoryCache&) = delete;
+
+    bool put(const Key& key, const Value& value) override {
+        uint32_t bucket = bucket_of(key);
+        Locked lock(*this);
+        uint32_t i = find(bucket, key);
+        if (i != kNil) {
+            slots_[i].value = value;
+            move_to_front(i);
+            return true;
+        }
+        if (header_->free_head == kNil) {
+            evict_tail();
+        }
+        i = header_->free_head;
+        header_->free_head = slots_[i].next;
+        slots_[i].key = key;
+        slots_[i].value = value;
+        slots_[i].chain = buckets_[bucket];
+        buckets_[bucket] = i;
+        push_front(i);
+        ++header_->size;
+        metrics_.set_size(header_->size);
+        return true;
+    }
+
+    std::optional<Value> get(const Key& key) override {
+        uint32_t bucket = bucket_of(key);
+        Locked lock(*this);
+        uint32_t i = find(bucket, key);
+        if (i == kNil) {
+            ++header_->misses;
+            metrics_.record_miss();
+            return std::nullopt;
+        }
+        move_to_front(i);
+        ++header_->hits;
+        metrics_.record_hit();
+        return slots_[i].value;
+    }
+
+    bool remove(const Key& key) override {
+        uint32_t bucket = bucket_of(key);
+        Locked lock(*this);
+        uint32_t i = find(bucket, key);
+        if (i == kNil) return false;
+        release(bucket, i);
+        metrics_.set_size(header_->size);
+        return true;
+    }
+
+    void clear() override {
+        Locked lock(*this);
+        reset();
+        metrics_.set_size(0);
+    }
+
+    std::optional<std::pair<Key, Value>> take_victim() override {
+        Locked lock(*this);
+        uint32_t i = header_->tail;
+        if (i == kNil) return std::nullopt;
+        std::pair<Key, Value> victim(slots_[i].key, slots_[i].value);
+        release(bucket_of(victim.first), i);
+        metrics_.set_size(header_->size);
+        return victim;
+    }
+
+    size_t size() const override {
+        Locked lock(*this);
+        return header_->size;
+    }
+
+    size_t capacity() const override { return capacity_; }
+
+    // Counters are shared by every attached process. metrics() holds only
+    // this process's view, exported under the cache name.
+    size_t hit_count() const override { return read_counter(&Header::hits); }
+    size_t miss_count() const override { return read_counter(&Header::misses); }
+    size_t eviction_count() const override { return read_counter(&Header::evictions); }
+    size_t recoveries() const { return read_counter(&Header::recoveries); }
+
+    double hit_rate() const override {
+        Locked lock(*this);
+        uint64_t total = header_->hits + header_->misses;
+        return total > 0 ? static_cast<double>(header_->hits) / total : 0.0;
+    }
+
+    const Metrics& metrics() const { return metrics_; }
+
+    // True if this instance created the region rather than attaching to it.
+    bool created() const { return created_; }
+
+    // Deletes the region name; processes still attached keep their mapping.
+    static bool remove_region(const std::string& region) {
+        return is_file(region) ? ::unlink(region.c_str()) == 0
+                               : ::shm_unlink(region.c_str()) == 0;
+    }
+
+private:
+    // Holds the region mutex, recovering it if its previous owner died.
+    class Locked {
+    public:
+        explicit Locked(const SharedMemoryCache& c) : c_(const_cast<SharedMemoryCache&>(c)) {
+            int rc = ::pthread_mutex_lock(&c_.header_->mutex);
+            if (rc == EOWNERDEAD) {
+                c_.reset();
+                ++c_.header_->recoveries;
+                ::pthread_mutex_consistent(&c_.header_->mutex);
+            } else if (rc != 0) {
+                throw std::system_error(rc, std::generic_category(), "SharedMemoryCache: lock");
+            }
+        }
+        ~Locked() { ::pthread_mutex_unlock(&c_.header_->mutex); }
+
+    private:
+        SharedMemoryCache& c_;
+    };
+
+    static bool is_file(const std::string& region) {
+        return region.find('/', 1) != std::string::npos;
+    }
+
+    static size_t align_up(size_t n) { return (n + 63) & ~size_t(63); }
+    size_t buckets_offset() const { return align_up(sizeof(Header)); }
+    size_t slots_offset() const { return align_up(buckets_offset() + sizeof(uint32_t) * bucket_count_); }
+
+    int open_region(int flags) const {
+        return is_file(region_) ? ::open(region_.c_str(), flags, 0600)
+                                : ::shm_open(region_.c_str(), flags, 0600);
+    }
+
+    void attach() {
+        int fd = open_region(O_RDWR | O_CREAT | O_EXCL);
+        created_ = fd >= 0;
+        if (!created_ && errno == EEXIST) {
+            fd = open_region(O_RDWR);
+        }
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "SharedMemoryCache: open " + region_);
+        }
+        if (created_ && ::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+            int err = errno;
+            ::close(fd);
+            remove_region(region_);
+            throw std::system_error(err, std::generic_category(), "SharedMemoryCache: size " + region_);
+        }
+        if (!created_ && !wait_for_size(fd)) {
+            ::close(fd);
+            throw std::runtime_error("SharedMemoryCache: " + region_ + " has a different layout");
+        }
+        void* map = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            throw std::system_error(err, std::generic_category(), "SharedMemoryCache: mmap " + region_);
+        }
+        base_ = static_cast<char*>(map);
+        header_ = reinterpret_cast<Header*>(base_);
+        buckets_ = reinterpret_cast<uint32_t*>(base_ + buckets_offset());
+        slots_ = reinterpret_cast<Slot*>(base_ + slots_offset());
+        if (created_) {
+            initialise();
+        } else if (!wait_until_ready() || !layout_matches()) {
+            ::munmap(base_, bytes_);
+            throw std::runtime_error("SharedMemoryCache: " + region_ + " is not a matching cache region");
+        }
+    }
+
+    // The creator sizes the file right after creating it; a size other
+    // than ours means a different capacity or Key/Value layout.
+    bool wait_for_size(int fd) const {
+        auto deadline = std::chrono::steady_clock::now() + kAttachTimeout;
+        struct stat st;
+        while (::fstat(fd, &st) == 0) {
+            if (st.st_size != 0) return static_cast<size_t>(st.st_size) == bytes_;
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    bool wait_until_ready() const {
+        auto deadline = std::chrono::steady_clock::now() + kAttachTimeout;
+        while (header_->magic.load(std::memory_order_acquire) != kMagic) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    bool layout_matches() const {
+        return header_->version == kVersion &&
+               header_->key_size == sizeof(Key) &&
+               header_->value_size == sizeof(Value) &&
+               header_->capacity == capacity_ &&
+               header_->bucket_count == bucket_count_;
+    }
+
+    void initialise() {
+        // ftruncate zero-fills, so only non-zero fields need setting.
+        header_->version = kVersion;
+        header_->key_size = sizeof(Key);
+        header_->value_size = sizeof(Value);
+        header_->capacity = capacity_;
+        header_->bucket_count = bucket_count_;
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        ::pthread_mutex_init(&header_->mutex, &attr);
+        ::pthread_mutexattr_destroy(&attr);
+        reset();
+        header_->magic.store(kMagic, std::memory_order_release);
+    }
+
+    // Empties the cache: every bucket nil, every slot on the free list.
+    void reset() {
+        for (uint32_t b = 0; b < bucket_count_; ++b) buckets_[b] = kNil;
+        for (uint32_t i = 0; i < capacity_; ++i) {
+            slots_[i].next = i + 1 < capacity_ ? i + 1 : kNil;
+        }
+        header_->free_head = 0;
+        header_->head = kNil;
+        header_->tail = kNil;
+        header_->size = 0;
+    }
+
+    size_t read_counter(uint64_t Header::*counter) const {
+        Locked lock(*this);
+        return header_->*counter;
+    }
+
+    uint32_t bucket_of(const Key& key) const {
+        return static_cast<uint32_t>(hash_key(key) & (bucket_count_ - 1));
+    }
+
+    uint32_t find(uint32_t bucket, const Key& key) const {
+        uint32_t i = buckets_[bucket];
+        while (i != kNil && !(slots_[i].key == key)) i = slots_[i].chain;
+        return i;
+    }
+
+    void unlink(uint32_t i) {
+        Slot& s = slots_[i];
+        if (s.prev != kNil) slots_[s.prev].next = s.next; else header_->head = s.next;
+        if (s.next != kNil) slots_[s.next].prev = s.prev; else header_->tail = s.prev;
+    }
+
+    void push_front(uint32_t i) {
+        slots_[i].prev = kNil;
+        slots_[i].next = header_->head;
+        if (header_->head != kNil) slots_[header_->head].prev = i; else header_->tail = i;
+        header_->head = i;
+    }
+
+    void move_to_front(uint32_t i) {
+        if (header_->head == i) return;
+        unlink(i);
+        push_front(i);
+    }
+
+    // Unlinks slot i from its chain and the recency list and frees it.
+    void release(uint32_t bucket, uint32_t i) {
+        uint32_t* link = &buckets_[bucket];
+        while (*link != i) link = &slots_[*link].chain;
+        *link = slots_[i].chain;
+        unlink(i);
+        slots_[i].next = header_->free_head;
+        header_->free_head = i;
+        --header_->size;
+    }
+
+    void evict_tail() {
+        uint32_t i = header_->tail;
+        release(bucket_of(slots_[i].key), i);
+        ++header_->evictions;
+        metrics_.record_eviction();
+    }
+
+    const std::string region_;
+    uint32_t capacity_ = 0;
+    uint32_t bucket_count_ = 0;
+    size_t bytes_ = 0;
+    bool created_ = false;
+    char* base_ = nullptr;
+    Header* header_ = nullptr;
+    uint32_t* buckets_ = nullptr;
+    Slot* slots_ = nullptr;
+    Metrics metrics_;
+};
+
+} // namespace cache
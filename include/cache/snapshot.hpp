@@ -0,0 +1,238 @@
+#pragma once
+#include "value_compression.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace cache {
+
+// Binary snapshot support for warm restarts.
+//
+// File layout (native endianness; snapshots are not portable across
+// architectures):
+//   SnapshotHeader
+//   records          key | value | u64 meta, in the policy's list order
+//   chunk index      u64 file offset of every kSnapshotChunk-th record
+// The chunk index lets load_snapshot() decode chunks on several threads
+// straight out of an mmap of the file.
+
+// Per-type encoding. Trivially copyable types are stored as raw bytes and
+// std::string as a u32 length followed by its bytes.
+template<typename T, typename Enable = void>
+struct SnapshotCodec {
+    static constexpr bool supported = false;
+};
+
+template<typename T>
+struct SnapshotCodec<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+    static constexpr bool supported = true;
+    static constexpr uint32_t fixed_size = sizeof(T);
+
+    static void write(std::string& out, const T& v) {
+        out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    static bool read(const char*& p, const char* end, T& v) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+template<>
+struct SnapshotCodec<std::string> {
+    static constexpr bool supported = true;
+    static constexpr uint32_t fixed_size = 0;
+
+    static void write(std::string& out, const std::string& v) {
+        uint32_t n = static_cast<uint32_t>(v.size());
+        out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+        out.append(v.data(), n);
+    }
+
+    static bool read(const char*& p, const char* end, std::string& v) {
+        uint32_t n;
+        if (static_cast<size_t>(end - p) < sizeof(n)) return false;
+        std::memcpy(&n, p, sizeof(n));
+        p += sizeof(n);
+        if (static_cast<size_t>(end - p) < n) return false;
+        v.assign(p, n);
+        p += n;
+        return true;
+    }
+};
+
+enum class SnapshotPolicy : uint32_t { LRU = 1, LFU = 2, ARC = 3 };
+
+// One entry in list order. `meta` is policy specific (LFU frequency, ARC
+// list); `raw_size` is non-zero while `value` still holds compressed bytes.
+template<typename Key, typename Value>
+struct SnapshotRecord {
+    Key key;
+    Value value;
+    uint64_t meta = 0;
+    uint32_t raw_size = 0;
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t policy;
+    uint64_t count;
+    uint64_t extra;      // policy state, e.g. ARC's p_
+    uint32_t key_size;   // sizeof(Key), or 0 for variable-length keys
+    uint32_t value_size;
+    uint64_t chunk_count;
+    uint64_t index_offset;
+};
+
+constexpr char kSnapshotMagic[8] = {'H', 'P', 'C', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kSnapshotChunk = 65536;
+
+// Encodes records (already copied out of the cache under its lock) and
+// writes them to path on a background thread. The file is written to
+// path.tmp, fsync'd and renamed, so a crash never leaves a torn snapshot.
+template<typename Key, typename Value>
+std::future<bool> write_snapshot_async(const std::string& path, SnapshotPolicy policy, uint64_t extra,
+                                       std::vector<SnapshotRecord<Key, Value>> records) {
+    static_assert(SnapshotCodec<Key>::supported && SnapshotCodec<Value>::supported,
+                  "snapshots support trivially copyable and std::string keys/values");
+    return std::async(std::launch::async, [path, policy, extra, records = std::move(records)]() mutable {
+        std::string tmp = path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.version = kSnapshotVersion;
+        header.policy = static_cast<uint32_t>(policy);
+        header.count = records.size();
+        header.extra = extra;
+        header.key_size = SnapshotCodec<Key>::fixed_size;
+        header.value_size = SnapshotCodec<Value>::fixed_size;
+        header.chunk_count = (records.size() + kSnapshotChunk - 1) / kSnapshotChunk;
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+        std::vector<uint64_t> index;
+        index.reserve(header.chunk_count);
+        uint64_t offset = sizeof(header);
+        std::string buf;
+        for (size_t i = 0; ok && i < records.size(); ++i) {
+            if (i % kSnapshotChunk == 0) {
+                ok = buf.empty() || std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+                offset += buf.size();
+                buf.clear();
+                index.push_back(offset);
+            }
+            auto& r = records[i];
+            // A value that no longer decompresses fails the save rather
+            // than writing compressed bytes a load would take as raw.
+            if (r.raw_size && !ValueCompressor<Value>::decompress(r.value, r.raw_size)) {
+                ok = false;
+                break;
+            }
+            SnapshotCodec<Key>::write(buf, r.key);
+            SnapshotCodec<Value>::write(buf, r.value);
+            buf.append(reinterpret_cast<const char*>(&r.meta), sizeof(r.meta));
+        }
+        ok = ok && (buf.empty() || std::fwrite(buf.data(), 1, buf.size(), f) == buf.size());
+        header.index_offset = offset + buf.size();
+        ok = ok && (index.empty() ||
+                    std::fwrite(index.data(), sizeof(uint64_t), index.size(), f) == index.size());
+        ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+        ok = ok && std::fflush(f) == 0 && ::fsync(::fileno(f)) == 0;
+        ok = (std::fclose(f) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    });
+}
+
+// Maps path and decodes its records in list order, one chunk range per
+// thread. Returns false if the file is missing, malformed, or was written
+// by a different policy or key/value layout.
+template<typename Key, typename Value>
+bool read_snapshot(const std::string& path, SnapshotPolicy policy, uint64_t& extra,
+                   std::vector<SnapshotRecord<Key, Value>>& out) {
+    static_assert(SnapshotCodec<Key>::supported && SnapshotCodec<Value>::supported,
+                  "snapshots support trivially copyable and std::string keys/values");
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    const char* base = static_cast<const char*>(map);
+
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    bool ok = std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) == 0 &&
+              header.version == kSnapshotVersion &&
+              header.policy == static_cast<uint32_t>(policy) &&
+              header.key_size == SnapshotCodec<Key>::fixed_size &&
+              header.value_size == SnapshotCodec<Value>::fixed_size &&
+              header.chunk_count == (header.count + kSnapshotChunk - 1) / kSnapshotChunk &&
+              header.index_offset <= size &&
+              (size - header.index_offset) / sizeof(uint64_t) >= header.chunk_count;
+    if (ok) {
+        std::vector<uint64_t> index(header.chunk_count);
+        if (!index.empty()) {
+            std::memcpy(index.data(), base + header.index_offset, index.size() * sizeof(uint64_t));
+        }
+        out.clear();
+        out.resize(header.count);
+        size_t workers = std::min<size_t>(header.chunk_count,
+                                          std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<char> results(workers, 1);
+        auto decode = [&](size_t worker) {
+            for (size_t c = worker; c < header.chunk_count; c += workers) {
+                const char* p = base + index[c];
+                const char* end = base + (c + 1 < header.chunk_count ? index[c + 1] : header.index_offset);
+                if (index[c] > header.index_offset || p > end) {
+                    results[worker] = 0;
+                    return;
+                }
+                size_t last = std::min<size_t>(header.count, (c + 1) * kSnapshotChunk);
+                for (size_t i = c * kSnapshotChunk; i < last; ++i) {
+                    auto& r = out[i];
+                    if (!SnapshotCodec<Key>::read(p, end, r.key) ||
+                        !SnapshotCodec<Value>::read(p, end, r.value) ||
+                        !SnapshotCodec<uint64_t>::read(p, end, r.meta)) {
+                        results[worker] = 0;
+                        return;
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(decode, w);
+        if (workers > 0) decode(0);
+        for (auto& t : threads) t.join();
+        ok = std::all_of(results.begin(), results.end(), [](char r) { return r != 0; });
+        extra = header.extra;
+    }
+    ::munmap(map, size);
+    if (!ok) out.clear();
+    return ok;
+}
+
+} // namespace cache
@@ -0,0 +1,252 @@
+#pragma once
+#include "cache_interface.hpp"
+#include "flash_store.hpp"
+#include "hash_util.hpp"
+#include "lru_cache.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// What TieredCache keeps in its DRAM tier: the value and the sequence
+// number of the write that stored it.
+template<typename Value>
+struct TieredValue {
+    Value value;
+    uint64_t version = 0;
+};
+
+// DRAM cache backed by a FlashStore. Entries the DRAM policy evicts spill
+// into the flash log instead of being dropped, and a flash hit promotes
+// the entry back into DRAM (removing its flash copy). Memory may be any
+// cache over TieredValue<Value> with set_eviction_listener(), i.e.
+// LRUCache or ARCCache.
+//
+// Spills and promotions race with writes to the same key: the policy hands
+// an evicted entry over after releasing its lock, and a promotion stores
+// what it read from flash some time earlier. Keys are therefore striped,
+// and each stripe remembers the version of every key it has in DRAM. A
+// spill is kept only if its version is still the key's current one, and a
+// promotion only if nothing in the stripe was written while flash was
+// read. A dropped promotion just leaves the entry in flash. Evictions that
+// happen inside a stripe-locked put() are queued and spilled once the lock
+// is released.
+//
+// capacity() is the DRAM capacity; size() counts both tiers.
+template<typename Key, typename Value, typename Memory = LRUCache<Key, TieredValue<Value>>>
+class TieredCache : public CacheInterface<Key, Value> {
+    using Stored = TieredValue<Value>;
+
+public:
+    TieredCache(size_t memory_capacity, const std::string& flash_path,
+                const FlashOptions& flash_options = FlashOptions(),
+                const std::string& name = "tiered_cache")
+        : memory_(memory_capacity, name + "_dram")
+        , flash_(flash_path, flash_options, name + "_flash")
+        , spiller_(*this) {
+        memory_.set_eviction_listener(&spiller_);
+    }
+
+    ~TieredCache() override { memory_.set_eviction_listener(nullptr); }
+
+    TieredCache(const TieredCache&) = delete;
+    TieredCache& operator=(const TieredCache&) = delete;
+
+    bool put(const Key& key, const Value& value) override {
+        bool inserted;
+        {
+            Locked locked(stripe_for(key));
+            flash_.remove(key); // the flash copy, if any, is now stale
+            inserted = memory_.put(key, Stored{value, locked.track(key, next_version())});
+        }
+        drain_spills();
+        return inserted;
+    }
+
+    std::optional<Value> get(const Key& key) override {
+        if (auto stored = memory_.get(key)) return std::move(stored->value);
+        uint64_t seen = stripe_for(key).writes.load(std::memory_order_acquire);
+        auto value = flash_.get(key);
+        if (value) promote(key, *value, seen);
+        return value;
+    }
+
+    // DRAM hits complete immediately; DRAM misses read flash through the
+    // store's get_async() (io_uring, or its pread pool) and promote on
+    // completion.
+    std::future<std::optional<Value>> get_async(const Key& key) {
+        if (auto stored = memory_.get(key)) {
+            std::promise<std::optional<Value>> ready;
+            ready.set_value(std::move(stored->value));
+            return ready.get_future();
+        }
+        uint64_t seen = stripe_for(key).writes.load(std::memory_order_acquire);
+        return std::async(std::launch::deferred, [this, key, seen, pending = flash_.get_async(key)]() mutable {
+            auto value = pending.get();
+            if (value) promote(key, *value, seen);
+            return value;
+        });
+    }
+
+    bool remove(const Key& key) override {
+        Locked locked(stripe_for(key));
+        locked.untrack(key);
+        bool in_memory = memory_.remove(key);
+        return flash_.remove(key) || in_memory;
+    }
+
+    void clear() override {
+        std::vector<std::unique_ptr<Locked>> all;
+        all.reserve(kStripes);
+        for (auto& stripe : stripes_) {
+            all.push_back(std::make_unique<Locked>(stripe));
+            stripe.resident.clear();
+            stripe.writes.fetch_add(1, std::memory_order_release);
+        }
+        memory_.clear();
+        flash_.clear();
+        std::lock_guard<std::mutex> lock(spill_mutex_);
+        spills_.clear();
+    }
+
+    size_t size() const override { return memory_.size() + flash_.size(); }
+    size_t capacity() const override { return memory_.capacity(); }
+
+    // Every DRAM miss consults flash, so flash misses are the misses of
+    // the tiered cache as a whole.
+    size_t hit_count() const override { return memory_.hit_count() + flash_.metrics().hits(); }
+    size_t miss_count() const override { return flash_.metrics().misses(); }
+    size_t eviction_count() const override { return flash_.metrics().evictions(); }
+
+    double hit_rate() const override {
+        size_t hits = hit_count();
+        size_t total = hits + miss_count();
+        return total > 0 ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    Memory& memory() { return memory_; }
+    FlashStore<Key, Value>& flash() { return flash_; }
+
+    // Spills dropped because the key was written again after its eviction,
+    // and promotions dropped because its stripe was written during the
+    // flash read.
+    uint64_t stale_spills() const { return stale_spills_.load(std::memory_order_relaxed); }
+    uint64_t stale_promotions() const { return stale_promotions_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kStripes = 64;
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+        std::unordered_map<Key, uint64_t> resident; // DRAM keys -> version of their value
+        std::atomic<uint64_t> writes{0};            // bumped by every change under mutex
+    };
+
+    // Holds a stripe's mutex. Evictions on this thread are queued rather
+    // than spilled while any stripe is held, since the evicted key may
+    // live in a stripe that is already locked.
+    class Locked {
+    public:
+        explicit Locked(Stripe& stripe) : stripe_(stripe), lock_(stripe.mutex) { ++stripes_held_; }
+        ~Locked() { --stripes_held_; }
+
+        uint64_t track(const Key& key, uint64_t version) {
+            stripe_.resident[key] = version;
+            stripe_.writes.fetch_add(1, std::memory_order_release);
+            return version;
+        }
+
+        void untrack(const Key& key) {
+            stripe_.resident.erase(key);
+            stripe_.writes.fetch_add(1, std::memory_order_release);
+        }
+
+        // True if `version` is what the stripe has for key in DRAM.
+        bool current(const Key& key, uint64_t version) const {
+            auto it = stripe_.resident.find(key);
+            return it != stripe_.resident.end() && it->second == version;
+        }
+
+        uint64_t writes() const { return stripe_.writes.load(std::memory_order_relaxed); }
+
+    private:
+        Stripe& stripe_;
+        std::lock_guard<std::mutex> lock_;
+    };
+
+    class Spiller : public EvictionListener<Key, Stored> {
+    public:
+        explicit Spiller(TieredCache& owner) : owner_(owner) {}
+        void on_evict(const Key& key, Stored&& stored) override { owner_.spill(key, std::move(stored)); }
+
+    private:
+        TieredCache& owner_;
+    };
+
+    Stripe& stripe_for(const Key& key) { return stripes_[hash_key(key) % kStripes]; }
+
+    uint64_t next_version() { return next_version_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    // `seen` is the stripe's write count from before flash was read.
+    void promote(const Key& key, const Value& value, uint64_t seen) {
+        {
+            Locked locked(stripe_for(key));
+            if (locked.writes() != seen) {
+                stale_promotions_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            flash_.remove(key);
+            memory_.put(key, Stored{value, locked.track(key, next_version())});
+        }
+        drain_spills();
+    }
+
+    void spill(const Key& key, Stored&& stored) {
+        {
+            std::lock_guard<std::mutex> lock(spill_mutex_);
+            spills_.emplace_back(key, std::move(stored));
+        }
+        if (stripes_held_ == 0) drain_spills();
+    }
+
+    void drain_spills() {
+        for (;;) {
+            std::unique_lock<std::mutex> lock(spill_mutex_);
+            if (spills_.empty()) return;
+            auto next = std::move(spills_.front());
+            spills_.pop_front();
+            lock.unlock();
+
+            Locked locked(stripe_for(next.first));
+            if (!locked.current(next.first, next.second.version)) {
+                stale_spills_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            locked.untrack(next.first);
+            flash_.put(next.first, next.second.value);
+        }
+    }
+
+    Memory memory_;
+    FlashStore<Key, Value> flash_;
+    Spiller spiller_;
+    std::array<Stripe, kStripes> stripes_;
+    std::atomic<uint64_t> next_version_{0};
+    std::mutex spill_mutex_;
+    std::deque<std::pair<Key, Stored>> spills_;
+    std::atomic<uint64_t> stale_spills_{0};
+    std::atomic<uint64_t> stale_promotions_{0};
+
+    static inline thread_local unsigned stripes_held_ = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,98 @@
+#pragma once
+#include "metrics.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace cache {
+
+// Cheap monotonic tick source. On x86 this reads the TSC, whose rate is
+// calibrated against steady_clock the first time ticks are converted;
+// elsewhere ticks are steady_clock nanoseconds.
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static double ns_per_tick();
+
+    static uint64_t to_ns(uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick());
+    }
+};
+
+// Timing policies plug into the caches' Timing template parameter.
+// Each exposes begin() before the operation and end() after it, both
+// outside the cache lock.
+
+// Compiles all latency measurement out of the hot path.
+struct NoTiming {
+    struct Sample {};
+    Sample begin() { return {}; }
+    void end(Sample, Metrics&, LatencyOp) {}
+};
+
+// Times every operation.
+struct FullTiming {
+    struct Sample { uint64_t start; };
+    Sample begin() { return {TscClock::now()}; }
+    void end(Sample s, Metrics& metrics, LatencyOp op) {
+        metrics.record_latency_ns(op, TscClock::to_ns(TscClock::now() - s.start));
+    }
+};
+
+// Times roughly one in sample_rate() operations, chosen by a per-thread
+// xorshift generator so interleaved caches do not alias with each other.
+class SampledTiming {
+public:
+    static constexpr uint32_t kDefaultSampleRate = 16;
+
+    struct Sample { uint64_t start; };
+
+    explicit SampledTiming(uint32_t sample_rate = kDefaultSampleRate) {
+        set_sample_rate(sample_rate);
+    }
+
+    SampledTiming(const SampledTiming& other) : SampledTiming(other.sample_rate()) {}
+
+    // 1 records every operation; 0 disables timing.
+    void set_sample_rate(uint32_t rate) { rate_.store(rate, std::memory_order_relaxed); }
+    uint32_t sample_rate() const { return rate_.load(std::memory_order_relaxed); }
+
+    Sample begin() {
+        uint32_t rate = sample_rate();
+        if (rate == 0 || next_random() % rate != 0) return {0};
+        return {TscClock::now()};
+    }
+
+    void end(Sample s, Metrics& metrics, LatencyOp op) {
+        if (s.start == 0) return;
+        metrics.record_latency_ns(op, TscClock::to_ns(TscClock::now() - s.start));
+    }
+
+private:
+    static uint32_t next_random() {
+        thread_local uint32_t state = 0x9E3779B9u ^
+            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state));
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    std::atomic<uint32_t> rate_{kDefaultSampleRate};
+};
+
+using DefaultTiming = SampledTiming;
+
+} // namespace cache
@@ -0,0 +1,107 @@
+#pragma once
+#include "lz4_codec.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+
+namespace cache {
+
+struct CompressionOptions {
+    bool enabled = false;
+    double hot_fraction = 0.1;  // MRU share of the list that is never compressed
+    size_t min_value_size = 64; // smaller payloads are not worth the codec
+};
+
+// Per-type hook for in-place value compression. Types without a
+// specialization are never compressed.
+template<typename Value>
+struct ValueCompressor {
+    static constexpr bool supported = false;
+    static uint32_t compress(Value&, size_t) { return 0; }
+    static bool decompress(Value&, uint32_t) { return true; }
+};
+
+template<>
+struct ValueCompressor<std::string> {
+    static constexpr bool supported = true;
+
+    // Replaces value with its compressed form and returns the original size,
+    // or returns 0 and leaves value untouched when compression does not pay.
+    static uint32_t compress(std::string& value, size_t min_size) {
+        if (value.size() < min_size ||
+            value.size() > std::numeric_limits<uint32_t>::max()) {
+            return 0;
+        }
+        std::string out(lz4::compress_bound(value.size()), '\0');
+        size_t n = lz4::compress(value.data(), value.size(), &out[0]);
+        if (n >= value.size()) return 0;
+        out.resize(n);
+        out.shrink_to_fit();
+        uint32_t raw = static_cast<uint32_t>(value.size());
+        value.swap(out);
+        return raw;
+    }
+
+    static bool decompress(std::string& value, uint32_t raw_size) {
+        std::string out(raw_size, '\0');
+        if (!lz4::decompress(value.data(), value.size(), &out[0], raw_size)) {
+            return false;
+        }
+        value.swap(out);
+        return true;
+    }
+};
+
+// Tracks the cold tail of a recency list for background compression.
+// Entries enter the cold region only at its top and leave it from
+// anywhere, so the entries already examined always form a contiguous
+// suffix of the list. `cursor_` marks the top of that suffix, which makes
+// each compression step O(entries examined) rather than a tail scan.
+// Nodes must carry `uint32_t raw_size` (0 = stored uncompressed) and
+// `bool cold` (examined by the compressor).
+template<typename NodeList>
+class ColdRegion {
+public:
+    using iterator = typename NodeList::iterator;
+
+    explicit ColdRegion(NodeList& list) : list_(list), cursor_(list.end()) {}
+
+    // Must be called before `it` is erased or spliced out of its position.
+    void on_unlink(iterator it) {
+        if (!it->cold) return;
+        it->cold = false;
+        --examined_;
+        if (it == cursor_) cursor_ = std::next(it);
+    }
+
+    void reset() {
+        cursor_ = list_.end();
+        examined_ = 0;
+    }
+
+    // Examines up to `budget` entries above the current cold suffix while
+    // the suffix is smaller than `target`, handing each one to `fn`.
+    template<typename Fn>
+    size_t advance(size_t target, size_t budget, Fn&& fn) {
+        size_t done = 0;
+        while (done < budget && examined_ < target && cursor_ != list_.begin()) {
+            --cursor_;
+            cursor_->cold = true;
+            ++examined_;
+            fn(*cursor_);
+            ++done;
+        }
+        return done;
+    }
+
+    size_t examined() const { return examined_; }
+
+private:
+    NodeList& list_;
+    iterator cursor_;
+    size_t examined_ = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cache {
+
+struct WalOptions {
+    std::chrono::milliseconds flush_interval{1};  // group-commit window
+    std::chrono::milliseconds fsync_interval{10}; // 0 fsyncs every group write
+    size_t max_buffer_bytes = size_t(4) << 20;    // appenders block beyond this
+};
+
+// Append-only, group-committed log of opaque records.
+//
+// append() copies a record into an in-memory buffer and returns its log
+// sequence number (LSN). A background flusher writes the buffer out with
+// a single write() every flush_interval and fdatasync()s at most every
+// fsync_interval, so concurrent writers share each I/O. sync() blocks
+// until everything appended so far is durable.
+//
+// The log is a series of segment files `<base>.wal.<generation>`; rotate()
+// seals the current one and starts the next. Each record is framed as
+// u32 length | u32 crc32c | payload, so replay() stops cleanly at a torn
+// tail left by a crash.
+//
+// A failed write() or fdatasync() is sticky: durable_lsn() stops where it
+// was, buffered records are dropped, and every later append(), sync() and
+// rotate() throws std::system_error with the errno of the first failure.
+// After a failed fdatasync the kernel may already have discarded the dirty
+// pages, so retrying could report durability that never happened.
+class WriteAheadLog {
+public:
+    // Opens a new segment with the given generation. Throws
+    // std::system_error if the file cannot be created.
+    WriteAheadLog(const std::string& base_path, uint64_t generation,
+                  const WalOptions& options = WalOptions());
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Both throw std::system_error once the log has failed.
+    uint64_t append(const void* data, size_t len);
+    void sync();
+
+    // Makes the current segment durable, closes it, and opens generation + 1.
+    // Returns the new generation. Throws std::system_error if the segment
+    // could not be written out, leaving it current.
+    uint64_t rotate();
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    uint64_t appended_lsn() const { return appended_lsn_.load(std::memory_order_acquire); }
+    uint64_t durable_lsn() const { return durable_lsn_.load(std::memory_order_acquire); }
+    uint64_t group_commits() const { return group_commits_.load(std::memory_order_relaxed); }
+    uint64_t fsyncs() const { return fsyncs_.load(std::memory_order_relaxed); }
+    // errno of the first failed write or fdatasync, 0 while healthy.
+    int error() const { return error_.load(std::memory_order_acquire); }
+
+    static std::string segment_path(const std::string& base_path, uint64_t generation);
+
+    // Calls fn(payload, len) for every intact record in a segment file.
+    // Returns the number of records replayed.
+    static size_t replay(const std::string& segment_path,
+                         const std::function<void(const char*, size_t)>& fn);
+
+private:
+    void open_segment(uint64_t generation);
+    void flush_loop();
+    // Writes the buffered records and, when due or forced, fdatasyncs.
+    void write_batch(bool force_sync);
+    // Records the first I/O error and wakes everyone waiting on the log.
+    // Called with io_mutex_ held.
+    void fail(int err);
+    void throw_if_failed() const;
+
+    const std::string base_path_;
+    const WalOptions options_;
+    int fd_ = -1;
+    std::atomic<uint64_t> generation_{0};
+
+    std::mutex mutex_;     // buffer_ and LSN bookkeeping
+    std::mutex io_mutex_;  // fd_, batch_ and the write/fsync sequence
+    std::condition_variable flush_cv_;
+    std::condition_variable durable_cv_;
+    std::condition_variable space_cv_;
+    std::string buffer_;
+    std::string batch_;
+    bool sync_requested_ = false;
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point last_fsync_;
+    uint64_t written_lsn_ = 0;
+
+    std::atomic<uint64_t> appended_lsn_{0};
+    std::atomic<uint64_t> durable_lsn_{0};
+    std::atomic<uint64_t> group_commits_{0};
+    std::atomic<uint64_t> fsyncs_{0};
+    std::atomic<int> error_{0};
+    std::thread flusher_;
+};
+
+} // namespace cache
@@ -0,0 +1,283 @@
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/memcached_protocol.hpp"
+#include "../include/cache/resp_protocol.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace cache {
+
+namespace {
+
+constexpr int kMaxIovecs = 512;
+constexpr size_t kReadReserve = 64 * 1024;
+constexpr size_t kMaxBufferedInput = size_t(64) << 20; // while a send is in flight
+constexpr uint64_t kAcceptTag = 0;
+
+// Connection ids start at 1; bit 0 of a tag tells a send from a receive.
+uint64_t recv_tag(uint64_t id) { return id << 1; }
+uint64_t send_tag(uint64_t id) { return id << 1 | 1; }
+
+int open_listener(const std::string& bind_address, uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, 1024) < 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "bind " + bind_address);
+    }
+    return fd;
+}
+
+uint16_t bound_port(int fd) {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    return ntohs(addr.sin_port);
+}
+
+} // namespace
+
+struct CacheServer::Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    std::vector<char> in;
+    size_t start = 0; // first unprocessed byte of `in`
+    size_t end = 0;   // one past the last received byte
+    ReplyBuilder out; // must not change while a send is in flight
+    std::unique_ptr<ProtocolHandler> handler;
+    bool receiving = false; // multishot recv armed
+    bool sending = false;
+    bool closing = false;   // shut down; freed once nothing is in flight
+    bool close_after_flush = false;
+};
+
+struct CacheServer::Loop {
+    std::unique_ptr<IoEngine> engine;
+    int listen_fd = -1;
+    std::thread thread;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t next_id = 1;
+    uint64_t syscalls_reported = 0;
+};
+
+CacheServer::CacheServer(ItemCache& cache, const ServerOptions& options)
+    : cache_(cache)
+    , options_(options)
+    , port_(options.port) {}
+
+CacheServer::~CacheServer() {
+    stop();
+}
+
+void CacheServer::start() {
+    if (running()) return;
+    size_t threads = options_.threads ? options_.threads
+                                      : std::max(1u, std::thread::hardware_concurrency());
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            auto loop = std::make_unique<Loop>();
+            loop->engine = make_io_engine(options_.io_backend, options_.io);
+            loops_.push_back(std::move(loop));
+            Loop& l = *loops_.back();
+            // With port 0 the first socket picks the port the rest share.
+            l.listen_fd = open_listener(options_.bind_address, port_);
+            port_ = bound_port(l.listen_fd);
+            l.engine->accept(l.listen_fd, kAcceptTag);
+        }
+    } catch (...) {
+        for (auto& loop : loops_) {
+            if (loop->listen_fd >= 0) ::close(loop->listen_fd);
+        }
+        loops_.clear();
+        port_ = options_.port;
+        throw;
+    }
+    io_engine_ = loops_.front()->engine->name();
+
+    running_.store(true, std::memory_order_release);
+    for (size_t i = 0; i < loops_.size(); ++i) {
+        Loop& loop = *loops_[i];
+        loop.thread = std::thread([this, &loop] { run(loop); });
+        if (options_.pin_threads) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % CPU_SETSIZE, &cpus);
+            ::pthread_setaffinity_np(loop.thread.native_handle(), sizeof(cpus), &cpus);
+        }
+    }
+}
+
+void CacheServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+    for (auto& loop : loops_) loop->engine->wake();
+    for (auto& loop : loops_) {
+        loop->thread.join();
+        for (auto& entry : loop->connections) ::shutdown(entry.second->fd, SHUT_RDWR);
+        // The engine waits out in-flight sends, which still reference the
+        // connections' reply buffers.
+        loop->engine.reset();
+        for (auto& entry : loop->connections) ::close(entry.second->fd);
+        ::close(loop->listen_fd);
+    }
+    loops_.clear();
+}
+
+void CacheServer::run(Loop& loop) {
+    std::vector<IoCompletion> completions;
+    while (running()) {
+        completions.clear();
+        loop.engine->wait(completions, -1);
+        for (const IoCompletion& c : completions) {
+            if (c.tag == kAcceptTag) {
+                on_accept(loop, c);
+                continue;
+            }
+            auto it = loop.connections.find(c.tag >> 1);
+            if (it == loop.connections.end()) {
+                if (c.data) loop.engine->release(c.buffer);
+                continue;
+            }
+            if (c.tag & 1) {
+                on_sent(loop, *it->second, c.result);
+            } else {
+                on_received(loop, *it->second, c);
+            }
+        }
+        uint64_t syscalls = loop.engine->syscalls();
+        stats_.syscalls.fetch_add(syscalls - loop.syscalls_reported, std::memory_order_relaxed);
+        loop.syscalls_reported = syscalls;
+    }
+}
+
+void CacheServer::on_accept(Loop& loop, const IoCompletion& c) {
+    // Out of descriptors ends the multishot accept; it is re-armed below
+    // and retries as connections close.
+    if (!c.more) loop.engine->accept(loop.listen_fd, kAcceptTag);
+    if (c.result < 0) return;
+    int fd = c.result;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    auto conn = std::make_unique<Connection>();
+    conn->id = loop.next_id++;
+    conn->fd = fd;
+    conn->handler = make_handler();
+    conn->receiving = true;
+    loop.engine->recv(fd, recv_tag(conn->id));
+    loop.connections.emplace(conn->id, std::move(conn));
+    stats_.connections.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::unique_ptr<ProtocolHandler> CacheServer::make_handler() const {
+    if (options_.protocol == ServerProtocol::Resp) {
+        return std::make_unique<RespHandler>(cache_, options_.max_item_bytes);
+    }
+    return std::make_unique<MemcachedHandler>(cache_, options_.max_item_bytes);
+}
+
+void CacheServer::on_received(Loop& loop, Connection& conn, const IoCompletion& c) {
+    if (c.result > 0) {
+        size_t n = static_cast<size_t>(c.result);
+        if (!conn.closing) {
+            if (conn.in.size() - conn.end < n) {
+                if (conn.start > 0) {
+                    std::memmove(conn.in.data(), conn.in.data() + conn.start, conn.end - conn.start);
+                    conn.end -= conn.start;
+                    conn.start = 0;
+                }
+                if (conn.in.size() - conn.end < n) conn.in.resize(conn.end + std::max(n, kReadReserve));
+            }
+            std::memcpy(conn.in.data() + conn.end, c.data, n);
+            conn.end += n;
+        }
+        loop.engine->release(c.buffer);
+        stats_.bytes_read.fetch_add(n, std::memory_order_relaxed);
+    }
+    if (!c.more) {
+        conn.receiving = false;
+        if (conn.closing) return reap(loop, conn);
+        if (c.result > 0 || c.result == -ENOBUFS) {
+            // The kernel ended the multishot recv early (out of buffers).
+            conn.receiving = true;
+            loop.engine->recv(conn.fd, recv_tag(conn.id));
+        } else if (c.result < 0) {
+            close_connection(loop, conn);
+            return;
+        } else {
+            conn.close_after_flush = true; // EOF: answer what arrived, then close
+        }
+    }
+    if (conn.sending) {
+        if (conn.end - conn.start > std::max(kMaxBufferedInput, 2 * options_.max_item_bytes)) {
+            close_connection(loop, conn);
+        }
+        return;
+    }
+    process(loop, conn);
+}
+
+void CacheServer::on_sent(Loop& loop, Connection& conn, int32_t result) {
+    conn.sending = false;
+    if (result < 0 || conn.closing) {
+        close_connection(loop, conn);
+        return;
+    }
+    stats_.bytes_written.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+    conn.out.consume(static_cast<size_t>(result));
+    process(loop, conn);
+}
+
+void CacheServer::process(Loop& loop, Connection& conn) {
+    if (conn.closing) return reap(loop, conn);
+    if (conn.out.empty() && conn.end > conn.start) {
+        ProcessResult result = conn.handler->process(conn.in.data() + conn.start,
+                                                     conn.end - conn.start, conn.out);
+        conn.start += result.consumed;
+        if (conn.start == conn.end) conn.start = conn.end = 0;
+        stats_.commands.fetch_add(result.commands, std::memory_order_relaxed);
+        if (result.close) conn.close_after_flush = true;
+    }
+    if (!conn.out.empty()) {
+        iovec iov[kMaxIovecs];
+        int count = conn.out.fill(iov, kMaxIovecs);
+        conn.sending = true;
+        loop.engine->send(conn.fd, iov, count, send_tag(conn.id));
+        return;
+    }
+    if (conn.close_after_flush) close_connection(loop, conn);
+}
+
+void CacheServer::close_connection(Loop& loop, Connection& conn) {
+    if (!conn.closing) {
+        conn.closing = true;
+        // Ends the multishot recv (and any stalled send) with a completion.
+        ::shutdown(conn.fd, SHUT_RDWR);
+    }
+    reap(loop, conn);
+}
+
+void CacheServer::reap(Loop& loop, Connection& conn) {
+    if (conn.receiving || conn.sending) return;
+    ::close(conn.fd);
+    loop.connections.erase(conn.id); // destroys conn
+}
+
+} // namespace cache
@@ -0,0 +1,396 @@
+#include "../include/cache/cluster_client.hpp"
+#include "../include/cache/hash_util.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace cache {
+
+// ---------------------------------------------------------------------------
+// RendezvousHash
+
+void RendezvousHash::add(const std::string& node) {
+    if (std::find(nodes_.begin(), nodes_.end(), node) != nodes_.end()) return;
+    nodes_.push_back(node);
+    seeds_.push_back(mix64(fnv1a(node)));
+}
+
+void RendezvousHash::remove(const std::string& node) {
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it == nodes_.end()) return;
+    seeds_.erase(seeds_.begin() + (it - nodes_.begin()));
+    nodes_.erase(it);
+}
+
+int RendezvousHash::pick(const std::string& key) const {
+    uint64_t h = mix64(fnv1a(key));
+    int best = -1;
+    uint64_t best_score = 0;
+    for (size_t i = 0; i < seeds_.size(); ++i) {
+        uint64_t score = mix64(h ^ seeds_[i]);
+        if (best < 0 || score > best_score) {
+            best = static_cast<int>(i);
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Connection: a blocking socket with a receive buffer for line parsing.
+
+class ClusterClient::Connection {
+public:
+    static std::unique_ptr<Connection> open(const sockaddr_storage& addr, socklen_t len,
+                                            std::chrono::milliseconds timeout) {
+        int fd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return nullptr;
+        timeval tv{};
+        tv.tv_sec = timeout.count() / 1000;
+        tv.tv_usec = (timeout.count() % 1000) * 1000;
+        // Linux applies SO_SNDTIMEO to connect() as well.
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), len) < 0) {
+            ::close(fd);
+            return nullptr;
+        }
+        return std::unique_ptr<Connection>(new Connection(fd));
+    }
+
+    ~Connection() { ::close(fd_); }
+
+    bool send_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Next line without its "\r\n"; valid until the next read.
+    bool read_line(std::string_view& line) {
+        for (;;) {
+            size_t eol = buf_.find("\r\n", pos_);
+            if (eol != std::string::npos) {
+                line = std::string_view(buf_).substr(pos_, eol - pos_);
+                pos_ = eol + 2;
+                return true;
+            }
+            if (!fill()) return false;
+        }
+    }
+
+    // A data block of `len` bytes followed by "\r\n".
+    bool read_block(size_t len, std::string& out) {
+        while (buf_.size() - pos_ < len + 2) {
+            if (!fill()) return false;
+        }
+        out.assign(buf_, pos_, len);
+        pos_ += len + 2;
+        return true;
+    }
+
+private:
+    explicit Connection(int fd) : fd_(fd) {}
+
+    bool fill() {
+        if (pos_ > 0) {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+        }
+        char chunk[16 * 1024];
+        for (;;) {
+            ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false; // closed, error or timeout
+            buf_.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+    }
+
+    int fd_;
+    std::string buf_;
+    size_t pos_ = 0;
+};
+
+struct ClusterClient::Node {
+    std::string endpoint;
+    sockaddr_storage addr{};
+    socklen_t addr_len = 0;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Connection>> idle;
+};
+
+namespace {
+
+constexpr size_t kMaxKeyBytes = 250;
+// memcached reads a larger exptime as an absolute unix time.
+constexpr uint32_t kMaxRelativeExpiry = 60 * 60 * 24 * 30;
+
+std::string exptime(uint32_t ttl_seconds) {
+    if (ttl_seconds <= kMaxRelativeExpiry) return std::to_string(ttl_seconds);
+    return std::to_string(static_cast<int64_t>(std::time(nullptr)) + ttl_seconds);
+}
+
+// A key is written into the command line as-is, so anything that would
+// split or end that line must be refused before it reaches the wire.
+bool valid_key(const std::string& key) {
+    if (key.empty() || key.size() > kMaxKeyBytes) return false;
+    for (unsigned char c : key) {
+        if (c <= ' ' || c == 0x7f) return false;
+    }
+    return true;
+}
+
+// "host:port" -> socket address. Throws std::invalid_argument.
+void resolve(const std::string& endpoint, sockaddr_storage& addr, socklen_t& len) {
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == endpoint.size()) {
+        throw std::invalid_argument("endpoint must be host:port: " + endpoint);
+    }
+    std::string host = endpoint.substr(0, colon);
+    std::string port = endpoint.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) {
+        throw std::invalid_argument("cannot resolve " + endpoint);
+    }
+    std::memcpy(&addr, found->ai_addr, found->ai_addrlen);
+    len = found->ai_addrlen;
+    ::freeaddrinfo(found);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ClusterClient
+
+ClusterClient::ClusterClient(const std::vector<std::string>& endpoints, const ClusterOptions& options)
+    : options_(options) {
+    for (const auto& endpoint : endpoints) add_node(endpoint);
+}
+
+ClusterClient::~ClusterClient() = default;
+
+void ClusterClient::add_node(const std::string& endpoint) {
+    auto node = std::make_shared<Node>();
+    node->endpoint = endpoint;
+    resolve(endpoint, node->addr, node->addr_len);
+    std::unique_lock lock(mutex_);
+    if (std::find(ring_.nodes().begin(), ring_.nodes().end(), endpoint) != ring_.nodes().end()) return;
+    ring_.add(endpoint);
+    nodes_.push_back(std::move(node));
+}
+
+void ClusterClient::remove_node(const std::string& endpoint) {
+    std::unique_lock lock(mutex_);
+    const auto& names = ring_.nodes();
+    auto it = std::find(names.begin(), names.end(), endpoint);
+    if (it == names.end()) return;
+    nodes_.erase(nodes_.begin() + (it - names.begin()));
+    ring_.remove(endpoint);
+}
+
+std::vector<std::string> ClusterClient::nodes() const {
+    std::shared_lock lock(mutex_);
+    return ring_.nodes();
+}
+
+std::string ClusterClient::node_for(const std::string& key) const {
+    std::shared_lock lock(mutex_);
+    int i = ring_.pick(key);
+    return i < 0 ? std::string() : ring_.nodes()[i];
+}
+
+template <typename KeyOf>
+std::vector<std::pair<std::shared_ptr<ClusterClient::Node>, std::vector<size_t>>>
+ClusterClient::group_by_node(size_t count, KeyOf key_of) {
+    std::vector<std::pair<std::shared_ptr<Node>, std::vector<size_t>>> groups;
+    std::shared_lock lock(mutex_);
+    if (nodes_.empty()) return groups;
+    groups.resize(nodes_.size());
+    for (size_t n = 0; n < nodes_.size(); ++n) groups[n].first = nodes_[n];
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& key = key_of(i);
+        if (!valid_key(key)) {
+            fail();
+            continue;
+        }
+        groups[ring_.pick(key)].second.push_back(i);
+    }
+    groups.erase(std::remove_if(groups.begin(), groups.end(),
+                                [](const auto& g) { return g.second.empty(); }),
+                 groups.end());
+    return groups;
+}
+
+std::unique_ptr<ClusterClient::Connection> ClusterClient::acquire(Node& node) {
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        if (!node.idle.empty()) {
+            auto conn = std::move(node.idle.back());
+            node.idle.pop_back();
+            return conn;
+        }
+    }
+    return Connection::open(node.addr, node.addr_len, options_.timeout);
+}
+
+void ClusterClient::release(Node& node, std::unique_ptr<Connection> conn) {
+    std::lock_guard<std::mutex> lock(node.mutex);
+    if (node.idle.size() < options_.idle_connections_per_node) node.idle.push_back(std::move(conn));
+}
+
+std::optional<std::string> ClusterClient::get(const std::string& key) {
+    return std::move(get_many({key})[0]);
+}
+
+std::vector<std::optional<std::string>> ClusterClient::get_many(const std::vector<std::string>& keys) {
+    std::vector<std::optional<std::string>> result(keys.size());
+    auto groups = group_by_node(keys.size(), [&](size_t i) -> const std::string& { return keys[i]; });
+    const size_t per_get = std::max<size_t>(1, options_.keys_per_get);
+
+    // Write every node's requests first so the nodes work concurrently.
+    std::vector<std::unique_ptr<Connection>> conns(groups.size());
+    std::string request;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const auto& indexes = groups[g].second;
+        request.clear();
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            request += i % per_get == 0 ? "get " : " ";
+            request += keys[indexes[i]];
+            if (i % per_get == per_get - 1 || i + 1 == indexes.size()) request += "\r\n";
+        }
+        conns[g] = acquire(*groups[g].first);
+        if (!conns[g] || !conns[g]->send_all(request)) {
+            conns[g].reset();
+            fail();
+        }
+    }
+
+    // Hits come back in request order, misses are skipped, and each get
+    // ends with END.
+    std::string_view line;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (!conns[g]) continue;
+        Connection& conn = *conns[g];
+        const auto& indexes = groups[g].second;
+        bool ok = true;
+        size_t next = 0;
+        for (size_t first = 0; ok && first < indexes.size(); first += per_get) {
+            size_t last = std::min(first + per_get, indexes.size());
+            next = first;
+            for (;;) {
+                if (!conn.read_line(line)) {
+                    ok = false;
+                    break;
+                }
+                if (line == "END") break;
+                // VALUE <key> <flags> <bytes>
+                if (line.compare(0, 6, "VALUE ") != 0) {
+                    ok = false;
+                    break;
+                }
+                size_t key_end = line.find(' ', 6);
+                size_t bytes_at = key_end == std::string_view::npos ? key_end : line.find(' ', key_end + 1);
+                if (bytes_at == std::string_view::npos) {
+                    ok = false;
+                    break;
+                }
+                std::string_view key = line.substr(6, key_end - 6);
+                size_t bytes = std::strtoull(std::string(line.substr(bytes_at + 1)).c_str(), nullptr, 10);
+                while (next < last && keys[indexes[next]] != key) ++next;
+                std::string value;
+                if (!conn.read_block(bytes, value)) {
+                    ok = false;
+                    break;
+                }
+                if (next < last) result[indexes[next++]] = std::move(value);
+            }
+        }
+        if (ok) {
+            release(*groups[g].first, std::move(conns[g]));
+        } else {
+            fail();
+        }
+    }
+    return result;
+}
+
+bool ClusterClient::set(const std::string& key, const std::string& value, uint32_t ttl_seconds) {
+    return set_many({{key, value}}, ttl_seconds) == 1;
+}
+
+size_t ClusterClient::set_many(const std::vector<std::pair<std::string, std::string>>& items,
+                               uint32_t ttl_seconds) {
+    auto groups = group_by_node(items.size(), [&](size_t i) -> const std::string& { return items[i].first; });
+    const std::string ttl = exptime(ttl_seconds);
+
+    std::vector<std::unique_ptr<Connection>> conns(groups.size());
+    std::string request;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        request.clear();
+        for (size_t i : groups[g].second) {
+            const auto& item = items[i];
+            request += "set " + item.first + " 0 " + ttl + " " + std::to_string(item.second.size()) + "\r\n";
+            request += item.second;
+            request += "\r\n";
+        }
+        conns[g] = acquire(*groups[g].first);
+        if (!conns[g] || !conns[g]->send_all(request)) {
+            conns[g].reset();
+            fail();
+        }
+    }
+
+    size_t stored = 0;
+    std::string_view line;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (!conns[g]) continue;
+        bool ok = true;
+        for (size_t n = groups[g].second.size(); ok && n > 0; --n) {
+            ok = conns[g]->read_line(line);
+            if (ok && line == "STORED") ++stored;
+        }
+        if (ok) {
+            release(*groups[g].first, std::move(conns[g]));
+        } else {
+            fail();
+        }
+    }
+    return stored;
+}
+
+bool ClusterClient::remove(const std::string& key) {
+    auto groups = group_by_node(1, [&](size_t) -> const std::string& { return key; });
+    if (groups.empty()) return false;
+    Node& node = *groups[0].first;
+    auto conn = acquire(node);
+    std::string_view line;
+    if (!conn || !conn->send_all("delete " + key + "\r\n") || !conn->read_line(line)) {
+        fail();
+        return false;
+    }
+    bool deleted = line == "DELETED";
+    release(node, std::move(conn));
+    return deleted;
+}
+
+} // namespace cache
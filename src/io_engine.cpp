@@ -0,0 +1,710 @@
+#include "../include/cache/io_engine.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include <unordered_map>
+
+#ifdef HAS_IO_URING
+#include <chrono>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace cache {
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+
+[[noreturn]] void throw_errno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Receive buffers shared by every socket of an engine.
+class BufferPool {
+public:
+    BufferPool(unsigned count, size_t size)
+        : size_(size)
+        , storage_(new char[count * size]) {
+        free_.reserve(count);
+        for (unsigned i = count; i > 0; --i) free_.push_back(static_cast<uint16_t>(i - 1));
+    }
+
+    char* data(uint16_t id) const { return storage_.get() + id * size_; }
+    size_t size() const { return size_; }
+
+    bool take(uint16_t& id) {
+        if (free_.empty()) return false;
+        id = free_.back();
+        free_.pop_back();
+        return true;
+    }
+
+    void give(uint16_t id) { free_.push_back(id); }
+
+private:
+    const size_t size_;
+    std::unique_ptr<char[]> storage_;
+    std::vector<uint16_t> free_;
+};
+
+// Level-triggered readiness turned into completions: a socket is watched
+// for EPOLLIN while an accept or recv is armed and for EPOLLOUT while a
+// send is waiting for space. Sends and reads are tried immediately.
+class EpollEngine : public IoEngine {
+public:
+    explicit EpollEngine(const IoEngineOptions& options)
+        : buffers_(options.buffer_count, options.buffer_size) {
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) throw_errno("epoll_create1");
+        wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wake_fd_ < 0) {
+            ::close(epoll_fd_);
+            throw_errno("eventfd");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wake_fd_;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    }
+
+    ~EpollEngine() override {
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    void accept(int listen_fd, uint64_t tag) override {
+        Watch& w = watches_[listen_fd];
+        w.accepting = true;
+        w.accept_tag = tag;
+        update(listen_fd, w);
+    }
+
+    void recv(int fd, uint64_t tag) override {
+        Watch& w = watches_[fd];
+        w.receiving = true;
+        w.recv_tag = tag;
+        update(fd, w);
+    }
+
+    void send(int fd, const iovec* iov, int count, uint64_t tag) override {
+        Watch& w = watches_[fd];
+        w.sends.push_back({tag, std::vector<iovec>(iov, iov + count)});
+        if (w.sends.size() == 1) send_ready(fd, w);
+        update(fd, w);
+    }
+
+    void read(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag, int) override {
+        ssize_t n;
+        do {
+            n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+            count_syscalls();
+        } while (n < 0 && errno == EINTR);
+        complete(tag, n < 0 ? -errno : static_cast<int32_t>(n));
+    }
+
+    // Nothing to pin: pread() copies through the page cache either way.
+    bool register_buffers(const iovec*, unsigned) override { return true; }
+
+    void release(uint16_t buffer) override { buffers_.give(buffer); }
+
+    size_t wait(std::vector<IoCompletion>& out, int timeout_ms) override {
+        epoll_event events[kMaxEvents];
+        int n = ::epoll_wait(epoll_fd_, events, kMaxEvents, ready_.empty() ? timeout_ms : 0);
+        count_syscalls();
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t value;
+                (void)::read(wake_fd_, &value, sizeof(value));
+                count_syscalls();
+                continue;
+            }
+            auto it = watches_.find(fd);
+            if (it == watches_.end()) continue;
+            Watch& w = it->second;
+            uint32_t ev = events[i].events;
+            if ((ev & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && !w.sends.empty()) send_ready(fd, w);
+            if (ev & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                if (w.accepting) accept_ready(fd, w);
+                if (w.receiving) recv_ready(fd, w);
+            }
+            update(fd, w);
+        }
+        size_t count = ready_.size();
+        out.insert(out.end(), ready_.begin(), ready_.end());
+        ready_.clear();
+        return count;
+    }
+
+    void wake() override {
+        uint64_t one = 1;
+        (void)::write(wake_fd_, &one, sizeof(one));
+    }
+
+    const char* name() const override { return "epoll"; }
+
+private:
+    struct PendingSend {
+        uint64_t tag;
+        std::vector<iovec> iov;
+    };
+
+    struct Watch {
+        uint32_t events = 0; // registered with epoll
+        bool accepting = false;
+        bool receiving = false;
+        uint64_t accept_tag = 0;
+        uint64_t recv_tag = 0;
+        std::deque<PendingSend> sends;
+    };
+
+    void complete(uint64_t tag, int32_t result, bool more = false) {
+        IoCompletion c;
+        c.tag = tag;
+        c.result = result;
+        c.more = more;
+        ready_.push_back(c);
+    }
+
+    void accept_ready(int fd, Watch& w) {
+        for (;;) {
+            int client = ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            count_syscalls();
+            if (client >= 0) {
+                complete(w.accept_tag, client, true);
+                continue;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            w.accepting = false;
+            complete(w.accept_tag, -errno);
+            return;
+        }
+    }
+
+    void recv_ready(int fd, Watch& w) {
+        for (;;) {
+            uint16_t id;
+            if (!buffers_.take(id)) {
+                w.receiving = false;
+                complete(w.recv_tag, -ENOBUFS);
+                return;
+            }
+            ssize_t n = ::recv(fd, buffers_.data(id), buffers_.size(), 0);
+            count_syscalls();
+            if (n > 0) {
+                IoCompletion c;
+                c.tag = w.recv_tag;
+                c.result = static_cast<int32_t>(n);
+                c.more = true;
+                c.data = buffers_.data(id);
+                c.buffer = id;
+                ready_.push_back(c);
+                // A short read means the socket is drained; level-triggered
+                // epoll reports anything that arrives later.
+                if (static_cast<size_t>(n) < buffers_.size()) return;
+                continue;
+            }
+            int err = n == 0 ? 0 : errno;
+            buffers_.give(id);
+            if (err == EINTR) continue;
+            if (err == EAGAIN || err == EWOULDBLOCK) return;
+            w.receiving = false;
+            complete(w.recv_tag, -err);
+            return;
+        }
+    }
+
+    void send_ready(int fd, Watch& w) {
+        while (!w.sends.empty()) {
+            PendingSend& s = w.sends.front();
+            msghdr msg{};
+            msg.msg_iov = s.iov.data();
+            msg.msg_iovlen = s.iov.size();
+            ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+            count_syscalls();
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            complete(s.tag, n < 0 ? -errno : static_cast<int32_t>(n));
+            w.sends.pop_front();
+        }
+    }
+
+    // Brings the epoll registration in line with what is armed; forgets
+    // the descriptor once nothing is.
+    void update(int fd, Watch& w) {
+        uint32_t want = (w.accepting || w.receiving ? EPOLLIN : 0u) | (w.sends.empty() ? 0u : EPOLLOUT);
+        if (want == w.events) {
+            if (want == 0) watches_.erase(fd);
+            return;
+        }
+        epoll_event ev{};
+        ev.events = want;
+        ev.data.fd = fd;
+        int op = want == 0 ? EPOLL_CTL_DEL : w.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        ::epoll_ctl(epoll_fd_, op, fd, &ev);
+        count_syscalls();
+        if (want == 0) {
+            watches_.erase(fd);
+        } else {
+            w.events = want;
+        }
+    }
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    BufferPool buffers_;
+    std::unordered_map<int, Watch> watches_;
+    std::vector<IoCompletion> ready_;
+};
+
+#ifdef HAS_IO_URING
+
+int uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                const void* arg, size_t arg_size) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+int uring_register(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <typename T>
+T load_acquire(const T* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+template <typename T>
+void store_release(T* p, T value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+// Talks to the kernel through the raw io_uring system calls and the rings
+// it maps, so no liburing is needed. user_data is an index into slots_,
+// which holds the caller's tag and anything the kernel reads after
+// submission (a send's msghdr and iovecs).
+class UringEngine : public IoEngine {
+public:
+    explicit UringEngine(const IoEngineOptions& options) {
+        unsigned buffers = 1;
+        while (buffers < options.buffer_count && buffers < 32768) buffers <<= 1;
+        buffer_count_ = buffers;
+        buffer_size_ = options.buffer_size;
+
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = options.queue_depth * 4; // multishot operations post many CQEs
+        ring_fd_ = uring_setup(options.queue_depth, &params);
+        if (ring_fd_ < 0 && errno == EINVAL) {
+            params = io_uring_params{};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = options.queue_depth * 4;
+            ring_fd_ = uring_setup(options.queue_depth, &params);
+        }
+        if (ring_fd_ < 0) throw_errno("io_uring_setup");
+        try {
+            const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+            if ((params.features & required) != required) {
+                throw std::system_error(ENOSYS, std::generic_category(), "io_uring features");
+            }
+            map_rings(params);
+            setup_buffer_ring();
+            wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+            if (wake_fd_ < 0) throw_errno("eventfd");
+            arm_wake();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    ~UringEngine() override {
+        // Cancel whatever is still in flight and wait for it, so the
+        // kernel is done with every buffer before they go away.
+        stopping_ = true;
+        if (in_flight_ > 0) {
+            io_uring_sqe* sqe = next_sqe();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+            sqe->user_data = kCancelData;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            std::vector<IoCompletion> discard;
+            while (in_flight_ > 0 && std::chrono::steady_clock::now() < deadline) {
+                wait(discard, 100);
+                discard.clear();
+            }
+        }
+        unmap();
+    }
+
+    void accept(int listen_fd, uint64_t tag) override {
+        io_uring_sqe* sqe = prepare(Op::Accept, tag);
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    }
+
+    void recv(int fd, uint64_t tag) override {
+        io_uring_sqe* sqe = prepare(Op::Recv, tag);
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+    }
+
+    void send(int fd, const iovec* iov, int count, uint64_t tag) override {
+        io_uring_sqe* sqe = prepare(Op::Send, tag);
+        Slot& slot = slots_[sqe->user_data];
+        slot.iov.assign(iov, iov + count);
+        slot.msg = msghdr{};
+        slot.msg.msg_iov = slot.iov.data();
+        slot.msg.msg_iovlen = slot.iov.size();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&slot.msg);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+    }
+
+    void read(int fd, void* buf, size_t len, uint64_t offset, uint64_t tag, int buffer_index) override {
+        io_uring_sqe* sqe = prepare(Op::Read, tag);
+        sqe->opcode = buffer_index >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = static_cast<uint32_t>(len);
+        sqe->off = offset;
+        if (buffer_index >= 0) sqe->buf_index = static_cast<uint16_t>(buffer_index);
+    }
+
+    bool register_buffers(const iovec* iov, unsigned count) override {
+        count_syscalls();
+        return uring_register(ring_fd_, IORING_REGISTER_BUFFERS, iov, count) == 0;
+    }
+
+    void release(uint16_t buffer) override {
+        provide(buffer);
+        store_release(&buf_ring_->tail, buf_tail_);
+    }
+
+    size_t wait(std::vector<IoCompletion>& out, int timeout_ms) override {
+        size_t before = out.size();
+        store_release(sq_tail_, sq_local_tail_);
+        bool ready = load_acquire(cq_tail_) != *cq_head_;
+        if (to_submit_ > 0 || (!ready && timeout_ms != 0)) {
+            unsigned flags = 0;
+            unsigned min_complete = 0;
+            io_uring_getevents_arg arg{};
+            __kernel_timespec ts{};
+            if (!ready && timeout_ms != 0) {
+                flags |= IORING_ENTER_GETEVENTS;
+                min_complete = 1;
+                if (timeout_ms > 0) {
+                    ts.tv_sec = timeout_ms / 1000;
+                    ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+                    arg.sigmask_sz = _NSIG / 8;
+                    arg.ts = reinterpret_cast<uint64_t>(&ts);
+                    flags |= IORING_ENTER_EXT_ARG;
+                }
+            }
+            int submitted = flags & IORING_ENTER_EXT_ARG
+                                ? uring_enter(ring_fd_, to_submit_, min_complete, flags, &arg, sizeof(arg))
+                                : uring_enter(ring_fd_, to_submit_, min_complete, flags, nullptr, _NSIG / 8);
+            count_syscalls();
+            if (submitted > 0) to_submit_ -= static_cast<unsigned>(submitted);
+        }
+        reap(out);
+        return out.size() - before;
+    }
+
+    void wake() override {
+        uint64_t one = 1;
+        (void)::write(wake_fd_, &one, sizeof(one));
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+private:
+    enum class Op : uint8_t { Free, Wake, Accept, Recv, Send, Read };
+
+    struct Slot {
+        Op op = Op::Free;
+        uint64_t tag = 0;
+        msghdr msg{};
+        std::vector<iovec> iov;
+    };
+
+    static constexpr uint16_t kBufferGroup = 0;
+    static constexpr uint64_t kCancelData = ~uint64_t(0);
+
+    void map_rings(const io_uring_params& p) {
+        sq_entries_ = p.sq_entries;
+        ring_size_ = std::max<size_t>(p.sq_off.array + p.sq_entries * sizeof(uint32_t),
+                                      p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe));
+        ring_ = ::mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_SQ_RING);
+        if (ring_ == MAP_FAILED) {
+            ring_ = nullptr;
+            throw_errno("mmap io_uring");
+        }
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) throw_errno("mmap io_uring sqes");
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* base = static_cast<char*>(ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(base + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(base + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(base + p.sq_off.ring_mask);
+        cq_head_ = reinterpret_cast<unsigned*>(base + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(base + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(base + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(base + p.cq_off.cqes);
+        // SQE i always sits in slot i of the indirection array.
+        auto* array = reinterpret_cast<unsigned*>(base + p.sq_off.array);
+        for (unsigned i = 0; i < p.sq_entries; ++i) array[i] = i;
+        sq_local_tail_ = *sq_tail_;
+    }
+
+    void setup_buffer_ring() {
+        buf_ring_size_ = buffer_count_ * sizeof(io_uring_buf);
+        void* mem = ::mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) throw_errno("mmap buffer ring");
+        buf_ring_ = static_cast<io_uring_buf_ring*>(mem);
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(mem);
+        reg.ring_entries = buffer_count_;
+        reg.bgid = kBufferGroup;
+        count_syscalls();
+        if (uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            throw_errno("io_uring provided buffers");
+        }
+        buffers_.reset(new char[buffer_count_ * buffer_size_]);
+        buf_tail_ = 0;
+        for (unsigned i = 0; i < buffer_count_; ++i) provide(static_cast<uint16_t>(i));
+        store_release(&buf_ring_->tail, buf_tail_);
+    }
+
+    void unmap() {
+        // Closing the ring first ends the kernel's use of the mappings.
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+        if (sqes_) ::munmap(sqes_, sqes_size_);
+        if (ring_) ::munmap(ring_, ring_size_);
+        if (buf_ring_) ::munmap(buf_ring_, buf_ring_size_);
+        ring_fd_ = wake_fd_ = -1;
+        sqes_ = nullptr;
+        ring_ = nullptr;
+        buf_ring_ = nullptr;
+    }
+
+    // Fills the next buf_ring_ entry field by field: the first entry's
+    // reserved word doubles as the ring tail. Indexes the memory directly
+    // because in C++ the header's flexible `bufs` member is misplaced.
+    void provide(uint16_t id) {
+        io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(buf_ring_) + (buf_tail_ & (buffer_count_ - 1));
+        buf->addr = reinterpret_cast<uint64_t>(buffers_.get() + id * buffer_size_);
+        buf->len = static_cast<uint32_t>(buffer_size_);
+        buf->bid = id;
+        ++buf_tail_;
+    }
+
+    io_uring_sqe* next_sqe() {
+        if (sq_local_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+            // Queue full: hand the batch over now instead of at wait().
+            store_release(sq_tail_, sq_local_tail_);
+            int submitted = uring_enter(ring_fd_, to_submit_, 0, 0, nullptr, _NSIG / 8);
+            count_syscalls();
+            if (submitted < 0) throw_errno("io_uring_enter");
+            to_submit_ -= static_cast<unsigned>(submitted);
+            if (sq_local_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+                throw std::system_error(EBUSY, std::generic_category(), "io_uring submission queue full");
+            }
+        }
+        io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+        ++sq_local_tail_;
+        ++to_submit_;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    io_uring_sqe* prepare(Op op, uint64_t tag) {
+        uint32_t index;
+        if (free_slots_.empty()) {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        } else {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        slots_[index].op = op;
+        slots_[index].tag = tag;
+        ++in_flight_;
+        io_uring_sqe* sqe = next_sqe();
+        sqe->user_data = index;
+        return sqe;
+    }
+
+    void finish(uint32_t index) {
+        slots_[index].op = Op::Free;
+        free_slots_.push_back(index);
+        --in_flight_;
+    }
+
+    void arm_wake() {
+        io_uring_sqe* sqe = prepare(Op::Wake, 0);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wake_fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+        sqe->len = sizeof(wake_value_);
+    }
+
+    void reap(std::vector<IoCompletion>& out) {
+        unsigned head = *cq_head_;
+        unsigned tail = load_acquire(cq_tail_);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            if (cqe.user_data == kCancelData) continue;
+            auto index = static_cast<uint32_t>(cqe.user_data);
+            Slot& slot = slots_[index];
+            bool more = cqe.flags & IORING_CQE_F_MORE;
+            if (slot.op == Op::Wake) {
+                finish(index);
+                if (!stopping_) arm_wake();
+                continue;
+            }
+            IoCompletion c;
+            c.tag = slot.tag;
+            c.result = cqe.res;
+            c.more = more;
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                c.buffer = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                c.data = buffers_.get() + c.buffer * buffer_size_;
+                if (stopping_) release(c.buffer);
+            }
+            if (!more) finish(index);
+            if (!stopping_) out.push_back(c);
+        }
+        store_release(cq_head_, head);
+    }
+
+    int ring_fd_ = -1;
+    int wake_fd_ = -1;
+    uint64_t wake_value_ = 0;
+    bool stopping_ = false;
+
+    void* ring_ = nullptr;
+    size_t ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_local_tail_ = 0;
+    unsigned to_submit_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_size_ = 0;
+    uint16_t buf_tail_ = 0;
+    unsigned buffer_count_ = 0;
+    size_t buffer_size_ = 0;
+    std::unique_ptr<char[]> buffers_;
+
+    std::deque<Slot> slots_; // stable addresses: the kernel reads msghdrs in place
+    std::vector<uint32_t> free_slots_;
+    size_t in_flight_ = 0;
+};
+
+// Multishot recv arrived in 6.0, a release after everything the
+// constructor checks, and older kernels fail each one with -EINVAL. Send a
+// byte over a socketpair and see whether a multishot recv takes it and
+// stays armed. Only the first caller pays for the probe.
+bool multishot_recv_supported() {
+    static const bool supported = [] {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0) return false;
+        bool works = false;
+        try {
+            IoEngineOptions probe;
+            probe.queue_depth = 4;
+            probe.buffer_count = 1;
+            probe.buffer_size = 64;
+            UringEngine engine(probe);
+            engine.recv(fds[0], 1);
+            char byte = 0;
+            if (::write(fds[1], &byte, 1) == 1) {
+                std::vector<IoCompletion> completions;
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                while (completions.empty() && std::chrono::steady_clock::now() < deadline) {
+                    engine.wait(completions, 100);
+                }
+                works = !completions.empty() && completions[0].result == 1 && completions[0].more;
+                for (const auto& c : completions) {
+                    if (c.data) engine.release(c.buffer);
+                }
+            }
+        } catch (const std::system_error&) {
+            works = false;
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return works;
+    }();
+    return supported;
+}
+
+#endif // HAS_IO_URING
+
+} // namespace
+
+std::unique_ptr<IoEngine> make_io_engine(IoBackend backend, const IoEngineOptions& options) {
+    if (backend == IoBackend::Epoll) return std::make_unique<EpollEngine>(options);
+#ifdef HAS_IO_URING
+    if (!multishot_recv_supported()) {
+        if (backend == IoBackend::IoUring) {
+            throw std::system_error(ENOSYS, std::generic_category(), "io_uring multishot recv");
+        }
+        return std::make_unique<EpollEngine>(options);
+    }
+    if (backend == IoBackend::IoUring) return std::make_unique<UringEngine>(options);
+    try {
+        return std::make_unique<UringEngine>(options);
+    } catch (const std::system_error&) {
+        return std::make_unique<EpollEngine>(options);
+    }
+#else
+    if (backend == IoBackend::IoUring) {
+        throw std::system_error(ENOSYS, std::generic_category(), "io_uring support not compiled in");
+    }
+    return std::make_unique<EpollEngine>(options);
+#endif
+}
+
+bool io_uring_available() {
+#ifdef HAS_IO_URING
+    return multishot_recv_supported();
+#else
+    return false;
+#endif
+}
+
+} // namespace cache
@@ -0,0 +1,75 @@
+#include "../include/cache/latency_histogram.hpp"
+
+namespace cache {
+
+LatencyHistogram::~LatencyHistogram() {
+    for (auto& slot : stripes_) {
+        delete slot.load(std::memory_order_acquire);
+    }
+}
+
+size_t LatencyHistogram::thread_slot() {
+    // Threads get consecutive slots; beyond kMaxStripes threads share
+    // stripes, which stays correct because counters are atomic.
+    static std::atomic<size_t> next_slot{0};
+    thread_local const size_t slot =
+        next_slot.fetch_add(1, std::memory_order_relaxed) % kMaxStripes;
+    return slot;
+}
+
+LatencyHistogram::Stripe& LatencyHistogram::allocate_stripe(std::atomic<Stripe*>& slot) {
+    Stripe* fresh = new Stripe();
+    Stripe* expected = nullptr;
+    if (!slot.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+        delete fresh;
+        return *expected;
+    }
+    return *fresh;
+}
+
+std::vector<uint64_t> LatencyHistogram::snapshot() const {
+    std::vector<uint64_t> merged(kBucketCount, 0);
+    for (auto& slot : stripes_) {
+        const Stripe* s = slot.load(std::memory_order_acquire);
+        if (!s) continue;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            merged[i] += s->counts[i].load(std::memory_order_relaxed);
+        }
+    }
+    return merged;
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (uint64_t c : snapshot()) total += c;
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    return percentile(snapshot(), p);
+}
+
+uint64_t LatencyHistogram::percentile(const std::vector<uint64_t>& merged, double p) {
+    uint64_t total = 0;
+    for (uint64_t c : merged) total += c;
+    if (total == 0) return 0;
+    if (p < 0.0) p = 0.0;
+    if (p > 1.0) p = 1.0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < merged.size(); ++i) {
+        seen += merged[i];
+        if (seen >= rank) return bucket_value(i);
+    }
+    return bucket_value(merged.size() - 1);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& slot : stripes_) {
+        Stripe* s = slot.load(std::memory_order_acquire);
+        if (!s) continue;
+        for (auto& c : s->counts) c.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace cache
@@ -0,0 +1,147 @@
+#include "../include/cache/lz4_codec.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace cache {
+namespace lz4 {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;   // block must end with >= 5 literals
+constexpr size_t kMatchSafeDistance = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr unsigned kHashLog = 12;
+
+inline uint32_t read32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash_sequence(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+inline char* write_length(char* op, size_t len) {
+    while (len >= 255) {
+        *op++ = static_cast<char>(255);
+        len -= 255;
+    }
+    *op++ = static_cast<char>(len);
+    return op;
+}
+
+char* emit_sequence(char* op, const char* literals, size_t literal_len,
+                    size_t offset, size_t match_len) {
+    char* token = op++;
+    uint8_t t = 0;
+    if (literal_len >= 15) {
+        t = 15 << 4;
+        op = write_length(op, literal_len - 15);
+    } else {
+        t = static_cast<uint8_t>(literal_len << 4);
+    }
+    std::memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (match_len == 0) {
+        *token = static_cast<char>(t);
+        return op;
+    }
+    *op++ = static_cast<char>(offset & 0xff);
+    *op++ = static_cast<char>(offset >> 8);
+    size_t ml = match_len - kMinMatch;
+    if (ml >= 15) {
+        t |= 15;
+        op = write_length(op, ml - 15);
+    } else {
+        t |= static_cast<uint8_t>(ml);
+    }
+    *token = static_cast<char>(t);
+    return op;
+}
+
+} // namespace
+
+size_t compress(const char* src, size_t size, char* dst) {
+    char* op = dst;
+    const char* anchor = src;
+    if (size > kMatchSafeDistance) {
+        uint32_t table[1u << kHashLog] = {};
+        const char* const match_limit = src + size - kMatchSafeDistance;
+        const char* const match_end = src + size - kLastLiterals;
+        const char* ip = src + 1;
+        while (ip < match_limit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = hash_sequence(seq);
+            const char* ref = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+            if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxOffset || read32(ref) != seq) {
+                ++ip;
+                continue;
+            }
+            // Extend backwards over pending literals, then forwards.
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+            size_t len = kMinMatch;
+            while (ip + len < match_end && ip[len] == ref[len]) ++len;
+            op = emit_sequence(op, anchor, static_cast<size_t>(ip - anchor),
+                               static_cast<size_t>(ip - ref), len);
+            ip += len;
+            anchor = ip;
+        }
+    }
+    return static_cast<size_t>(
+        emit_sequence(op, anchor, static_cast<size_t>(src + size - anchor), 0, 0) - dst);
+}
+
+bool decompress(const char* src, size_t size, char* dst, size_t raw_size) {
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* const iend = ip + size;
+    char* op = dst;
+    char* const oend = dst + raw_size;
+
+    auto read_length = [&](size_t len) -> size_t {
+        if (len != 15) return len;
+        uint8_t b;
+        do {
+            if (ip >= iend) return SIZE_MAX;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return len;
+    };
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t literal_len = read_length(token >> 4);
+        if (literal_len == SIZE_MAX ||
+            literal_len > static_cast<size_t>(iend - ip) ||
+            literal_len > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == iend) break; // last sequence carries literals only
+
+        if (iend - ip < 2) return false;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+        size_t match_len = read_length(token & 15);
+        if (match_len == SIZE_MAX) return false;
+        match_len += kMinMatch;
+        if (match_len > static_cast<size_t>(oend - op)) return false;
+        // Byte copy: matches may overlap their own output.
+        const char* ref = op - offset;
+        for (size_t i = 0; i < match_len; ++i) op[i] = ref[i];
+        op += match_len;
+    }
+    return op == oend;
+}
+
+} // namespace lz4
+} // namespace cache
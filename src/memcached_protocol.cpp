@@ -0,0 +1,194 @@
+#include "../include/cache/memcached_protocol.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+namespace cache {
+
+namespace {
+
+constexpr size_t kIncomplete = static_cast<size_t>(-1);
+// Expiry times up to 30 days are relative; larger values are unix times.
+constexpr int64_t kMaxRelativeExpiry = 60 * 60 * 24 * 30;
+
+std::atomic<uint64_t> next_cas{1};
+
+template<typename T>
+bool parse_number(std::string_view text, T& out) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void tokenize(const char* p, const char* end, std::vector<std::string_view>& tokens) {
+    tokens.clear();
+    while (p < end) {
+        while (p < end && *p == ' ') ++p;
+        const char* start = p;
+        while (p < end && *p != ' ') ++p;
+        if (p > start) tokens.emplace_back(start, static_cast<size_t>(p - start));
+    }
+}
+
+} // namespace
+
+MemcachedHandler::MemcachedHandler(ItemCache& cache, size_t max_item_bytes)
+    : cache_(cache)
+    , max_item_bytes_(max_item_bytes) {}
+
+ProcessResult MemcachedHandler::process(const char* data, size_t len, ReplyBuilder& out) {
+    ProcessResult result;
+    now_ = static_cast<int64_t>(std::time(nullptr));
+    const char* p = data;
+    const char* end = data + len;
+    while (p < end && !result.close) {
+        if (swallow_ > 0) {
+            size_t n = std::min(swallow_, static_cast<size_t>(end - p));
+            p += n;
+            swallow_ -= n;
+            continue;
+        }
+        size_t used = handle(p, end, out, result.close);
+        if (used == 0) break;
+        p += used;
+        ++result.commands;
+    }
+    result.consumed = static_cast<size_t>(p - data);
+    return result;
+}
+
+size_t MemcachedHandler::handle(const char* p, const char* end, ReplyBuilder& out, bool& close) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!nl) {
+        if (static_cast<size_t>(end - p) > kMaxLineBytes) {
+            out.append("CLIENT_ERROR line too long\r\n");
+            close = true;
+            return static_cast<size_t>(end - p);
+        }
+        return 0;
+    }
+    const char* line_end = (nl > p && nl[-1] == '\r') ? nl - 1 : nl;
+    size_t line_len = static_cast<size_t>(nl + 1 - p);
+    tokenize(p, line_end, tokens_);
+    if (tokens_.empty()) {
+        out.append("ERROR\r\n");
+        return line_len;
+    }
+
+    std::string_view command = tokens_[0];
+    if (command == "get" || command == "gets") {
+        handle_get(command == "gets", out);
+    } else if (command == "set") {
+        size_t body = handle_set(nl + 1, end, out);
+        if (body == kIncomplete) return 0;
+        return line_len + body;
+    } else if (command == "delete") {
+        handle_delete(out);
+    } else if (command == "version") {
+        out.append("VERSION 1.0\r\n");
+    } else if (command == "quit") {
+        close = true;
+    } else {
+        out.append("ERROR\r\n");
+    }
+    return line_len;
+}
+
+void MemcachedHandler::handle_get(bool with_cas, ReplyBuilder& out) {
+    if (tokens_.size() < 2) {
+        out.append("ERROR\r\n");
+        return;
+    }
+    keys_.clear();
+    for (size_t i = 1; i < tokens_.size(); ++i) {
+        if (tokens_[i].size() > kMaxKeyBytes) {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        keys_.emplace_back(tokens_[i]);
+    }
+    auto found = cache_.get_many(keys_);
+    std::string header;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (!found[i]) continue;
+        const CacheItem& item = *found[i];
+        if (item.expired(now_)) {
+            cache_.remove(keys_[i]);
+            continue;
+        }
+        header.assign("VALUE ");
+        header += keys_[i];
+        header += ' ';
+        append_number(header, item.flags);
+        header += ' ';
+        append_number(header, item.data->size());
+        if (with_cas) {
+            header += ' ';
+            append_number(header, item.cas);
+        }
+        header += "\r\n";
+        out.append(header);
+        out.append_value(item.data);
+        out.append("\r\n");
+    }
+    out.append("END\r\n");
+}
+
+size_t MemcachedHandler::handle_set(const char* body, const char* end, ReplyBuilder& out) {
+    // set <key> <flags> <exptime> <bytes> [noreply]
+    bool noreply = tokens_.size() == 6 && tokens_[5] == "noreply";
+    uint32_t flags = 0;
+    int64_t exptime = 0;
+    size_t bytes = 0;
+    if ((tokens_.size() != 5 && !noreply) || tokens_[1].size() > kMaxKeyBytes ||
+        !parse_number(tokens_[2], flags) || !parse_number(tokens_[3], exptime) ||
+        !parse_number(tokens_[4], bytes)) {
+        out.append("CLIENT_ERROR bad command line format\r\n");
+        return 0;
+    }
+    if (bytes > max_item_bytes_) {
+        out.append("SERVER_ERROR object too large for cache\r\n");
+        swallow_ = bytes + 2;
+        return 0;
+    }
+    if (static_cast<size_t>(end - body) < bytes + 2) return kIncomplete;
+    if (body[bytes] != '\r' || body[bytes + 1] != '\n') {
+        out.append("CLIENT_ERROR bad data chunk\r\n");
+        return bytes + 2;
+    }
+
+    std::string key(tokens_[1]);
+    if (exptime < 0) {
+        // Already expired: the store succeeds but nothing is visible.
+        cache_.remove(key);
+    } else {
+        CacheItem item;
+        item.data = std::make_shared<const std::string>(body, bytes);
+        item.flags = flags;
+        item.cas = next_cas.fetch_add(1, std::memory_order_relaxed);
+        item.expires = exptime == 0 ? 0 : exptime <= kMaxRelativeExpiry ? now_ + exptime : exptime;
+        cache_.put(key, item);
+    }
+    if (!noreply) out.append("STORED\r\n");
+    return bytes + 2;
+}
+
+void MemcachedHandler::handle_delete(ReplyBuilder& out) {
+    bool noreply = tokens_.size() == 3 && tokens_[2] == "noreply";
+    if ((tokens_.size() != 2 && !noreply) || tokens_[1].size() > kMaxKeyBytes) {
+        out.append("CLIENT_ERROR bad command line format\r\n");
+        return;
+    }
+    bool removed = cache_.remove(std::string(tokens_[1]));
+    if (!noreply) out.append(removed ? "DELETED\r\n" : "NOT_FOUND\r\n");
+}
+
+} // namespace cache
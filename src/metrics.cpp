@@ -1,9 +1,10 @@
 #include "../include/cache/metrics.hpp"
+#include "../include/cache/metrics_registry.hpp"
 #include <vector>
 
 namespace cache {
 
-Metrics::Metrics(const std::string& /*cache_name*/) {
+Metrics::Metrics(const std::string& cache_name) : name_(cache_name) {
 #ifdef HAS_PROMETHEUS
     registry_ = std::make_shared<prometheus::Registry>();
     auto& hits_family = prometheus::BuildCounter()
@@ -18,12 +19,17 @@ Metrics::Metrics(const std::string& /*cache_name*/) {
     auto& latency_family = prometheus::BuildHistogram()
         .Name("cache_op_latency_ns").Help("Cache operation latency (ns)")
         .Register(*registry_);
-    prometheus_hits_ = &hits_family.Add({});
-    prometheus_misses_ = &misses_family.Add({});
-    prometheus_evictions_ = &evictions_family.Add({});
-    prometheus_size_ = &size_family.Add({});
-    prometheus_latency_ = &latency_family.Add({}, buckets);
+    prometheus_hits_ = &hits_family.Add({{"cache", cache_name}});
+    prometheus_misses_ = &misses_family.Add({{"cache", cache_name}});
+    prometheus_evictions_ = &evictions_family.Add({{"cache", cache_name}});
+    prometheus_size_ = &size_family.Add({{"cache", cache_name}});
+    prometheus_latency_ = &latency_family.Add({{"cache", cache_name}}, buckets);
 #endif
+    MetricsRegistry::instance().add(this);
+}
+
+Metrics::~Metrics() {
+    MetricsRegistry::instance().remove(this);
 }
 
 void Metrics::record_hit() {
@@ -47,19 +53,40 @@ void Metrics::record_eviction() {
 #endif
 }
 
-void Metrics::record_latency_ns(uint64_t latency_ns) {
+void Metrics::record_latency_ns(LatencyOp op, uint64_t latency_ns) {
+    (op == LatencyOp::Get ? get_latency_ : put_latency_).record(latency_ns);
 #ifdef HAS_PROMETHEUS
     if (prometheus_latency_) prometheus_latency_->Observe(static_cast<double>(latency_ns));
-#else
-    (void)latency_ns;
 #endif
 }
 
+void Metrics::record_compression(size_t raw_bytes, size_t compressed_bytes) {
+    compressions_.fetch_add(1, std::memory_order_relaxed);
+    compressed_in_bytes_.fetch_add(raw_bytes, std::memory_order_relaxed);
+    compressed_out_bytes_.fetch_add(compressed_bytes, std::memory_order_relaxed);
+}
+
+void Metrics::record_decompression() {
+    decompressions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::record_decompression_failure() {
+    decompression_failures_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::record_replication(uint64_t records, uint64_t bytes) {
+    replicated_records_.fetch_add(records, std::memory_order_relaxed);
+    replicated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Metrics::set_replication_lag(uint64_t bytes) {
+    replication_lag_.store(bytes, std::memory_order_relaxed);
+}
+
 void Metrics::set_size(size_t size) {
+    size_.store(size, std::memory_order_relaxed);
 #ifdef HAS_PROMETHEUS
     if (prometheus_size_) prometheus_size_->Set(static_cast<double>(size));
-#else
-    (void)size;
 #endif
 }
 
@@ -0,0 +1,122 @@
+#include "../include/cache/metrics_http_server.hpp"
+#include "../include/cache/metrics_registry.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace cache {
+
+namespace {
+
+constexpr int kPollIntervalMs = 100;
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string response(const char* status, const char* content_type, const std::string& body) {
+    std::string out = "HTTP/1.0 ";
+    out += status;
+    out += "\r\nContent-Type: ";
+    out += content_type;
+    out += "\r\nContent-Length: " + std::to_string(body.size());
+    out += "\r\nConnection: close\r\n\r\n";
+    out += body;
+    return out;
+}
+
+} // namespace
+
+MetricsHttpServer::MetricsHttpServer(uint16_t port, const std::string& bind_address)
+    : port_(port)
+    , bind_address_(bind_address) {}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+void MetricsHttpServer::start() {
+    if (running()) return;
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    if (::inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, 16) < 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "bind " + bind_address_);
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    listen_fd_ = fd;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { serve(); });
+}
+
+void MetricsHttpServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+    if (thread_.joinable()) thread_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void MetricsHttpServer::serve() {
+    pollfd pfd{listen_fd_, POLLIN, 0};
+    while (running_.load(std::memory_order_acquire)) {
+        int ready = ::poll(&pfd, 1, kPollIntervalMs);
+        if (ready <= 0) continue;
+        int client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) continue;
+        handle(client);
+        ::close(client);
+    }
+}
+
+void MetricsHttpServer::handle(int client_fd) {
+    // Scrapers send a small request; only the request line matters.
+    timeval timeout{1, 0};
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    if (line.rfind("GET ", 0) != 0) {
+        send_all(client_fd, response("405 Method Not Allowed", "text/plain", "method not allowed\n"));
+        return;
+    }
+    std::string path = line.substr(4, line.find(' ', 4) - 4);
+    if (path == "/metrics" || path.rfind("/metrics?", 0) == 0) {
+        send_all(client_fd, response("200 OK", "text/plain; version=0.0.4",
+                                     MetricsRegistry::instance().render_prometheus()));
+    } else {
+        send_all(client_fd, response("404 Not Found", "text/plain", "not found\n"));
+    }
+}
+
+} // namespace cache
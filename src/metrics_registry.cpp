@@ -0,0 +1,199 @@
+#include "../include/cache/metrics_registry.hpp"
+#include "../include/cache/metrics.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+namespace {
+
+std::string escape_label(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+struct Family {
+    const char* name;
+    const char* type;
+    const char* help;
+};
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // Leaked on purpose so caches with static storage can unregister safely
+    // during shutdown regardless of destruction order.
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+void MetricsRegistry::add(const Metrics* metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.push_back({metrics, unique_instance(metrics, std::string())});
+}
+
+void MetricsRegistry::remove(const Metrics* metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.erase(std::remove_if(metrics_.begin(), metrics_.end(),
+                                  [metrics](const Entry& e) { return e.metrics == metrics; }),
+                   metrics_.end());
+}
+
+size_t MetricsRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metrics_.size();
+}
+
+void MetricsRegistry::set_instance(const Metrics& metrics, const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& e : metrics_) {
+        if (e.metrics == &metrics && e.instance != label) e.instance = unique_instance(&metrics, label);
+    }
+}
+
+std::string MetricsRegistry::instance_of(const Metrics& metrics) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& e : metrics_) {
+        if (e.metrics == &metrics) return e.instance;
+    }
+    return std::string();
+}
+
+std::string MetricsRegistry::unique_instance(const Metrics* self, const std::string& label) {
+    const std::string& name = self->name();
+    auto taken = [&](const std::string& instance) {
+        for (const auto& e : metrics_) {
+            if (e.metrics != self && e.instance == instance && e.metrics->name() == name) return true;
+        }
+        return false;
+    };
+    if (!taken(label)) return label;
+    uint64_t& n = suffixes_[{name, label}];
+    std::string instance;
+    do {
+        n = std::max<uint64_t>(n, 1) + 1;
+        instance = label.empty() ? std::to_string(n) : label + "-" + std::to_string(n);
+    } while (taken(instance));
+    return instance;
+}
+
+std::string MetricsRegistry::render_prometheus() const {
+    static const Family kCounters[] = {
+        {"cache_hits_total", "counter", "Cache hit count"},
+        {"cache_misses_total", "counter", "Cache miss count"},
+        {"cache_evictions_total", "counter", "Cache eviction count"},
+        {"cache_compressions_total", "counter", "Values compressed in the cold tier"},
+        {"cache_decompressions_total", "counter", "Compressed values inflated on hit"},
+        {"cache_decompression_failures_total", "counter", "Compressed values dropped because they failed to decode"},
+        {"cache_size", "gauge", "Cache size"},
+        {"cache_hit_ratio", "gauge", "Hits divided by lookups"},
+        {"cache_compression_ratio", "gauge", "Raw bytes per compressed byte"},
+        {"cache_replicated_records_total", "counter", "Mutations shipped to or applied from a replication stream"},
+        {"cache_replicated_bytes_total", "counter", "Replication stream bytes shipped or applied"},
+        {"cache_replication_lag_bytes", "gauge", "Replication log bytes not yet applied by the slowest replica"},
+    };
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    // Copied out under the lock, which only keeps the Metrics alive;
+    // percentiles and formatting happen after it is released. Labels are
+    // unique among live entries (see unique_instance()).
+    struct Series {
+        uint64_t hits = 0, misses = 0, evictions = 0, compressions = 0, decompressions = 0, size = 0;
+        uint64_t decompression_failures = 0;
+        uint64_t compressed_in = 0, compressed_out = 0;
+        uint64_t replicated_records = 0, replicated_bytes = 0, replication_lag = 0;
+        std::vector<uint64_t> latency[2]; // get, put
+    };
+    std::map<std::pair<std::string, std::string>, Series> series;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Entry& e : metrics_) {
+            const Metrics* m = e.metrics;
+            Series& s = series[{m->name(), e.instance}];
+            s.hits = m->hits();
+            s.misses = m->misses();
+            s.evictions = m->evictions();
+            s.compressions = m->compressions();
+            s.decompressions = m->decompressions();
+            s.decompression_failures = m->decompression_failures();
+            s.size = m->size();
+            s.compressed_in = m->compressed_in_bytes();
+            s.compressed_out = m->compressed_out_bytes();
+            s.replicated_records = m->replicated_records();
+            s.replicated_bytes = m->replicated_bytes();
+            s.replication_lag = m->replication_lag();
+            s.latency[0] = m->histogram(LatencyOp::Get).snapshot();
+            s.latency[1] = m->histogram(LatencyOp::Put).snapshot();
+        }
+    }
+
+    std::vector<std::string> labels;
+    labels.reserve(series.size());
+    for (const auto& entry : series) {
+        std::string label = "cache=\"" + escape_label(entry.first.first) + "\"";
+        if (!entry.first.second.empty()) label += ",instance=\"" + escape_label(entry.first.second) + "\"";
+        labels.push_back(std::move(label));
+    }
+
+    std::ostringstream out;
+    for (size_t f = 0; f < sizeof(kCounters) / sizeof(kCounters[0]); ++f) {
+        const Family& family = kCounters[f];
+        out << "# HELP " << family.name << ' ' << family.help << '\n';
+        out << "# TYPE " << family.name << ' ' << family.type << '\n';
+        size_t i = 0;
+        for (const auto& entry : series) {
+            const Series& s = entry.second;
+            out << family.name << '{' << labels[i++] << "} ";
+            switch (f) {
+                case 0: out << s.hits; break;
+                case 1: out << s.misses; break;
+                case 2: out << s.evictions; break;
+                case 3: out << s.compressions; break;
+                case 4: out << s.decompressions; break;
+                case 5: out << s.decompression_failures; break;
+                case 6: out << s.size; break;
+                case 7:
+                    out << (s.hits + s.misses > 0 ? static_cast<double>(s.hits) / (s.hits + s.misses) : 0.0);
+                    break;
+                case 8:
+                    out << (s.compressed_out > 0 ? static_cast<double>(s.compressed_in) / s.compressed_out : 0.0);
+                    break;
+                case 9: out << s.replicated_records; break;
+                case 10: out << s.replicated_bytes; break;
+                case 11: out << s.replication_lag; break;
+            }
+            out << '\n';
+        }
+    }
+
+    out << "# HELP cache_op_latency_ns Cache operation latency (ns)\n";
+    out << "# TYPE cache_op_latency_ns summary\n";
+    size_t i = 0;
+    for (const auto& entry : series) {
+        const std::string& label = labels[i++];
+        for (int op = 0; op < 2; ++op) {
+            const char* op_name = op == 0 ? "get" : "put";
+            const std::vector<uint64_t>& counts = entry.second.latency[op];
+            for (double q : kQuantiles) {
+                out << "cache_op_latency_ns{" << label << ",op=\"" << op_name
+                    << "\",quantile=\"" << q << "\"} " << LatencyHistogram::percentile(counts, q) << '\n';
+            }
+            uint64_t count = 0;
+            for (uint64_t c : counts) count += c;
+            out << "cache_op_latency_ns_count{" << label << ",op=\"" << op_name << "\"} " << count << '\n';
+        }
+    }
+    return out.str();
+}
+
+} // namespace cache
@@ -0,0 +1,102 @@
+#include "../include/cache/miss_ratio_curve.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace cache {
+
+namespace {
+constexpr size_t kInitialClockSpace = 1024;
+} // namespace
+
+MissRatioCurve::MissRatioCurve(double sampling_rate)
+    : rate_(std::min(1.0, std::max(sampling_rate, 1.0 / (kSampleMask + 1))))
+    , threshold_(static_cast<uint64_t>(std::ceil(rate_ * (kSampleMask + 1))))
+    , fenwick_(kInitialClockSpace + 1, 0) {}
+
+void MissRatioCurve::fenwick_add(size_t pos, int64_t delta) {
+    for (size_t i = pos + 1; i < fenwick_.size(); i += i & (~i + 1)) fenwick_[i] += delta;
+}
+
+int64_t MissRatioCurve::fenwick_prefix(size_t pos) const {
+    int64_t sum = 0;
+    for (size_t i = pos; i > 0; i -= i & (~i + 1)) sum += fenwick_[i];
+    return sum;
+}
+
+void MissRatioCurve::compact() {
+    // Renumber live timestamps densely, keeping their order, and size the
+    // clock space to twice the tracked key count.
+    std::vector<std::pair<size_t, uint64_t>> order;
+    order.reserve(last_access_.size());
+    for (const auto& kv : last_access_) order.emplace_back(kv.second, kv.first);
+    std::sort(order.begin(), order.end());
+    size_t space = std::max(kInitialClockSpace, order.size() * 2);
+    fenwick_.assign(space + 1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        last_access_[order[i].second] = i;
+        fenwick_add(i, 1);
+    }
+    clock_ = order.size();
+}
+
+void MissRatioCurve::record_sampled(uint64_t key_hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (clock_ + 1 >= fenwick_.size()) compact();
+    size_t now = clock_++;
+    ++references_;
+
+    auto it = last_access_.find(key_hash);
+    if (it == last_access_.end()) {
+        ++cold_misses_;
+        last_access_.emplace(key_hash, now);
+    } else {
+        size_t prev = it->second;
+        // Distinct sampled keys touched after prev, plus the key itself.
+        size_t distance = static_cast<size_t>(fenwick_prefix(now) - fenwick_prefix(prev + 1)) + 1;
+        if (distance_counts_.size() < distance) distance_counts_.resize(distance, 0);
+        ++distance_counts_[distance - 1];
+        fenwick_add(prev, -1);
+        it->second = now;
+    }
+    fenwick_add(now, 1);
+}
+
+double MissRatioCurve::hit_ratio(size_t capacity) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (references_ == 0) return 0.0;
+    // A reference hits in an LRU cache of size C when its stack distance is
+    // at most C; in the sampled stream that is C * rate.
+    size_t limit = static_cast<size_t>(static_cast<double>(capacity) * rate_);
+    limit = std::min(limit, distance_counts_.size());
+    uint64_t hits = 0;
+    for (size_t i = 0; i < limit; ++i) hits += distance_counts_[i];
+    return static_cast<double>(hits) / static_cast<double>(references_);
+}
+
+std::vector<std::pair<size_t, double>> MissRatioCurve::curve(size_t max_capacity, size_t points) const {
+    std::vector<std::pair<size_t, double>> out;
+    if (points == 0) return out;
+    out.reserve(points);
+    for (size_t i = 1; i <= points; ++i) {
+        size_t capacity = max_capacity * i / points;
+        out.emplace_back(capacity, miss_ratio(capacity));
+    }
+    return out;
+}
+
+uint64_t MissRatioCurve::sampled_references() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return references_;
+}
+
+void MissRatioCurve::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_access_.clear();
+    fenwick_.assign(kInitialClockSpace + 1, 0);
+    clock_ = 0;
+    distance_counts_.clear();
+    cold_misses_ = 0;
+    references_ = 0;
+}
+
+} // namespace cache
@@ -0,0 +1,592 @@
+#include "../include/cache/replication.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace cache {
+
+namespace {
+
+constexpr char kMagic[8] = {'H', 'P', 'C', 'R', 'E', 'P', 'L', '1'};
+constexpr size_t kFrameHeader = 1 + sizeof(uint64_t);
+constexpr int kAcceptPollMs = 100;
+
+enum class Frame : uint8_t { Snapshot = 1, Batch = 2, Heartbeat = 3 };
+
+void put_u64(std::string& out, uint64_t v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+uint64_t get_u64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::string frame_header(Frame type, uint64_t length) {
+    std::string header(1, static_cast<char>(type));
+    put_u64(header, length);
+    return header;
+}
+
+bool send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recv_all(int fd, char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::recv(fd, data, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false; // closed, error or timeout
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void set_timeouts(int fd, std::chrono::milliseconds timeout) {
+    timeval tv{};
+    tv.tv_sec = timeout.count() / 1000;
+    tv.tv_usec = (timeout.count() % 1000) * 1000;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+uint64_t random_id() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+// Staging files are written by name (save_snapshot() uses fopen), so they
+// go in a fresh 0700 directory: no other user can plant a file or symlink
+// at a name we are about to write.
+std::string make_staging_dir(const std::string& parent, const std::string& name) {
+    std::string base = parent;
+    if (base.empty()) {
+        const char* tmp = std::getenv("TMPDIR");
+        base = tmp && *tmp ? tmp : "/tmp";
+    }
+    std::string leaf = name;
+    std::replace(leaf.begin(), leaf.end(), '/', '_');
+    std::string path = base + "/" + leaf + ".XXXXXX";
+    if (!::mkdtemp(path.data())) {
+        throw std::system_error(errno, std::generic_category(), "mkdtemp " + path);
+    }
+    return path;
+}
+
+void remove_staging_dir(std::string& dir) {
+    if (dir.empty()) return;
+    std::error_code ignored;
+    std::filesystem::remove_all(dir, ignored);
+    dir.clear();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ReplicationLog
+
+ReplicationLog::ReplicationLog(size_t capacity)
+    : id_(random_id())
+    , ring_(std::max<size_t>(capacity, 64)) {}
+
+void ReplicationLog::copy_in(uint64_t offset, const char* src, size_t len) {
+    size_t at = static_cast<size_t>(offset % ring_.size());
+    size_t first = std::min(len, ring_.size() - at);
+    std::memcpy(&ring_[at], src, first);
+    std::memcpy(&ring_[0], src + first, len - first);
+}
+
+void ReplicationLog::copy_out(uint64_t offset, char* dst, size_t len) const {
+    size_t at = static_cast<size_t>(offset % ring_.size());
+    size_t first = std::min(len, ring_.size() - at);
+    std::memcpy(dst, &ring_[at], first);
+    std::memcpy(dst + first, &ring_[0], len - first);
+}
+
+uint64_t ReplicationLog::append(const char* data, size_t len) {
+    uint32_t n = static_cast<uint32_t>(len);
+    uint64_t need = sizeof(n) + len;
+    uint64_t end;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (need > ring_.size()) {
+            // Cannot be held at all: every replica has to resync past it.
+            head_ += need;
+            tail_ = head_;
+        } else {
+            copy_in(head_, reinterpret_cast<const char*>(&n), sizeof(n));
+            copy_in(head_ + sizeof(n), data, len);
+            head_ += need;
+            if (head_ - tail_ > ring_.size()) tail_ = head_ - ring_.size();
+        }
+        end = head_;
+    }
+    appended_.notify_all();
+    return end;
+}
+
+uint64_t ReplicationLog::head() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return head_;
+}
+
+bool ReplicationLog::read(uint64_t from, size_t max_bytes, std::string& out, size_t& records,
+                          std::chrono::milliseconds wait) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    appended_.wait_for(lock, wait, [&] { return head_ != from; });
+    if (from < tail_ || from > head_) return false;
+    records = 0;
+    for (uint64_t pos = from; pos < head_;) {
+        uint32_t n;
+        copy_out(pos, reinterpret_cast<char*>(&n), sizeof(n));
+        size_t need = sizeof(n) + n;
+        if (records > 0 && out.size() + need > max_bytes) break;
+        size_t at = out.size();
+        out.resize(at + need);
+        copy_out(pos, &out[at], need);
+        pos += need;
+        ++records;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ReplicationServer
+
+struct ReplicationServer::Replica {
+    int fd = -1;
+    std::thread thread;
+    std::atomic<uint64_t> acked{0};
+    std::atomic<bool> done{false};
+    std::string acks; // partial ack bytes
+};
+
+ReplicationServer::ReplicationServer(const ReplicationLog& log, SnapshotFn snapshot,
+                                     const ReplicationOptions& options, const std::string& name)
+    : log_(log)
+    , snapshot_(std::move(snapshot))
+    , options_(options)
+    , name_(name)
+    , metrics_(name) {}
+
+ReplicationServer::~ReplicationServer() { stop(); }
+
+void ReplicationServer::start() {
+    if (running_.load()) return;
+    staging_dir_ = make_staging_dir(options_.snapshot_dir, name_);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        int err = errno;
+        remove_staging_dir(staging_dir_);
+        throw std::system_error(err, std::generic_category(), "socket");
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    if (::inet_pton(AF_INET, options_.bind_address.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, 64) < 0) {
+        int err = errno;
+        ::close(fd);
+        remove_staging_dir(staging_dir_);
+        throw std::system_error(err, std::generic_category(), "bind " + options_.bind_address);
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    listen_fd_ = fd;
+    port_ = ntohs(addr.sin_port);
+    running_.store(true);
+    acceptor_ = std::thread([this] { accept_loop(); });
+}
+
+void ReplicationServer::stop() {
+    if (!running_.exchange(false)) return;
+    acceptor_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    std::list<std::unique_ptr<Replica>> replicas;
+    {
+        std::lock_guard<std::mutex> lock(replicas_mutex_);
+        replicas.swap(replicas_);
+    }
+    // Unblocks senders stuck in send() to a replica that stopped reading.
+    for (auto& r : replicas) ::shutdown(r->fd, SHUT_RDWR);
+    for (auto& r : replicas) {
+        r->thread.join();
+        ::close(r->fd);
+    }
+    remove_staging_dir(staging_dir_);
+}
+
+size_t ReplicationServer::replicas() const {
+    std::lock_guard<std::mutex> lock(replicas_mutex_);
+    size_t live = 0;
+    for (const auto& r : replicas_) live += !r->done.load();
+    return live;
+}
+
+void ReplicationServer::accept_loop() {
+    while (running_.load()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, kAcceptPollMs) > 0) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                set_timeouts(fd, options_.timeout);
+                auto replica = std::make_unique<Replica>();
+                replica->fd = fd;
+                Replica* r = replica.get();
+                std::lock_guard<std::mutex> lock(replicas_mutex_);
+                replicas_.push_back(std::move(replica));
+                r->thread = std::thread([this, r] {
+                    serve(*r);
+                    r->done.store(true);
+                });
+            }
+        }
+        // Reap replicas that disconnected.
+        std::lock_guard<std::mutex> lock(replicas_mutex_);
+        for (auto it = replicas_.begin(); it != replicas_.end();) {
+            if ((*it)->done.load()) {
+                (*it)->thread.join();
+                ::close((*it)->fd);
+                it = replicas_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void ReplicationServer::serve(Replica& replica) {
+    char hello[sizeof(kMagic) + 2 * sizeof(uint64_t)];
+    if (!recv_all(replica.fd, hello, sizeof(hello)) ||
+        std::memcmp(hello, kMagic, sizeof(kMagic)) != 0) {
+        return;
+    }
+    uint64_t position = get_u64(hello + sizeof(kMagic) + sizeof(uint64_t));
+    bool full_sync = get_u64(hello + sizeof(kMagic)) != log_.id() || position == kNoReplicationOffset;
+    if (!full_sync) replica.acked.store(position);
+
+    std::string batch;
+    while (running_.load()) {
+        if (full_sync) {
+            // Counted before sending: the replica may finish loading before
+            // send_snapshot() returns here.
+            full_syncs_.fetch_add(1, std::memory_order_relaxed);
+            if (!send_snapshot(replica.fd, position)) return;
+            full_sync = false;
+        }
+        batch.assign(kFrameHeader + 2 * sizeof(uint64_t), '\0');
+        size_t records = 0;
+        if (!log_.read(position, options_.max_batch_bytes, batch, records, options_.heartbeat)) {
+            full_sync = true; // fell out of the backlog
+            continue;
+        }
+        uint64_t head = log_.head();
+        if (records == 0) {
+            std::string frame = frame_header(Frame::Heartbeat, sizeof(uint64_t));
+            put_u64(frame, head);
+            if (!send_all(replica.fd, frame.data(), frame.size())) return;
+        } else {
+            size_t bytes = batch.size() - kFrameHeader - 2 * sizeof(uint64_t);
+            std::string header = frame_header(Frame::Batch, batch.size() - kFrameHeader);
+            put_u64(header, position);
+            put_u64(header, head);
+            batch.replace(0, header.size(), header);
+            // Counted before sending, like a full sync: the replica may
+            // apply the batch before send_all() returns here.
+            metrics_.record_replication(records, bytes);
+            if (!send_all(replica.fd, batch.data(), batch.size())) return;
+            position += bytes;
+        }
+        if (!read_acks(replica)) return;
+        update_lag();
+    }
+}
+
+bool ReplicationServer::send_snapshot(int fd, uint64_t& offset) {
+    std::string path = staging_dir_ + "/sync." + std::to_string(snapshot_seq_.fetch_add(1));
+    uint64_t at = snapshot_(path);
+    int file = at == kNoReplicationOffset ? -1 : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    ::unlink(path.c_str()); // the open descriptor keeps it readable
+    if (file < 0) return false;
+    struct stat st{};
+    bool ok = ::fstat(file, &st) == 0;
+    if (ok) {
+        uint64_t size = static_cast<uint64_t>(st.st_size);
+        std::string header = frame_header(Frame::Snapshot, 2 * sizeof(uint64_t) + size);
+        put_u64(header, log_.id());
+        put_u64(header, at);
+        ok = send_all(fd, header.data(), header.size());
+        // Not sendfile(): it raises SIGPIPE when the replica has gone away.
+        char chunk[64 * 1024];
+        for (uint64_t sent = 0; ok && sent < size;) {
+            ssize_t n = ::pread(file, chunk, sizeof(chunk), static_cast<off_t>(sent));
+            ok = n > 0 && send_all(fd, chunk, static_cast<size_t>(n));
+            sent += static_cast<uint64_t>(std::max<ssize_t>(n, 0));
+        }
+    }
+    ::close(file);
+    if (ok) offset = at;
+    return ok;
+}
+
+bool ReplicationServer::read_acks(Replica& replica) {
+    char buf[256];
+    for (;;) {
+        ssize_t n = ::recv(replica.fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            replica.acks.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+        break;
+    }
+    size_t whole = replica.acks.size() / sizeof(uint64_t) * sizeof(uint64_t);
+    if (whole > 0) {
+        replica.acked.store(get_u64(replica.acks.data() + whole - sizeof(uint64_t)));
+        replica.acks.erase(0, whole);
+    }
+    return true;
+}
+
+void ReplicationServer::update_lag() {
+    uint64_t head = log_.head();
+    uint64_t lag = 0;
+    std::lock_guard<std::mutex> lock(replicas_mutex_);
+    for (const auto& r : replicas_) {
+        if (!r->done.load()) lag = std::max(lag, head - std::min(head, r->acked.load()));
+    }
+    metrics_.set_replication_lag(lag);
+}
+
+// ---------------------------------------------------------------------------
+// ReplicationClient
+
+struct ReplicationClient::Address {
+    sockaddr_storage addr{};
+    socklen_t len = 0;
+};
+
+ReplicationClient::ReplicationClient(const std::string& primary, Handler handler,
+                                     const ReplicationOptions& options, const std::string& name)
+    : address_(std::make_unique<Address>())
+    , handler_(std::move(handler))
+    , options_(options)
+    , name_(name)
+    , metrics_(name) {
+    size_t colon = primary.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == primary.size()) {
+        throw std::invalid_argument("primary must be host:port: " + primary);
+    }
+    std::string host = primary.substr(0, colon);
+    std::string port = primary.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) {
+        throw std::invalid_argument("cannot resolve " + primary);
+    }
+    std::memcpy(&address_->addr, found->ai_addr, found->ai_addrlen);
+    address_->len = found->ai_addrlen;
+    ::freeaddrinfo(found);
+}
+
+ReplicationClient::~ReplicationClient() { stop(); }
+
+void ReplicationClient::start() {
+    if (running_.load()) return;
+    staging_dir_ = make_staging_dir(options_.snapshot_dir, name_);
+    running_.store(true);
+    thread_ = std::thread([this] { run(); });
+}
+
+void ReplicationClient::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(fd_mutex_);
+        if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    applied_cv_.notify_all(); // also ends the reconnect wait
+    thread_.join();
+    remove_staging_dir(staging_dir_);
+}
+
+bool ReplicationClient::wait_for(uint64_t offset, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    return applied_cv_.wait_for(lock, timeout, [&] {
+        uint64_t applied = applied_.load(std::memory_order_acquire);
+        return applied != kNoReplicationOffset && applied >= offset;
+    });
+}
+
+void ReplicationClient::set_applied(uint64_t offset) {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        applied_.store(offset, std::memory_order_release);
+    }
+    applied_cv_.notify_all();
+    uint64_t primary = primary_.load(std::memory_order_relaxed);
+    metrics_.set_replication_lag(primary > offset ? primary - offset : 0);
+}
+
+void ReplicationClient::run() {
+    auto delay = options_.reconnect_delay;
+    bool first = true;
+    while (running_.load()) {
+        if (!first) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            applied_cv_.wait_for(lock, delay, [this] { return !running_.load(); });
+            if (!running_.load()) break;
+        }
+        first = false;
+        int fd = ::socket(address_->addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) continue;
+        set_timeouts(fd, std::max(options_.timeout, options_.heartbeat * 4));
+        {
+            std::lock_guard<std::mutex> lock(fd_mutex_);
+            fd_ = fd;
+        }
+        bool up = running_.load() &&
+                  ::connect(fd, reinterpret_cast<const sockaddr*>(&address_->addr), address_->len) == 0;
+        if (up) {
+            connected_.store(true, std::memory_order_release);
+            delay = options_.reconnect_delay;
+            session(fd);
+            connected_.store(false, std::memory_order_release);
+        } else {
+            delay = std::min(delay * 2, options_.reconnect_delay * 32);
+        }
+        {
+            std::lock_guard<std::mutex> lock(fd_mutex_);
+            fd_ = -1;
+        }
+        ::close(fd);
+    }
+}
+
+void ReplicationClient::session(int fd) {
+    std::string hello(kMagic, sizeof(kMagic));
+    put_u64(hello, log_id_);
+    put_u64(hello, applied_.load());
+    if (!send_all(fd, hello.data(), hello.size())) return;
+
+    char header[kFrameHeader];
+    while (running_.load() && recv_all(fd, header, sizeof(header))) {
+        uint64_t length = get_u64(header + 1);
+        bool ok = false;
+        switch (static_cast<Frame>(header[0])) {
+            case Frame::Snapshot:
+                ok = receive_snapshot(fd, length);
+                break;
+            case Frame::Batch:
+                ok = receive_batch(fd, length);
+                break;
+            case Frame::Heartbeat: {
+                char head[sizeof(uint64_t)];
+                ok = length == sizeof(head) && recv_all(fd, head, sizeof(head));
+                if (ok) {
+                    primary_.store(get_u64(head), std::memory_order_relaxed);
+                    set_applied(applied_.load());
+                }
+                break;
+            }
+        }
+        if (!ok || !ack(fd)) return;
+    }
+}
+
+bool ReplicationClient::receive_snapshot(int fd, uint64_t length) {
+    char ids[2 * sizeof(uint64_t)];
+    if (length < sizeof(ids) || !recv_all(fd, ids, sizeof(ids))) return false;
+    std::string path = staging_dir_ + "/load";
+    int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (file < 0) return false;
+    uint64_t remaining = length - sizeof(ids);
+    char chunk[64 * 1024];
+    bool ok = true;
+    while (ok && remaining > 0) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(remaining, sizeof(chunk)));
+        ok = recv_all(fd, chunk, n) && ::write(file, chunk, n) == static_cast<ssize_t>(n);
+        remaining -= n;
+    }
+    ::close(file);
+    ok = ok && handler_.load_snapshot(path);
+    ::unlink(path.c_str());
+    if (!ok) return false;
+    log_id_ = get_u64(ids);
+    uint64_t offset = get_u64(ids + sizeof(uint64_t));
+    primary_.store(std::max(primary_.load(), offset), std::memory_order_relaxed);
+    full_syncs_.fetch_add(1, std::memory_order_relaxed);
+    set_applied(offset);
+    return true;
+}
+
+bool ReplicationClient::receive_batch(int fd, uint64_t length) {
+    constexpr size_t kOffsets = 2 * sizeof(uint64_t);
+    if (length < kOffsets) return false;
+    batch_.resize(static_cast<size_t>(length));
+    if (!recv_all(fd, &batch_[0], batch_.size())) return false;
+    uint64_t start = get_u64(batch_.data());
+    uint64_t applied = applied_.load();
+    if (start != applied) return false; // out of step; reconnecting resyncs
+    primary_.store(get_u64(batch_.data() + sizeof(uint64_t)), std::memory_order_relaxed);
+
+    const char* p = batch_.data() + kOffsets;
+    const char* end = batch_.data() + batch_.size();
+    uint64_t records = 0;
+    while (end - p >= static_cast<ptrdiff_t>(sizeof(uint32_t))) {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        p += sizeof(n);
+        if (static_cast<size_t>(end - p) < n) return false;
+        handler_.apply(p, n);
+        p += n;
+        ++records;
+    }
+    uint64_t bytes = batch_.size() - kOffsets;
+    metrics_.record_replication(records, bytes);
+    set_applied(applied + bytes);
+    return true;
+}
+
+bool ReplicationClient::ack(int fd) {
+    uint64_t applied = applied_.load();
+    return send_all(fd, reinterpret_cast<const char*>(&applied), sizeof(applied));
+}
+
+} // namespace cache
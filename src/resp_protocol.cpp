@@ -0,0 +1,322 @@
+#include "../include/cache/resp_protocol.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+namespace cache {
+
+namespace {
+
+bool command_is(std::string_view name, const char* upper) {
+    size_t n = std::strlen(upper);
+    if (name.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::toupper(static_cast<unsigned char>(name[i])) != upper[i]) return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool parse_number(std::string_view text, T& out) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+// Reads "<prefix><digits>\r\n" at p; returns the position after it, or
+// nullptr if the line is incomplete. Sets ok = false on a malformed line.
+const char* read_length(const char* p, const char* end, int64_t& value, bool& ok) {
+    const char* cr = static_cast<const char*>(std::memchr(p, '\r', static_cast<size_t>(end - p)));
+    if (!cr || cr + 1 >= end) {
+        if (end - p > 32) ok = false;
+        return nullptr;
+    }
+    ok = cr[1] == '\n' && parse_number(std::string_view(p + 1, static_cast<size_t>(cr - p - 1)), value);
+    return cr + 2;
+}
+
+} // namespace
+
+RespHandler::RespHandler(ItemCache& cache, size_t max_item_bytes)
+    : cache_(cache)
+    , max_item_bytes_(max_item_bytes) {}
+
+ProcessResult RespHandler::process(const char* data, size_t len, ReplyBuilder& out) {
+    ProcessResult result;
+    now_ = static_cast<int64_t>(std::time(nullptr));
+    args_.clear();
+    commands_.clear();
+    error_.clear();
+    const char* p = data;
+    const char* end = data + len;
+    while (p < end) {
+        size_t used = parse(p, end);
+        if (!error_.empty()) {
+            p = end;
+            break;
+        }
+        if (used == 0) break;
+        p += used;
+    }
+
+    for (size_t i = 0; i < commands_.size() && !result.close;) {
+        if (is_batched_read(commands_[i])) {
+            size_t j = i + 1;
+            while (j < commands_.size() && is_batched_read(commands_[j])) ++j;
+            run_reads(i, j, out);
+            i = j;
+        } else {
+            result.close = !run(commands_[i++], out);
+        }
+    }
+    result.commands = commands_.size();
+    if (!error_.empty()) {
+        reply_error("Protocol error: " + error_, out);
+        result.close = true;
+    }
+    result.consumed = static_cast<size_t>(p - data);
+    return result;
+}
+
+size_t RespHandler::parse(const char* p, const char* end) {
+    if (*p == '*') return parse_multibulk(p, end);
+    return parse_inline(p, end);
+}
+
+size_t RespHandler::parse_multibulk(const char* p, const char* end) {
+    // *<argc>\r\n then argc times $<len>\r\n<bytes>\r\n
+    bool ok = true;
+    int64_t argc = 0;
+    const char* q = read_length(p, end, argc, ok);
+    if (!ok || (q && (argc < 0 || static_cast<size_t>(argc) > kMaxArgs))) {
+        error_ = "invalid multibulk length";
+        return 0;
+    }
+    if (!q) return 0;
+    size_t first = args_.size();
+    for (int64_t i = 0; i < argc; ++i) {
+        if (q >= end) break;
+        if (*q != '$') {
+            error_ = "expected '$'";
+            return 0;
+        }
+        int64_t len = 0;
+        const char* body = read_length(q, end, len, ok);
+        if (!ok || (body && (len < 0 || static_cast<size_t>(len) > max_item_bytes_))) {
+            error_ = "invalid bulk length";
+            return 0;
+        }
+        if (!body || static_cast<size_t>(end - body) < static_cast<size_t>(len) + 2) break;
+        if (body[len] != '\r' || body[len + 1] != '\n') {
+            error_ = "expected CRLF after bulk";
+            return 0;
+        }
+        args_.emplace_back(body, static_cast<size_t>(len));
+        q = body + len + 2;
+    }
+    if (args_.size() - first != static_cast<size_t>(argc)) {
+        args_.resize(first); // incomplete; retried when more input arrives
+        return 0;
+    }
+    if (argc > 0) commands_.push_back({first, static_cast<size_t>(argc)});
+    return static_cast<size_t>(q - p);
+}
+
+size_t RespHandler::parse_inline(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!nl) {
+        if (static_cast<size_t>(end - p) > kMaxInlineBytes) error_ = "too big inline request";
+        return 0;
+    }
+    const char* line_end = (nl > p && nl[-1] == '\r') ? nl - 1 : nl;
+    size_t first = args_.size();
+    for (const char* q = p; q < line_end;) {
+        while (q < line_end && *q == ' ') ++q;
+        const char* start = q;
+        while (q < line_end && *q != ' ') ++q;
+        if (q > start) args_.emplace_back(start, static_cast<size_t>(q - start));
+    }
+    if (args_.size() > first) commands_.push_back({first, args_.size() - first});
+    return static_cast<size_t>(nl + 1 - p);
+}
+
+bool RespHandler::is_batched_read(const Command& c) const {
+    return (c.argc == 2 && command_is(arg(c, 0), "GET")) ||
+           (c.argc >= 2 && command_is(arg(c, 0), "MGET"));
+}
+
+void RespHandler::run_reads(size_t first, size_t last, ReplyBuilder& out) {
+    keys_.clear();
+    for (size_t i = first; i < last; ++i) {
+        for (size_t a = 1; a < commands_[i].argc; ++a) keys_.emplace_back(arg(commands_[i], a));
+    }
+    auto found = cache_.get_many(keys_);
+    for (size_t k = 0; k < found.size(); ++k) {
+        if (found[k] && found[k]->expired(now_)) {
+            cache_.remove(keys_[k]);
+            found[k].reset();
+        }
+    }
+    size_t k = 0;
+    std::string header;
+    for (size_t i = first; i < last; ++i) {
+        const Command& c = commands_[i];
+        if (command_is(arg(c, 0), "MGET")) {
+            header.assign("*");
+            append_number(header, c.argc - 1);
+            header += "\r\n";
+            out.append(header);
+            for (size_t a = 1; a < c.argc; ++a) reply_value(found[k++], out);
+        } else {
+            reply_value(found[k++], out);
+        }
+    }
+}
+
+bool RespHandler::run(const Command& c, ReplyBuilder& out) {
+    std::string_view name = arg(c, 0);
+    auto wrong_arity = [&] {
+        std::string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        reply_error("ERR wrong number of arguments for '" + lower + "' command", out);
+    };
+
+    if (command_is(name, "GET") || command_is(name, "MGET")) {
+        wrong_arity(); // well-formed reads are batched in run_reads
+    } else if (command_is(name, "SET")) {
+        // SET key value [EX seconds | PX milliseconds]
+        if (c.argc != 3 && c.argc != 5) {
+            c.argc < 3 ? wrong_arity() : reply_error("ERR syntax error", out);
+            return true;
+        }
+        int64_t expires = 0;
+        if (c.argc == 5) {
+            int64_t ttl = 0;
+            bool ex = command_is(arg(c, 3), "EX");
+            if ((!ex && !command_is(arg(c, 3), "PX")) || !parse_number(arg(c, 4), ttl)) {
+                reply_error("ERR syntax error", out);
+                return true;
+            }
+            int64_t seconds = ex ? ttl : ttl / 1000 + (ttl % 1000 != 0);
+            // The TTL comes off the wire; now_ + seconds must not overflow.
+            if (ttl <= 0 || seconds > std::numeric_limits<int64_t>::max() - now_) {
+                reply_error("ERR invalid expire time in 'set' command", out);
+                return true;
+            }
+            expires = now_ + seconds;
+        }
+        CacheItem item;
+        item.data = std::make_shared<const std::string>(arg(c, 2));
+        item.expires = expires;
+        cache_.put(std::string(arg(c, 1)), item);
+        out.append("+OK\r\n");
+    } else if (command_is(name, "DEL")) {
+        if (c.argc < 2) {
+            wrong_arity();
+            return true;
+        }
+        int64_t removed = 0;
+        for (size_t a = 1; a < c.argc; ++a) {
+            if (cache_.remove(std::string(arg(c, a)))) ++removed;
+        }
+        reply_int(removed, out);
+    } else if (command_is(name, "EXPIRE")) {
+        int64_t seconds = 0;
+        if (c.argc != 3) {
+            wrong_arity();
+            return true;
+        }
+        if (!parse_number(arg(c, 2), seconds)) {
+            reply_error("ERR value is not an integer or out of range", out);
+            return true;
+        }
+        if (seconds > std::numeric_limits<int64_t>::max() - now_) {
+            reply_error("ERR invalid expire time in 'expire' command", out);
+            return true;
+        }
+        std::string key(arg(c, 1));
+        auto item = cache_.get(key);
+        if (!item || item->expired(now_)) {
+            reply_int(0, out);
+        } else if (seconds <= 0) {
+            cache_.remove(key);
+            reply_int(1, out);
+        } else {
+            // Read-modify-write; a concurrent SET of the same key may win.
+            item->expires = now_ + seconds;
+            cache_.put(key, *item);
+            reply_int(1, out);
+        }
+    } else if (command_is(name, "PING")) {
+        if (c.argc == 1) {
+            out.append("+PONG\r\n");
+        } else {
+            std::string header = "$";
+            append_number(header, arg(c, 1).size());
+            header += "\r\n";
+            out.append(header);
+            out.append(arg(c, 1));
+            out.append("\r\n");
+        }
+    } else if (command_is(name, "HELLO")) {
+        int64_t requested = version_;
+        if (c.argc >= 2 && (!parse_number(arg(c, 1), requested) || requested < 2 || requested > 3)) {
+            reply_error("NOPROTO unsupported protocol version", out);
+            return true;
+        }
+        version_ = static_cast<int>(requested);
+        out.append(version_ == 3 ? "%3\r\n" : "*6\r\n");
+        out.append("$6\r\nserver\r\n$15\r\nhigh-perf-cache\r\n");
+        out.append("$7\r\nversion\r\n$3\r\n1.0\r\n");
+        out.append(version_ == 3 ? "$5\r\nproto\r\n:3\r\n" : "$5\r\nproto\r\n:2\r\n");
+    } else if (command_is(name, "COMMAND")) {
+        out.append("*0\r\n"); // enough for clients that probe on connect
+    } else if (command_is(name, "QUIT")) {
+        out.append("+OK\r\n");
+        return false;
+    } else {
+        reply_error("ERR unknown command '" + std::string(name) + "'", out);
+    }
+    return true;
+}
+
+void RespHandler::reply_value(const std::optional<CacheItem>& item, ReplyBuilder& out) {
+    if (!item) {
+        reply_null(out);
+        return;
+    }
+    std::string header = "$";
+    append_number(header, item->data->size());
+    header += "\r\n";
+    out.append(header);
+    out.append_value(item->data);
+    out.append("\r\n");
+}
+
+void RespHandler::reply_null(ReplyBuilder& out) {
+    out.append(version_ == 3 ? "_\r\n" : "$-1\r\n");
+}
+
+void RespHandler::reply_int(int64_t value, ReplyBuilder& out) {
+    std::string text = ":";
+    append_number(text, value);
+    text += "\r\n";
+    out.append(text);
+}
+
+void RespHandler::reply_error(const std::string& message, ReplyBuilder& out) {
+    out.append("-");
+    out.append(message);
+    out.append("\r\n");
+}
+
+} // namespace cache
@@ -0,0 +1,34 @@
+#include "../include/cache/timing.hpp"
+
+namespace cache {
+
+namespace {
+
+double calibrate_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    uint64_t c0 = TscClock::now();
+    // Spin rather than sleep: a short busy window calibrates to well under 1%.
+    while (clock::now() - t0 < std::chrono::milliseconds(5)) {
+    }
+    uint64_t c1 = TscClock::now();
+    auto t1 = clock::now();
+    double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    return c1 > c0 ? ns / static_cast<double>(c1 - c0) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace
+
+// Calibrated on first use, so programs that never convert ticks (or link
+// the library without timing anything) do not spin for 5ms at startup.
+double TscClock::ns_per_tick() {
+    static const double ns = calibrate_tsc();
+    return ns;
+}
+
+} // namespace cache
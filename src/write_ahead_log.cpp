@@ -0,0 +1,273 @@
+#include "../include/cache/write_ahead_log.hpp"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace cache {
+
+namespace {
+
+constexpr size_t kFrameHeader = 2 * sizeof(uint32_t);
+
+// CRC-32C (Castagnoli): the SSE4.2 instruction computes it directly, and
+// the table fallback produces the same values on other targets.
+#ifdef __SSE4_2__
+uint32_t crc32c(const void* data, size_t len) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t c = 0xFFFFFFFFu;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    for (; len > 0; ++p, --len) c32 = _mm_crc32_u8(c32, *p);
+    return c32 ^ 0xFFFFFFFFu;
+}
+#else
+std::array<uint32_t, 256> make_crc_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0x82F63B78u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+uint32_t crc32c(const void* data, size_t len) {
+    static const std::array<uint32_t, 256> table = make_crc_table();
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+#endif
+
+bool write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& base_path, uint64_t generation,
+                             const WalOptions& options)
+    : base_path_(base_path)
+    , options_(options)
+    , last_fsync_(std::chrono::steady_clock::now()) {
+    open_segment(generation);
+    flusher_ = std::thread([this] { flush_loop(); });
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    flush_cv_.notify_all();
+    flusher_.join();
+    write_batch(true);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+std::string WriteAheadLog::segment_path(const std::string& base_path, uint64_t generation) {
+    return base_path + ".wal." + std::to_string(generation);
+}
+
+void WriteAheadLog::open_segment(uint64_t generation) {
+    std::string path = segment_path(base_path_, generation);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "WriteAheadLog: open " + path);
+    }
+    fd_ = fd;
+    generation_.store(generation, std::memory_order_release);
+}
+
+uint64_t WriteAheadLog::append(const void* data, size_t len) {
+    uint32_t header[2] = {static_cast<uint32_t>(len), crc32c(data, len)};
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_cv_.wait(lock, [&] {
+        return buffer_.size() < options_.max_buffer_bytes || stopping_ || error() != 0;
+    });
+    throw_if_failed();
+    size_t at = buffer_.size();
+    buffer_.resize(at + kFrameHeader + len);
+    std::memcpy(&buffer_[at], header, kFrameHeader);
+    std::memcpy(&buffer_[at + kFrameHeader], data, len);
+    uint64_t lsn = appended_lsn_.load(std::memory_order_relaxed) + kFrameHeader + len;
+    appended_lsn_.store(lsn, std::memory_order_release);
+    if (buffer_.size() >= options_.max_buffer_bytes / 2) flush_cv_.notify_one();
+    return lsn;
+}
+
+void WriteAheadLog::sync() {
+    uint64_t target = appended_lsn();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sync_requested_ = true;
+    }
+    flush_cv_.notify_one();
+    std::unique_lock<std::mutex> lock(mutex_);
+    durable_cv_.wait(lock, [&] { return durable_lsn() >= target || error() != 0; });
+    throw_if_failed();
+}
+
+uint64_t WriteAheadLog::rotate() {
+    std::lock_guard<std::mutex> io(io_mutex_);
+    throw_if_failed();
+    uint64_t lsn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_.swap(buffer_);
+        lsn = appended_lsn();
+    }
+    space_cv_.notify_all();
+    int err = write_all(fd_, batch_.data(), batch_.size()) ? 0 : errno;
+    batch_.clear();
+    if (err == 0 && ::fdatasync(fd_) != 0) err = errno;
+    if (err != 0) {
+        fail(err);
+        throw_if_failed();
+    }
+    ::close(fd_);
+    fd_ = -1;
+    open_segment(generation() + 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        written_lsn_ = lsn;
+        last_fsync_ = std::chrono::steady_clock::now();
+        durable_lsn_.store(lsn, std::memory_order_release);
+    }
+    durable_cv_.notify_all();
+    return generation();
+}
+
+void WriteAheadLog::flush_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        flush_cv_.wait_for(lock, options_.flush_interval, [this] {
+            return stopping_ || sync_requested_ || buffer_.size() >= options_.max_buffer_bytes / 2;
+        });
+        if (stopping_) break;
+        bool force = sync_requested_;
+        sync_requested_ = false;
+        lock.unlock();
+        write_batch(force);
+        lock.lock();
+    }
+}
+
+void WriteAheadLog::write_batch(bool force_sync) {
+    std::lock_guard<std::mutex> io(io_mutex_);
+    uint64_t lsn;
+    bool sync_due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Swapping in the drained batch_ hands its capacity back to the
+        // appenders, so steady-state appends never reallocate.
+        batch_.swap(buffer_);
+        lsn = appended_lsn();
+        if (error() != 0) {
+            // Nothing can be made durable any more; just keep appenders
+            // from blocking on a buffer nobody drains.
+            batch_.clear();
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        sync_due = force_sync || now - last_fsync_ >= options_.fsync_interval;
+        if (batch_.empty() && (lsn == durable_lsn() || !sync_due)) return;
+    }
+    space_cv_.notify_all();
+    if (!batch_.empty()) {
+        int err = write_all(fd_, batch_.data(), batch_.size()) ? 0 : errno;
+        batch_.clear();
+        if (err != 0) {
+            fail(err);
+            return;
+        }
+        group_commits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (sync_due) {
+        if (::fdatasync(fd_) != 0) {
+            fail(errno);
+            return;
+        }
+        fsyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        written_lsn_ = lsn;
+        if (sync_due) {
+            last_fsync_ = std::chrono::steady_clock::now();
+            durable_lsn_.store(lsn, std::memory_order_release);
+        }
+    }
+    if (sync_due) durable_cv_.notify_all();
+}
+
+void WriteAheadLog::fail(int err) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int expected = 0;
+        error_.compare_exchange_strong(expected, err != 0 ? err : EIO, std::memory_order_acq_rel);
+        buffer_.clear();
+    }
+    durable_cv_.notify_all();
+    space_cv_.notify_all();
+}
+
+void WriteAheadLog::throw_if_failed() const {
+    if (int err = error()) {
+        throw std::system_error(err, std::generic_category(), "WriteAheadLog: write " + base_path_);
+    }
+}
+
+size_t WriteAheadLog::replay(const std::string& segment_path,
+                             const std::function<void(const char*, size_t)>& fn) {
+    int fd = ::open(segment_path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return 0;
+    const char* p = static_cast<const char*>(map);
+    const char* end = p + size;
+    size_t records = 0;
+    while (static_cast<size_t>(end - p) >= kFrameHeader) {
+        uint32_t header[2];
+        std::memcpy(header, p, kFrameHeader);
+        if (header[0] > static_cast<size_t>(end - p) - kFrameHeader) break;
+        const char* payload = p + kFrameHeader;
+        if (crc32c(payload, header[0]) != header[1]) break; // torn or corrupt tail
+        fn(payload, header[0]);
+        ++records;
+        p = payload + header[0];
+    }
+    ::munmap(map, size);
+    return records;
+}
+
+} // namespace cache
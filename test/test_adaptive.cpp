@@ -0,0 +1,117 @@
+#include "../include/cache/adaptive_cache.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Moves everything from `from` into `to` the way AdaptiveCache migrates.
+void migrate(cache::CacheInterface<int, int>& from, cache::CacheInterface<int, int>& to) {
+  while (auto entry = from.take_hottest()) {
+    to.put_cold(entry->key, entry->value, entry->references);
+  }
+}
+
+// Keys in eviction order.
+std::vector<int> drain_victims(cache::CacheInterface<int, int>& c) {
+  std::vector<int> keys;
+  while (auto victim = c.take_victim()) keys.push_back(victim->first);
+  return keys;
+}
+
+} // namespace
+
+TEST(AdaptiveCacheTest, BasicPutGet) {
+  cache::AdaptiveCache<int, int> c(2);
+  EXPECT_TRUE(c.put(1, 10));
+  EXPECT_TRUE(c.put(2, 20));
+  auto v1 = c.get(1);
+  ASSERT_TRUE(v1.has_value());
+  EXPECT_EQ(*v1, 10);
+  c.put(3, 30);
+  EXPECT_LE(c.size(), c.capacity());
+}
+
+TEST(AdaptiveCacheTest, SwitchesAwayFromLRUUnderScans) {
+  cache::AdaptiveOptions options;
+  options.initial_policy = cache::ShadowPolicy::LRU;
+  options.window = 2000;
+  options.windows_to_switch = 2;
+  cache::AdaptiveCache<int, int> c(500, "adaptive_scan", options);
+  // A 300-key working set interrupted by one-pass scans of 1000 keys that
+  // flush an LRU cache but not a frequency-aware one.
+  int scan = 1000000;
+  for (int i = 0; i < 200000; ++i) {
+    int k = (i % 3000 < 2000) ? (i * 7919) % 300 : scan++;
+    if (!c.get(k)) c.put(k, k);
+  }
+  EXPECT_NE(c.current_policy(), cache::ShadowPolicy::LRU);
+  EXPECT_GE(c.policy_switches(), 1u);
+  EXPECT_LE(c.size(), c.capacity());
+  // Data written before or during migration is still reachable.
+  c.put(7, 70);
+  EXPECT_EQ(*c.get(7), 70);
+}
+
+TEST(AdaptiveCacheTest, MigratedEntriesRankBelowKeysUsedSinceTheSwitch) {
+  std::vector<std::unique_ptr<cache::CacheInterface<int, int>>> targets;
+  targets.push_back(std::make_unique<cache::LRUCache<int, int>>(10));
+  targets.push_back(std::make_unique<cache::LFUCache<int, int>>(10));
+  targets.push_back(std::make_unique<cache::ARCCache<int, int>>(10));
+  for (auto& target : targets) {
+    cache::LRUCache<int, int> source(10);
+    for (int k = 0; k < 5; ++k) source.put(k, k); // 0 coldest, 4 hottest
+    target->put(100, 100);                        // used since the switch
+    migrate(source, *target);
+    EXPECT_EQ(source.size(), 0u);
+    EXPECT_EQ(target->size(), 6u);
+    EXPECT_EQ(drain_victims(*target), (std::vector<int>{0, 1, 2, 3, 4, 100}));
+  }
+}
+
+TEST(AdaptiveCacheTest, MigrationKeepsLFUFrequencies) {
+  cache::LFUCache<int, int> source(10);
+  for (int k = 0; k < 4; ++k) source.put(k, k);
+  for (int i = 0; i < 3; ++i) (void)source.get(2); // freq 4
+  (void)source.get(0);                            // freq 2
+  cache::LFUCache<int, int> target(10);
+  target.put(100, 100);
+  (void)target.get(100); // freq 2, touched after 0 was
+  migrate(source, target);
+  EXPECT_EQ(drain_victims(target), (std::vector<int>{1, 3, 0, 100, 2}));
+
+  // A full target keeps what it has.
+  cache::LFUCache<int, int> full(1);
+  full.put(7, 7);
+  EXPECT_FALSE(full.put_cold(8, 8, 5));
+  EXPECT_TRUE(full.get(7).has_value());
+}
+
+TEST(AdaptiveCacheTest, SwitchesWaitForTheMigrationInFlight) {
+  cache::AdaptiveOptions options;
+  options.initial_policy = cache::ShadowPolicy::LRU;
+  options.window = 500;
+  options.windows_to_switch = 1;
+  options.switch_margin = 0.0;
+  options.migrate_per_op = 1; // a migration outlasts several windows
+  cache::AdaptiveCache<int, int> c(2000, "adaptive_pending", options);
+  // Alternate scan-heavy and recency-friendly phases so the leader flips.
+  int scan = 1000000;
+  bool waited = false;
+  for (int i = 0; i < 200000; ++i) {
+    bool scanning = (i / 20000) % 2 == 0;
+    int k = scanning ? ((i % 3000 < 2000) ? (i * 7919) % 1500 : scan++) : i % 2500;
+    size_t switches = c.policy_switches();
+    bool migrating = c.migrating();
+    if (!c.get(k)) c.put(k, k);
+    if (c.policy_switches() != switches) {
+      // No switch starts while the last one is still draining.
+      EXPECT_FALSE(migrating) << i;
+    } else if (migrating && (i + 1) % options.window == 0) {
+      waited = true;
+    }
+    ASSERT_LE(c.size(), c.capacity());
+  }
+  EXPECT_GE(c.policy_switches(), 1u);
+  EXPECT_TRUE(waited);
+}
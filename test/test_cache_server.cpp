@@ -0,0 +1,236 @@
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/memcached_protocol.hpp"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::string render(const cache::ReplyBuilder& out) {
+  iovec iov[64];
+  int n = out.fill(iov, 64);
+  std::string text;
+  for (int i = 0; i < n; ++i) text.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  return text;
+}
+
+// Feeds `input` to a fresh handler and returns everything it replied.
+struct HandlerHarness {
+  cache::ItemCache items{1024, 4, "memcached_test"};
+  cache::MemcachedHandler handler{items, 1024};
+  cache::ReplyBuilder out;
+
+  cache::ProcessResult feed(const std::string& input) { return handler.process(input.data(), input.size(), out); }
+
+  std::string take() {
+    std::string text = render(out);
+    out.clear();
+    return text;
+  }
+};
+
+int connect_loopback(uint16_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  return fd;
+}
+
+// Reads until `terminator` has been seen at the end of the reply stream.
+std::string read_until(int fd, const std::string& terminator) {
+  std::string reply;
+  char buf[4096];
+  while (reply.size() < terminator.size() ||
+         reply.compare(reply.size() - terminator.size(), terminator.size(), terminator) != 0) {
+    ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) break;
+    reply.append(buf, static_cast<size_t>(n));
+  }
+  return reply;
+}
+
+} // namespace
+
+TEST(MemcachedHandlerTest, SetThenGet) {
+  HandlerHarness h;
+  auto r = h.feed("set greeting 5 0 5\r\nhello\r\nget greeting\r\n");
+  EXPECT_EQ(r.commands, 2u);
+  EXPECT_EQ(h.take(), "STORED\r\nVALUE greeting 5 5\r\nhello\r\nEND\r\n");
+}
+
+TEST(MemcachedHandlerTest, MultiGetSkipsMisses) {
+  HandlerHarness h;
+  h.feed("set a 0 0 1\r\n1\r\nset c 0 0 1\r\n3\r\n");
+  h.take();
+  h.feed("get a b c\r\n");
+  EXPECT_EQ(h.take(), "VALUE a 0 1\r\n1\r\nVALUE c 0 1\r\n3\r\nEND\r\n");
+}
+
+TEST(MemcachedHandlerTest, GetsReportsDistinctCas) {
+  HandlerHarness h;
+  // "VALUE k 0 1 <cas>\r\n..." -> <cas>
+  auto cas_of = [](const std::string& reply) {
+    size_t eol = reply.find("\r\n");
+    size_t sp = reply.rfind(' ', eol);
+    return reply.substr(sp + 1, eol - sp - 1);
+  };
+  h.feed("set k 0 0 1\r\nx\r\ngets k\r\n");
+  std::string first = h.take().substr(8); // drop STORED
+  h.feed("set k 0 0 1\r\ny\r\ngets k\r\n");
+  std::string second = h.take().substr(8);
+  ASSERT_EQ(first.rfind("VALUE k 0 1 ", 0), 0u);
+  ASSERT_EQ(second.rfind("VALUE k 0 1 ", 0), 0u);
+  EXPECT_NE(cas_of(first), cas_of(second));
+}
+
+TEST(MemcachedHandlerTest, PartialRequestsWaitForMoreInput) {
+  HandlerHarness h;
+  std::string request = "set k 0 0 10\r\n0123456789\r\n";
+  auto r = h.feed(request.substr(0, 20));
+  EXPECT_EQ(r.consumed, 0u);
+  EXPECT_EQ(r.commands, 0u);
+  r = h.feed(request);
+  EXPECT_EQ(r.consumed, request.size());
+  EXPECT_EQ(h.take(), "STORED\r\n");
+  r = h.feed("get k\r\nget");
+  EXPECT_EQ(r.consumed, 7u);
+}
+
+TEST(MemcachedHandlerTest, DeleteAndNoreply) {
+  HandlerHarness h;
+  h.feed("set k 0 0 1 noreply\r\nv\r\ndelete k\r\ndelete k\r\ndelete k noreply\r\n");
+  EXPECT_EQ(h.take(), "DELETED\r\nNOT_FOUND\r\n");
+}
+
+TEST(MemcachedHandlerTest, ExpiredItemsAreMisses) {
+  HandlerHarness h;
+  h.feed("set old 0 -1 1\r\nv\r\nset past 0 1000000000 1\r\nv\r\nget old past\r\n");
+  EXPECT_EQ(h.take(), "STORED\r\nSTORED\r\nEND\r\n");
+  EXPECT_EQ(h.items.size(), 0u);
+}
+
+TEST(MemcachedHandlerTest, RejectsOversizedAndMalformedRequests) {
+  HandlerHarness h;
+  std::string big(2000, 'x');
+  h.feed("set big 0 0 2000\r\n" + big + "\r\nget big\r\n");
+  EXPECT_EQ(h.take(), "SERVER_ERROR object too large for cache\r\nEND\r\n");
+  h.feed("set k 0 0 3\r\nabcde\r\nbogus\r\nset k x 0 1\r\n");
+  EXPECT_EQ(h.take(), "CLIENT_ERROR bad data chunk\r\nERROR\r\nERROR\r\nCLIENT_ERROR bad command line format\r\n");
+}
+
+TEST(MemcachedHandlerTest, QuitClosesConnection) {
+  HandlerHarness h;
+  auto r = h.feed("version\nquit\r\nget k\r\n");
+  EXPECT_TRUE(r.close);
+  EXPECT_EQ(r.commands, 2u);
+  EXPECT_EQ(h.take(), "VERSION 1.0\r\n");
+}
+
+TEST(ReplyBuilderTest, PinsValuesAndResumesPartialWrites) {
+  cache::ReplyBuilder out;
+  auto value = std::make_shared<const std::string>("payload");
+  out.append("A");
+  out.append("B");
+  out.append_value(value);
+  out.append("C");
+  iovec iov[8];
+  ASSERT_EQ(out.fill(iov, 8), 3); // "AB" merged, value referenced, "C"
+  EXPECT_EQ(iov[1].iov_base, value->data());
+  out.consume(4);
+  EXPECT_EQ(render(out), "yloadC");
+  EXPECT_EQ(out.pending_bytes(), 6u);
+  out.consume(6);
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(CacheServerTest, ServesPipelinedRequestsOverLoopback) {
+  cache::ItemCache items(1000, 4, "server_test");
+  cache::ServerOptions options;
+  options.port = 0;
+  options.threads = 2;
+  cache::CacheServer server(items, options);
+  server.start();
+  ASSERT_NE(server.port(), 0);
+
+  int fd = connect_loopback(server.port());
+  std::string pipeline;
+  for (int i = 0; i < 100; ++i) {
+    pipeline += "set k" + std::to_string(i) + " 0 0 2\r\n" + std::to_string(i % 10) + "x\r\n";
+  }
+  pipeline += "get k1 k2 missing\r\n";
+  ASSERT_EQ(::send(fd, pipeline.data(), pipeline.size(), 0), static_cast<ssize_t>(pipeline.size()));
+  std::string reply = read_until(fd, "END\r\n");
+  std::string expected;
+  for (int i = 0; i < 100; ++i) expected += "STORED\r\n";
+  expected += "VALUE k1 0 2\r\n1x\r\nVALUE k2 0 2\r\n2x\r\nEND\r\n";
+  EXPECT_EQ(reply, expected);
+  ::close(fd);
+
+  // A second client sees the same cache.
+  fd = connect_loopback(server.port());
+  std::string get = "get k99\r\n";
+  ::send(fd, get.data(), get.size(), 0);
+  EXPECT_EQ(read_until(fd, "END\r\n"), "VALUE k99 0 2\r\n9x\r\nEND\r\n");
+  ::close(fd);
+
+  EXPECT_EQ(items.size(), 100u);
+  EXPECT_GE(server.stats().commands.load(), 102u);
+  server.stop();
+  EXPECT_FALSE(server.running());
+}
+
+TEST(CacheServerTest, LargeRepliesSurviveSlowReaders) {
+  cache::ItemCache items(1000, 1, "server_large_test");
+  auto value = std::make_shared<const std::string>(512 * 1024, 'z');
+  for (int i = 0; i < 8; ++i) items.put("big" + std::to_string(i), {value, 0, 1, 0});
+  cache::ServerOptions options;
+  options.port = 0;
+  options.threads = 1;
+  cache::CacheServer server(items, options);
+  server.start();
+
+  int fd = connect_loopback(server.port());
+  std::string get = "get big0 big1 big2 big3 big4 big5 big6 big7\r\n";
+  ::send(fd, get.data(), get.size(), 0);
+  ::usleep(50000); // let the socket buffer fill so the server must wait for EPOLLOUT
+  std::string reply = read_until(fd, "END\r\n");
+  EXPECT_EQ(reply.size(), 8 * (std::string("VALUE bigN 0 524288\r\n").size() + value->size() + 2) + 5);
+  ::close(fd);
+  server.stop();
+}
+
+TEST(CacheServerTest, ServesOverEveryIoBackend) {
+  std::vector<cache::IoBackend> backends{cache::IoBackend::Epoll};
+  if (cache::io_uring_available()) backends.push_back(cache::IoBackend::IoUring);
+  for (auto backend : backends) {
+    cache::ItemCache items(1000, 2, "server_backend_test");
+    cache::ServerOptions options;
+    options.port = 0;
+    options.threads = 1;
+    options.io_backend = backend;
+    cache::CacheServer server(items, options);
+    server.start();
+    SCOPED_TRACE(server.io_engine());
+    EXPECT_EQ(std::string(server.io_engine()), backend == cache::IoBackend::Epoll ? "epoll" : "io_uring");
+
+    int fd = connect_loopback(server.port());
+    std::string pipeline;
+    for (int i = 0; i < 50; ++i) pipeline += "set k" + std::to_string(i) + " 0 0 1\r\nv\r\n";
+    pipeline += "get k0 k49\r\nquit\r\n";
+    ::send(fd, pipeline.data(), pipeline.size(), 0);
+    std::string reply = read_until(fd, "END\r\n");
+    EXPECT_EQ(reply.size(), 50 * 8 + std::string("VALUE k0 0 1\r\nv\r\nVALUE k49 0 1\r\nv\r\nEND\r\n").size());
+    char byte;
+    EXPECT_EQ(::recv(fd, &byte, 1, 0), 0); // quit closed the connection
+    ::close(fd);
+    server.stop();
+    EXPECT_EQ(server.stats().commands.load(), 52u);
+    EXPECT_GT(server.stats().syscalls.load(), 0u);
+  }
+}
@@ -0,0 +1,224 @@
+#include "../include/cache/cluster_client.hpp"
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/hash_util.hpp"
+#include <gtest/gtest.h>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Several in-process cache_server nodes on loopback, each with its own cache.
+struct LocalCluster {
+  std::vector<std::unique_ptr<cache::ItemCache>> caches;
+  std::vector<std::unique_ptr<cache::CacheServer>> servers;
+  std::vector<std::string> endpoints;
+
+  explicit LocalCluster(size_t nodes) {
+    for (size_t i = 0; i < nodes; ++i) {
+      caches.push_back(std::make_unique<cache::ItemCache>(10000, 2, "cluster_node_" + std::to_string(i)));
+      cache::ServerOptions options;
+      options.port = 0;
+      options.threads = 1;
+      servers.push_back(std::make_unique<cache::CacheServer>(*caches.back(), options));
+      servers.back()->start();
+      endpoints.push_back("127.0.0.1:" + std::to_string(servers.back()->port()));
+    }
+  }
+
+  cache::ItemCache& cache_of(const std::string& endpoint) {
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+      if (endpoints[i] == endpoint) return *caches[i];
+    }
+    throw std::out_of_range(endpoint);
+  }
+};
+
+std::string key(int i) { return "key:" + std::to_string(i); }
+
+} // namespace
+
+TEST(RendezvousHashTest, SpreadsKeysAndMovesOnlyTheirShare) {
+  cache::RendezvousHash ring;
+  for (int n = 0; n < 5; ++n) ring.add("node" + std::to_string(n));
+  const int keys = 20000;
+  std::vector<std::string> before(keys);
+  std::map<std::string, int> load;
+  for (int i = 0; i < keys; ++i) {
+    before[i] = ring.nodes()[ring.pick(key(i))];
+    ++load[before[i]];
+  }
+  for (const auto& entry : load) EXPECT_NEAR(entry.second, keys / 5, keys / 25) << entry.first;
+
+  // A new node takes about 1/6 of the keys, all from the others.
+  ring.add("node5");
+  int moved = 0;
+  for (int i = 0; i < keys; ++i) {
+    std::string now = ring.nodes()[ring.pick(key(i))];
+    if (now != before[i]) {
+      ++moved;
+      EXPECT_EQ(now, "node5");
+    }
+  }
+  EXPECT_NEAR(moved, keys / 6, keys / 30);
+
+  // Removing a node moves only the keys it owned.
+  ring.remove("node5");
+  ring.remove("node2");
+  for (int i = 0; i < keys; ++i) {
+    std::string now = ring.nodes()[ring.pick(key(i))];
+    if (before[i] != "node2") {
+      EXPECT_EQ(now, before[i]);
+    }
+  }
+}
+
+TEST(RendezvousHashTest, PlacementDoesNotDependOnTheBuild) {
+  // FNV-1a's published test vectors, then placements computed outside C++.
+  EXPECT_EQ(cache::fnv1a(""), 0xcbf29ce484222325ull);
+  EXPECT_EQ(cache::fnv1a("a"), 0xaf63dc4c8601ec8cull);
+  cache::RendezvousHash ring;
+  for (int n = 0; n < 3; ++n) ring.add("node" + std::to_string(n));
+  std::vector<int> picks;
+  for (int i = 0; i < 10; ++i) picks.push_back(ring.pick(key(i)));
+  EXPECT_EQ(picks, (std::vector<int>{0, 0, 0, 0, 1, 2, 2, 2, 1, 0}));
+}
+
+TEST(ClusterClientTest, FansOutAcrossNodes) {
+  LocalCluster cluster(3);
+  cache::ClusterClient client(cluster.endpoints);
+  std::vector<std::pair<std::string, std::string>> items;
+  for (int i = 0; i < 300; ++i) items.emplace_back(key(i), "value" + std::to_string(i));
+  EXPECT_EQ(client.set_many(items), 300u);
+
+  // Every key landed on the node the ring picked, and nowhere else.
+  size_t total = 0;
+  for (size_t n = 0; n < cluster.endpoints.size(); ++n) {
+    EXPECT_GT(cluster.caches[n]->size(), 50u);
+    total += cluster.caches[n]->size();
+  }
+  EXPECT_EQ(total, 300u);
+  for (int i = 0; i < 300; i += 37) {
+    EXPECT_TRUE(cluster.cache_of(client.node_for(key(i))).get(key(i)).has_value());
+  }
+
+  std::vector<std::string> keys;
+  for (int i = 299; i >= 0; --i) keys.push_back(key(i));
+  keys.push_back("missing");
+  keys.push_back(key(7)); // duplicates are answered too
+  auto values = client.get_many(keys);
+  ASSERT_EQ(values.size(), keys.size());
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_TRUE(values[i].has_value()) << keys[i];
+    EXPECT_EQ(*values[i], "value" + std::to_string(299 - i));
+  }
+  EXPECT_FALSE(values[300].has_value());
+  EXPECT_EQ(values[301], std::optional<std::string>("value7"));
+  EXPECT_EQ(client.errors(), 0u);
+}
+
+TEST(ClusterClientTest, PipelinesLargeGetsInChunks) {
+  LocalCluster cluster(1);
+  cache::ClusterOptions options;
+  options.keys_per_get = 7;
+  cache::ClusterClient client(cluster.endpoints, options);
+  std::vector<std::pair<std::string, std::string>> items;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 3) items.emplace_back(key(i), std::string(i * 10, 'x'));
+    keys.push_back(key(i));
+  }
+  client.set_many(items);
+  auto values = client.get_many(keys);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i].has_value(), i % 3 != 0) << i;
+    if (values[i]) {
+      EXPECT_EQ(values[i]->size(), static_cast<size_t>(i * 10));
+    }
+  }
+}
+
+TEST(ClusterClientTest, SetGetRemoveAndTtl) {
+  LocalCluster cluster(2);
+  cache::ClusterClient client(cluster.endpoints);
+  EXPECT_TRUE(client.set("a", "1"));
+  EXPECT_EQ(client.get("a"), std::optional<std::string>("1"));
+  EXPECT_TRUE(client.remove("a"));
+  EXPECT_FALSE(client.remove("a"));
+  EXPECT_FALSE(client.get("a").has_value());
+  EXPECT_TRUE(client.set("b", "2", 100));
+  auto item = cluster.cache_of(client.node_for("b")).get("b");
+  ASSERT_TRUE(item.has_value());
+  EXPECT_GT(item->expires, 0);
+
+  // Past 30 days memcached takes exptime as a unix time, not a delta.
+  const uint32_t long_ttl = 31 * 86400;
+  int64_t now = static_cast<int64_t>(std::time(nullptr));
+  EXPECT_TRUE(client.set("c", "3", long_ttl));
+  EXPECT_EQ(client.get("c"), std::optional<std::string>("3"));
+  item = cluster.cache_of(client.node_for("c")).get("c");
+  ASSERT_TRUE(item.has_value());
+  EXPECT_GE(item->expires, now + long_ttl);
+  EXPECT_LE(item->expires, now + long_ttl + 5);
+}
+
+TEST(ClusterClientTest, RejectsKeysThatWouldBreakTheProtocol) {
+  LocalCluster cluster(2);
+  cache::ClusterClient client(cluster.endpoints);
+  ASSERT_TRUE(client.set("y", "keep"));
+  const std::string injected = "x 0 0 1\r\nA\r\ndelete y";
+  const std::vector<std::string> bad = {"", "has space", "tab\t", "nul" + std::string(1, '\0'),
+                                        std::string(251, 'k'), injected};
+  for (const auto& k : bad) EXPECT_FALSE(client.set(k, "v")) << k;
+  EXPECT_EQ(client.errors(), bad.size());
+  EXPECT_FALSE(client.remove(injected));
+  EXPECT_EQ(client.set_many({{"ok1", "1"}, {injected, "2"}, {"ok2", "3"}}), 2u);
+
+  std::vector<std::string> keys = {"ok1", "bad key", "y", std::string(251, 'k')};
+  auto values = client.get_many(keys);
+  EXPECT_EQ(values[0], std::optional<std::string>("1"));
+  EXPECT_FALSE(values[1].has_value());
+  EXPECT_EQ(values[2], std::optional<std::string>("keep")); // nothing was injected
+  EXPECT_FALSE(values[3].has_value());
+  EXPECT_EQ(client.errors(), bad.size() + 4);
+  EXPECT_TRUE(client.set(std::string(250, 'k'), "max"));
+  EXPECT_EQ(client.get(std::string(250, 'k')), std::optional<std::string>("max"));
+}
+
+TEST(ClusterClientTest, NodeChangesAndFailures) {
+  LocalCluster cluster(3);
+  cache::ClusterClient client({cluster.endpoints[0], cluster.endpoints[1]});
+  for (int i = 0; i < 200; ++i) client.set(key(i), "v");
+  std::vector<std::string> owner(200);
+  for (int i = 0; i < 200; ++i) owner[i] = client.node_for(key(i));
+
+  client.add_node(cluster.endpoints[2]);
+  EXPECT_EQ(client.nodes().size(), 3u);
+  int moved = 0, hits = 0;
+  for (int i = 0; i < 200; ++i) {
+    if (client.node_for(key(i)) != owner[i]) ++moved;
+    if (client.get(key(i))) ++hits;
+  }
+  EXPECT_GT(moved, 30);
+  EXPECT_LT(moved, 110);
+  EXPECT_EQ(hits, 200 - moved); // moved keys miss on their new (empty) node
+
+  // A node that goes away reads as misses and counts errors.
+  cluster.servers[2]->stop();
+  int on_stopped = 0;
+  for (int i = 0; i < 200; ++i) {
+    if (client.node_for(key(i)) == cluster.endpoints[2]) {
+      ++on_stopped;
+      EXPECT_FALSE(client.get(key(i)).has_value());
+    }
+  }
+  EXPECT_GT(on_stopped, 0);
+  EXPECT_GT(client.errors(), 0u);
+
+  client.remove_node(cluster.endpoints[2]);
+  for (int i = 0; i < 200; ++i) EXPECT_EQ(client.node_for(key(i)), owner[i]);
+  EXPECT_THROW(client.add_node("no-port"), std::invalid_argument);
+}
@@ -0,0 +1,154 @@
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// A value whose "compression" only records its size, and whose
+// decompression fails on demand, as a corrupted payload would.
+struct Packed {
+  uint32_t id = 0;
+  uint32_t len = 0;
+  size_t size() const { return len; }
+};
+
+} // namespace
+
+namespace cache {
+
+template<>
+struct ValueCompressor<Packed> {
+  static constexpr bool supported = true;
+  static inline bool fail = false;
+  static uint32_t compress(Packed& value, size_t min_size) {
+    if (value.len < min_size) return 0;
+    uint32_t raw = value.len;
+    value.len = 1;
+    return raw;
+  }
+  static bool decompress(Packed& value, uint32_t raw_size) {
+    if (fail) return false;
+    value.len = raw_size;
+    return true;
+  }
+};
+
+} // namespace cache
+
+namespace {
+
+using Fragile = cache::ValueCompressor<Packed>;
+
+// Resets the failure switch even when an assertion returns early.
+struct FailDecompression {
+  FailDecompression() { Fragile::fail = true; }
+  ~FailDecompression() { Fragile::fail = false; }
+};
+
+std::string json_payload(int i) {
+  std::string s;
+  for (int r = 0; r < 8; ++r) {
+    s += "{\"id\":" + std::to_string(i) + ",\"name\":\"item\",\"tags\":[\"a\",\"b\",\"c\"]},";
+  }
+  return s;
+}
+} // namespace
+
+TEST(CompressionTest, LZ4RoundTrip) {
+  std::string in = json_payload(7) + std::string(300, 'x');
+  std::string out(cache::lz4::compress_bound(in.size()), '\0');
+  size_t n = cache::lz4::compress(in.data(), in.size(), &out[0]);
+  EXPECT_LT(n, in.size());
+  std::string back(in.size(), '\0');
+  ASSERT_TRUE(cache::lz4::decompress(out.data(), n, &back[0], in.size()));
+  EXPECT_EQ(back, in);
+}
+
+TEST(CompressionTest, LRUCompressesColdAndInflatesOnHit) {
+  cache::LRUCache<int, std::string> c(100);
+  c.set_compression({true, 0.1, 64});
+  for (int i = 0; i < 100; ++i) c.put(i, json_payload(i));
+  EXPECT_EQ(c.compress_cold(1000), 90u);
+  EXPECT_EQ(c.compress_cold(1000), 0u); // nothing new has gone cold
+  EXPECT_EQ(c.metrics().compressions(), 90u);
+  EXPECT_GT(c.metrics().compression_ratio(), 2.0);
+  auto v = c.get(0); // coldest entry, compressed
+  ASSERT_TRUE(v.has_value());
+  EXPECT_EQ(*v, json_payload(0));
+  EXPECT_EQ(c.metrics().decompressions(), 1u);
+  EXPECT_EQ(*c.get(0), json_payload(0));
+  EXPECT_EQ(c.metrics().decompressions(), 1u);
+}
+
+TEST(CompressionTest, ARCCompressesT1Tail) {
+  cache::ARCCache<int, std::string> c(10);
+  c.set_compression({true, 0.0, 64});
+  for (int i = 0; i < 10; ++i) c.put(i, json_payload(i));
+  EXPECT_EQ(c.compress_cold(100), 10u);
+  auto v = c.get(3);
+  ASSERT_TRUE(v.has_value());
+  EXPECT_EQ(*v, json_payload(3));
+  EXPECT_EQ(c.metrics().decompressions(), 1u);
+}
+
+TEST(CompressionTest, LRUDropsValuesThatFailToDecode) {
+  cache::LRUCache<int, Packed> c(10);
+  c.set_compression({true, 0.0, 64});
+  for (int i = 0; i < 10; ++i) c.put(i, Packed{static_cast<uint32_t>(i), 100});
+  EXPECT_EQ(c.compress_cold(100), 10u);
+  {
+    FailDecompression fail;
+    EXPECT_FALSE(c.get(3).has_value());
+    EXPECT_EQ(c.metrics().decompression_failures(), 1u);
+    EXPECT_EQ(c.metrics().misses(), 1u);
+    EXPECT_EQ(c.size(), 9u);
+    // Taking entries out skips the ones that do not decode.
+    EXPECT_FALSE(c.take_victim().has_value());
+    EXPECT_EQ(c.size(), 0u);
+  }
+  c.put(1, Packed{1, 100});
+  auto v = c.get(1);
+  ASSERT_TRUE(v.has_value());
+  EXPECT_EQ(v->len, 100u);
+}
+
+TEST(CompressionTest, ARCDropsValuesThatFailToDecode) {
+  cache::ARCCache<int, Packed> c(10);
+  c.set_compression({true, 0.0, 64});
+  for (int i = 0; i < 10; ++i) c.put(i, Packed{static_cast<uint32_t>(i), 100});
+  EXPECT_EQ(c.compress_cold(100), 10u);
+  {
+    FailDecompression fail;
+    EXPECT_FALSE(c.get(3).has_value());
+    EXPECT_FALSE(c.get(3).has_value());
+    EXPECT_EQ(c.metrics().decompression_failures(), 1u);
+    EXPECT_EQ(c.metrics().misses(), 2u);
+    EXPECT_EQ(c.size(), 9u);
+    EXPECT_FALSE(c.take_hottest().has_value());
+    EXPECT_EQ(c.size(), 0u);
+  }
+  EXPECT_EQ(c.metrics().decompressions(), 0u);
+}
+
+TEST(CompressionTest, SnapshotOfAValueThatFailsToDecodeFails) {
+  std::string path = "/tmp/hpc_compression_" + std::to_string(::getpid()) + ".snap";
+  cache::LRUCache<int, Packed> c(10);
+  c.set_compression({true, 0.0, 64});
+  for (int i = 0; i < 10; ++i) c.put(i, Packed{static_cast<uint32_t>(i), 100});
+  EXPECT_EQ(c.compress_cold(100), 10u);
+  {
+    FailDecompression fail;
+    EXPECT_FALSE(c.save_snapshot(path).get());
+  }
+  EXPECT_FALSE(c.load_snapshot(path));
+  EXPECT_TRUE(c.save_snapshot(path).get());
+  cache::LRUCache<int, Packed> warm(10);
+  EXPECT_TRUE(warm.load_snapshot(path));
+  ASSERT_TRUE(warm.get(0).has_value());
+  EXPECT_EQ(warm.get(0)->len, 100u);
+  std::remove(path.c_str());
+}
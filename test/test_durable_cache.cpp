@@ -0,0 +1,205 @@
+#include "../include/cache/durable_cache.hpp"
+#include "../include/cache/lfu_cache.hpp"
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Each test gets its own directory so leftover segments never leak between runs.
+class DurableCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    dir_ = "/tmp/hpc_durable_" + std::to_string(::getpid()) + "_" + info->name();
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+    base_ = dir_ + "/cache";
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  size_t count_files(const std::string& kind) const {
+    size_t n = 0;
+    for (const auto& e : std::filesystem::directory_iterator(dir_)) {
+      if (e.path().filename().string().find(kind) != std::string::npos) ++n;
+    }
+    return n;
+  }
+
+  std::string dir_;
+  std::string base_;
+};
+
+} // namespace
+
+TEST(WriteAheadLogTest, ReplayReturnsRecordsInOrder) {
+  std::string base = "/tmp/hpc_wal_" + std::to_string(::getpid());
+  {
+    cache::WriteAheadLog wal(base, 7);
+    wal.append("alpha", 5);
+    wal.append("", 0);
+    wal.append("gamma", 5);
+    wal.sync();
+    EXPECT_EQ(wal.durable_lsn(), wal.appended_lsn());
+    EXPECT_GE(wal.fsyncs(), 1u);
+  }
+  std::vector<std::string> seen;
+  std::string path = cache::WriteAheadLog::segment_path(base, 7);
+  EXPECT_EQ(cache::WriteAheadLog::replay(path, [&](const char* p, size_t n) {
+    seen.emplace_back(p, n);
+  }), 3u);
+  EXPECT_EQ(seen, (std::vector<std::string>{"alpha", "", "gamma"}));
+  std::filesystem::remove(path);
+}
+
+TEST(WriteAheadLogTest, ConcurrentAppendersShareGroupCommits) {
+  std::string base = "/tmp/hpc_wal_group_" + std::to_string(::getpid());
+  {
+    cache::WriteAheadLog wal(base, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 5000; ++i) wal.append("record", 6);
+      });
+    }
+    for (auto& t : threads) t.join();
+    wal.sync();
+    EXPECT_LT(wal.group_commits(), 20000u);
+  }
+  std::string path = cache::WriteAheadLog::segment_path(base, 0);
+  EXPECT_EQ(cache::WriteAheadLog::replay(path, [](const char*, size_t) {}), 20000u);
+  std::filesystem::remove(path);
+}
+
+TEST(WriteAheadLogTest, WriteFailuresAreStickyAndNotReportedDurable) {
+  // /dev/full accepts the open and fails every write with ENOSPC.
+  std::string base = "/tmp/hpc_wal_full_" + std::to_string(::getpid());
+  std::string path = cache::WriteAheadLog::segment_path(base, 0);
+  std::filesystem::remove(path);
+  std::filesystem::create_symlink("/dev/full", path);
+  {
+    cache::WriteAheadLog wal(base, 0);
+    wal.append("lost", 4);
+    EXPECT_THROW(wal.sync(), std::system_error);
+    EXPECT_EQ(wal.durable_lsn(), 0u);
+    EXPECT_EQ(wal.error(), ENOSPC);
+    EXPECT_THROW(wal.append("after", 5), std::system_error);
+    EXPECT_THROW(wal.sync(), std::system_error);
+    EXPECT_THROW(wal.rotate(), std::system_error);
+    EXPECT_EQ(wal.generation(), 0u);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_F(DurableCacheTest, FailedLogWritesSurfaceAndStopMutations) {
+  cache::WalOptions options;
+  options.fsync_interval = std::chrono::milliseconds(0);
+  cache::DurableCache<std::string, std::string> c(100, base_, options);
+  // Point the open segment's descriptor at /dev/full.
+  std::string segment = std::filesystem::canonical(cache::WriteAheadLog::segment_path(base_, 0)).string();
+  int full = ::open("/dev/full", O_WRONLY);
+  ASSERT_GE(full, 0);
+  bool redirected = false;
+  for (const auto& e : std::filesystem::directory_iterator("/proc/self/fd")) {
+    std::error_code ec;
+    if (std::filesystem::read_symlink(e.path(), ec).string() != segment) continue;
+    redirected = ::dup2(full, std::stoi(e.path().filename().string())) >= 0;
+  }
+  ::close(full);
+  ASSERT_TRUE(redirected);
+  c.put("a", "1");
+  EXPECT_THROW(c.sync(), std::system_error);
+  EXPECT_THROW(c.put("b", "2"), std::system_error);
+  EXPECT_FALSE(c.get("b").has_value()); // not applied without its log record
+  EXPECT_THROW(c.checkpoint(), std::system_error);
+  EXPECT_EQ(c.wal().generation(), 0u);
+}
+
+TEST_F(DurableCacheTest, RecoversFromLogAfterRestart) {
+  {
+    cache::DurableCache<int, std::string> c(100, base_);
+    for (int i = 0; i < 50; ++i) c.put(i, "v" + std::to_string(i));
+    c.remove(10);
+    c.put(20, "updated");
+  }
+  cache::DurableCache<int, std::string> c(100, base_);
+  EXPECT_EQ(c.replayed_records(), 52u);
+  EXPECT_EQ(c.size(), 49u);
+  EXPECT_FALSE(c.get(10).has_value());
+  EXPECT_EQ(*c.get(20), "updated");
+  EXPECT_EQ(*c.get(49), "v49");
+}
+
+TEST_F(DurableCacheTest, ReplaysLogOnTopOfCheckpoint) {
+  {
+    cache::DurableCache<int, std::string> c(100, base_);
+    for (int i = 0; i < 30; ++i) c.put(i, "before");
+    ASSERT_TRUE(c.checkpoint());
+    for (int i = 20; i < 40; ++i) c.put(i, "after");
+    c.remove(0);
+  }
+  // The checkpoint superseded the first segment.
+  EXPECT_EQ(count_files(".snap."), 1u);
+  cache::DurableCache<int, std::string> c(100, base_);
+  EXPECT_EQ(c.replayed_records(), 21u);
+  EXPECT_EQ(c.size(), 39u);
+  EXPECT_FALSE(c.get(0).has_value());
+  EXPECT_EQ(*c.get(5), "before");
+  EXPECT_EQ(*c.get(25), "after");
+  EXPECT_EQ(*c.get(39), "after");
+}
+
+TEST_F(DurableCacheTest, ClearIsReplayed) {
+  {
+    cache::DurableCache<int, int> c(10, base_);
+    c.put(1, 1);
+    c.clear();
+    c.put(2, 2);
+  }
+  cache::DurableCache<int, int> c(10, base_);
+  EXPECT_EQ(c.size(), 1u);
+  EXPECT_FALSE(c.get(1).has_value());
+  EXPECT_EQ(*c.get(2), 2);
+}
+
+TEST_F(DurableCacheTest, TornTailIsIgnored) {
+  std::string segment;
+  {
+    cache::DurableCache<int, int> c(10, base_);
+    c.put(1, 100);
+    c.put(2, 200);
+    segment = cache::WriteAheadLog::segment_path(base_, c.wal().generation());
+  }
+  // Simulate a crash in the middle of writing a third record.
+  std::filesystem::resize_file(segment, std::filesystem::file_size(segment) - 3);
+  {
+    cache::DurableCache<int, int> c(10, base_);
+    EXPECT_EQ(c.replayed_records(), 1u);
+    EXPECT_EQ(*c.get(1), 100);
+    EXPECT_FALSE(c.get(2).has_value());
+    c.put(3, 300); // goes to a fresh segment, not after the torn tail
+  }
+  cache::DurableCache<int, int> c(10, base_);
+  EXPECT_EQ(*c.get(3), 300);
+}
+
+TEST_F(DurableCacheTest, WorksWithOtherPolicies) {
+  {
+    cache::DurableCache<int, int, cache::LFUCache<int, int>> c(2, base_);
+    c.put(1, 1);
+    (void)c.get(1);
+    ASSERT_TRUE(c.checkpoint());
+    c.put(2, 2);
+  }
+  cache::DurableCache<int, int, cache::LFUCache<int, int>> c(2, base_);
+  c.put(3, 3); // LFU victim is the once-used key 2
+  EXPECT_TRUE(c.get(1).has_value());
+  EXPECT_FALSE(c.get(2).has_value());
+}
@@ -0,0 +1,183 @@
+#include "../include/cache/heavy_hitters.hpp"
+#include "../include/cache/hot_key_cache.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+cache::HotKeyOptions manual_options() {
+  cache::HotKeyOptions options;
+  options.sample_rate = 1;
+  options.refresh_interval = std::chrono::milliseconds(0);
+  return options;
+}
+
+bool contains(const std::vector<std::string>& keys, const std::string& key) {
+  return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+} // namespace
+
+TEST(HeavyHittersTest, FindsFrequentKeysAmongNoise) {
+  cache::HeavyHitters<int> detector(64);
+  for (int round = 0; round < 1000; ++round) {
+    for (int hot = 0; hot < 10; ++hot) detector.add(hot);
+    for (int n = 0; n < 10; ++n) detector.add(1000 + round * 10 + n); // each seen once
+  }
+  auto top = detector.top(10);
+  ASSERT_EQ(top.size(), 10u);
+  for (const auto& hitter : top) {
+    EXPECT_LT(hitter.key, 10);
+    EXPECT_GE(hitter.count, 1000u);
+    EXPECT_LE(hitter.count - hitter.error, 1000u);
+  }
+  EXPECT_EQ(detector.total(), 20000u);
+}
+
+TEST(HeavyHittersTest, DecayLetsCooledKeysFall) {
+  cache::HeavyHitters<int> detector(4);
+  detector.add(1, 100);
+  detector.decay();
+  EXPECT_EQ(detector.top(1)[0].count, 50u);
+  for (int i = 0; i < 6; ++i) detector.decay();
+  EXPECT_TRUE(detector.top(1).empty()); // counts that reach zero are dropped
+  detector.add(2, 5);
+  EXPECT_EQ(detector.top(1)[0].key, 2);
+  EXPECT_EQ(detector.top(4).size(), 1u);
+}
+
+TEST(HeavyHittersTest, ObservesACacheThroughTheHook) {
+  cache::LRUCache<int, int> c(16);
+  cache::HeavyHitters<int> detector(8);
+  c.set_observer(&detector);
+  c.put(1, 1);
+  for (int i = 0; i < 50; ++i) (void)c.get(1);
+  (void)c.get(2);
+  c.set_observer(nullptr);
+  auto top = detector.top(1);
+  ASSERT_EQ(top.size(), 1u);
+  EXPECT_EQ(top[0].key, 1);
+  EXPECT_EQ(top[0].count, 50u);
+}
+
+TEST(HotKeyCacheTest, PromotesHotKeysAndServesThemWithoutTheShard) {
+  cache::HotKeyCache<std::string, std::string> c(1000, 4, manual_options());
+  for (int i = 0; i < 100; ++i) c.put("k" + std::to_string(i), "v" + std::to_string(i));
+  for (int i = 0; i < 500; ++i) (void)c.get("k1");
+  for (int i = 0; i < 100; ++i) (void)c.get("k" + std::to_string(i));
+  c.refresh();
+  auto hot = c.hot_keys();
+  EXPECT_EQ(hot, std::vector<std::string>{"k1"});
+  EXPECT_EQ(c.top_keys(1)[0].key, "k1");
+
+  size_t shard_hits = c.sharded().hit_count();
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(c.get("k1"), std::optional<std::string>("v1"));
+  EXPECT_EQ(c.sharded().hit_count(), shard_hits);
+  EXPECT_EQ(c.hot_hits(), 100u);
+  EXPECT_EQ(c.hit_count(), shard_hits + 100);
+
+  auto values = c.get_many({"k1", "k2", "missing", "k1"});
+  EXPECT_EQ(values[0], std::optional<std::string>("v1"));
+  EXPECT_EQ(values[1], std::optional<std::string>("v2"));
+  EXPECT_FALSE(values[2].has_value());
+  EXPECT_EQ(values[3], std::optional<std::string>("v1"));
+  EXPECT_EQ(c.hot_hits(), 102u);
+}
+
+TEST(HotKeyCacheTest, RefreshReadsAreNotCountedButKeepKeysRecent) {
+  cache::HotKeyCache<int, int> c(4, 1, manual_options());
+  for (int k = 1; k <= 4; ++k) c.put(k, k);
+  for (int i = 0; i < 50; ++i) (void)c.get(1);
+  for (int k = 2; k <= 4; ++k) c.put(k, k); // 1 is now least recent
+  size_t hits = c.hit_count();
+  size_t misses = c.miss_count();
+  c.refresh();
+  ASSERT_EQ(c.hot_keys(), std::vector<int>{1});
+  EXPECT_EQ(c.hit_count(), hits);
+  EXPECT_EQ(c.miss_count(), misses);
+
+  c.put(5, 5); // evicts 2, not the key the refresh read
+  EXPECT_TRUE(c.sharded().shard(0).contains(1));
+  EXPECT_FALSE(c.sharded().shard(0).contains(2));
+}
+
+TEST(HotKeyCacheTest, WritesBypassTheHotCopyUntilTheNextRefresh) {
+  cache::HotKeyCache<std::string, std::string> c(1000, 4, manual_options());
+  c.put("viral", "1");
+  for (int i = 0; i < 100; ++i) (void)c.get("viral");
+  c.refresh();
+  ASSERT_TRUE(contains(c.hot_keys(), "viral"));
+
+  c.put("viral", "2");
+  size_t hot_hits = c.hot_hits();
+  EXPECT_EQ(c.get("viral"), std::optional<std::string>("2"));
+  EXPECT_EQ(c.hot_hits(), hot_hits); // stale copy skipped
+  c.refresh();
+  EXPECT_EQ(c.get("viral"), std::optional<std::string>("2"));
+  EXPECT_EQ(c.hot_hits(), hot_hits + 1);
+
+  EXPECT_TRUE(c.remove("viral"));
+  EXPECT_FALSE(c.get("viral").has_value());
+  c.put("viral", "3");
+  c.refresh();
+  c.clear();
+  EXPECT_FALSE(c.get("viral").has_value());
+}
+
+TEST(HotKeyCacheTest, CooledKeysAreDemoted) {
+  cache::HotKeyCache<std::string, std::string> c(1000, 4, manual_options());
+  c.put("old", "x");
+  c.put("new", "y");
+  for (int i = 0; i < 200; ++i) (void)c.get("old");
+  c.refresh();
+  ASSERT_TRUE(contains(c.hot_keys(), "old"));
+
+  // Traffic moves on; decay lets "old" fall below min_share.
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 200; ++i) (void)c.get("new");
+    c.refresh();
+  }
+  auto hot = c.hot_keys();
+  EXPECT_FALSE(contains(hot, "old"));
+  EXPECT_TRUE(contains(hot, "new"));
+}
+
+TEST(HotKeyCacheTest, ConcurrentReadersSeeCompletedWrites) {
+  cache::HotKeyOptions options;
+  options.sample_rate = 1;
+  options.refresh_interval = std::chrono::milliseconds(1);
+  cache::HotKeyCache<int, int> c(1024, 4, options);
+  constexpr int kKeys = 4;
+  std::vector<std::atomic<int>> written(kKeys);
+  for (int k = 0; k < kKeys; ++k) {
+    c.put(k, 0);
+    written[k].store(0);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<int> stale{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&, t] {
+      for (int i = t; !done.load(std::memory_order_relaxed); ++i) {
+        int k = i % kKeys;
+        int floor = written[k].load(std::memory_order_acquire);
+        auto v = c.get(k);
+        if (!v || *v < floor) stale.fetch_add(1);
+      }
+    });
+  }
+  for (int i = 1; i <= 20000; ++i) {
+    int k = i % kKeys;
+    c.put(k, i);
+    written[k].store(i, std::memory_order_release);
+    if (i % 2000 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  done.store(true);
+  for (auto& r : readers) r.join();
+  EXPECT_EQ(stale.load(), 0);
+}
@@ -0,0 +1,33 @@
+#include "../include/cache/incremental_hash_map.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include <gtest/gtest.h>
+
+TEST(IncrementalHashMapTest, GrowsWithoutLosingEntries) {
+  cache::IncrementalHashMap<int, int> m;
+  const int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    EXPECT_TRUE(m.insert(i, i * 2).second);
+    // Every key inserted so far stays visible while buckets migrate
+    ASSERT_NE(m.find(i / 2), nullptr);
+  }
+  EXPECT_EQ(m.size(), static_cast<size_t>(n));
+  for (int i = 0; i < n; i += 2) EXPECT_TRUE(m.erase(i));
+  for (int i = 0; i < n; ++i) {
+    auto* v = m.find(i);
+    if (i % 2) {
+      ASSERT_NE(v, nullptr);
+      EXPECT_EQ(*v, i * 2);
+    } else {
+      EXPECT_EQ(v, nullptr);
+    }
+  }
+  EXPECT_FALSE(m.insert(1, 0).second);
+}
+
+TEST(IncrementalHashMapTest, LRUBeyondInitialIndex) {
+  cache::LRUCache<int, int> c(200000);
+  for (int i = 0; i < 200000; ++i) c.put(i, i);
+  EXPECT_EQ(c.size(), 200000u);
+  EXPECT_TRUE(c.get(0).has_value());
+  EXPECT_TRUE(c.get(199999).has_value());
+}
@@ -0,0 +1,228 @@
+#include "../include/cache/io_engine.hpp"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Every backend this machine can run; each test repeats for all of them.
+std::vector<cache::IoBackend> backends() {
+  std::vector<cache::IoBackend> result{cache::IoBackend::Epoll};
+  if (cache::io_uring_available()) result.push_back(cache::IoBackend::IoUring);
+  return result;
+}
+
+int listen_loopback(uint16_t& port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  EXPECT_EQ(::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  EXPECT_EQ(::listen(fd, 16), 0);
+  socklen_t len = sizeof(addr);
+  ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
+int connect_loopback(uint16_t port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  return fd;
+}
+
+// Waits until a completion with `tag` arrives; others are dropped.
+cache::IoCompletion wait_for(cache::IoEngine& engine, uint64_t tag) {
+  std::vector<cache::IoCompletion> completions;
+  for (int i = 0; i < 100; ++i) {
+    completions.clear();
+    engine.wait(completions, 100);
+    for (const auto& c : completions) {
+      if (c.tag == tag) return c;
+      if (c.data) engine.release(c.buffer);
+    }
+  }
+  ADD_FAILURE() << "no completion for tag " << tag;
+  return {};
+}
+
+} // namespace
+
+TEST(IoEngineTest, AutoPicksAnAvailableBackend) {
+  auto engine = cache::make_io_engine();
+  std::string name = engine->name();
+  EXPECT_EQ(name, cache::io_uring_available() ? "io_uring" : "epoll");
+}
+
+TEST(IoEngineTest, IoUringIsOnlyAvailableWithMultishotRecv) {
+  if (!cache::io_uring_available()) {
+    EXPECT_THROW(cache::make_io_engine(cache::IoBackend::IoUring), std::system_error);
+    return;
+  }
+  // Whatever io_uring_available() accepts keeps a recv armed after data.
+  auto engine = cache::make_io_engine(cache::IoBackend::IoUring);
+  int fds[2];
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+  engine->recv(fds[0], 3);
+  ASSERT_EQ(::write(fds[1], "x", 1), 1);
+  auto c = wait_for(*engine, 3);
+  EXPECT_EQ(c.result, 1);
+  EXPECT_TRUE(c.more);
+  if (c.data) engine->release(c.buffer);
+  ::close(fds[1]);
+  EXPECT_EQ(wait_for(*engine, 3).result, 0);
+  ::close(fds[0]);
+}
+
+TEST(IoEngineTest, AcceptsReceivesAndSends) {
+  for (auto backend : backends()) {
+    auto engine = cache::make_io_engine(backend);
+    SCOPED_TRACE(engine->name());
+    uint16_t port = 0;
+    int listener = listen_loopback(port);
+    engine->accept(listener, 1);
+
+    int client = connect_loopback(port);
+    cache::IoCompletion accepted = wait_for(*engine, 1);
+    ASSERT_GE(accepted.result, 0);
+    EXPECT_TRUE(accepted.more); // multishot: stays armed
+    int fd = accepted.result;
+
+    engine->recv(fd, 2);
+    ASSERT_EQ(::send(client, "hello", 5, 0), 5);
+    cache::IoCompletion received = wait_for(*engine, 2);
+    ASSERT_EQ(received.result, 5);
+    ASSERT_NE(received.data, nullptr);
+    EXPECT_EQ(std::string(received.data, 5), "hello");
+    EXPECT_TRUE(received.more);
+    engine->release(received.buffer);
+
+    std::string a = "wor", b = "ld";
+    iovec iov[2] = {{&a[0], a.size()}, {&b[0], b.size()}};
+    engine->send(fd, iov, 2, 3);
+    EXPECT_EQ(wait_for(*engine, 3).result, 5);
+    char reply[8] = {};
+    ASSERT_EQ(::recv(client, reply, sizeof(reply), MSG_WAITALL | MSG_DONTWAIT), 5);
+    EXPECT_EQ(std::string(reply, 5), "world");
+
+    ::close(client);
+    cache::IoCompletion eof = wait_for(*engine, 2);
+    EXPECT_EQ(eof.result, 0);
+    EXPECT_FALSE(eof.more);
+    ::close(fd);
+    engine.reset();
+    ::close(listener);
+  }
+}
+
+TEST(IoEngineTest, RecvRearmsAfterRunningOutOfBuffers) {
+  for (auto backend : backends()) {
+    cache::IoEngineOptions options;
+    options.buffer_count = 2;
+    options.buffer_size = 4;
+    auto engine = cache::make_io_engine(backend, options);
+    SCOPED_TRACE(engine->name());
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair), 0);
+    std::string payload(64, 'x');
+    ASSERT_EQ(::send(pair[1], payload.data(), payload.size(), 0), 64);
+
+    // Hold every buffer until the recv gives up, then hand them back.
+    engine->recv(pair[0], 7);
+    std::vector<uint16_t> held;
+    std::vector<cache::IoCompletion> completions;
+    size_t received = 0;
+    bool ran_out = false;
+    for (int i = 0; i < 200 && received < payload.size(); ++i) {
+      completions.clear();
+      engine->wait(completions, 100);
+      for (const auto& c : completions) {
+        if (c.result > 0) {
+          received += static_cast<size_t>(c.result);
+          held.push_back(c.buffer);
+        }
+        if (!c.more) {
+          ASSERT_EQ(c.result, -ENOBUFS);
+          ran_out = true;
+          for (uint16_t id : held) engine->release(id);
+          held.clear();
+          engine->recv(pair[0], 7);
+        }
+      }
+    }
+    EXPECT_EQ(received, payload.size());
+    EXPECT_TRUE(ran_out);
+    ::shutdown(pair[0], SHUT_RDWR);
+    for (uint16_t id : held) engine->release(id);
+    engine.reset();
+    ::close(pair[0]);
+    ::close(pair[1]);
+  }
+}
+
+TEST(IoEngineTest, ReadsAtOffsetsIntoRegisteredBuffers) {
+  std::string path = "/tmp/hpc_io_engine_" + std::to_string(::getpid());
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(fd, 0);
+  std::string contents;
+  for (int i = 0; i < 1000; ++i) contents += std::to_string(i % 10);
+  ASSERT_EQ(::write(fd, contents.data(), contents.size()), static_cast<ssize_t>(contents.size()));
+
+  for (auto backend : backends()) {
+    auto engine = cache::make_io_engine(backend);
+    SCOPED_TRACE(engine->name());
+    static char pinned[4096];
+    iovec region{pinned, sizeof(pinned)};
+    ASSERT_TRUE(engine->register_buffers(&region, 1));
+    char plain[16];
+
+    // Queued reads go to the kernel together.
+    uint64_t before = engine->syscalls();
+    engine->read(fd, pinned, 10, 500, 1, 0);
+    engine->read(fd, plain, 16, 995, 2);
+    std::vector<cache::IoCompletion> completions;
+    while (completions.size() < 2) engine->wait(completions, 1000);
+    if (std::string(engine->name()) == "io_uring") {
+      EXPECT_LE(engine->syscalls() - before, 2u);
+    }
+    for (const auto& c : completions) {
+      if (c.tag == 1) {
+        EXPECT_EQ(c.result, 10);
+        EXPECT_EQ(std::string(pinned, 10), contents.substr(500, 10));
+      } else {
+        EXPECT_EQ(c.result, 5); // short read at end of file
+        EXPECT_EQ(std::string(plain, 5), contents.substr(995));
+      }
+    }
+  }
+  ::close(fd);
+  ::unlink(path.c_str());
+}
+
+TEST(IoEngineTest, WakeInterruptsWait) {
+  for (auto backend : backends()) {
+    auto engine = cache::make_io_engine(backend);
+    SCOPED_TRACE(engine->name());
+    std::thread waker([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      engine->wake();
+    });
+    std::vector<cache::IoCompletion> completions;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(engine->wait(completions, -1), 0u);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    waker.join();
+  }
+}
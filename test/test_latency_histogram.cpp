@@ -0,0 +1,36 @@
+#include "../include/cache/latency_histogram.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(LatencyHistogramTest, PercentilesWithinRelativeError) {
+  cache::LatencyHistogram h;
+  for (uint64_t v = 1; v <= 100000; ++v) h.record(v);
+  EXPECT_EQ(h.count(), 100000u);
+  EXPECT_NEAR(static_cast<double>(h.percentile(0.5)), 50000.0, 50000.0 * 0.04);
+  EXPECT_NEAR(static_cast<double>(h.percentile(0.99)), 99000.0, 99000.0 * 0.04);
+  EXPECT_EQ(h.percentile(0.0), 1u);
+}
+
+TEST(LatencyHistogramTest, MergesPerThreadStripes) {
+  cache::LatencyHistogram h;
+  std::vector<std::thread> ts;
+  for (int t = 0; t < 8; ++t) {
+    ts.emplace_back([&h, t] {
+      for (int i = 0; i < 1000; ++i) h.record(static_cast<uint64_t>(t + 1) * 1000);
+    });
+  }
+  for (auto& th : ts) th.join();
+  EXPECT_EQ(h.count(), 8000u);
+  EXPECT_NEAR(static_cast<double>(h.percentile(1.0)), 8000.0, 8000.0 * 0.04);
+}
+
+TEST(LatencyHistogramTest, CacheRecordsGetAndPutSeparately) {
+  cache::LRUCache<int, int, cache::FullTiming> c(16);
+  for (int i = 0; i < 10; ++i) c.put(i, i);
+  for (int i = 0; i < 5; ++i) (void)c.get(i);
+  EXPECT_EQ(c.metrics().histogram(cache::LatencyOp::Put).count(), 10u);
+  EXPECT_EQ(c.metrics().histogram(cache::LatencyOp::Get).count(), 5u);
+  EXPECT_GT(c.metrics().latency_percentile(cache::LatencyOp::Put, 0.5), 0u);
+}
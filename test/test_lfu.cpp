@@ -21,3 +21,21 @@ TEST(LFUCacheTest, EvictionLeastFrequent) {
   EXPECT_TRUE(c.get(3).has_value());
 }
 
+
+TEST(LFUCacheTest, EvictsLeastFrequentAfterRemovals) {
+  cache::LFUCache<int, int> c(3);
+  c.put(1, 10);
+  c.put(2, 20);
+  c.put(3, 30);
+  for (int i = 0; i < 2; ++i) (void)c.get(2);
+  (void)c.get(3);
+  EXPECT_TRUE(c.remove(1)); // empties the frequency-1 bucket
+  c.put(4, 40);
+  c.put(5, 50);              // full: evicts 4, the only key seen once
+  EXPECT_EQ(c.size(), 3u);
+  EXPECT_FALSE(c.get(4).has_value());
+  EXPECT_TRUE(c.get(2).has_value());
+  EXPECT_TRUE(c.get(3).has_value());
+  EXPECT_TRUE(c.get(5).has_value());
+  EXPECT_EQ(c.eviction_count(), 1u);
+}
@@ -0,0 +1,307 @@
+#include "../include/cache/loading_cache.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A steady clock that only moves when a test advances it.
+struct ManualClock {
+  using duration = std::chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<ManualClock>;
+  static constexpr bool is_steady = true;
+
+  static std::atomic<int64_t> ticks;
+  static time_point now() { return time_point(duration(ticks.load())); }
+  static void advance(std::chrono::milliseconds ms) {
+    ticks.fetch_add(std::chrono::duration_cast<duration>(ms).count());
+  }
+};
+std::atomic<int64_t> ManualClock::ticks{1};
+
+using Cache = cache::LoadingCache<std::string, int,
+                                  cache::LRUCache<std::string, cache::LoadedValue<int>>, ManualClock>;
+
+cache::LoadingOptions options(double refresh_ahead, std::chrono::milliseconds grace) {
+  cache::LoadingOptions o;
+  o.ttl = std::chrono::milliseconds(1000);
+  o.refresh_ahead = refresh_ahead;
+  o.stale_grace = grace;
+  o.xfetch_beta = 0;
+  o.refresh_threads = 1;
+  return o;
+}
+
+void wait_for_refreshes(Cache& c, uint64_t n) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((c.refreshes() + c.refresh_failures() < n || c.refreshes_in_flight() > 0) &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+// The policy cache under a LoadingCache, with a put() that can be held
+// at the door so a test can act while LoadingCache::put() is under way.
+struct GatedLRU : cache::LRUCache<std::string, cache::LoadedValue<int>> {
+  using LRUCache::LRUCache;
+
+  bool put(const std::string& key, const cache::LoadedValue<int>& value) override {
+    if (hold.exchange(false)) {
+      entered.set_value();
+      released.wait();
+    }
+    return LRUCache::put(key, value);
+  }
+
+  std::atomic<bool> hold{false};
+  std::promise<void> entered;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+};
+
+} // namespace
+
+TEST(LoadingCacheTest, LoadsOnMissAndExpiresAfterTtl) {
+  std::atomic<int> calls{0};
+  Cache c(16, [&](const std::string& key) -> std::optional<int> {
+    if (key == "absent") return std::nullopt;
+    return ++calls;
+  }, options(0, std::chrono::milliseconds(0)));
+
+  EXPECT_EQ(c.get("a"), std::optional<int>(1));
+  EXPECT_EQ(c.get("a"), std::optional<int>(1));
+  EXPECT_EQ(c.loads(), 1u);
+  EXPECT_FALSE(c.get("absent").has_value());
+  EXPECT_EQ(c.size(), 1u); // misses at the source are not cached
+
+  ManualClock::advance(std::chrono::milliseconds(1001));
+  EXPECT_EQ(c.get("a"), std::optional<int>(2)); // expired, no grace: reloaded inline
+  EXPECT_EQ(c.refreshes(), 0u);
+
+  c.put("a", 42);
+  EXPECT_EQ(c.get("a"), std::optional<int>(42));
+}
+
+TEST(LoadingCacheTest, RefreshesAheadOfExpiryInTheBackground) {
+  std::atomic<int> version{1};
+  Cache c(16, [&](const std::string&) -> std::optional<int> { return version.load(); },
+          options(0.5, std::chrono::milliseconds(0)));
+  EXPECT_EQ(c.get("k"), std::optional<int>(1));
+
+  ManualClock::advance(std::chrono::milliseconds(400));
+  version = 2;
+  EXPECT_EQ(c.get("k"), std::optional<int>(1)); // still young
+  EXPECT_EQ(c.refreshes_in_flight(), 0u);
+
+  ManualClock::advance(std::chrono::milliseconds(200));
+  EXPECT_EQ(c.get("k"), std::optional<int>(1)); // current value returned, reload queued
+  wait_for_refreshes(c, 1);
+  EXPECT_EQ(c.refreshes(), 1u);
+  EXPECT_EQ(c.get("k"), std::optional<int>(2));
+  EXPECT_EQ(c.loads(), 1u); // no reader ever waited on the loader
+}
+
+TEST(LoadingCacheTest, ServesStaleWithinGraceWhileRevalidating) {
+  std::atomic<int> version{1};
+  Cache c(16, [&](const std::string&) -> std::optional<int> { return version.load(); },
+          options(0, std::chrono::milliseconds(500)));
+  EXPECT_EQ(c.get("k"), std::optional<int>(1));
+
+  version = 2;
+  ManualClock::advance(std::chrono::milliseconds(1200));
+  EXPECT_EQ(c.get("k"), std::optional<int>(1)); // stale but inside grace
+  EXPECT_EQ(c.stale_hits(), 1u);
+  wait_for_refreshes(c, 1);
+  EXPECT_EQ(c.get("k"), std::optional<int>(2));
+
+  version = 3;
+  ManualClock::advance(std::chrono::milliseconds(1600));
+  EXPECT_EQ(c.get("k"), std::optional<int>(3)); // past grace: loaded inline
+  EXPECT_EQ(c.loads(), 2u);
+}
+
+TEST(LoadingCacheTest, FailedRefreshKeepsTheOldValue) {
+  std::atomic<bool> fail{false};
+  Cache c(16, [&](const std::string&) -> std::optional<int> {
+    if (fail) throw std::runtime_error("backend down");
+    return 7;
+  }, options(0.5, std::chrono::milliseconds(0)));
+  EXPECT_EQ(c.get("k"), std::optional<int>(7));
+
+  fail = true;
+  ManualClock::advance(std::chrono::milliseconds(600));
+  EXPECT_EQ(c.get("k"), std::optional<int>(7));
+  wait_for_refreshes(c, 1);
+  EXPECT_EQ(c.refresh_failures(), 1u);
+  EXPECT_EQ(c.get("k"), std::optional<int>(7));
+
+  ManualClock::advance(std::chrono::milliseconds(600));
+  EXPECT_THROW(c.get("k"), std::runtime_error); // expired: the load error reaches the caller
+}
+
+TEST(LoadingCacheTest, XFetchRefreshesSlowLoadsEarly) {
+  // Each load "takes" 100ms of clock time. Right after a load a read only
+  // refreshes if -100ms * ln(u) >= 1s (u < 0.005%); 50ms before expiry it
+  // does for u < 60%.
+  Cache::Loader loader = [](const std::string&) -> std::optional<int> {
+    ManualClock::advance(std::chrono::milliseconds(100));
+    return 1;
+  };
+  cache::LoadingOptions o = options(0, std::chrono::milliseconds(0));
+  o.xfetch_beta = 1;
+  Cache c(16, loader, o);
+  EXPECT_EQ(c.get("k"), std::optional<int>(1));
+  for (int i = 0; i < 20; ++i) (void)c.get("k");
+  EXPECT_EQ(c.refreshes() + c.refreshes_in_flight(), 0u);
+
+  ManualClock::advance(std::chrono::milliseconds(950));
+  for (int i = 0; i < 100 && c.refreshes() + c.refreshes_in_flight() == 0; ++i) {
+    EXPECT_EQ(c.get("k"), std::optional<int>(1));
+  }
+  wait_for_refreshes(c, 1);
+  EXPECT_EQ(c.refreshes(), 1u);
+  EXPECT_EQ(c.loads(), 1u);
+}
+
+TEST(LoadingCacheTest, ConcurrentMissesShareOneLoad) {
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  std::atomic<int> calls{0};
+  Cache c(16, [&](const std::string&) -> std::optional<int> {
+    ++calls;
+    gate.wait();
+    return 5;
+  }, options(0, std::chrono::milliseconds(0)));
+
+  std::vector<std::future<std::optional<int>>> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.push_back(std::async(std::launch::async, [&] { return c.get("k"); }));
+  }
+  while (calls.load() == 0) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  release.set_value();
+  for (auto& r : readers) EXPECT_EQ(r.get(), std::optional<int>(5));
+  EXPECT_EQ(calls.load(), 1);
+  EXPECT_EQ(c.loads(), 1u);
+}
+
+TEST(LoadingCacheTest, OneRefreshPerKeyAndAFullQueueDrops) {
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  std::atomic<int> version{1};
+  cache::LoadingOptions o = options(0.5, std::chrono::milliseconds(0));
+  o.max_queued_refreshes = 1;
+  Cache c(16, [&](const std::string&) -> std::optional<int> {
+    if (version > 1) gate.wait();
+    return version.load();
+  }, o);
+  for (const char* key : {"a", "b", "c"}) (void)c.get(key);
+
+  version = 2;
+  ManualClock::advance(std::chrono::milliseconds(600));
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(c.get("a"), std::optional<int>(1));
+  EXPECT_EQ(c.refreshes_in_flight(), 1u); // deduplicated
+  // "a" occupies the worker (or the queue slot); one of "b"/"c" fits, at
+  // least the last one has nowhere to go.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  (void)c.get("b");
+  (void)c.get("c");
+  EXPECT_GE(c.refreshes_dropped(), 1u);
+  release.set_value();
+  wait_for_refreshes(c, 2);
+  EXPECT_EQ(c.get("a"), std::optional<int>(2));
+}
+
+TEST(LoadingCacheTest, WritesDuringALoadAreNotUndone) {
+  // The loader parks on `gate` once `park` is set, so the test can write
+  // to the key while the load is in flight.
+  std::atomic<bool> park{false};
+  std::atomic<int> parked{0};
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  cache::LoadingOptions two_refreshers = options(0.5, std::chrono::milliseconds(0));
+  two_refreshers.refresh_threads = 2; // both refreshes park at once
+  Cache c(16, [&](const std::string&) -> std::optional<int> {
+    if (park) {
+      parked.fetch_add(1);
+      gate.wait();
+      return 2;
+    }
+    return 1;
+  }, two_refreshers);
+  auto wait_parked = [&](int n) {
+    while (parked.load() < n) std::this_thread::yield();
+  };
+  for (const char* key : {"removed", "replaced"}) EXPECT_EQ(c.get(key), std::optional<int>(1));
+
+  park = true;
+  ManualClock::advance(std::chrono::milliseconds(600));
+  EXPECT_EQ(c.get("removed"), std::optional<int>(1)); // refresh starts
+  wait_parked(1);
+  EXPECT_TRUE(c.remove("removed"));
+  EXPECT_EQ(c.get("replaced"), std::optional<int>(1));
+  wait_parked(2);
+  EXPECT_TRUE(c.put("replaced", 99));
+
+  // A synchronous load raced by clear().
+  auto cleared = std::async(std::launch::async, [&] { return c.get("cleared"); });
+  wait_parked(3);
+  c.clear();
+  EXPECT_TRUE(c.put("other", 7));
+
+  release.set_value();
+  EXPECT_EQ(cleared.get(), std::optional<int>(2)); // the caller still gets what it loaded
+  wait_for_refreshes(c, 2);
+  EXPECT_EQ(c.refreshes(), 2u);
+  EXPECT_FALSE(c.cache().get("removed").has_value()); // not resurrected
+  EXPECT_FALSE(c.cache().get("replaced").has_value()); // cleared along with the rest
+  EXPECT_FALSE(c.cache().get("cleared").has_value());
+  EXPECT_EQ(c.get("other"), std::optional<int>(7));
+
+  // With nothing racing it, a reload is stored as before.
+  park = false;
+  EXPECT_TRUE(c.put("replaced", 99));
+  ManualClock::advance(std::chrono::milliseconds(600));
+  EXPECT_EQ(c.get("replaced"), std::optional<int>(99));
+  wait_for_refreshes(c, 3);
+  EXPECT_EQ(c.get("replaced"), std::optional<int>(1));
+}
+
+TEST(LoadingCacheTest, LoadsStartedDuringAPutDoNotUndoIt) {
+  std::atomic<int> calls{0};
+  std::promise<void> loader_entered;
+  std::promise<void> put_done;
+  std::shared_future<void> put_finished = put_done.get_future().share();
+  cache::LoadingCache<std::string, int, GatedLRU, ManualClock> c(
+      16, [&](const std::string&) -> std::optional<int> {
+        if (calls++ == 0) {
+          loader_entered.set_value();
+          put_finished.wait();
+        }
+        return 1;
+      }, options(0, std::chrono::milliseconds(0)));
+
+  // The writer stops inside the policy cache's put. A reader that misses
+  // now must not load a value that lands over the put.
+  c.cache().hold = true;
+  std::thread writer([&] {
+    EXPECT_TRUE(c.put("k", 99));
+    put_done.set_value();
+  });
+  c.cache().entered.get_future().wait();
+  auto read = std::async(std::launch::async, [&] { return c.get("k"); });
+  // Before the fix the reader reached the loader while the put was held.
+  loader_entered.get_future().wait_for(std::chrono::milliseconds(200));
+  c.cache().release.set_value();
+  writer.join();
+  EXPECT_EQ(read.get(), std::optional<int>(99));
+  EXPECT_EQ(c.get("k"), std::optional<int>(99));
+  EXPECT_EQ(calls.load(), 0);
+}
@@ -0,0 +1,174 @@
+#include "../include/cache/lru_cache.hpp"
+#include "../include/cache/maintenance_scheduler.hpp"
+#include "../include/cache/sharded_cache.hpp"
+#include <gtest/gtest.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+cache::MaintenanceOptions options(double low_water, double overshoot) {
+  cache::MaintenanceOptions o;
+  o.low_water = low_water;
+  o.overshoot = overshoot;
+  o.batch = 4; // several lock holds per pass
+  return o;
+}
+
+// Occupies a scheduler's only worker until released.
+struct Blocker : cache::MaintenanceTask {
+  std::promise<void> started;
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  void run() override {
+    started.set_value();
+    gate.wait();
+  }
+};
+
+// Records which thread destroyed it.
+struct Tracked {
+  explicit Tracked(std::thread::id* freed_by) : freed_by(freed_by) {}
+  ~Tracked() { *freed_by = std::this_thread::get_id(); }
+  std::thread::id* freed_by;
+};
+
+template<typename Key, typename Value>
+struct CollectingListener : cache::EvictionListener<Key, Value> {
+  void on_evict(const Key& key, Value&&) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    keys.push_back(key);
+  }
+  std::mutex mutex;
+  std::vector<Key> keys;
+};
+
+} // namespace
+
+TEST(MaintenanceSchedulerTest, EvictsInBatchesDownToLowWater) {
+  cache::MaintenanceScheduler scheduler(1);
+  cache::LRUCache<int, int> c(100);
+  c.set_maintenance(&scheduler, options(0.9, 0.1));
+  for (int i = 0; i < 100; ++i) c.put(i, i);
+  (void)c.get(0); // keep the oldest key recent
+  scheduler.wait_idle();
+  EXPECT_EQ(c.size(), 100u);
+  EXPECT_EQ(c.eviction_count(), 0u);
+
+  c.put(100, 100); // one past capacity queues a pass
+  scheduler.wait_idle();
+  EXPECT_EQ(c.size(), 90u);
+  EXPECT_EQ(c.eviction_count(), 11u);
+  EXPECT_TRUE(c.get(0).has_value());
+  for (int i = 1; i <= 11; ++i) EXPECT_FALSE(c.get(i).has_value()) << i;
+  EXPECT_TRUE(c.get(12).has_value());
+  EXPECT_GE(scheduler.runs(), 1u);
+}
+
+TEST(MaintenanceSchedulerTest, PutsEvictInlineOnceTheOvershootIsUsed) {
+  cache::MaintenanceScheduler scheduler(1);
+  Blocker blocker;
+  scheduler.schedule(blocker);
+  blocker.started.get_future().wait();
+
+  cache::LRUCache<int, int> c(100);
+  c.set_maintenance(&scheduler, options(0.9, 0.1));
+  for (int i = 0; i < 500; ++i) {
+    c.put(i, i);
+    ASSERT_LE(c.size(), 110u);
+  }
+  EXPECT_EQ(c.eviction_count(), 390u); // the scheduler is stuck; puts paid for it
+  blocker.release.set_value();
+  scheduler.wait_idle();
+  EXPECT_EQ(c.size(), 90u);
+  EXPECT_TRUE(c.get(499).has_value());
+}
+
+TEST(MaintenanceSchedulerTest, EvictedAndRemovedValuesAreFreedByTheWorker) {
+  cache::MaintenanceScheduler scheduler(1);
+  cache::LRUCache<int, std::shared_ptr<Tracked>> c(4);
+  c.set_maintenance(&scheduler, options(0.5, 0.5));
+  std::vector<std::thread::id> freed_by(8);
+  for (int i = 0; i < 5; ++i) c.put(i, std::make_shared<Tracked>(&freed_by[i]));
+  scheduler.wait_idle();
+  EXPECT_EQ(c.size(), 2u);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(freed_by[i], std::thread::id());
+    EXPECT_NE(freed_by[i], std::this_thread::get_id()) << i;
+  }
+
+  EXPECT_TRUE(c.remove(3));
+  scheduler.wait_idle();
+  EXPECT_NE(freed_by[3], std::thread::id());
+  EXPECT_NE(freed_by[3], std::this_thread::get_id());
+
+  c.clear();
+  scheduler.wait_idle();
+  EXPECT_NE(freed_by[4], std::thread::id());
+  EXPECT_NE(freed_by[4], std::this_thread::get_id());
+  EXPECT_EQ(c.size(), 0u);
+}
+
+TEST(MaintenanceSchedulerTest, ListenersStillSeeDeferredEvictions) {
+  cache::MaintenanceScheduler scheduler(1);
+  CollectingListener<std::string, std::string> listener;
+  cache::LRUCache<std::string, std::string> c(10);
+  c.set_eviction_listener(&listener);
+  c.set_maintenance(&scheduler, options(0.5, 0.2));
+  for (int i = 0; i < 11; ++i) c.put("k" + std::to_string(i), "v");
+  scheduler.wait_idle();
+  std::lock_guard<std::mutex> lock(listener.mutex);
+  ASSERT_EQ(listener.keys.size(), 6u);
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(listener.keys[i], "k" + std::to_string(i));
+}
+
+TEST(MaintenanceSchedulerTest, OneSchedulerServesEveryShardAndDetachTrims) {
+  cache::MaintenanceScheduler scheduler(2);
+  cache::ShardedCache<int, int> c(1024, 8);
+  for (size_t s = 0; s < 8; ++s) c.shard(s).set_maintenance(&scheduler, options(0.9, 0.1));
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&, t] {
+      for (int i = 0; i < 20000; ++i) c.put(t * 100000 + i, i);
+    });
+  }
+  for (auto& w : writers) w.join();
+  scheduler.wait_idle();
+  for (size_t s = 0; s < 8; ++s) {
+    EXPECT_LE(c.shard(s).size(), 128u) << s;
+    EXPECT_GE(c.shard(s).size(), 115u) << s;
+  }
+
+  // Detaching an over-full shard trims it back to capacity immediately.
+  Blocker blockers[2];
+  for (auto& b : blockers) {
+    scheduler.schedule(b);
+    b.started.get_future().wait();
+  }
+  for (int i = 0; i < 1000; ++i) c.shard(0).put(-i - 1, i);
+  EXPECT_GT(c.shard(0).size(), 128u);
+  c.shard(0).set_maintenance(nullptr);
+  EXPECT_EQ(c.shard(0).size(), 128u);
+  for (auto& b : blockers) b.release.set_value();
+  scheduler.wait_idle();
+}
+
+TEST(MaintenanceSchedulerTest, DestroyingACacheUnqueuesItsTask) {
+  cache::MaintenanceScheduler scheduler(1);
+  Blocker blocker;
+  scheduler.schedule(blocker);
+  blocker.started.get_future().wait();
+  {
+    cache::LRUCache<int, int> c(10);
+    c.set_maintenance(&scheduler);
+    for (int i = 0; i < 11; ++i) c.put(i, i); // queued behind the blocker
+  }
+  blocker.release.set_value();
+  scheduler.wait_idle();
+  EXPECT_EQ(scheduler.runs(), 1u); // only the blocker ran
+}
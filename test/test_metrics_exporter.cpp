@@ -0,0 +1,92 @@
+#include "../include/cache/lru_cache.hpp"
+#include "../include/cache/metrics_http_server.hpp"
+#include "../include/cache/metrics_registry.hpp"
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+TEST(MetricsExporterTest, RendersLabelledCaches) {
+  size_t before = cache::MetricsRegistry::instance().size();
+  {
+    cache::LRUCache<int, int> c(4, "sessions");
+    c.put(1, 1);
+    (void)c.get(1);
+    (void)c.get(2);
+    EXPECT_EQ(cache::MetricsRegistry::instance().size(), before + 1);
+    std::string text = cache::MetricsRegistry::instance().render_prometheus();
+    EXPECT_NE(text.find("# TYPE cache_hits_total counter"), std::string::npos);
+    EXPECT_NE(text.find("cache_hits_total{cache=\"sessions\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("cache_misses_total{cache=\"sessions\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("cache_size{cache=\"sessions\"} 1"), std::string::npos);
+  }
+  EXPECT_EQ(cache::MetricsRegistry::instance().size(), before);
+}
+
+TEST(MetricsExporterTest, SharedNamesGetTheirOwnSeries) {
+  auto& registry = cache::MetricsRegistry::instance();
+  auto a = std::make_unique<cache::LRUCache<int, int>>(4, "shared_name");
+  cache::LRUCache<int, int> b(4, "shared_name");
+  a->put(1, 1);
+  a->put(2, 2);
+  b.put(1, 1);
+  (void)a->get(1);
+  (void)b.get(1);
+  (void)b.get(2);
+  EXPECT_EQ(registry.instance_of(a->metrics()), "");
+  EXPECT_EQ(registry.instance_of(b.metrics()), "2");
+  std::string text = registry.render_prometheus();
+  EXPECT_NE(text.find("cache_hits_total{cache=\"shared_name\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("cache_misses_total{cache=\"shared_name\"} 0\n"), std::string::npos);
+  EXPECT_NE(text.find("cache_size{cache=\"shared_name\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("cache_hits_total{cache=\"shared_name\",instance=\"2\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("cache_misses_total{cache=\"shared_name\",instance=\"2\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("cache_size{cache=\"shared_name\",instance=\"2\"} 1\n"), std::string::npos);
+
+  // Destroying one cache drops its series; the other's counters stay.
+  a.reset();
+  text = registry.render_prometheus();
+  EXPECT_EQ(text.find("cache_hits_total{cache=\"shared_name\"}"), std::string::npos);
+  EXPECT_NE(text.find("cache_hits_total{cache=\"shared_name\",instance=\"2\"} 1\n"), std::string::npos);
+
+  // The unsuffixed label is free again, but suffixes are not reused.
+  cache::LRUCache<int, int> c(4, "shared_name");
+  EXPECT_EQ(registry.instance_of(c.metrics()), "");
+  cache::LRUCache<int, int> d(4, "shared_name");
+  EXPECT_EQ(registry.instance_of(d.metrics()), "3");
+
+  registry.set_instance(b.metrics(), "eu");
+  registry.set_instance(c.metrics(), "eu");
+  EXPECT_EQ(registry.instance_of(b.metrics()), "eu");
+  EXPECT_EQ(registry.instance_of(c.metrics()), "eu-2");
+  registry.set_instance(b.metrics(), "eu"); // unchanged, keeps its label
+  EXPECT_EQ(registry.instance_of(b.metrics()), "eu");
+}
+
+TEST(MetricsExporterTest, ServesMetricsOverHttp) {
+  cache::LRUCache<int, int> c(4, "http_scrape");
+  c.put(1, 1);
+  cache::MetricsHttpServer server(0);
+  server.start();
+  ASSERT_NE(server.port(), 0);
+
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(server.port());
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  const char req[] = "GET /metrics HTTP/1.0\r\n\r\n";
+  ASSERT_EQ(::send(fd, req, sizeof(req) - 1, 0), static_cast<ssize_t>(sizeof(req) - 1));
+  std::string body;
+  char buf[4096];
+  ssize_t n;
+  while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) body.append(buf, static_cast<size_t>(n));
+  ::close(fd);
+
+  EXPECT_EQ(body.rfind("HTTP/1.0 200 OK", 0), 0u);
+  EXPECT_NE(body.find("cache_size{cache=\"http_scrape\"} 1"), std::string::npos);
+  server.stop();
+}
@@ -0,0 +1,34 @@
+#include "../include/cache/lru_cache.hpp"
+#include "../include/cache/miss_ratio_curve.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(MissRatioCurveTest, ExactStackDistancesWithoutSampling) {
+  cache::MissRatioCurve mrc(1.0);
+  // Cyclic scan over 100 keys: LRU misses everything below 100 entries.
+  for (int round = 0; round < 10; ++round) {
+    for (int k = 0; k < 100; ++k) mrc.access(k);
+  }
+  EXPECT_EQ(mrc.sampled_references(), 1000u);
+  EXPECT_DOUBLE_EQ(mrc.hit_ratio(99), 0.0);
+  EXPECT_DOUBLE_EQ(mrc.hit_ratio(100), 0.9); // all but the cold first round
+}
+
+TEST(MissRatioCurveTest, SampledEstimateTracksSimulatedLRU) {
+  cache::MissRatioCurve mrc(0.05);
+  cache::MissRatioCurveObserver<int> hook(mrc);
+  cache::LRUCache<int, int> lru(2000);
+  lru.set_observer(&hook);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> hot(0, 999), cold(0, 99999);
+  for (int i = 0; i < 300000; ++i) {
+    int k = (i % 4 == 0) ? cold(rng) : hot(rng);
+    if (!lru.get(k)) lru.put(k, k);
+  }
+  lru.set_observer(nullptr);
+  EXPECT_GT(mrc.sampled_references(), 0u);
+  EXPECT_NEAR(mrc.hit_ratio(2000), lru.hit_rate(), 0.05);
+  auto curve = mrc.curve(10000, 5);
+  ASSERT_EQ(curve.size(), 5u);
+  for (size_t i = 1; i < curve.size(); ++i) EXPECT_LE(curve[i].second, curve[i - 1].second);
+}
@@ -0,0 +1,132 @@
+#include "../include/cache/near_cache.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(NearCacheTest, RepeatedReadsHitTheThreadLocalCopy) {
+  cache::NearCache<int, std::string> c(16);
+  EXPECT_TRUE(c.put(1, "one"));
+  EXPECT_EQ(c.get(1), std::optional<std::string>("one")); // fills L1 from L2
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(c.get(1), std::optional<std::string>("one"));
+  EXPECT_EQ(c.l1_hits(), 10u);
+  EXPECT_EQ(c.cache().hit_count(), 1u);
+  EXPECT_EQ(c.hit_count(), 11u);
+  EXPECT_FALSE(c.get(2).has_value());
+  EXPECT_EQ(c.miss_count(), 1u);
+}
+
+TEST(NearCacheTest, WritesInvalidateOtherThreadsCopies) {
+  cache::NearCache<int, int> c(16);
+  c.put(7, 1);
+  std::promise<void> filled, written;
+  auto reader = std::async(std::launch::async, [&] {
+    std::vector<std::optional<int>> seen;
+    seen.push_back(c.get(7));
+    seen.push_back(c.get(7)); // served from this thread's L1
+    filled.set_value();
+    written.get_future().wait();
+    seen.push_back(c.get(7));
+    return seen;
+  });
+  filled.get_future().wait();
+  c.put(7, 2);
+  written.set_value();
+  auto seen = reader.get();
+  EXPECT_EQ(seen[0], std::optional<int>(1));
+  EXPECT_EQ(seen[1], std::optional<int>(1));
+  EXPECT_EQ(seen[2], std::optional<int>(2));
+}
+
+TEST(NearCacheTest, RemoveAndClearInvalidate) {
+  cache::NearCache<std::string, std::string> c(16);
+  c.put("a", "1");
+  c.put("b", "2");
+  (void)c.get("a");
+  (void)c.get("b");
+  EXPECT_TRUE(c.remove("a"));
+  EXPECT_FALSE(c.get("a").has_value());
+  EXPECT_EQ(c.get("b"), std::optional<std::string>("2"));
+  c.clear();
+  EXPECT_FALSE(c.get("b").has_value());
+  EXPECT_EQ(c.size(), 0u);
+}
+
+TEST(NearCacheTest, ExitedThreadsReleaseTheirL1) {
+  cache::NearCache<int, std::string> c(16);
+  c.put(1, "one");
+  std::thread([&] {
+    EXPECT_TRUE(c.get(1).has_value()); // fills this thread's L1
+    EXPECT_TRUE(c.get(1).has_value());
+  }).join();
+  // The thread's hit is kept, but its L1 no longer pins the value: only
+  // L2 and this reference hold it.
+  EXPECT_EQ(c.l1_hits(), 1u);
+  auto ref = c.cache().get(1);
+  ASSERT_TRUE(ref.has_value());
+  EXPECT_EQ(ref->use_count(), 2);
+}
+
+TEST(NearCacheTest, CollidingKeysShareASlot) {
+  cache::NearCacheOptions options;
+  options.l1_slots = 1;
+  cache::NearCache<int, int> c(16, options);
+  for (int i = 0; i < 8; ++i) c.put(i, i * 10);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(c.get(i), std::optional<int>(i * 10));
+  }
+  EXPECT_EQ(c.l1_hits(), 0u); // each read displaced the previous key
+}
+
+TEST(NearCacheTest, HotKeysStayResidentInL2) {
+  cache::NearCacheOptions options;
+  options.l2_touch_interval = 4;
+  cache::NearCache<int, int> c(8, options);
+  c.put(-1, 42);
+  for (int i = 0; i < 200; ++i) {
+    c.put(i, i);
+    for (int r = 0; r < 4; ++r) EXPECT_EQ(c.get(-1), std::optional<int>(42));
+  }
+  // Periodic L2 reads kept the hot key from looking idle to the policy.
+  auto resident = c.cache().get(-1);
+  ASSERT_TRUE(resident.has_value());
+  EXPECT_EQ(**resident, 42);
+  EXPECT_GT(c.l1_hits(), 500u);
+}
+
+TEST(NearCacheTest, ReadersNeverSeeValuesOlderThanACompletedWrite) {
+  cache::NearCacheOptions options;
+  options.version_stripes = 4; // make neighbouring keys share stripes
+  cache::NearCache<int, int> c(1024, options);
+  constexpr int kKeys = 8;
+  constexpr int kWrites = 20000;
+  std::vector<std::atomic<int>> written(kKeys);
+  for (int k = 0; k < kKeys; ++k) {
+    c.put(k, 0);
+    written[k].store(0);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<int> stale{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&, t] {
+      for (int i = t; !done.load(std::memory_order_relaxed); ++i) {
+        int k = i % kKeys;
+        int floor = written[k].load(std::memory_order_acquire);
+        auto v = c.get(k);
+        if (!v || *v < floor) stale.fetch_add(1);
+      }
+    });
+  }
+  for (int i = 1; i <= kWrites; ++i) {
+    int k = i % kKeys;
+    c.put(k, i);
+    written[k].store(i, std::memory_order_release);
+  }
+  done.store(true);
+  for (auto& r : readers) r.join();
+  EXPECT_EQ(stale.load(), 0);
+}
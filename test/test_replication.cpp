@@ -0,0 +1,196 @@
+#include "../include/cache/replication.hpp"
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/metrics_registry.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+using Primary = cache::ReplicatedCache<std::string, std::string, cache::ARCCache<std::string, std::string>>;
+using Replica = cache::CacheReplica<std::string, std::string, cache::ARCCache<std::string, std::string>>;
+
+constexpr std::chrono::seconds kWait{10};
+
+std::string endpoint(const Primary& primary) {
+  return "127.0.0.1:" + std::to_string(primary.port());
+}
+
+cache::ReplicationOptions fast_options() {
+  cache::ReplicationOptions options;
+  options.heartbeat = std::chrono::milliseconds(10);
+  options.reconnect_delay = std::chrono::milliseconds(10);
+  return options;
+}
+
+} // namespace
+
+TEST(ReplicationLogTest, ReadsWholeRecordsUntilOverwritten) {
+  cache::ReplicationLog log(64);
+  uint64_t first = log.append("abc", 3);
+  EXPECT_EQ(first, 7u); // u32 length + bytes
+  log.append("defgh", 5);
+
+  std::string out;
+  size_t records = 0;
+  ASSERT_TRUE(log.read(0, 1024, out, records, std::chrono::milliseconds(0)));
+  EXPECT_EQ(records, 2u);
+  EXPECT_EQ(out.size(), 16u);
+  EXPECT_EQ(out.substr(4, 3), "abc");
+
+  // max_bytes stops at a record boundary but always returns one record.
+  out.clear();
+  ASSERT_TRUE(log.read(0, 1, out, records, std::chrono::milliseconds(0)));
+  EXPECT_EQ(records, 1u);
+  out.clear();
+  ASSERT_TRUE(log.read(first, 1024, out, records, std::chrono::milliseconds(0)));
+  EXPECT_EQ(out.substr(4), "defgh");
+
+  // Caught up: waits, then returns nothing.
+  out.clear();
+  ASSERT_TRUE(log.read(log.head(), 1024, out, records, std::chrono::milliseconds(5)));
+  EXPECT_EQ(records, 0u);
+
+  // Wrapping past the start makes offset 0 unreadable; the newest still reads.
+  for (int i = 0; i < 10; ++i) log.append("0123456789", 10);
+  uint64_t last = log.head() - 14;
+  EXPECT_FALSE(log.read(0, 1024, out, records, std::chrono::milliseconds(0)));
+  out.clear();
+  ASSERT_TRUE(log.read(last, 1024, out, records, std::chrono::milliseconds(0)));
+  EXPECT_EQ(out.substr(4), "0123456789");
+  EXPECT_FALSE(log.read(log.head() + 1, 1024, out, records, std::chrono::milliseconds(0)));
+}
+
+TEST(ReplicationTest, ReplicaBootstrapsFromSnapshotThenStreams) {
+  Primary primary(1000, fast_options(), "repl_primary");
+  for (int i = 0; i < 300; ++i) primary.put("k" + std::to_string(i), "v" + std::to_string(i));
+
+  Replica replica(1000, endpoint(primary), fast_options(), "repl_replica");
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.replication().full_syncs(), 1u);
+  EXPECT_EQ(replica.size(), 300u);
+  EXPECT_EQ(replica.get("k42"), std::optional<std::string>("v42"));
+
+  // Later mutations arrive as a stream, in order.
+  primary.put("k42", "changed");
+  primary.remove("k7");
+  for (int i = 300; i < 400; ++i) primary.put("k" + std::to_string(i), "v");
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.get("k42"), std::optional<std::string>("changed"));
+  EXPECT_FALSE(replica.get("k7").has_value());
+  EXPECT_EQ(replica.size(), primary.size());
+  EXPECT_EQ(replica.replication().full_syncs(), 1u);
+
+  primary.clear();
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.size(), 0u);
+
+  // Throughput on both ends; lag drains to zero once the acks arrive.
+  const cache::Metrics& applied = replica.replication().metrics();
+  EXPECT_EQ(applied.replicated_records(), 103u);
+  EXPECT_GT(applied.replicated_bytes(), 0u);
+  EXPECT_EQ(applied.replication_lag(), 0u);
+  EXPECT_EQ(primary.replication().metrics().replicated_records(), 103u);
+  EXPECT_EQ(primary.replication().replicas(), 1u);
+  auto deadline = std::chrono::steady_clock::now() + kWait;
+  while (primary.replication().metrics().replication_lag() != 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(primary.replication().metrics().replication_lag(), 0u);
+
+  std::string text = cache::MetricsRegistry::instance().render_prometheus();
+  EXPECT_NE(text.find("cache_replicated_records_total{cache=\"repl_replica_replication\"} 103"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE cache_replication_lag_bytes gauge"), std::string::npos);
+}
+
+TEST(ReplicationTest, ReconnectingReplicaResumesFromItsOffset) {
+  Primary primary(1000, fast_options(), "repl_resume_primary");
+  primary.put("a", "1");
+  Replica replica(1000, endpoint(primary), fast_options(), "repl_resume_replica");
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+
+  replica.replication().stop();
+  EXPECT_FALSE(replica.replication().connected());
+  primary.put("b", "2");
+  primary.remove("a");
+  EXPECT_EQ(replica.get("b"), std::nullopt);
+
+  replica.replication().start();
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.get("b"), std::optional<std::string>("2"));
+  EXPECT_FALSE(replica.get("a").has_value());
+  EXPECT_EQ(replica.replication().full_syncs(), 1u); // partial resync only
+  EXPECT_EQ(primary.replication().full_syncs(), 1u);
+}
+
+TEST(ReplicationTest, FullSyncWhenTheBacklogHasMovedOn) {
+  cache::ReplicationOptions options = fast_options();
+  options.backlog_bytes = 1024;
+  Primary primary(1000, options, "repl_overflow_primary");
+  primary.put("first", "1");
+  Replica replica(1000, endpoint(primary), options, "repl_overflow_replica");
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+
+  replica.replication().stop();
+  for (int i = 0; i < 200; ++i) primary.put("k" + std::to_string(i), std::string(32, 'x'));
+  replica.replication().start();
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.replication().full_syncs(), 2u);
+  EXPECT_EQ(replica.size(), primary.size());
+  EXPECT_EQ(replica.get("k199"), std::optional<std::string>(std::string(32, 'x')));
+}
+
+TEST(ReplicationTest, ReplicaWaitsForAPrimaryThatIsNotUpYet) {
+  cache::ReplicationOptions options = fast_options();
+  options.port = 0;
+  uint16_t port;
+  {
+    Primary probe(10, options, "repl_probe");
+    port = probe.port(); // free once probe is gone
+  }
+  Replica replica(100, "127.0.0.1:" + std::to_string(port), options, "repl_early_replica");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(replica.replication().connected());
+  EXPECT_GT(replica.replication().reconnects(), 0u);
+
+  options.port = port;
+  Primary primary(100, options, "repl_late_primary");
+  primary.put("x", "y");
+  ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+  EXPECT_EQ(replica.get("x"), std::optional<std::string>("y"));
+  EXPECT_THROW(Replica(10, "no-port"), std::invalid_argument);
+}
+
+TEST(ReplicationTest, StagesSnapshotsInPrivateDirectories) {
+  namespace fs = std::filesystem;
+  fs::path parent = fs::temp_directory_path() / ("repl_staging_" + std::to_string(::getpid()));
+  fs::remove_all(parent);
+  fs::create_directories(parent);
+  cache::ReplicationOptions options = fast_options();
+  options.snapshot_dir = parent.string();
+  {
+    Primary primary(1000, options, "repl_staging_primary");
+    primary.put("a", "1");
+    Replica replica(1000, endpoint(primary), options, "repl_staging_replica");
+    ASSERT_TRUE(replica.replication().wait_for(primary.offset(), kWait));
+    EXPECT_EQ(replica.get("a"), std::optional<std::string>("1"));
+
+    size_t dirs = 0;
+    for (const auto& entry : fs::directory_iterator(parent)) {
+      ASSERT_TRUE(entry.is_directory()) << entry.path();
+      EXPECT_EQ(entry.status().permissions() & fs::perms::all, fs::perms::owner_all) << entry.path();
+      EXPECT_TRUE(fs::is_empty(entry.path())) << entry.path(); // staged files are gone after use
+      ++dirs;
+    }
+    EXPECT_EQ(dirs, 2u); // one per endpoint
+  }
+  EXPECT_TRUE(fs::is_empty(parent)); // removed on stop
+  fs::remove_all(parent);
+}
@@ -0,0 +1,171 @@
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/resp_protocol.hpp"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::string render(const cache::ReplyBuilder& out) {
+  iovec iov[256];
+  int n = out.fill(iov, 256);
+  std::string text;
+  for (int i = 0; i < n; ++i) text.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  return text;
+}
+
+// Encodes a command as a RESP multi-bulk array.
+std::string command(std::initializer_list<std::string> args) {
+  std::string out = "*" + std::to_string(args.size()) + "\r\n";
+  for (const auto& a : args) out += "$" + std::to_string(a.size()) + "\r\n" + a + "\r\n";
+  return out;
+}
+
+struct RespHarness {
+  cache::ItemCache items{1024, 4, "resp_test"};
+  cache::RespHandler handler{items, 1024};
+  cache::ReplyBuilder out;
+
+  cache::ProcessResult feed(const std::string& input) { return handler.process(input.data(), input.size(), out); }
+
+  std::string take() {
+    std::string text = render(out);
+    out.clear();
+    return text;
+  }
+};
+
+} // namespace
+
+TEST(RespHandlerTest, SetGetAndMget) {
+  RespHarness h;
+  auto r = h.feed(command({"SET", "a", "1"}) + command({"set", "b", "two"}) + command({"GET", "a"}) +
+                  command({"MGET", "a", "missing", "b"}) + command({"GET", "missing"}));
+  EXPECT_EQ(r.commands, 5u);
+  EXPECT_EQ(h.take(), "+OK\r\n+OK\r\n$1\r\n1\r\n*3\r\n$1\r\n1\r\n$-1\r\n$3\r\ntwo\r\n$-1\r\n");
+}
+
+TEST(RespHandlerTest, BatchedReadsDoNotCrossWrites) {
+  RespHarness h;
+  h.feed(command({"SET", "k", "old"}) + command({"GET", "k"}) + command({"SET", "k", "new"}) +
+         command({"GET", "k"}) + command({"MGET", "k", "k"}));
+  EXPECT_EQ(h.take(), "+OK\r\n$3\r\nold\r\n+OK\r\n$3\r\nnew\r\n*2\r\n$3\r\nnew\r\n$3\r\nnew\r\n");
+}
+
+TEST(RespHandlerTest, Resp3NullsAfterHello) {
+  RespHarness h;
+  h.feed(command({"HELLO", "3"}));
+  std::string hello = h.take();
+  EXPECT_EQ(hello.rfind("%3\r\n", 0), 0u);
+  EXPECT_EQ(h.handler.protocol_version(), 3);
+  h.feed(command({"GET", "nope"}) + command({"MGET", "nope"}));
+  EXPECT_EQ(h.take(), "_\r\n*1\r\n_\r\n");
+  h.feed(command({"HELLO", "4"}));
+  EXPECT_EQ(h.take(), "-NOPROTO unsupported protocol version\r\n");
+}
+
+TEST(RespHandlerTest, DelAndExpire) {
+  RespHarness h;
+  h.feed(command({"SET", "a", "1"}) + command({"SET", "b", "2"}) + command({"DEL", "a", "b", "c"}));
+  EXPECT_EQ(h.take(), "+OK\r\n+OK\r\n:2\r\n");
+  h.feed(command({"SET", "t", "v", "EX", "100"}) + command({"EXPIRE", "t", "50"}) +
+         command({"EXPIRE", "gone", "50"}) + command({"EXPIRE", "t", "0"}) + command({"GET", "t"}));
+  EXPECT_EQ(h.take(), "+OK\r\n:1\r\n:0\r\n:1\r\n$-1\r\n");
+  h.feed(command({"SET", "x", "v", "PX", "1500"}));
+  EXPECT_EQ(h.take(), "+OK\r\n");
+  auto item = h.items.get("x");
+  ASSERT_TRUE(item.has_value());
+  EXPECT_GT(item->expires, 0);
+}
+
+TEST(RespHandlerTest, RejectsExpireTimesThatWouldOverflow) {
+  RespHarness h;
+  const std::string huge = "9223372036854775807";
+  h.feed(command({"SET", "a", "v", "EX", huge}) + command({"SET", "a", "v", "PX", huge}) +
+         command({"SET", "a", "v"}) + command({"EXPIRE", "a", huge}) + command({"GET", "a"}));
+  EXPECT_EQ(h.take(),
+            "-ERR invalid expire time in 'set' command\r\n"
+            "+OK\r\n" // PX in milliseconds still fits once converted to seconds
+            "+OK\r\n"
+            "-ERR invalid expire time in 'expire' command\r\n"
+            "$1\r\nv\r\n");
+}
+
+TEST(RespHandlerTest, InlineCommandsAndErrors) {
+  RespHarness h;
+  h.feed("PING\r\nSET k v\r\nGET k\r\nGET\r\nFLUSHALL\r\nSET k v XX 1\r\n");
+  EXPECT_EQ(h.take(),
+            "+PONG\r\n+OK\r\n$1\r\nv\r\n"
+            "-ERR wrong number of arguments for 'get' command\r\n"
+            "-ERR unknown command 'FLUSHALL'\r\n"
+            "-ERR syntax error\r\n");
+}
+
+TEST(RespHandlerTest, PartialCommandsWaitForMoreInput) {
+  RespHarness h;
+  std::string set = command({"SET", "key", "value"});
+  for (size_t cut = 1; cut < set.size(); ++cut) {
+    auto r = h.feed(set.substr(0, cut));
+    ASSERT_EQ(r.consumed, 0u) << cut;
+    ASSERT_EQ(r.commands, 0u);
+  }
+  auto r = h.feed(set + command({"GET", "key"}).substr(0, 5));
+  EXPECT_EQ(r.consumed, set.size());
+  EXPECT_EQ(h.take(), "+OK\r\n");
+}
+
+TEST(RespHandlerTest, ProtocolErrorClosesAfterEarlierReplies) {
+  RespHarness h;
+  auto r = h.feed(command({"PING"}) + "*1\r\n$x\r\n");
+  EXPECT_TRUE(r.close);
+  EXPECT_EQ(h.take(), "+PONG\r\n-Protocol error: invalid bulk length\r\n");
+}
+
+TEST(RespHandlerTest, QuitClosesConnection) {
+  RespHarness h;
+  auto r = h.feed(command({"QUIT"}) + command({"PING"}));
+  EXPECT_TRUE(r.close);
+  EXPECT_EQ(h.take(), "+OK\r\n");
+}
+
+TEST(RespServerTest, ServesPipelinedClientOverLoopback) {
+  cache::ItemCache items(1000, 4, "resp_server_test");
+  cache::ServerOptions options;
+  options.protocol = cache::ServerProtocol::Resp;
+  options.port = 0;
+  options.threads = 1;
+  cache::CacheServer server(items, options);
+  server.start();
+
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(server.port());
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+
+  std::string pipeline;
+  std::string expected;
+  for (int i = 0; i < 50; ++i) {
+    pipeline += command({"SET", "k" + std::to_string(i), std::string(100, 'a' + i % 26)});
+    expected += "+OK\r\n";
+  }
+  for (int i = 0; i < 50; ++i) {
+    pipeline += command({"GET", "k" + std::to_string(i)});
+    expected += "$100\r\n" + std::string(100, 'a' + i % 26) + "\r\n";
+  }
+  ASSERT_EQ(::send(fd, pipeline.data(), pipeline.size(), 0), static_cast<ssize_t>(pipeline.size()));
+  std::string reply;
+  char buf[4096];
+  while (reply.size() < expected.size()) {
+    ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) break;
+    reply.append(buf, static_cast<size_t>(n));
+  }
+  EXPECT_EQ(reply, expected);
+  ::close(fd);
+  server.stop();
+}
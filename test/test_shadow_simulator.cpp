@@ -0,0 +1,101 @@
+#include "../include/cache/shadow_simulator.hpp"
+#include "../include/lockfree/bounded_queue.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(ShadowSimulatorTest, BoundedQueueFifoAndFull) {
+  cache::BoundedQueue<int> q(4);
+  for (int i = 0; i < 4; ++i) EXPECT_TRUE(q.try_push(i));
+  EXPECT_FALSE(q.try_push(4));
+  int v = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(q.try_pop(v));
+    EXPECT_EQ(v, i);
+  }
+  EXPECT_FALSE(q.try_pop(v));
+}
+
+TEST(ShadowSimulatorTest, ProjectsLiveHitRate) {
+  cache::LRUCache<int, int> live(2000, "shadowed");
+  cache::ShadowSimulator<int> shadow(live.capacity(), 0.1, "shadowed");
+  live.set_observer(&shadow);
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> hot(0, 1499), cold(0, 199999);
+  for (int i = 0; i < 200000; ++i) {
+    int k = (i % 3 == 0) ? cold(rng) : hot(rng);
+    if (!live.get(k)) live.put(k, k);
+    if (i % 4096 == 0) shadow.drain(); // keep the test free of drops
+  }
+  live.set_observer(nullptr);
+  shadow.drain();
+  EXPECT_EQ(shadow.dropped_samples(), 0u);
+  EXPECT_GT(shadow.replayed_samples(), 0u);
+  EXPECT_NEAR(shadow.projected_hit_rate(cache::ShadowPolicy::LRU), live.hit_rate(), 0.05);
+  EXPECT_GT(shadow.projected_hit_rate(cache::ShadowPolicy::LFU), 0.0);
+  EXPECT_GT(shadow.projected_hit_rate(cache::ShadowPolicy::ARC), 0.0);
+}
+
+TEST(ShadowSimulatorTest, LookupsAreReplayedAsDemandFills) {
+  // Sampling everything makes each ghost as large as the live cache.
+  cache::ShadowSimulator<int> shadow(4, 1.0, "demand_fill");
+  for (int k = 0; k < 4; ++k) shadow.on_get(k, false); // no put follows
+  shadow.drain();
+  for (int k = 0; k < 4; ++k) shadow.on_get(k, true);
+  shadow.drain();
+  for (auto policy : {cache::ShadowPolicy::LRU, cache::ShadowPolicy::LFU, cache::ShadowPolicy::ARC}) {
+    EXPECT_EQ(shadow.metrics(policy).misses(), 4u);
+    EXPECT_EQ(shadow.metrics(policy).hits(), 4u);
+  }
+}
+
+TEST(ShadowSimulatorTest, FillAfterAMissIsNotASecondReference) {
+  // Ghost LFU of 2. Key 1 is looked up twice, each time followed by a
+  // live fill; key 2 is looked up three times. Counting the fills as
+  // references would tie them and evict 2 when 3 arrives.
+  cache::ShadowSimulator<int> shadow(2, 1.0, "fill_once");
+  auto miss_and_fill = [&](int k) {
+    shadow.on_get(k, false);
+    shadow.on_put(k);
+  };
+  miss_and_fill(1);
+  miss_and_fill(2);
+  shadow.on_get(2, true);
+  shadow.on_get(2, true);
+  miss_and_fill(1); // as if the live cache had lost 1
+  miss_and_fill(3);
+  shadow.drain();
+  uint64_t hits = shadow.metrics(cache::ShadowPolicy::LFU).hits();
+  shadow.on_get(2, true);
+  shadow.drain();
+  EXPECT_EQ(shadow.metrics(cache::ShadowPolicy::LFU).hits(), hits + 1);
+}
+
+TEST(ShadowSimulatorTest, ProjectsWriteFirstTraffic) {
+  // Every key is written before it is read, so the live cache only hits.
+  cache::LRUCache<int, int> live(2000, "write_first");
+  cache::ShadowSimulator<int> shadow(live.capacity(), 1.0, "write_first");
+  live.set_observer(&shadow);
+  for (int round = 0; round < 20; ++round) {
+    for (int k = round * 100; k < round * 100 + 100; ++k) live.put(k, k);
+    for (int k = round * 100; k < round * 100 + 100; ++k) EXPECT_TRUE(live.get(k).has_value());
+    shadow.drain();
+  }
+  live.set_observer(nullptr);
+  EXPECT_EQ(live.hit_rate(), 1.0);
+  for (auto policy : {cache::ShadowPolicy::LRU, cache::ShadowPolicy::LFU, cache::ShadowPolicy::ARC}) {
+    EXPECT_EQ(shadow.projected_hit_rate(policy), 1.0);
+  }
+
+  // Rewriting a resident key is not a reference: 1 stays the LFU victim.
+  cache::ShadowSimulator<int> small(2, 1.0, "rewrite");
+  small.on_put(1);
+  small.on_put(2);
+  small.on_get(2, true);
+  for (int i = 0; i < 3; ++i) small.on_put(1);
+  small.on_put(3);
+  small.drain();
+  uint64_t hits = small.metrics(cache::ShadowPolicy::LFU).hits();
+  small.on_get(2, true);
+  small.drain();
+  EXPECT_EQ(small.metrics(cache::ShadowPolicy::LFU).hits(), hits + 1);
+}
@@ -0,0 +1,64 @@
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/sharded_cache.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(ShardedCacheTest, RoutesKeysToStableShards) {
+  cache::ShardedCache<int, int> c(1024, 6);
+  EXPECT_EQ(c.shard_count(), 8u); // rounded up to a power of two
+  for (int i = 0; i < 500; ++i) c.put(i, i * 2);
+  for (int i = 0; i < 500; ++i) {
+    auto v = c.get(i);
+    ASSERT_TRUE(v.has_value());
+    EXPECT_EQ(*v, i * 2);
+    EXPECT_TRUE(c.shard(c.shard_index(i)).get(i).has_value());
+  }
+  EXPECT_EQ(c.size(), 500u);
+  EXPECT_EQ(c.hit_count(), 1000u);
+  EXPECT_TRUE(c.remove(3));
+  EXPECT_FALSE(c.get(3).has_value());
+}
+
+TEST(ShardedCacheTest, CapacityIsSplitAcrossShards) {
+  cache::ShardedCache<int, int, cache::ARCCache<int, int>> c(64, 4, "sharded_arc");
+  for (int i = 0; i < 10000; ++i) c.put(i, i);
+  EXPECT_LE(c.size(), c.capacity());
+  EXPECT_GT(c.eviction_count(), 0u);
+  size_t drained = 0;
+  while (c.take_victim()) ++drained;
+  EXPECT_GT(drained, 0u);
+  EXPECT_EQ(c.size(), 0u);
+}
+
+TEST(ShardedCacheTest, ConcurrentAccess) {
+  cache::ShardedCache<int, int> c(4096, 16);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&c, t] {
+      for (int i = 0; i < 20000; ++i) {
+        int k = (i * 31 + t) % 8192;
+        if (!c.get(k)) c.put(k, k);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  EXPECT_LE(c.size(), c.capacity());
+  EXPECT_EQ(c.hit_count() + c.miss_count(), 8u * 20000u);
+}
+
+TEST(ShardedCacheTest, GetManyKeepsRequestOrder) {
+  cache::ShardedCache<int, int> c(1024, 8);
+  for (int i = 0; i < 100; i += 2) c.put(i, i * 10);
+  std::vector<int> keys = {98, 1, 0, 51, 42, 42};
+  auto found = c.get_many(keys);
+  ASSERT_EQ(found.size(), keys.size());
+  EXPECT_EQ(*found[0], 980);
+  EXPECT_FALSE(found[1].has_value());
+  EXPECT_EQ(*found[2], 0);
+  EXPECT_FALSE(found[3].has_value());
+  EXPECT_EQ(*found[4], 420);
+  EXPECT_EQ(*found[5], 420);
+  EXPECT_EQ(c.hit_count(), 4u);
+  EXPECT_EQ(c.miss_count(), 2u);
+}
@@ -0,0 +1,174 @@
+#include "../include/cache/shared_memory_cache.hpp"
+#include <gtest/gtest.h>
+#include <csignal>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::string region_name(const char* name) {
+  return "/hpc_shm_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+// Runs fn in a forked child and returns its exit status.
+template <typename Fn>
+int in_child(Fn fn) {
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    int rc = 1;
+    try {
+      rc = fn();
+    } catch (...) {
+    }
+    ::_exit(rc);
+  }
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+} // namespace
+
+TEST(SharedMemoryCacheTest, EvictsLeastRecentlyUsed) {
+  std::string region = region_name("lru");
+  {
+    cache::SharedMemoryCache<int, int> c(region, 3);
+    EXPECT_TRUE(c.created());
+    c.put(1, 10);
+    c.put(2, 20);
+    c.put(3, 30);
+    (void)c.get(1);
+    c.put(4, 40);
+    EXPECT_FALSE(c.get(2).has_value());
+    EXPECT_EQ(*c.get(1), 10);
+    EXPECT_EQ(c.size(), 3u);
+    EXPECT_EQ(c.eviction_count(), 1u);
+
+    auto victim = c.take_victim();
+    ASSERT_TRUE(victim.has_value());
+    EXPECT_EQ(victim->first, 3);
+    EXPECT_TRUE(c.remove(4));
+    EXPECT_FALSE(c.remove(4));
+    EXPECT_EQ(c.size(), 1u);
+    c.clear();
+    EXPECT_EQ(c.size(), 0u);
+    c.put(5, 50);
+    EXPECT_EQ(*c.get(5), 50);
+  }
+  cache::SharedMemoryCache<int, int>::remove_region(region);
+}
+
+TEST(SharedMemoryCacheTest, EntriesAreVisibleAcrossProcesses) {
+  std::string region = region_name("cross");
+  cache::SharedMemoryCache<int, double> c(region, 1000);
+  int rc = in_child([&] {
+    cache::SharedMemoryCache<int, double> child(region, 1000, "shm_child");
+    if (child.created()) return 2;
+    for (int i = 0; i < 500; ++i) child.put(i, i * 0.5);
+    return child.get(7) ? 0 : 3;
+  });
+  ASSERT_EQ(rc, 0);
+  EXPECT_EQ(c.size(), 500u);
+  EXPECT_DOUBLE_EQ(*c.get(499), 249.5);
+  EXPECT_EQ(c.hit_count(), 2u); // one hit from each process
+  cache::SharedMemoryCache<int, double>::remove_region(region);
+}
+
+TEST(SharedMemoryCacheTest, ReattachKeepsContents) {
+  std::string region = region_name("reattach");
+  {
+    cache::SharedMemoryCache<int, int> first(region, 64);
+    first.put(42, 4200);
+  }
+  cache::SharedMemoryCache<int, int> second(region, 64);
+  EXPECT_FALSE(second.created());
+  EXPECT_EQ(*second.get(42), 4200);
+  cache::SharedMemoryCache<int, int>::remove_region(region);
+}
+
+TEST(SharedMemoryCacheTest, RejectsMismatchedLayout) {
+  std::string region = region_name("mismatch");
+  cache::SharedMemoryCache<int, int> c(region, 64);
+  EXPECT_THROW((cache::SharedMemoryCache<int, int>(region, 128)), std::runtime_error);
+  EXPECT_THROW((cache::SharedMemoryCache<int, double>(region, 64)), std::runtime_error);
+  cache::SharedMemoryCache<int, int>::remove_region(region);
+}
+
+TEST(SharedMemoryCacheTest, FileBackedRegion) {
+  std::string path = "/tmp" + region_name("file");
+  {
+    cache::SharedMemoryCache<uint64_t, uint64_t> c(path, 16);
+    c.put(1, 2);
+  }
+  cache::SharedMemoryCache<uint64_t, uint64_t> c(path, 16);
+  EXPECT_EQ(*c.get(1), 2u);
+  EXPECT_TRUE((cache::SharedMemoryCache<uint64_t, uint64_t>::remove_region(path)));
+}
+
+TEST(SharedMemoryCacheTest, ConcurrentProcessesKeepStructureConsistent) {
+  std::string region = region_name("concurrent");
+  constexpr size_t kCapacity = 256;
+  cache::SharedMemoryCache<int, int> c(region, kCapacity);
+  std::vector<pid_t> children;
+  for (int p = 0; p < 4; ++p) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      int rc = 0;
+      {
+        cache::SharedMemoryCache<int, int> child(region, kCapacity, "shm_worker");
+        uint32_t rng = 12345u + p;
+        for (int i = 0; i < 20000; ++i) {
+          rng = rng * 1664525u + 1013904223u;
+          int k = static_cast<int>(rng >> 22); // 1024 keys
+          if (rng & 1) {
+            child.put(k, k * 3);
+          } else if (auto v = child.get(k); v && *v != k * 3) {
+            rc = 1;
+          } else if ((rng & 0x70) == 0) {
+            child.remove(k);
+          }
+        }
+      }
+      ::_exit(rc);
+    }
+    children.push_back(pid);
+  }
+  for (pid_t pid : children) {
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+  EXPECT_LE(c.size(), kCapacity);
+  size_t found = 0;
+  for (int k = 0; k < 1024; ++k) {
+    if (auto v = c.get(k)) {
+      EXPECT_EQ(*v, k * 3);
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, c.size());
+  EXPECT_EQ(c.recoveries(), 0u);
+  cache::SharedMemoryCache<int, int>::remove_region(region);
+}
+
+TEST(SharedMemoryCacheTest, SurvivesWorkerKilledMidOperation) {
+  std::string region = region_name("killed");
+  cache::SharedMemoryCache<int, int> c(region, 128);
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    cache::SharedMemoryCache<int, int> child(region, 128, "shm_doomed");
+    for (int i = 0;; ++i) child.put(i & 1023, i);
+  }
+  // The child spends nearly all its time under the lock, so SIGKILL
+  // usually lands while it is held; the robust mutex must not deadlock us.
+  ::usleep(20000);
+  ::kill(pid, SIGKILL);
+  ::waitpid(pid, nullptr, 0);
+  c.put(-1, 1);
+  EXPECT_EQ(*c.get(-1), 1);
+  EXPECT_LE(c.recoveries(), 1u);
+  EXPECT_LE(c.size(), 128u);
+  cache::SharedMemoryCache<int, int>::remove_region(region);
+}
@@ -0,0 +1,124 @@
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/lfu_cache.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+std::string snapshot_path(const char* name) {
+  return "/tmp/hpc_snapshot_" + std::to_string(::getpid()) + "_" + name;
+}
+
+} // namespace
+
+TEST(SnapshotTest, LRURoundTripKeepsRecencyOrder) {
+  std::string path = snapshot_path("lru");
+  cache::LRUCache<int, std::string> a(3);
+  a.put(1, "one");
+  a.put(2, "two");
+  a.put(3, "three");
+  (void)a.get(1); // order: 1, 3, 2
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::LRUCache<int, std::string> b(3);
+  ASSERT_TRUE(b.load_snapshot(path));
+  EXPECT_EQ(b.size(), 3u);
+  EXPECT_EQ(*b.get(3), "three");
+  b.put(4, "four"); // LRU victim after the reads above is 2
+  EXPECT_FALSE(b.get(2).has_value());
+  EXPECT_EQ(*b.get(1), "one");
+  std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, LRUSnapshotOfCompressedValues) {
+  std::string path = snapshot_path("lru_compressed");
+  cache::LRUCache<int, std::string> a(100);
+  a.set_compression({true, 0.1, 16});
+  std::string payload(500, 'z');
+  for (int i = 0; i < 100; ++i) a.put(i, payload + std::to_string(i));
+  a.compress_cold(100);
+  ASSERT_GT(a.metrics().compressions(), 0u);
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::LRUCache<int, std::string> b(100);
+  ASSERT_TRUE(b.load_snapshot(path));
+  EXPECT_EQ(*b.get(0), payload + "0");
+  EXPECT_EQ(*b.get(99), payload + "99");
+  std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, LFURestoresFrequencies) {
+  std::string path = snapshot_path("lfu");
+  cache::LFUCache<uint64_t, uint64_t> a(3);
+  a.put(1, 10);
+  a.put(2, 20);
+  a.put(3, 30);
+  for (int i = 0; i < 5; ++i) (void)a.get(1);
+  (void)a.get(3);
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::LFUCache<uint64_t, uint64_t> b(3);
+  ASSERT_TRUE(b.load_snapshot(path));
+  b.put(4, 40); // key 2 has the lowest frequency
+  EXPECT_FALSE(b.get(2).has_value());
+  EXPECT_EQ(*b.get(1), 10u);
+  EXPECT_EQ(*b.get(3), 30u);
+  std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, ARCRestoresListsAndGhosts) {
+  std::string path = snapshot_path("arc");
+  cache::ARCCache<int, int> a(4);
+  for (int i = 0; i < 4; ++i) a.put(i, i);
+  (void)a.get(0);
+  (void)a.get(1);
+  for (int i = 4; i < 8; ++i) a.put(i, i); // pushes T1 entries into B1
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::ARCCache<int, int> b(4);
+  ASSERT_TRUE(b.load_snapshot(path));
+  EXPECT_EQ(b.size(), a.size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(b.get(i).has_value(), a.get(i).has_value()) << "key " << i;
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, LargeSnapshotUsesChunkIndex) {
+  std::string path = snapshot_path("large");
+  const int n = 200000; // several decode chunks
+  cache::LRUCache<int, std::string> a(n);
+  for (int i = 0; i < n; ++i) a.put(i, "v" + std::to_string(i));
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::LRUCache<int, std::string> b(n / 2);
+  ASSERT_TRUE(b.load_snapshot(path));
+  EXPECT_EQ(b.size(), static_cast<size_t>(n / 2));
+  EXPECT_EQ(*b.get(n - 1), "v" + std::to_string(n - 1)); // most recent kept
+  EXPECT_FALSE(b.get(0).has_value());
+  std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, RejectsMismatchedOrCorruptFiles) {
+  std::string path = snapshot_path("reject");
+  cache::LRUCache<int, int> a(10);
+  a.put(1, 1);
+  ASSERT_TRUE(a.save_snapshot(path).get());
+
+  cache::ARCCache<int, int> wrong_policy(10);
+  EXPECT_FALSE(wrong_policy.load_snapshot(path));
+  cache::LRUCache<int, std::string> wrong_type(10);
+  EXPECT_FALSE(wrong_type.load_snapshot(path));
+
+  { std::ofstream(path, std::ios::trunc) << "garbage"; }
+  cache::LRUCache<int, int> b(10);
+  b.put(5, 5);
+  EXPECT_FALSE(b.load_snapshot(path));
+  EXPECT_EQ(*b.get(5), 5); // contents untouched on failure
+  EXPECT_FALSE(b.load_snapshot(snapshot_path("missing")));
+  std::remove(path.c_str());
+}
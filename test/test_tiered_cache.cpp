@@ -0,0 +1,268 @@
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/tiered_cache.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::string flash_path(const char* name) {
+  return "/tmp/hpc_flash_" + std::to_string(::getpid()) + "_" + name;
+}
+
+cache::FlashOptions small_flash() {
+  cache::FlashOptions o;
+  o.file_bytes = 64 * 4096;
+  o.block_bytes = 4096;
+  o.read_threads = 2;
+  o.max_pending_blocks = 64;
+  return o;
+}
+
+// DRAM tier whose evictions can be held back, to open the window between
+// an eviction and its spill that the policy normally leaves to the scheduler.
+class GatedMemory : public cache::LRUCache<int, cache::TieredValue<std::string>> {
+public:
+  using Stored = cache::TieredValue<std::string>;
+  using cache::LRUCache<int, Stored>::LRUCache;
+
+  void set_eviction_listener(cache::EvictionListener<int, Stored>* listener) {
+    gate_.target = listener;
+    cache::LRUCache<int, Stored>::set_eviction_listener(listener ? &gate_ : nullptr);
+  }
+
+  void hold() { gate_.holding = true; }
+
+  void release() {
+    gate_.holding = false;
+    for (auto& e : gate_.held) gate_.target->on_evict(e.first, std::move(e.second));
+    gate_.held.clear();
+  }
+
+private:
+  struct Gate : cache::EvictionListener<int, Stored> {
+    void on_evict(const int& key, Stored&& value) override {
+      if (holding) {
+        held.emplace_back(key, std::move(value));
+      } else {
+        target->on_evict(key, std::move(value));
+      }
+    }
+    cache::EvictionListener<int, Stored>* target = nullptr;
+    bool holding = false;
+    std::vector<std::pair<int, Stored>> held;
+  };
+  Gate gate_;
+};
+
+} // namespace
+
+TEST(FlashStoreTest, ReadsFromBufferAndFile) {
+  std::string path = flash_path("store");
+  {
+    cache::FlashStore<int, std::string> f(path, small_flash());
+    EXPECT_TRUE(f.put(1, "one"));
+    EXPECT_EQ(*f.get(1), "one"); // still in the active block
+    for (int i = 2; i < 200; ++i) f.put(i, std::string(100, 'a' + i % 26));
+    f.flush();
+    EXPECT_GT(f.blocks_written(), 0u);
+    EXPECT_EQ(*f.get(1), "one"); // now from the file
+    EXPECT_EQ(*f.get_async(150).get(), std::string(100, 'a' + 150 % 26));
+    EXPECT_FALSE(f.get(1000).has_value());
+    EXPECT_TRUE(f.remove(1));
+    EXPECT_FALSE(f.get(1).has_value());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(FlashStoreTest, AsyncReadsOnEachBackend) {
+  std::vector<cache::IoBackend> backends = {cache::IoBackend::Epoll};
+  if (cache::io_uring_available()) backends.push_back(cache::IoBackend::IoUring);
+  for (auto backend : backends) {
+    std::string path = flash_path("async");
+    {
+      cache::FlashOptions options = small_flash();
+      options.block_bytes = 64 * 1024; // room for records past a registered read slot
+      options.file_bytes = 64 * options.block_bytes;
+      options.read_backend = backend;
+      cache::FlashStore<int, std::string> f(path, options);
+      EXPECT_STREQ(f.read_backend(), backend == cache::IoBackend::Epoll ? "thread_pool" : "io_uring");
+      auto value_of = [](int i) { return std::string(i % 7 == 0 ? 20000 + i : 100 + i, 'a' + i % 26); };
+      for (int i = 0; i < 300; ++i) f.put(i, value_of(i));
+      f.flush();
+
+      std::vector<std::future<std::optional<std::string>>> reads;
+      for (int i = 0; i < 300; ++i) reads.push_back(f.get_async(i));
+      reads.push_back(f.get_async(1000));
+      for (int i = 0; i < 300; ++i) {
+        auto value = reads[i].get();
+        ASSERT_TRUE(value.has_value()) << f.read_backend() << " " << i;
+        EXPECT_EQ(*value, value_of(i));
+      }
+      EXPECT_FALSE(reads.back().get().has_value());
+      EXPECT_EQ(f.metrics().hits(), 300u);
+      EXPECT_EQ(f.metrics().misses(), 1u);
+    }
+    std::remove(path.c_str());
+  }
+}
+
+TEST(FlashStoreTest, RingOverwriteDropsOldestEntries) {
+  std::string path = flash_path("ring");
+  {
+    cache::FlashStore<int, std::string> f(path, small_flash());
+    const std::string payload(1000, 'x');
+    for (int i = 0; i < 2000; ++i) { // ~8x the ring
+      // Let the writer keep up so no put is shed as backpressure.
+      if (i % 100 == 0) f.flush();
+      EXPECT_TRUE(f.put(i, payload));
+    }
+    f.flush();
+    EXPECT_EQ(f.dropped_writes(), 0u);
+    EXPECT_FALSE(f.get(0).has_value());
+    auto last = f.get(1999);
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(*last, payload);
+    EXPECT_LT(f.size(), 2000u);
+    EXPECT_GT(f.metrics().evictions(), 0u);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TieredCacheTest, EvictionsSpillAndPromote) {
+  std::string path = flash_path("tiered");
+  {
+    cache::TieredCache<int, std::string> c(10, path, small_flash());
+    for (int i = 0; i < 100; ++i) c.put(i, "v" + std::to_string(i));
+    EXPECT_EQ(c.memory().size(), 10u);
+    EXPECT_EQ(c.size(), 100u);
+
+    auto v = c.get(5); // served by flash, promoted to DRAM
+    ASSERT_TRUE(v.has_value());
+    EXPECT_EQ(*v, "v5");
+    EXPECT_TRUE(c.memory().get(5).has_value());
+    EXPECT_EQ(*c.get_async(7).get(), "v7");
+    EXPECT_GE(c.hit_count(), 2u);
+    EXPECT_FALSE(c.get(1000).has_value());
+    EXPECT_EQ(c.miss_count(), 1u);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TieredCacheTest, PutReplacesFlashCopy) {
+  std::string path = flash_path("tiered_put");
+  {
+    cache::TieredCache<int, std::string, cache::ARCCache<int, cache::TieredValue<std::string>>> c(4, path, small_flash());
+    for (int i = 0; i < 20; ++i) c.put(i, "old");
+    c.put(0, "new"); // key 0 had spilled to flash
+    for (int i = 20; i < 40; ++i) c.put(i, "filler");
+    EXPECT_EQ(*c.get(0), "new");
+    EXPECT_TRUE(c.remove(0));
+    EXPECT_FALSE(c.get(0).has_value());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TieredCacheTest, WritesDuringAPromotionWin) {
+  std::string path = flash_path("tiered_promote");
+  {
+    cache::TieredCache<int, std::string> c(2, path, small_flash());
+    for (int i = 0; i < 10; ++i) c.put(i, "old");
+    ASSERT_FALSE(c.memory().get(0).has_value());
+
+    // Waits for the pool's flash read; the promotion happens on get().
+    auto read_async = [&c](int key) {
+      size_t hits = c.flash().metrics().hits();
+      auto future = c.get_async(key);
+      while (c.flash().metrics().hits() == hits) std::this_thread::yield();
+      return future;
+    };
+    auto pending = read_async(0);
+    c.put(0, "new");
+    EXPECT_EQ(*pending.get(), "old");
+    EXPECT_EQ(*c.get(0), "new");
+
+    pending = read_async(1);
+    EXPECT_TRUE(c.remove(1));
+    EXPECT_EQ(*pending.get(), "old");
+    EXPECT_FALSE(c.get(1).has_value());
+    EXPECT_EQ(c.stale_promotions(), 2u);
+
+    EXPECT_EQ(*read_async(2).get(), "old"); // undisturbed: promoted
+    EXPECT_TRUE(c.memory().get(2).has_value());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TieredCacheTest, LateSpillsDoNotResurrectOrOverwrite) {
+  std::string path = flash_path("tiered_spill");
+  {
+    cache::TieredCache<int, std::string, GatedMemory> c(1, path, small_flash());
+    c.put(1, "one");
+    c.memory().hold();
+    c.put(2, "two");   // evicts 1; its spill is held back
+    c.remove(1);
+    c.put(1, "again"); // evicts 2
+    c.put(2, "later"); // evicts 1 ("again")
+    c.memory().release();
+    EXPECT_EQ(c.stale_spills(), 2u); // "one" and "two"; "again" reaches flash
+    EXPECT_EQ(*c.get(1), "again");
+    EXPECT_EQ(*c.get(2), "later");
+
+    c.memory().hold();
+    c.put(3, "three"); // evicts 2
+    c.remove(2);
+    c.memory().release();
+    EXPECT_FALSE(c.get(2).has_value());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TieredCacheTest, PromotionsAndSpillsNeverUndoWrites) {
+  // Each writer owns its keys and alternates put and remove on them, while
+  // readers keep promoting from flash and a tiny DRAM tier keeps spilling.
+  // A writer may miss its own key (a spill still in flight), but must never
+  // read an older value or one it has removed.
+  std::string path = flash_path("tiered_race");
+  {
+    cache::FlashOptions options = small_flash();
+    options.file_bytes = 1024 * 4096;
+    cache::TieredCache<int, std::string> c(8, path, options);
+    const int writers = 3, keys_per_writer = 16, rounds = 3000;
+    std::atomic<bool> done{false};
+    std::atomic<int> violations{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+      readers.emplace_back([&, r] {
+        for (int i = r; !done.load(); ++i) c.get(i % (writers * keys_per_writer));
+      });
+    }
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+      threads.emplace_back([&, w] {
+        for (int round = 1; round <= rounds; ++round) {
+          int k = w * keys_per_writer + round % keys_per_writer;
+          std::string value = std::to_string(round);
+          if (round % 5 == 0) {
+            c.remove(k);
+            if (c.get(k).has_value()) ++violations;
+          } else {
+            c.put(k, value);
+            auto seen = c.get(k);
+            if (seen && *seen != value) ++violations;
+          }
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    done = true;
+    for (auto& t : readers) t.join();
+    EXPECT_EQ(violations.load(), 0);
+  }
+  std::remove(path.c_str());
+}
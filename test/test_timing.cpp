@@ -0,0 +1,28 @@
+#include "../include/cache/lru_cache.hpp"
+#include "../include/cache/timing.hpp"
+#include <gtest/gtest.h>
+
+TEST(TimingTest, TscCalibrated) {
+  EXPECT_GT(cache::TscClock::ns_per_tick(), 0.0);
+  uint64_t t0 = cache::TscClock::now();
+  uint64_t t1 = cache::TscClock::now();
+  EXPECT_GE(t1, t0);
+}
+
+TEST(TimingTest, NoTimingRecordsNothing) {
+  cache::LRUCache<int, int, cache::NoTiming> c(8);
+  for (int i = 0; i < 100; ++i) c.put(i % 8, i);
+  EXPECT_EQ(c.metrics().histogram(cache::LatencyOp::Put).count(), 0u);
+}
+
+TEST(TimingTest, SampledTimingRecordsFraction) {
+  cache::LRUCache<int, int, cache::SampledTiming> c(8);
+  c.timing().set_sample_rate(4);
+  const int ops = 40000;
+  for (int i = 0; i < ops; ++i) (void)c.get(i % 8);
+  double recorded = static_cast<double>(c.metrics().histogram(cache::LatencyOp::Get).count());
+  EXPECT_NEAR(recorded, ops / 4.0, ops / 4.0 * 0.1);
+  c.timing().set_sample_rate(0);
+  (void)c.get(1);
+  EXPECT_EQ(c.metrics().histogram(cache::LatencyOp::Get).count(), static_cast<uint64_t>(recorded));
+}
@@ -0,0 +1,202 @@
+#include "../tools/trace_reader.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Request = std::pair<uint64_t, uint32_t>;
+
+// A trace file under /tmp, removed when the test ends.
+class TraceFile {
+public:
+  TraceFile(const char* name, const std::string& contents)
+      : path_("/tmp/hpc_trace_" + std::to_string(::getpid()) + "_" + name) {
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  }
+  ~TraceFile() { std::remove(path_.c_str()); }
+
+  const std::string& path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+std::vector<Request> read_all(const std::string& path, const tools::TraceReader::Options& options,
+                              uint64_t* count = nullptr) {
+  tools::TraceReader reader(path, options);
+  std::vector<Request> requests;
+  uint64_t n = reader.for_each([&](uint64_t key, uint32_t size) { requests.emplace_back(key, size); });
+  if (count) *count = n;
+  return requests;
+}
+
+template<typename T>
+void append(std::string& out, T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.append(bytes, sizeof(T));
+}
+
+std::string oracle_record(uint32_t time, uint64_t id, uint32_t size, int64_t next) {
+  std::string record;
+  append(record, time);
+  append(record, id);
+  append(record, size);
+  append(record, next);
+  return record;
+}
+
+uint64_t fnv1a(const std::string& s) {
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+tools::TraceReader::Options text_options(int key_column, int size_column = 0) {
+  tools::TraceReader::Options options;
+  options.format = tools::TraceFormat::Text;
+  options.key_column = key_column;
+  options.size_column = size_column;
+  return options;
+}
+
+} // namespace
+
+TEST(TraceReaderTest, Binary64ReadsKeysInOrder) {
+  std::string contents;
+  for (uint64_t key : {7ull, 0ull, 1ull << 40, ~0ull}) append(contents, key);
+  TraceFile file("binary64", contents);
+  uint64_t count = 0;
+  auto requests = read_all(file.path(), tools::TraceReader::Options(), &count);
+  EXPECT_EQ(count, 4u);
+  std::vector<Request> expected = {{7, 1}, {0, 1}, {1ull << 40, 1}, {~0ull, 1}};
+  EXPECT_EQ(requests, expected);
+}
+
+TEST(TraceReaderTest, OracleGeneralReadsIdAndSize) {
+  std::string contents = oracle_record(1, 42, 4096, 10) + oracle_record(2, 1ull << 50, 17, -1) +
+                         oracle_record(3, 42, 4096, -1);
+  TraceFile file("oracle", contents);
+  tools::TraceReader::Options options;
+  options.format = tools::TraceFormat::OracleGeneral;
+  uint64_t count = 0;
+  auto requests = read_all(file.path(), options, &count);
+  EXPECT_EQ(count, 3u);
+  std::vector<Request> expected = {{42, 4096}, {1ull << 50, 17}, {42, 4096}};
+  EXPECT_EQ(requests, expected);
+}
+
+TEST(TraceReaderTest, TextPicksKeyAndSizeColumns) {
+  // Mixed separators, CRLF endings and a last line without a newline.
+  TraceFile file("text_columns", "100,5,512\r\n"
+                                 "200 6 1024\n"
+                                 "300\t7\t64\n"
+                                 "  400,, 8 ,\t2048");
+  std::vector<Request> keys_only = {{100, 1}, {200, 1}, {300, 1}, {400, 1}};
+  EXPECT_EQ(read_all(file.path(), text_options(1)), keys_only);
+
+  std::vector<Request> with_sizes = {{5, 512}, {6, 1024}, {7, 64}, {8, 2048}};
+  EXPECT_EQ(read_all(file.path(), text_options(2, 3)), with_sizes);
+}
+
+TEST(TraceReaderTest, TextHashesNonNumericKeys) {
+  TraceFile file("text_hashed", "user:1\nuser:2\nuser:1\n12x\n-5\n");
+  auto requests = read_all(file.path(), text_options(1));
+  ASSERT_EQ(requests.size(), 5u);
+  EXPECT_EQ(requests[0].first, fnv1a("user:1"));
+  EXPECT_EQ(requests[1].first, fnv1a("user:2"));
+  EXPECT_EQ(requests[2].first, requests[0].first);
+  EXPECT_NE(requests[0].first, requests[1].first);
+  // Only all-digit fields are numbers.
+  EXPECT_EQ(requests[3].first, fnv1a("12x"));
+  EXPECT_EQ(requests[4].first, fnv1a("-5"));
+}
+
+TEST(TraceReaderTest, TextSkipsCommentsBlankAndShortLines) {
+  TraceFile file("text_malformed", "# time,key,size\n"
+                                   "\n"
+                                   "1,10,100\n"
+                                   "2\n"          // no key column
+                                   "\r\n"         // blank with CR
+                                   " ,\t\n"       // separators only
+                                   "3,11\n"       // no size column: size 1
+                                   "#4,12,100\n"
+                                   "5,13,100\n\n");
+  uint64_t count = 0;
+  auto requests = read_all(file.path(), text_options(2, 3), &count);
+  EXPECT_EQ(count, 3u);
+  std::vector<Request> expected = {{10, 100}, {11, 1}, {13, 100}};
+  EXPECT_EQ(requests, expected);
+}
+
+TEST(TraceReaderTest, IgnoresTrailingPartialBinaryRecords) {
+  std::string binary;
+  append(binary, uint64_t{1});
+  append(binary, uint64_t{2});
+  binary.append("\x03\x00\x00", 3);
+  TraceFile binary_file("binary_partial", binary);
+  std::vector<Request> expected_binary = {{1, 1}, {2, 1}};
+  EXPECT_EQ(read_all(binary_file.path(), tools::TraceReader::Options()), expected_binary);
+
+  std::string oracle = oracle_record(1, 9, 32, -1) + oracle_record(2, 10, 64, -1).substr(0, 20);
+  TraceFile oracle_file("oracle_partial", oracle);
+  tools::TraceReader::Options options;
+  options.format = tools::TraceFormat::OracleGeneral;
+  std::vector<Request> expected_oracle = {{9, 32}};
+  EXPECT_EQ(read_all(oracle_file.path(), options), expected_oracle);
+}
+
+TEST(TraceReaderTest, LimitStopsEachFormat) {
+  std::string binary, oracle, text;
+  for (uint64_t i = 0; i < 10; ++i) {
+    append(binary, i);
+    oracle += oracle_record(static_cast<uint32_t>(i), i, 8, -1);
+    text += (i % 2 ? "# comment\n" : "") + std::to_string(i) + "\n";
+  }
+  TraceFile binary_file("limit_binary", binary);
+  TraceFile oracle_file("limit_oracle", oracle);
+  TraceFile text_file("limit_text", text);
+
+  tools::TraceReader::Options options;
+  options.limit = 3;
+  uint64_t count = 0;
+  EXPECT_EQ(read_all(binary_file.path(), options, &count).size(), 3u);
+  EXPECT_EQ(count, 3u);
+  options.format = tools::TraceFormat::OracleGeneral;
+  EXPECT_EQ(read_all(oracle_file.path(), options, &count).size(), 3u);
+  EXPECT_EQ(count, 3u);
+  options.format = tools::TraceFormat::Text;
+  auto requests = read_all(text_file.path(), options, &count);
+  EXPECT_EQ(count, 3u); // skipped comment lines do not count
+  std::vector<Request> expected = {{0, 1}, {1, 1}, {2, 1}};
+  EXPECT_EQ(requests, expected);
+
+  options.limit = 100; // past the end: the whole trace
+  EXPECT_EQ(read_all(text_file.path(), options).size(), 10u);
+}
+
+TEST(TraceReaderTest, EmptyAndMissingFiles) {
+  TraceFile empty("empty", "");
+  for (auto format : {tools::TraceFormat::Binary64, tools::TraceFormat::OracleGeneral, tools::TraceFormat::Text}) {
+    tools::TraceReader::Options options;
+    options.format = format;
+    tools::TraceReader reader(empty.path(), options);
+    EXPECT_EQ(reader.bytes(), 0u);
+    EXPECT_EQ(reader.for_each([](uint64_t, uint32_t) { FAIL(); }), 0u);
+  }
+  EXPECT_THROW(tools::TraceReader("/tmp/hpc_trace_missing_" + std::to_string(::getpid()),
+                                  tools::TraceReader::Options()),
+               std::runtime_error);
+}
@@ -0,0 +1,200 @@
+// cache_loadgen: open-loop load generator. Each of N threads issues
+// operations on a fixed schedule (one every threads/rate seconds) and
+// measures latency from the *intended* send time, so time spent queued
+// behind a slow operation is counted instead of silently skipped
+// (coordinated-omission correction). Sweeps target rates for each policy
+// and shard count and marks the saturation knee.
+//
+//   cache_loadgen [--policy lru|lfu|arc|all] [--shards 1,8] [--threads N]
+//                 [--rates 1e6,2e6,...] [--duration SECONDS] [--read-pct P]
+//                 [--capacity N] [--keys N]
+#include "../benchmark/workload_patterns.hpp"
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/latency_histogram.hpp"
+#include "../include/cache/lfu_cache.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include "../include/cache/sharded_cache.hpp"
+#include "../include/cache/timing.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using LoadCache = cache::CacheInterface<int, int>;
+
+struct Config {
+    std::vector<std::string> policies = {"lru", "lfu", "arc"};
+    std::vector<size_t> shards = {1, 8};
+    std::vector<double> rates = {250e3, 500e3, 1e6, 2e6, 4e6, 8e6};
+    unsigned threads = 4;
+    double duration = 2.0;
+    unsigned read_pct = 95;
+    size_t capacity = 100000;
+    int keys = 1000000;
+};
+
+struct RunResult {
+    double achieved = 0.0;
+    uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0; // from intended send time
+    uint64_t service_p99 = 0;                     // from actual send time
+};
+
+template<template<class, class, class> class Policy>
+std::unique_ptr<LoadCache> make_sharded(size_t capacity, size_t shards, const std::string& name) {
+    using Shard = Policy<int, int, cache::NoTiming>;
+    return std::make_unique<cache::ShardedCache<int, int, Shard>>(capacity, shards, name);
+}
+
+std::unique_ptr<LoadCache> make_cache(const std::string& policy, size_t capacity, size_t shards) {
+    std::string name = "loadgen_" + policy;
+    if (policy == "lru") return make_sharded<cache::LRUCache>(capacity, shards, name);
+    if (policy == "lfu") return make_sharded<cache::LFUCache>(capacity, shards, name);
+    if (policy == "arc") return make_sharded<cache::ARCCache>(capacity, shards, name);
+    return nullptr;
+}
+
+RunResult run(LoadCache& c, const std::vector<int>& trace, const Config& cfg, double rate) {
+    cache::LatencyHistogram intended;
+    cache::LatencyHistogram service;
+    std::atomic<uint64_t> completed{0};
+    const double interval_ns = 1e9 * cfg.threads / rate;
+    const uint64_t ops_per_thread = static_cast<uint64_t>(rate * cfg.duration / cfg.threads);
+    const double ns_per_tick = cache::TscClock::ns_per_tick();
+    const uint64_t start = cache::TscClock::now() + static_cast<uint64_t>(1e6 / ns_per_tick);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < cfg.threads; ++t) {
+        threads.emplace_back([&, t] {
+            size_t idx = (t * trace.size()) / cfg.threads;
+            uint64_t rng = 0x9E3779B97F4A7C15ull * (t + 1);
+            // Stagger threads so the aggregate schedule is evenly spaced.
+            double offset = interval_ns * t / cfg.threads;
+            for (uint64_t i = 0; i < ops_per_thread; ++i) {
+                uint64_t due = start + static_cast<uint64_t>((offset + interval_ns * i) / ns_per_tick);
+                uint64_t now = cache::TscClock::now();
+                if (now < due) {
+                    double wait_ns = (due - now) * ns_per_tick;
+                    if (wait_ns > 100000) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(
+                            static_cast<int64_t>(wait_ns) - 50000));
+                    }
+                    while ((now = cache::TscClock::now()) < due) std::this_thread::yield();
+                }
+                int k = trace[idx];
+                if (++idx == trace.size()) idx = 0;
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                if (rng % 100 < cfg.read_pct) {
+                    if (!c.get(k)) c.put(k, k);
+                } else {
+                    c.put(k, k);
+                }
+                uint64_t done = cache::TscClock::now();
+                intended.record(cache::TscClock::to_ns(done - due));
+                service.record(cache::TscClock::to_ns(done - now));
+            }
+            completed.fetch_add(ops_per_thread, std::memory_order_relaxed);
+        });
+    }
+    for (auto& th : threads) th.join();
+    double elapsed = (cache::TscClock::now() - start) * ns_per_tick / 1e9;
+
+    RunResult r;
+    r.achieved = completed.load() / elapsed;
+    r.p50 = intended.percentile(0.5);
+    r.p99 = intended.percentile(0.99);
+    r.p999 = intended.percentile(0.999);
+    r.max = intended.percentile(1.0);
+    r.service_p99 = service.percentile(0.99);
+    return r;
+}
+
+template<typename T, typename Parse>
+std::vector<T> parse_list(const std::string& list, Parse parse) {
+    std::vector<T> out;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(static_cast<T>(parse(item)));
+    }
+    return out;
+}
+
+int usage() {
+    std::cerr << "usage: cache_loadgen [--policy lru|lfu|arc|all] [--shards N,N] [--threads N] "
+                 "[--rates R,R,...] [--duration S] [--read-pct P] [--capacity N] [--keys N]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config cfg;
+    auto to_double = [](const std::string& s) { return std::strtod(s.c_str(), nullptr); };
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[++i];
+        if (arg == "--policy") {
+            if (value != "all") cfg.policies = {value};
+        } else if (arg == "--shards") {
+            cfg.shards = parse_list<size_t>(value, to_double);
+        } else if (arg == "--threads") {
+            cfg.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--rates") {
+            cfg.rates = parse_list<double>(value, to_double);
+        } else if (arg == "--duration") {
+            cfg.duration = to_double(value);
+        } else if (arg == "--read-pct") {
+            cfg.read_pct = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (arg == "--capacity") {
+            cfg.capacity = static_cast<size_t>(to_double(value));
+        } else if (arg == "--keys") {
+            cfg.keys = static_cast<int>(to_double(value));
+        } else {
+            return usage();
+        }
+    }
+    for (const auto& p : cfg.policies) {
+        if (!make_cache(p, 1, 1)) return usage();
+    }
+
+    const auto trace = bench::zipf_keys(1 << 21, cfg.keys, 0.99);
+    std::printf("%-5s %6s %12s %12s %10s %10s %10s %12s %12s\n", "policy", "shards", "target/s",
+                "achieved/s", "p50_ns", "p99_ns", "p999_ns", "max_ns", "svc_p99_ns");
+    for (const auto& policy : cfg.policies) {
+        for (size_t shards : cfg.shards) {
+            uint64_t base_p99 = 0;
+            bool saturated = false;
+            for (double rate : cfg.rates) {
+                auto c = make_cache(policy, cfg.capacity, shards);
+                for (size_t i = 0; i < 2 * cfg.capacity && i < trace.size(); ++i) {
+                    if (!c->get(trace[i])) c->put(trace[i], trace[i]);
+                }
+                RunResult r = run(*c, trace, cfg, rate);
+                if (base_p99 == 0) base_p99 = std::max<uint64_t>(r.p99, 1);
+                // Knee: the rate is no longer sustained, or queueing has
+                // blown the corrected p99 up by 10x over the lightest load.
+                bool knee = !saturated && (r.achieved < 0.95 * rate || r.p99 > 10 * base_p99);
+                saturated = saturated || knee;
+                std::printf("%-5s %6zu %12.0f %12.0f %10llu %10llu %10llu %12llu %12llu%s\n",
+                            policy.c_str(), shards, rate,
+                            r.achieved, static_cast<unsigned long long>(r.p50),
+                            static_cast<unsigned long long>(r.p99),
+                            static_cast<unsigned long long>(r.p999),
+                            static_cast<unsigned long long>(r.max),
+                            static_cast<unsigned long long>(r.service_p99), knee ? "  <- knee" : "");
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// cache_server: cache service backed by a sharded LRU cache, speaking the
+// memcached text protocol on --port and, with --resp-port, the Redis
+// protocol alongside it. Runs until SIGINT or SIGTERM.
+//
+//   cache_server [--port 11211] [--resp-port 6379] [--bind 127.0.0.1]
+//                [--threads N] [--pin] [--capacity ITEMS] [--shards N]
+//                [--max-item-bytes N] [--io auto|epoll|io_uring] [--metrics-port P]
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/metrics_http_server.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+int usage() {
+    std::cerr << "usage: cache_server [--port P] [--resp-port P] [--bind ADDR] [--threads N] [--pin] "
+                 "[--capacity ITEMS] [--shards N] [--max-item-bytes N] [--io auto|epoll|io_uring] "
+                 "[--metrics-port P]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    cache::ServerOptions options;
+    size_t capacity = 1000000;
+    size_t shards = 0;
+    int metrics_port = -1;
+    int resp_port = -1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--pin") {
+            options.pin_threads = true;
+            continue;
+        }
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[++i];
+        if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(value.c_str()));
+        } else if (arg == "--resp-port") {
+            resp_port = std::atoi(value.c_str());
+        } else if (arg == "--bind") {
+            options.bind_address = value;
+        } else if (arg == "--threads") {
+            options.threads = static_cast<size_t>(std::atoi(value.c_str()));
+        } else if (arg == "--capacity") {
+            capacity = static_cast<size_t>(std::strtod(value.c_str(), nullptr));
+        } else if (arg == "--shards") {
+            shards = static_cast<size_t>(std::atoi(value.c_str()));
+        } else if (arg == "--max-item-bytes") {
+            options.max_item_bytes = static_cast<size_t>(std::strtod(value.c_str(), nullptr));
+        } else if (arg == "--io") {
+            if (value == "auto") options.io_backend = cache::IoBackend::Auto;
+            else if (value == "epoll") options.io_backend = cache::IoBackend::Epoll;
+            else if (value == "io_uring") options.io_backend = cache::IoBackend::IoUring;
+            else return usage();
+        } else if (arg == "--metrics-port") {
+            metrics_port = std::atoi(value.c_str());
+        } else {
+            return usage();
+        }
+    }
+
+    // Block the signals before any thread starts so only sigwait sees them.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    cache::ItemCache items(capacity, shards, "cache_server");
+    cache::CacheServer server(items, options);
+    std::unique_ptr<cache::CacheServer> resp;
+    std::unique_ptr<cache::MetricsHttpServer> metrics;
+    try {
+        server.start();
+        if (resp_port >= 0) {
+            cache::ServerOptions resp_options = options;
+            resp_options.protocol = cache::ServerProtocol::Resp;
+            resp_options.port = static_cast<uint16_t>(resp_port);
+            resp = std::make_unique<cache::CacheServer>(items, resp_options);
+            resp->start();
+        }
+        if (metrics_port >= 0) {
+            metrics = std::make_unique<cache::MetricsHttpServer>(static_cast<uint16_t>(metrics_port));
+            metrics->start();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "cache_server: " << e.what() << "\n";
+        return 1;
+    }
+    std::printf("cache_server listening on %s:%u (%zu shards, %zu items, %s)\n",
+                options.bind_address.c_str(), server.port(), items.shard_count(), items.capacity(),
+                server.io_engine());
+    if (resp) std::printf("RESP listening on %s:%u\n", options.bind_address.c_str(), resp->port());
+    std::fflush(stdout);
+
+    int sig = 0;
+    sigwait(&signals, &sig);
+    server.stop();
+    uint64_t connections = server.stats().connections.load();
+    uint64_t commands = server.stats().commands.load();
+    if (resp) {
+        resp->stop();
+        connections += resp->stats().connections.load();
+        commands += resp->stats().commands.load();
+    }
+    std::printf("connections=%llu commands=%llu hit_rate=%.3f\n",
+                static_cast<unsigned long long>(connections),
+                static_cast<unsigned long long>(commands), items.hit_rate());
+    return 0;
+}
@@ -0,0 +1,332 @@
+// cache_server_bench: closed-loop, pipelined load generator for the
+// memcached text protocol or, with --protocol resp, the Redis protocol.
+// Each thread drives its share of the connections: it sends
+// `--pipeline` requests on every connection in one write, then reads all
+// the replies, and records how long each batch took. `--embedded` starts
+// an in-process CacheServer on an ephemeral loopback port instead of
+// connecting to --host/--port, and also reports server syscalls per command
+// for the I/O engine picked with --io.
+//
+//   cache_server_bench [--protocol memcached|resp] [--host H] [--port P | --embedded]
+//                      [--server-threads N] [--io auto|epoll|io_uring]
+//                      [--threads N] [--connections N] [--pipeline N]
+//                      [--duration S] [--keys N] [--value-size B] [--get-pct P]
+#include "../benchmark/workload_patterns.hpp"
+#include "../include/cache/cache_server.hpp"
+#include "../include/cache/latency_histogram.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Config {
+    std::string host = "127.0.0.1";
+    uint16_t port = 11211;
+    bool resp = false;
+    bool embedded = false;
+    size_t server_threads = 1;
+    cache::IoBackend io_backend = cache::IoBackend::Auto;
+    unsigned threads = 2;
+    unsigned connections = 8;
+    unsigned pipeline = 16;
+    double duration = 5.0;
+    int keys = 100000;
+    size_t value_size = 100;
+    unsigned get_pct = 90;
+};
+
+int connect_to(const std::string& host, uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (fd < 0 || ::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+        ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror("connect");
+        std::exit(1);
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            std::perror("send");
+            std::exit(1);
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+void append_get(bool resp, std::string& batch, const std::string& key) {
+    if (resp) {
+        batch += "*2\r\n$3\r\nGET\r\n$" + std::to_string(key.size()) + "\r\n" + key + "\r\n";
+    } else {
+        batch += "get " + key + "\r\n";
+    }
+}
+
+void append_set(bool resp, std::string& batch, const std::string& key, const std::string& value) {
+    if (resp) {
+        batch += "*3\r\n$3\r\nSET\r\n$" + std::to_string(key.size()) + "\r\n" + key + "\r\n";
+        batch += "$" + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    } else {
+        batch += "set " + key + " 0 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    }
+}
+
+// Reads replies until `count` complete ones have arrived. memcached:
+// VALUE blocks are hits, END/STORED end a reply, anything else is an
+// error. RESP: a non-null bulk is a hit, simple strings and nulls are
+// fine, and '-' lines are errors.
+class ReplyReader {
+public:
+    ReplyReader(int fd, bool resp) : fd_(fd), resp_(resp) {}
+
+    void read(unsigned count, uint64_t& hits, uint64_t& errors) {
+        while (count > 0) {
+            size_t eol = buf_.find("\r\n", pos_);
+            if (eol == std::string::npos) {
+                fill();
+                continue;
+            }
+            size_t bytes = 0;
+            bool value = false;
+            if (resp_ && buf_[pos_] == '$' && buf_[pos_ + 1] != '-') {
+                bytes = std::strtoull(buf_.c_str() + pos_ + 1, nullptr, 10);
+                value = true;
+            } else if (!resp_ && buf_.compare(pos_, 6, "VALUE ") == 0) {
+                // VALUE <key> <flags> <bytes> [cas]
+                size_t bytes_at = buf_.find(' ', buf_.find(' ', pos_ + 6) + 1) + 1;
+                bytes = std::strtoull(buf_.c_str() + bytes_at, nullptr, 10);
+                value = true;
+            }
+            if (value) {
+                if (buf_.size() < eol + 2 + bytes + 2) {
+                    fill();
+                    continue;
+                }
+                pos_ = eol + 2 + bytes + 2;
+                ++hits;
+                if (!resp_) continue; // END follows
+                --count;
+                continue;
+            }
+            bool ok = resp_ ? buf_[pos_] != '-'
+                            : buf_.compare(pos_, eol - pos_, "END") == 0 ||
+                                  buf_.compare(pos_, eol - pos_, "STORED") == 0;
+            if (!ok) ++errors;
+            pos_ = eol + 2;
+            --count;
+        }
+        buf_.erase(0, pos_);
+        pos_ = 0;
+    }
+
+private:
+    void fill() {
+        char chunk[64 * 1024];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            std::cerr << "cache_server_bench: connection closed\n";
+            std::exit(1);
+        }
+        buf_.append(chunk, static_cast<size_t>(n));
+    }
+
+    int fd_;
+    bool resp_;
+    std::string buf_;
+    size_t pos_ = 0;
+};
+
+std::string key_name(int k) {
+    return "key:" + std::to_string(k);
+}
+
+void prefill(const Config& cfg, const std::string& value) {
+    int fd = connect_to(cfg.host, cfg.port);
+    ReplyReader reader(fd, cfg.resp);
+    uint64_t hits = 0, errors = 0;
+    constexpr int kBatch = 256;
+    for (int k = 0; k < cfg.keys; k += kBatch) {
+        std::string batch;
+        int n = std::min(kBatch, cfg.keys - k);
+        for (int i = 0; i < n; ++i) append_set(cfg.resp, batch, key_name(k + i), value);
+        send_all(fd, batch);
+        reader.read(static_cast<unsigned>(n), hits, errors);
+    }
+    ::close(fd);
+}
+
+int usage() {
+    std::cerr << "usage: cache_server_bench [--protocol memcached|resp] [--host H] [--port P | --embedded] "
+                 "[--server-threads N] [--io auto|epoll|io_uring] "
+                 "[--threads N] [--connections N] [--pipeline N] [--duration S] [--keys N] "
+                 "[--value-size B] [--get-pct P]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--embedded") {
+            cfg.embedded = true;
+            continue;
+        }
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[++i];
+        if (arg == "--protocol") {
+            if (value != "memcached" && value != "resp") return usage();
+            cfg.resp = value == "resp";
+        } else if (arg == "--host") {
+            cfg.host = value;
+        } else if (arg == "--port") {
+            cfg.port = static_cast<uint16_t>(std::atoi(value.c_str()));
+        } else if (arg == "--server-threads") {
+            cfg.server_threads = static_cast<size_t>(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--io") {
+            if (value == "auto") cfg.io_backend = cache::IoBackend::Auto;
+            else if (value == "epoll") cfg.io_backend = cache::IoBackend::Epoll;
+            else if (value == "io_uring") cfg.io_backend = cache::IoBackend::IoUring;
+            else return usage();
+        } else if (arg == "--threads") {
+            cfg.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--connections") {
+            cfg.connections = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--pipeline") {
+            cfg.pipeline = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--duration") {
+            cfg.duration = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--keys") {
+            cfg.keys = std::max(1, static_cast<int>(std::strtod(value.c_str(), nullptr)));
+        } else if (arg == "--value-size") {
+            cfg.value_size = static_cast<size_t>(std::atoi(value.c_str()));
+        } else if (arg == "--get-pct") {
+            cfg.get_pct = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else {
+            return usage();
+        }
+    }
+    cfg.threads = std::min(cfg.threads, cfg.connections);
+
+    std::unique_ptr<cache::ItemCache> items;
+    std::unique_ptr<cache::CacheServer> server;
+    if (cfg.embedded) {
+        items = std::make_unique<cache::ItemCache>(static_cast<size_t>(cfg.keys) * 2, 0, "bench_server");
+        cache::ServerOptions options;
+        options.port = 0;
+        options.threads = cfg.server_threads;
+        options.io_backend = cfg.io_backend;
+        options.protocol = cfg.resp ? cache::ServerProtocol::Resp : cache::ServerProtocol::Memcached;
+        server = std::make_unique<cache::CacheServer>(*items, options);
+        server->start();
+        cfg.host = "127.0.0.1";
+        cfg.port = server->port();
+    }
+
+    const std::string value(cfg.value_size, 'v');
+    prefill(cfg, value);
+    const auto trace = bench::zipf_keys(1 << 20, cfg.keys, 0.99);
+
+    cache::LatencyHistogram batch_latency;
+    std::atomic<uint64_t> total_ops{0};
+    std::atomic<uint64_t> total_gets{0};
+    std::atomic<uint64_t> total_hits{0};
+    std::atomic<uint64_t> total_errors{0};
+    std::atomic<bool> done{false};
+    uint64_t server_commands = server ? server->stats().commands.load() : 0;
+    uint64_t server_syscalls = server ? server->stats().syscalls.load() : 0;
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < cfg.threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<int> fds;
+            std::vector<ReplyReader> readers;
+            for (unsigned c = t; c < cfg.connections; c += cfg.threads) {
+                fds.push_back(connect_to(cfg.host, cfg.port));
+                readers.emplace_back(fds.back(), cfg.resp);
+            }
+            size_t idx = (t * trace.size()) / cfg.threads;
+            uint64_t rng = 0x9E3779B97F4A7C15ull * (t + 1);
+            uint64_t ops = 0, gets = 0, hits = 0, errors = 0;
+            std::vector<std::chrono::steady_clock::time_point> sent(fds.size());
+            std::string batch;
+            while (!done.load(std::memory_order_relaxed)) {
+                for (size_t c = 0; c < fds.size(); ++c) {
+                    batch.clear();
+                    for (unsigned i = 0; i < cfg.pipeline; ++i) {
+                        std::string key = key_name(trace[idx]);
+                        if (++idx == trace.size()) idx = 0;
+                        rng ^= rng << 13;
+                        rng ^= rng >> 7;
+                        rng ^= rng << 17;
+                        if (rng % 100 < cfg.get_pct) {
+                            append_get(cfg.resp, batch, key);
+                            ++gets;
+                        } else {
+                            append_set(cfg.resp, batch, key, value);
+                        }
+                    }
+                    sent[c] = std::chrono::steady_clock::now();
+                    send_all(fds[c], batch);
+                }
+                for (size_t c = 0; c < fds.size(); ++c) {
+                    readers[c].read(cfg.pipeline, hits, errors);
+                    auto elapsed = std::chrono::steady_clock::now() - sent[c];
+                    batch_latency.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                    ops += cfg.pipeline;
+                }
+            }
+            for (int fd : fds) ::close(fd);
+            total_ops += ops;
+            total_gets += gets;
+            total_hits += hits;
+            total_errors += errors;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(cfg.duration));
+    done = true;
+    for (auto& th : threads) th.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("protocol=%s threads=%u connections=%u pipeline=%u value_size=%zu get_pct=%u\n",
+                cfg.resp ? "resp" : "memcached", cfg.threads,
+                cfg.connections, cfg.pipeline, cfg.value_size, cfg.get_pct);
+    std::printf("ops/s=%.0f hit_rate=%.3f errors=%llu batch_p50_us=%.1f batch_p99_us=%.1f\n",
+                total_ops / elapsed,
+                total_gets ? static_cast<double>(total_hits) / total_gets : 0.0,
+                static_cast<unsigned long long>(total_errors.load()),
+                batch_latency.percentile(0.5) / 1e3, batch_latency.percentile(0.99) / 1e3);
+    if (server) {
+        const auto& stats = server->stats();
+        uint64_t commands = stats.commands.load() - server_commands;
+        uint64_t syscalls = stats.syscalls.load() - server_syscalls;
+        std::printf("io=%s server_syscalls_per_command=%.3f\n", server->io_engine(),
+                    commands ? static_cast<double>(syscalls) / commands : 0.0);
+        server->stop();
+    }
+    return total_errors.load() == 0 ? 0 : 1;
+}
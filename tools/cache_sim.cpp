@@ -0,0 +1,170 @@
+// cache_sim: replays a key trace through cache policies at several
+// capacities, one thread per (policy, capacity) point.
+//
+//   cache_sim TRACE [--format bin|oracle|text] [--policy lru|lfu|arc|adaptive|all]
+//             [--capacities 1000,10000,...] [--key-col N] [--size-col N] [--limit N]
+//
+// Every point reads the same read-only mapping of the trace, so the page
+// cache holds one copy no matter how many points run.
+#include "../include/cache/adaptive_cache.hpp"
+#include "../include/cache/arc_cache.hpp"
+#include "../include/cache/lfu_cache.hpp"
+#include "../include/cache/lru_cache.hpp"
+#include "trace_reader.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Key = uint64_t;
+using Size = uint32_t;
+using SimCache = cache::CacheInterface<Key, Size>;
+
+struct SimPoint {
+    std::string policy;
+    size_t capacity = 0;
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    uint64_t bytes = 0;
+    uint64_t hit_bytes = 0;
+    double seconds = 0.0;
+};
+
+std::unique_ptr<SimCache> make_cache(const std::string& policy, size_t capacity) {
+    std::string name = "sim_" + policy + "_" + std::to_string(capacity);
+    if (policy == "lru") return std::make_unique<cache::LRUCache<Key, Size, cache::NoTiming>>(capacity, name);
+    if (policy == "lfu") return std::make_unique<cache::LFUCache<Key, Size, cache::NoTiming>>(capacity, name);
+    if (policy == "arc") return std::make_unique<cache::ARCCache<Key, Size, cache::NoTiming>>(capacity, name);
+    if (policy == "adaptive") {
+        return std::make_unique<cache::AdaptiveCache<Key, Size, cache::NoTiming>>(capacity, name);
+    }
+    return nullptr;
+}
+
+// Demand-fill replay: a miss inserts the object, as a read-through cache would.
+void run_point(const tools::TraceReader& trace, SimPoint& point) {
+    auto c = make_cache(point.policy, point.capacity);
+    auto start = std::chrono::steady_clock::now();
+    point.requests = trace.for_each([&](Key key, Size size) {
+        point.bytes += size;
+        if (c->get(key)) {
+            ++point.hits;
+            point.hit_bytes += size;
+        } else {
+            c->put(key, size);
+        }
+    });
+    point.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<size_t> parse_capacities(const std::string& list) {
+    std::vector<size_t> out;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::strtoull(item.c_str(), nullptr, 10));
+    }
+    return out;
+}
+
+bool parse_format(const std::string& s, tools::TraceFormat& format) {
+    if (s == "bin") format = tools::TraceFormat::Binary64;
+    else if (s == "oracle") format = tools::TraceFormat::OracleGeneral;
+    else if (s == "text" || s == "csv") format = tools::TraceFormat::Text;
+    else return false;
+    return true;
+}
+
+int usage() {
+    std::cerr << "usage: cache_sim TRACE [--format bin|oracle|text] "
+                 "[--policy lru|lfu|arc|adaptive|all] [--capacities N,N,...] "
+                 "[--key-col N] [--size-col N] [--limit N]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string path = argv[1];
+    tools::TraceReader::Options options;
+    std::string policy = "all";
+    std::vector<size_t> capacities = {1000, 10000, 100000, 1000000};
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[++i];
+        if (arg == "--format") {
+            if (!parse_format(value, options.format)) return usage();
+        } else if (arg == "--policy") {
+            policy = value;
+        } else if (arg == "--capacities") {
+            capacities = parse_capacities(value);
+        } else if (arg == "--key-col") {
+            options.key_column = std::atoi(value.c_str());
+        } else if (arg == "--size-col") {
+            options.size_column = std::atoi(value.c_str());
+        } else if (arg == "--limit") {
+            options.limit = std::strtoull(value.c_str(), nullptr, 10);
+        } else {
+            return usage();
+        }
+    }
+
+    std::vector<std::string> policies;
+    if (policy == "all") {
+        policies = {"lru", "lfu", "arc", "adaptive"};
+    } else if (make_cache(policy, 1)) {
+        policies = {policy};
+    } else {
+        return usage();
+    }
+
+    std::unique_ptr<tools::TraceReader> trace;
+    try {
+        trace = std::make_unique<tools::TraceReader>(path, options);
+    } catch (const std::exception& e) {
+        std::cerr << "cache_sim: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<SimPoint> points;
+    for (const auto& p : policies) {
+        for (size_t cap : capacities) {
+            SimPoint point;
+            point.policy = p;
+            point.capacity = cap;
+            points.push_back(point);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(points.size());
+    for (auto& point : points) {
+        threads.emplace_back([&trace, &point] { run_point(*trace, point); });
+    }
+    for (auto& t : threads) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-9s %12s %12s %10s %14s %14s\n",
+                "policy", "capacity", "requests", "hit_ratio", "byte_hit_ratio", "ops/sec");
+    for (const auto& p : points) {
+        double hit = p.requests ? static_cast<double>(p.hits) / p.requests : 0.0;
+        double byte_hit = p.bytes ? static_cast<double>(p.hit_bytes) / p.bytes : 0.0;
+        double ops = p.seconds > 0 ? p.requests / p.seconds : 0.0;
+        std::printf("%-9s %12zu %12llu %10.4f %14.4f %14.0f\n", p.policy.c_str(), p.capacity,
+                    static_cast<unsigned long long>(p.requests), hit, byte_hit, ops);
+    }
+    std::printf("# %zu points, %.2f MB trace, %.2f s wall\n",
+                points.size(), trace->bytes() / 1e6, wall);
+    return 0;
+}
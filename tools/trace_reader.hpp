@@ -0,0 +1,148 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tools {
+
+enum class TraceFormat {
+    Binary64,      // little-endian uint64 key per request
+    OracleGeneral, // libCacheSim oracleGeneral: u32 time, u64 id, u32 size, i64 next
+    Text,          // one request per line, fields split by ',', ' ' or '\t'
+};
+
+// Read-only memory-mapped key trace. Binary records are decoded in place
+// straight out of the page cache; text lines are tokenised without copies.
+// Several replay threads can share one reader.
+class TraceReader {
+public:
+    struct Options {
+        TraceFormat format = TraceFormat::Binary64;
+        int key_column = 1;  // text: 1-based column holding the key
+        int size_column = 0; // text: 1-based column holding the size, 0 = none
+        uint64_t limit = 0;  // stop after this many requests, 0 = whole trace
+    };
+
+    TraceReader(const std::string& path, const Options& options) : options_(options) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) throw std::runtime_error("cannot open trace " + path);
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("cannot stat trace " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd_);
+                throw std::runtime_error("cannot mmap trace " + path);
+            }
+            data_ = static_cast<const char*>(p);
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    ~TraceReader() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    size_t bytes() const { return size_; }
+
+    // Calls fn(key, size) for each request in trace order.
+    template<typename Fn>
+    uint64_t for_each(Fn&& fn) const {
+        switch (options_.format) {
+            case TraceFormat::Binary64: return for_each_fixed(8, 0, -1, fn);
+            case TraceFormat::OracleGeneral: return for_each_fixed(24, 4, 12, fn);
+            case TraceFormat::Text: return for_each_text(fn);
+        }
+        return 0;
+    }
+
+private:
+    template<typename Fn>
+    uint64_t for_each_fixed(size_t record, size_t key_off, int size_off, Fn& fn) const {
+        uint64_t n = size_ / record;
+        if (options_.limit && options_.limit < n) n = options_.limit;
+        const char* p = data_;
+        for (uint64_t i = 0; i < n; ++i, p += record) {
+            uint64_t key;
+            std::memcpy(&key, p + key_off, sizeof(key));
+            uint32_t size = 1;
+            if (size_off >= 0) std::memcpy(&size, p + size_off, sizeof(size));
+            fn(key, size);
+        }
+        return n;
+    }
+
+    static bool is_separator(char c) { return c == ',' || c == ' ' || c == '\t' || c == '\r'; }
+
+    // Numeric fields are used as-is; anything else is hashed (FNV-1a).
+    static uint64_t parse_key(const char* b, const char* e) {
+        uint64_t v = 0;
+        const char* p = b;
+        for (; p < e && *p >= '0' && *p <= '9'; ++p) v = v * 10 + static_cast<uint64_t>(*p - '0');
+        if (p == e && b != e) return v;
+        uint64_t h = 1469598103934665603ull;
+        for (p = b; p < e; ++p) {
+            h ^= static_cast<unsigned char>(*p);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    template<typename Fn>
+    uint64_t for_each_text(Fn& fn) const {
+        uint64_t n = 0;
+        const char* p = data_;
+        const char* end = data_ + size_;
+        while (p < end && (!options_.limit || n < options_.limit)) {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!eol) eol = end;
+            if (eol > p && *p != '#') {
+                const char* key_b = nullptr;
+                const char* key_e = nullptr;
+                uint32_t size = 1;
+                int col = 0;
+                const char* q = p;
+                while (q < eol) {
+                    while (q < eol && is_separator(*q)) ++q;
+                    if (q == eol) break;
+                    const char* f = q;
+                    while (q < eol && !is_separator(*q)) ++q;
+                    ++col;
+                    if (col == options_.key_column) {
+                        key_b = f;
+                        key_e = q;
+                    } else if (col == options_.size_column) {
+                        size = static_cast<uint32_t>(parse_key(f, q));
+                    }
+                }
+                if (key_b) {
+                    fn(parse_key(key_b, key_e), size);
+                    ++n;
+                }
+            }
+            p = eol + 1;
+        }
+        return n;
+    }
+
+    Options options_;
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace tools